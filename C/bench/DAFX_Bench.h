@@ -0,0 +1,28 @@
+//
+//  DAFX_Bench.h
+//
+//  Timing shared by the benchmarks (processor time, so the load of the
+//  machine matters less than with the wall clock)
+//
+
+#ifndef DAFX_Bench_h
+#define DAFX_Bench_h
+
+#include <stdio.h>
+#include <time.h>
+
+//written with results so the compiler cannot drop the processing
+static volatile float dafx_bench_sink;
+
+static double DAFX_BenchSeconds(void)
+{
+    return (double)clock() / (double)CLOCKS_PER_SEC;
+}
+
+//nanoseconds per sample of a run over num_samples samples
+static double DAFX_BenchNsPerSample(double t_start, double t_end, double num_samples)
+{
+    return (t_end - t_start) * 1e9 / num_samples;
+}
+
+#endif /* DAFX_Bench_h */
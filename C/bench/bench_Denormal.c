@@ -0,0 +1,95 @@
+//
+//  bench_Denormal.c
+//
+//  Cost per block of a few recursive modules through a loud burst and the
+//  silence after it. Subnormal states would make the silent blocks several
+//  times slower on x86; with the guard they cost the same as the loud ones
+//
+
+#include "DAFX_Bench.h"
+#include "DAFX_BiquadFilter.h"
+#include "DAFX_Crossover.h"
+#include "DAFX_Crybaby.h"
+#include "DAFX_StateVariableFilter.h"
+#include <math.h>
+
+#define FS              48000
+#define BLOCK_LEN       64
+#define SECOND          (FS / BLOCK_LEN)
+#define NUM_REGIONS     4
+
+//burst, then silence: the first second, seconds 1 to 6, seconds 6 to 11
+static const int c_region_end[NUM_REGIONS] = {SECOND, 2 * SECOND, 7 * SECOND, 12 * SECOND};
+static const char *c_region_name[NUM_REGIONS] = {"burst", "silence 0-1 s", "silence 1-6 s", "silence 6-11 s"};
+
+int main(void)
+{
+    t_DAFXCrossover xover = {0};
+    t_DAFXCrybaby cb = {0};
+    t_DAFXStateVariableFilter svf = {0};
+    t_DAFX_BiquadFilter bq;
+    float in[BLOCK_LEN];
+    unsigned int seed = 1;
+    int blk = 0;
+
+    xover.block_size = BLOCK_LEN;
+    xover.fs = FS;
+    InitDAFXCrossover(&xover);
+    cb.block_size = BLOCK_LEN;
+    cb.fs = FS;
+    InitDAFXCrybaby(&cb);
+    svf.block_size = BLOCK_LEN;
+    svf.fs = FS;
+    InitDAFXStateVariableFilter(&svf);
+    SVF_SetCutoff(&svf, 60.0f);
+    SVF_SetQ(&svf, 8.0f);
+
+    //40 Hz low pass, Q 10
+    double w0 = 2.0 * M_PI * 40.0 / FS;
+    double alpha = sin(w0) / 20.0;
+    float coeffs[6] = {(float)((1.0 - cos(w0)) * 0.5), (float)(1.0 - cos(w0)), (float)((1.0 - cos(w0)) * 0.5),
+                       (float)(1.0 + alpha), (float)(-2.0 * cos(w0)), (float)(1.0 - alpha)};
+    bq.buffer_len = BLOCK_LEN;
+    InitBiquadFilter(&bq);
+    SetBiquadFilterCoeffs(&bq, coeffs);
+
+    printf("ns/block of crossover + crybaby + SVF + biquad, %d samples per block\n", BLOCK_LEN);
+    for (int r = 0; r < NUM_REGIONS; r++)
+    {
+        int num_blocks = c_region_end[r] - blk;
+        double t0 = DAFX_BenchSeconds();
+
+        //the input is made in the loop too, a small part of the cost next to the modules
+        for (; blk < c_region_end[r]; blk++)
+        {
+            for (int i = 0; i < BLOCK_LEN; i++) {
+                seed = seed * 1664525u + 1013904223u;
+                in[i] = (r == 0) ? (float)(seed >> 9) * (1.0f / 8388608.0f) - 1.0f : 0.0f;
+            }
+            memcpy(xover.p_input_block, in, sizeof(in));
+            memcpy(cb.p_input_block, in, sizeof(in));
+            memcpy(svf.p_input_block, in, sizeof(in));
+            memcpy(bq.pInBuff, in, sizeof(in));
+
+            DAFXProcessCrossover(&xover);
+            DAFXProcessCrybaby(&cb);
+            DAFXProcessStateVariableFilter(&svf);
+            ProcessBlockBiquad(&bq);
+        }
+        double t1 = DAFX_BenchSeconds();
+        dafx_bench_sink = bq.pOutBuff[0];
+
+        printf("  %-15s %10.0f\n", c_region_name[r], DAFX_BenchNsPerSample(t0, t1, num_blocks));
+    }
+
+    printf("subnormal states seen: crybaby %u, SVF %u, biquad %u\n",
+           cb.p_biquad->denormal_stats.num_subnormals, svf.denormal_stats.num_subnormals,
+           bq.denormal_stats.num_subnormals);
+
+    DeallocDAFXCrossover(&xover);
+    DeallocDAFXCrybaby(&cb);
+    DeallocDAFXStateVariableFilter(&svf);
+    DeallocBiquadFilter(&bq);
+
+    return 0;
+}
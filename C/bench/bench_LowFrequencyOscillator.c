@@ -0,0 +1,50 @@
+//
+//  bench_LowFrequencyOscillator.c
+//
+//  ns/sample of the LFO sine and sawtooth, the recursive path (one call through
+//  pf_process_func per sample) against the block generators
+//
+
+#include "DAFX_Bench.h"
+#include "DAFX_LowFrequencyOscillator.h"
+
+#define FS          48000
+#define NUM_SAMPLES 40000000.0
+
+static double _Bench(t_lfo_process_mode mode, t_lfo_algo_select algo, int len)
+{
+    t_DAFXLowFrequencyOscillator lfo = {0};
+    long num_blocks = (long)(NUM_SAMPLES / len);
+    double t0, t1;
+
+    lfo.block_size = len;
+    lfo.fs = FS;
+    InitDAFXLowFrequencyOscillator(&lfo);
+    LFO_SetFrequency(&lfo, 3.7f);
+    LFO_SetAmplitude(&lfo, 0.8f);
+    LFO_SetOffset(&lfo, 0.1f);
+    LFO_SetClipHigh(&lfo, 0.85f);
+    LFO_SetProcessMode(&lfo, mode);
+    LFO_SetMode(&lfo, algo);
+
+    t0 = DAFX_BenchSeconds();
+    for (long b = 0; b < num_blocks; b++)
+        DAFXLowFrequencyOscillator(&lfo);
+    t1 = DAFX_BenchSeconds();
+    dafx_bench_sink = lfo.p_output_block[len - 1];
+
+    DeallocDAFXLowFrequencyOscillator(&lfo);
+
+    return DAFX_BenchNsPerSample(t0, t1, (double)num_blocks * len);
+}
+
+int main(void)
+{
+    printf("block   recursive sine   block sine   recursive saw   block saw   (ns/sample)\n");
+    for (int len = 16; len <= 1024; len *= 4) {
+        printf("%5d   %14.3f   %10.3f   %13.3f   %9.3f\n", len,
+               _Bench(LFO_PROCESS_RECURSIVE, LFO_ALGO_SELECT_SIN, len), _Bench(LFO_PROCESS_BLOCK, LFO_ALGO_SELECT_SIN, len),
+               _Bench(LFO_PROCESS_RECURSIVE, LFO_ALGO_SELECT_SAW, len), _Bench(LFO_PROCESS_BLOCK, LFO_ALGO_SELECT_SAW, len));
+    }
+    return 0;
+}
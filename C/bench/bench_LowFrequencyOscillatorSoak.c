@@ -0,0 +1,83 @@
+//
+//  bench_LowFrequencyOscillatorSoak.c
+//
+//  10^9 samples (almost 6 hours at 48 kHz) of the recursive LFO sine and
+//  sawtooth at a tempo synced rate: ns/sample, and the largest error against
+//  the exact phase, checked on every 1024th block and over the last second
+//
+
+#include "DAFX_Bench.h"
+#include "DAFX_LowFrequencyOscillator.h"
+#include <math.h>
+
+#define FS              48000
+#define BLOCK_LEN       64
+#define NUM_SAMPLES     1000000000L
+#define FREQ            (97.0f / 60.0f)     //97 bpm, no whole number of samples per period
+#define CHECK_EVERY     1024
+
+//sample n is at phase n f / fs, as in block mode
+static double _BlockError(t_lfo_algo_select algo, const float *p_out, long n)
+{
+    double inc = (double)FREQ / FS;
+    double max_err = 0.0;
+
+    for (int i = 0; i < BLOCK_LEN; i++)
+    {
+        double p = fmod((double)(n + i) * inc, 1.0);
+        double q = fmod(p + 0.25, 1.0);
+        double ref = (algo == LFO_ALGO_SELECT_SIN) ? sin(2.0 * M_PI * p) : (q < 0.5 ? 4.0 * q - 1.0 : 3.0 - 4.0 * q);
+        double err = fabs(ref - (double)p_out[i]);
+        if (err > max_err)
+            max_err = err;
+    }
+    return max_err;
+}
+
+static void _Soak(t_lfo_algo_select algo, const char *name)
+{
+    t_DAFXLowFrequencyOscillator lfo = {0};
+    long num_blocks = NUM_SAMPLES / BLOCK_LEN;
+    long last_second = num_blocks - FS / BLOCK_LEN;
+    double max_err = 0.0, last_err = 0.0;
+    double t0, t1;
+
+    lfo.block_size = BLOCK_LEN;
+    lfo.fs = FS;
+    InitDAFXLowFrequencyOscillator(&lfo);
+    LFO_SetProcessMode(&lfo, LFO_PROCESS_RECURSIVE);
+    LFO_SetMode(&lfo, algo);
+    LFO_SetFrequency(&lfo, FREQ);
+    LFO_SetBalance(&lfo, 0.5f);
+    LFO_ReinitPhase(&lfo);
+
+    //the checks cost less than 0.1 % of the samples
+    t0 = DAFX_BenchSeconds();
+    for (long b = 0; b < num_blocks; b++)
+    {
+        DAFXLowFrequencyOscillator(&lfo);
+        if (b % CHECK_EVERY == 0 || b >= last_second)
+        {
+            double err = _BlockError(algo, lfo.p_output_block, b * BLOCK_LEN);
+            if (err > max_err)
+                max_err = err;
+            if (b >= last_second && err > last_err)
+                last_err = err;
+        }
+    }
+    t1 = DAFX_BenchSeconds();
+    dafx_bench_sink = lfo.p_output_block[0];
+
+    printf("%-8s %8.3f ns/sample   max error %.3g   in the last second %.3g\n", name,
+           DAFX_BenchNsPerSample(t0, t1, (double)num_blocks * BLOCK_LEN), max_err, last_err);
+
+    DeallocDAFXLowFrequencyOscillator(&lfo);
+}
+
+int main(void)
+{
+    printf("recursive LFO, %ld samples at %d Hz\n", NUM_SAMPLES, FS);
+    _Soak(LFO_ALGO_SELECT_SIN, "sine");
+    _Soak(LFO_ALGO_SELECT_SAW, "sawtooth");
+    return 0;
+}
@@ -0,0 +1,91 @@
+//
+//  bench_SOSCascade.c
+//
+//  ns/sample of the pipelined SOS cascade against the biquad chain it replaced
+//  in Crossover and Crybaby (one t_DAFX_BiquadFilter per stage, buffers chained)
+//
+
+#include "DAFX_Bench.h"
+#include "DAFX_BiquadFilter.h"
+#include "DAFX_SOSCascade.h"
+
+#define NUM_SAMPLES 32000000.0
+
+static const float c_coeffs[6] = {0.1f, 0.2f, 0.1f, 1.0f, -1.2f, 0.5f};
+
+static double _BenchChain(int num_stages, int len)
+{
+    t_DAFX_BiquadFilter *p_chain[8];
+    long num_blocks = (long)(NUM_SAMPLES / len);
+    double t0, t1;
+
+    for (int s = 0; s < num_stages; s++) {
+        p_chain[s] = (t_DAFX_BiquadFilter *) calloc(1, sizeof(t_DAFX_BiquadFilter));
+        p_chain[s]->buffer_len = len;
+        InitBiquadFilter(p_chain[s]);
+        SetBiquadFilterCoeffs(p_chain[s], (float *)c_coeffs);
+    }
+    //each stage writes straight into the input of the next one
+    for (int s = 1; s < num_stages; s++) {
+        free(p_chain[s-1]->pOutBuff);
+        p_chain[s-1]->pOutBuff = p_chain[s]->pInBuff;
+    }
+    for (int i = 0; i < len; i++)
+        p_chain[0]->pInBuff[i] = sinf((float)i);
+
+    t0 = DAFX_BenchSeconds();
+    for (long b = 0; b < num_blocks; b++)
+        for (int s = 0; s < num_stages; s++)
+            ProcessBlockBiquad(p_chain[s]);
+    t1 = DAFX_BenchSeconds();
+    dafx_bench_sink = p_chain[num_stages-1]->pOutBuff[0];
+
+    for (int s = 0; s < num_stages; s++) {
+        if (s < num_stages - 1)
+            p_chain[s]->pOutBuff = NULL;
+        DeallocBiquadFilter(p_chain[s]);
+        free(p_chain[s]);
+    }
+
+    return DAFX_BenchNsPerSample(t0, t1, (double)num_blocks * len);
+}
+
+static double _BenchCascade(int num_stages, int len)
+{
+    t_DAFX_SOSCascade sos;
+    float in[4096], out[4096];
+    long num_blocks = (long)(NUM_SAMPLES / len);
+    double t0, t1;
+
+    sos.num_stages = num_stages;
+    InitSOSCascade(&sos);
+    for (int s = 0; s < num_stages; s++)
+        SetSOSCascadeStageCoeffs(&sos, s, (float *)c_coeffs);
+    for (int i = 0; i < len; i++)
+        in[i] = sinf((float)i);
+
+    t0 = DAFX_BenchSeconds();
+    for (long b = 0; b < num_blocks; b++)
+        ProcessBlockSOSCascade(&sos, in, out, len);
+    t1 = DAFX_BenchSeconds();
+    dafx_bench_sink = out[0];
+
+    DeallocSOSCascade(&sos);
+
+    return DAFX_BenchNsPerSample(t0, t1, (double)num_blocks * len);
+}
+
+int main(void)
+{
+    const int stage_counts[] = {2, 4, 8};
+    const int lens[] = {16, 64, 256};
+
+    printf("stages  block   chain ns/sample   cascade ns/sample\n");
+    for (int s = 0; s < 3; s++) {
+        for (int l = 0; l < 3; l++) {
+            printf("%6d  %5d   %15.3f   %17.3f\n", stage_counts[s], lens[l],
+                   _BenchChain(stage_counts[s], lens[l]), _BenchCascade(stage_counts[s], lens[l]));
+        }
+    }
+    return 0;
+}
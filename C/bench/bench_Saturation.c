@@ -0,0 +1,75 @@
+//
+//  bench_Saturation.c
+//
+//  tanh approximation tiers: ns/sample on 64 sample blocks of audio range input,
+//  and the max error against double precision tanh over [-20, 20]
+//
+
+#include "DAFX_Bench.h"
+#include "DAFX_Saturation.h"
+#include <math.h>
+
+#define BLOCK_LEN   64
+#define NUM_BLOCKS  500000
+#define NUM_POINTS  (1 << 20)
+
+static const char *c_tier_name[Saturation_N_TANH_TIERS] = {"libm tanhf", "exp", "pade", "poly"};
+
+static float in[NUM_POINTS];
+static float out[NUM_POINTS];
+
+static double _MaxError(t_sat_tanh_tier tier)
+{
+    double max_err = 0.0;
+
+    for (int i = 0; i < NUM_POINTS; i++)
+        in[i] = -20.0f + 40.0f * (float)i / (float)(NUM_POINTS - 1);
+    SAT_TanhBlock(tier, in, out, NUM_POINTS, 1.0f, 1.0f);
+
+    for (int i = 0; i < NUM_POINTS; i++) {
+        double err = fabs((double)out[i] - tanh((double)in[i]));
+        if (err > max_err)
+            max_err = err;
+    }
+    return max_err;
+}
+
+static double _NsPerSample(t_sat_tanh_tier tier)
+{
+    float x[BLOCK_LEN], y[BLOCK_LEN];
+    double t0, t1;
+
+    for (int i = 0; i < BLOCK_LEN; i++)
+        x[i] = 0.9f * sinf(0.1f * (float)i);
+
+    t0 = DAFX_BenchSeconds();
+    for (int b = 0; b < NUM_BLOCKS; b++)
+        SAT_TanhBlock(tier, x, y, BLOCK_LEN, 5.0f, 0.75f);
+    t1 = DAFX_BenchSeconds();
+    dafx_bench_sink = y[BLOCK_LEN - 1];
+
+    return DAFX_BenchNsPerSample(t0, t1, (double)NUM_BLOCKS * BLOCK_LEN);
+}
+
+int main(void)
+{
+    double t0, t1;
+
+    printf("tier         ns/sample   max error\n");
+    for (int t = 0; t < Saturation_N_TANH_TIERS; t++)
+        printf("%-11s %10.3f   %9.2g\n", c_tier_name[t], _NsPerSample((t_sat_tanh_tier)t), _MaxError((t_sat_tanh_tier)t));
+
+    //what the Overdrive used to call for every sample
+    float x[BLOCK_LEN], acc = 0.0f;
+    for (int i = 0; i < BLOCK_LEN; i++)
+        x[i] = 0.9f * sinf(0.1f * (float)i);
+    t0 = DAFX_BenchSeconds();
+    for (int k = 0; k < NUM_BLOCKS * BLOCK_LEN / 8; k++)
+        acc += (float)tanh(5.0 * (double)x[k & (BLOCK_LEN - 1)]);
+    t1 = DAFX_BenchSeconds();
+    dafx_bench_sink = acc;
+    printf("(libm double tanh, one sample at a time: %.3f ns/sample)\n",
+           DAFX_BenchNsPerSample(t0, t1, (double)NUM_BLOCKS * BLOCK_LEN / 8));
+
+    return 0;
+}
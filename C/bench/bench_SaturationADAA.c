@@ -0,0 +1,153 @@
+//
+//  bench_SaturationADAA.c
+//
+//  Aliasing and cost of the shapers driven hard by a 2.5 kHz tone at 48 kHz:
+//  plain, 1st and 2nd order ADAA, and the plain shaper run 4x oversampled.
+//  The alias power is everything in the spectrum off the harmonics of the tone
+//  (which is on an odd bin, so no alias lands on a harmonic), relative to the
+//  power of the harmonics
+//
+
+#include "DAFX_Bench.h"
+#include "DAFX_Saturation.h"
+#include "DAFX_Oversampler.h"
+#include "DAFX_FFT.h"
+#include "DAFX_Denormal.h"
+#include <math.h>
+
+#define FS          48000
+#define FFT_SIZE    16384
+#define TONE_BIN    849
+#define BLOCK_LEN   64
+#define NUM_REPS    60
+
+//plain, ADAA 1, ADAA 2, 4x oversampling
+#define NUM_METHODS 4
+#define METHOD_OS4  3
+
+static const char *c_method_name[NUM_METHODS] = {"plain", "ADAA1", "ADAA2", "4x OS"};
+static const char *c_shape_name[Saturation_N_SHAPES] = {"tanh", "sine", "exp"};
+static const float c_drives[Saturation_N_SHAPES][2] = {{5.0f, 20.0f}, {2.0f, 8.0f}, {5.0f, 20.0f}};
+
+//2 analysis lengths: the first one lets the filters settle
+static float in[2 * FFT_SIZE];
+static float out[2 * FFT_SIZE];
+
+typedef struct{
+    t_sat_shape shape;
+    float drive;
+}t_shaper_state;
+
+//the plain shaper, at the oversampled rate
+static bool _Shaper(void *p_state, float *p_in, float *p_out, int n)
+{
+    t_shaper_state *pState = (t_shaper_state *) p_state;
+
+    switch (pState->shape) {
+        case SAT_SHAPE_SINE:
+            return SAT_SineClipBlock(p_in, p_out, n, pState->drive, 1.0f);
+        case SAT_SHAPE_EXP:
+            return SAT_ExpClipBlock(p_in, p_out, n, pState->drive, 1.0f);
+        default:
+            return SAT_TanhBlock(SAT_TANH_EXP, p_in, p_out, n, pState->drive, 1.0f);
+    }
+}
+
+static void _Run(int method, t_shaper_state *pShaper, t_DAFXSaturationADAA *pADAA, t_DAFXOversampler *pOS)
+{
+    for (int i = 0; i < 2 * FFT_SIZE; i += BLOCK_LEN)
+    {
+        if (method == METHOD_OS4)
+            DAFXOversampler(pOS, _Shaper, pShaper, in + i, out + i, BLOCK_LEN);
+        else
+            SAT_ADAABlock(pADAA, pShaper->shape, (t_sat_adaa_order)method, in + i, out + i, BLOCK_LEN, pShaper->drive, 1.0f);
+    }
+}
+
+//alias power against harmonic power in dB, over the whole band and below 20 kHz
+static void _AliasPower(t_DAFX_FFT *pFFT, float *p_re, float *p_im, double *p_alias_db, double *p_alias_20k_db)
+{
+    double harm = 0.0, alias = 0.0, alias_20k = 0.0;
+
+    FFTForwardReal(pFFT, out + FFT_SIZE, p_re, p_im);
+
+    //bin 0 is DC (and the Nyquist bin, in p_im[0]), left out
+    for (int k = 1; k < FFT_SIZE / 2; k++)
+    {
+        double p = (double)p_re[k] * p_re[k] + (double)p_im[k] * p_im[k];
+        if (k % TONE_BIN == 0) {
+            harm += p;
+        } else {
+            alias += p;
+            if ((double)k * FS / FFT_SIZE < 20000.0)
+                alias_20k += p;
+        }
+    }
+    *p_alias_db = 10.0 * log10(alias / harm);
+    *p_alias_20k_db = 10.0 * log10(alias_20k / harm);
+}
+
+int main(void)
+{
+    t_DAFX_FFT fft = {0};
+    t_DAFXSaturationADAA adaa = {0};
+    t_DAFXOversampler os = {0};
+    t_dafx_fp_state fp_state;
+
+    fft.size = FFT_SIZE;
+    InitFFT(&fft);
+    float *p_re = (float *) DAFX_AlignedCalloc(FFT_SIZE / 2, sizeof(float));
+    float *p_im = (float *) DAFX_AlignedCalloc(FFT_SIZE / 2, sizeof(float));
+
+    adaa.block_size = BLOCK_LEN;
+    InitDAFXSaturationADAA(&adaa);
+    os.block_size = BLOCK_LEN;
+    InitDAFXOversampler(&os);
+    OS_SetFactor(&os, 4);
+    OS_SetFilter(&os, OS_FILTER_LINEAR_PHASE);
+
+    for (int i = 0; i < 2 * FFT_SIZE; i++)
+        in[i] = (float)(0.9 * sin(2.0 * M_PI * TONE_BIN * (double)i / FFT_SIZE));
+
+    //as in a host callback: the shapers themselves do not guard against subnormals
+    DAFX_DenormalGuardBegin(&fp_state);
+
+    printf("%.0f Hz tone at %d Hz: alias power against harmonic power, cost\n", (double)TONE_BIN * FS / FFT_SIZE, FS);
+    for (int s = 0; s < Saturation_N_SHAPES; s++)
+    {
+        for (int d = 0; d < 2; d++)
+        {
+            t_shaper_state shaper = {(t_sat_shape)s, c_drives[s][d]};
+            printf("%s, drive %g\n", c_shape_name[s], shaper.drive);
+
+            for (int m = 0; m < NUM_METHODS; m++)
+            {
+                double alias_db, alias_20k_db;
+
+                SAT_ResetADAA(&adaa);
+                OS_Reset(&os);
+                _Run(m, &shaper, &adaa, &os);
+                _AliasPower(&fft, p_re, p_im, &alias_db, &alias_20k_db);
+
+                double t0 = DAFX_BenchSeconds();
+                for (int r = 0; r < NUM_REPS; r++)
+                    _Run(m, &shaper, &adaa, &os);
+                double t1 = DAFX_BenchSeconds();
+                dafx_bench_sink = out[0];
+
+                printf("  %-6s alias %7.1f dB   below 20 kHz %7.1f dB   %6.2f ns/sample\n", c_method_name[m],
+                       alias_db, alias_20k_db, DAFX_BenchNsPerSample(t0, t1, (double)NUM_REPS * 2 * FFT_SIZE));
+            }
+        }
+    }
+
+    DAFX_DenormalGuardEnd(&fp_state);
+
+    DAFX_AlignedFree(p_re);
+    DAFX_AlignedFree(p_im);
+    DeallocFFT(&fft);
+    DeallocDAFXSaturationADAA(&adaa);
+    DeallocDAFXOversampler(&os);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+//
+//  DAFX_BiquadBank.h
+//
+
+
+#ifndef DAFX_BiquadBank_h
+#define DAFX_BiquadBank_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_Denormal.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Bank of independent biquads (transposed direct form II), one per channel.
+     *
+     * Coefficients and states are stored as structure of arrays, so that
+     * the recursion of DAFX_SIMD_LANES channels is computed by a single vector
+     * instruction stream (8 channels at once when built with AVX and the data
+     * is interleaved). Every channel has its own coefficients.
+     */
+    typedef struct{
+
+        //number of channels (1 .. BQBANK_MAX_CHANNELS) - set before calling InitBiquadBank
+        int num_channels;
+
+        //num_channels rounded up to a multiple of the vector width
+        int num_lanes;
+
+        //coeffs and states (BQBANK_NUMOF_ROWS * num_lanes floats)
+        float *p_memory;
+
+        //subnormals seen in the states, checked after every block
+        t_dafx_denormal_stats denormal_stats;
+
+    }t_DAFX_BiquadBank;
+
+
+    /*!
+     * Init BiquadBank struct and allocate memory
+     * num_channels has to be set before calling this.
+     * All channels are initialized to pass-through filters
+     *
+     * @param pointer on a BiquadBank structure
+     * @return process status
+     */
+    bool InitBiquadBank(t_DAFX_BiquadBank *pBANK);
+
+    /*!
+     * Set the biquad coefficients of one channel
+     *
+     * Same format as SetBiquadFilterCoeffs: (b0, b1, b2, a0, a1, a2)
+     *
+     * @param pointer on BiquadBank structure
+     * @param channel index
+     * @param pointer on array of coefficients (b0, b1, b2, a0, a1, a2)
+     * @return process status
+     */
+    bool SetBiquadBankChannelCoeffs(t_DAFX_BiquadBank *pBANK, int ch, float *p_coeffs);
+
+    /*!
+     * Filter one block of every channel - planar (non-interleaved) buffers
+     * pp_in and pp_out hold num_channels pointers. In-place processing is allowed
+     *
+     * @param pointer on BiquadBank structure
+     * @param array of input buffers (one per channel)
+     * @param array of output buffers (one per channel)
+     * @param number of samples per channel
+     * @return process status
+     */
+    bool ProcessBlockBiquadBank(t_DAFX_BiquadBank *pBANK, float **pp_in, float **pp_out, int n);
+
+    /*!
+     * Same as above, but the buffers are frame-interleaved:
+     * sample i of channel c is at [i * num_channels + c]
+     */
+    bool ProcessBlockBiquadBankInterleaved(t_DAFX_BiquadBank *pBANK, float *p_in, float *p_out, int n);
+
+    /*!
+     * Clears the states of all channels (coefficients are kept)
+     *
+     * @param pointer on BiquadBank structure
+     * @return process status
+     */
+    bool ResetBiquadBank(t_DAFX_BiquadBank *pBANK);
+
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on BiquadBank structure
+     * @return void
+     */
+    void DeallocBiquadBank(t_DAFX_BiquadBank *pBANK);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_BiquadBank_h */
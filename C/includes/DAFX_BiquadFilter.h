@@ -21,11 +21,20 @@
 #include <Accelerate/Accelerate.h>
 #endif
 
+#include "DAFX_Denormal.h"
+
 
 #ifdef __cplusplus
 extern "C" {
 #endif
     
+    typedef enum
+    {
+        BIQUAD_MODE_SAMPLE = 0,         //sample by sample TDF-II recursion
+        BIQUAD_MODE_STATE_SPACE,        //block mode: BIQUAD_SS_STEP outputs per step from precomputed matrices
+        BiquadFilter_N_MODES,
+    }t_biquad_process_mode;
+    
     typedef struct{
         
         int buffer_len;
@@ -37,6 +46,16 @@ extern "C" {
         float * b;
         float * a;
         
+        //block processing method used by ProcessBlockBiquad
+        t_biquad_process_mode mode;
+        
+        //state-space block mode: matrices mapping (state, inputs) to (outputs, next state)
+        //recomputed by SetBiquadFilterCoeffs when the state-space mode is active
+        float * pStateSpaceMatrices;
+        
+        //subnormals seen in pInternalMemory, checked after every ProcessBlockBiquad
+        t_dafx_denormal_stats denormal_stats;
+        
     }t_DAFX_BiquadFilter;
     
     
@@ -72,6 +91,27 @@ extern "C" {
     /* same as above, but sample-based*/
     float ProcessSingleSampleBiquad(t_DAFX_BiquadFilter *pBQF, float x);
     
+    /*!
+     * Select the block processing method
+     *
+     * BIQUAD_MODE_STATE_SPACE rewrites the recursion in state-space form:
+     * BIQUAD_SS_STEP outputs and the next state are computed at once as
+     * matrix-vector products of the current state and the next BIQUAD_SS_STEP
+     * inputs, which breaks the sample to sample dependency chain. The state
+     * is the same as in the TDF-II recursion, so the modes can be switched
+     * at any time and ProcessSingleSampleBiquad stays valid.
+     * The matrices hold powers of the feedback matrix rounded to float, so
+     * for poles very close to z = 1 (high Q below ~100 Hz at 48 kHz) the
+     * sample mode is the more accurate choice: the error then grows to
+     * ~1e-2 of full scale (20 Hz, Q 10), against a few times the TDF-II
+     * error above 1 kHz (tests/test_BiquadFilter.c)
+     *
+     * @param pointer on BiquadFilter structure
+     * @param processing mode
+     * @return false for an unknown mode (the current one is kept)
+     */
+    bool SetBiquadProcessMode(t_DAFX_BiquadFilter *pBQF, t_biquad_process_mode mode);
+    
     /*!
      * Set biquad coefficients
      *
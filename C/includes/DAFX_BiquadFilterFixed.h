@@ -0,0 +1,115 @@
+//
+//  DAFX_BiquadFilterFixed.h
+//
+
+
+#ifndef DAFX_BiquadFilterFixed_h
+#define DAFX_BiquadFilterFixed_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_FixedPoint.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+    /*
+     * Fixed-point counterpart of DAFX_BiquadFilter.
+     *
+     * Direct form I with Q31 states and a 64 bit accumulator: every product
+     * is kept at full precision and rounding happens once per output sample.
+     * The rounding error is fed back into the next sample (first order error
+     * shaping), which keeps the noise floor of low frequency / high Q filters
+     * down where a plain truncating implementation would lose it.
+     * Coefficients are stored in Q3.29 (BIQUAD_FX_COEFF_FRAC_BITS), so every
+     * normalized coefficient has to lie in [-4, 4). That covers every stable
+     * feedback pair (|a1| < 2, |a2| < 1), high gain designs can exceed it in b.
+     */
+    typedef struct{
+        
+        int buffer_len;
+        
+        t_dafx_fx * pInBuff;
+        t_dafx_fx * pOutBuff;
+        
+        //normalized coeffs (Q3.29): b0, b1, b2, a1, a2
+        int32_t b[3];
+        int32_t a[3];
+        
+        //past inputs and outputs (Q31)
+        int32_t x1, x2;
+        int32_t y1, y2;
+        
+        //fractional part dropped when rounding the last output (error feedback)
+        int64_t err;
+        
+    }t_DAFX_BiquadFilterFixed;
+    
+    
+    /*!
+     * Init BiquadFilterFixed struct and allocate memory
+     * buffer_len has to be set before calling this
+     *
+     * @param pointer on a BiquadFilterFixed structure
+     * @return process status
+     */
+    bool InitBiquadFilterFixed(t_DAFX_BiquadFilterFixed *pBQF);
+    
+    /*!
+     * Filter pInBuff into pOutBuff
+     *
+     * @param pointer on BiquadFilterFixed structure
+     * @return process status
+     */
+    bool ProcessBlockBiquadFixed(t_DAFX_BiquadFilterFixed *pBQF);
+    
+    /* same as above, but sample-based*/
+    t_dafx_fx ProcessSingleSampleBiquadFixed(t_DAFX_BiquadFilterFixed *pBQF, t_dafx_fx x);
+    
+    /*!
+     * Set biquad coefficients
+     *
+     * Same format as SetBiquadFilterCoeffs: (b0, b1, b2, a0, a1, a2) as floats.
+     * The coefficients are normalized to a0 and converted to Q3.29 here, so the
+     * filter design can stay in floating point (it runs at control rate only)
+     *
+     * @param pointer on BiquadFilterFixed structure
+     * @param pointer on array of coefficients (b0, b1, b2, a0, a1, a2)
+     * @return false if a normalized coefficient is outside [-4, 4), the previous coeffs are kept then
+     */
+    bool SetBiquadFilterCoeffsFixed(t_DAFX_BiquadFilterFixed *pBQF, float *p_coeffs);
+    
+    /*!
+     * Clears the filter states (coefficients are kept)
+     *
+     * @param pointer on BiquadFilterFixed structure
+     * @return process status
+     */
+    bool ResetBiquadFilterFixed(t_DAFX_BiquadFilterFixed *pBQF);
+    
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on BiquadFilterFixed structure
+     * @return void
+     */
+    void DeallocBiquadFilterFixed(t_DAFX_BiquadFilterFixed *pBQF);
+    
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_BiquadFilterFixed_h */
@@ -0,0 +1,137 @@
+//
+//  DAFX_ControlRate.h
+//
+
+
+#ifndef DAFX_ControlRate_h
+#define DAFX_ControlRate_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_InitControlRate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    //how the control points are brought back to audio rate
+    typedef enum
+    {
+        CTRL_INTERP_HOLD = 0,       //each point held over its control period
+        CTRL_INTERP_LINEAR,         //straight line from the previous point
+        CTRL_INTERP_CUBIC,          //Hermite, tangents from the last three points (no added latency)
+        ControlRate_N_INTERP_MODES,
+    }t_ctrl_interp_mode;
+
+    /*
+     * Control-rate parameter track.
+     *
+     * Modulators and parameter mappings only need to run once every few
+     * samples: the owner computes num_points control points per block, point
+     * k being the value for the last sample of the k-th control period, and
+     * CTRL_Interpolate brings them back to one value per sample for the
+     * audio-rate kernel. With a period of 1 the output is the points
+     * themselves, whatever the interpolation.
+     *
+     * Each effect sets max_period to the coarsest granularity it tolerates,
+     * the period is then a power of two no larger than that, dividing the
+     * block size.
+     */
+    typedef struct{
+        
+        //wrapper, general (set by the owner before the init)
+        int block_size;
+        int max_period;
+        
+        int period;
+        int num_points;             //block_size / period
+        t_ctrl_interp_mode interp;
+        
+        //CTRL_NUMOF_HISTORY_POINTS past points followed by the points of the block
+        float *p_points;
+        bool is_primed;             //false: no past points yet, the first point is used instead
+        
+        //audio-rate output of CTRL_Interpolate
+        float *p_output_block;
+        
+    }t_DAFX_ControlRate;
+    
+    
+    /*!
+     * @brief Init ControlRate struct and allocate memory
+     *
+     * @param pointer on a ControlRate structure (block_size and max_period set)
+     * @return process status
+     */
+    bool InitControlRate(t_DAFX_ControlRate *pCR);
+    
+    /*!
+     * @brief Buffer to write the control points of the next block into
+     *
+     * @param pointer on ControlRate structure
+     * @return num_points floats
+     */
+    float *CTRL_GetPoints(t_DAFX_ControlRate *pCR);
+    
+    /*!
+     * @brief Interpolates the points of the block into p_output_block
+     *
+     * @param pointer on ControlRate structure
+     * @return process status
+     */
+    bool CTRL_Interpolate(t_DAFX_ControlRate *pCR);
+    
+    /*!
+     * @brief Ends the block without interpolating (for owners that only use the points)
+     *
+     * @param pointer on ControlRate structure
+     * @return process status
+     */
+    bool CTRL_Advance(t_DAFX_ControlRate *pCR);
+    
+    /*!
+     * @brief Forgets the past points, the next block starts flat from its first point
+     *
+     * @param pointer on ControlRate structure
+     * @return process status
+     */
+    bool CTRL_Reset(t_DAFX_ControlRate *pCR);
+    
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on ControlRate structure
+     * @return void
+     */
+    void DeallocControlRate(t_DAFX_ControlRate *pCR);
+    
+    //Setters
+    
+    /*!
+     * @brief sets the number of samples between two control points
+     *
+     * Rounded down to a power of two dividing the block size, and limited to max_period
+     *
+     * @param pointer on ControlRate structure
+     * @param period in samples
+     * @return process status
+     */
+    bool CTRL_SetPeriod(t_DAFX_ControlRate *pCR, int period);
+    bool CTRL_SetInterpolation(t_DAFX_ControlRate *pCR, t_ctrl_interp_mode interp);
+    
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_ControlRate_h */
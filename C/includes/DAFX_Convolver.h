@@ -0,0 +1,245 @@
+//
+//  DAFX_Convolver.h
+//
+
+
+#ifndef DAFX_Convolver_h
+#define DAFX_Convolver_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_FFT.h"
+#include "DAFX_InitConvolver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    //one run of equally sized partitions of the impulse response
+    typedef struct{
+
+        //partition length P (the FFT size is 2P)
+        int part_size;
+
+        //first IR sample covered by the segment
+        int offset;
+
+        int num_parts;
+
+        //FFT of size 2P, shared by every instance using the IR
+        t_DAFX_FFT fft;
+
+        //spectra of the partitions (P floats each, one after the other), scaled by 1/(2P)
+        float *p_spec_re;
+        float *p_spec_im;
+
+    }t_conv_segment_ir;
+
+    /*
+     * Impulse response prepared for partitioned convolution.
+     *
+     * The first head_len samples are kept as direct-form FIR taps, the rest is
+     * split into segments of equally sized partitions, stored as spectra.
+     * The object is read-only once initialized, so one IR can be used by any
+     * number of convolver instances running the same block size, and the
+     * spectra are computed only once.
+     */
+    typedef struct{
+
+        //set before calling InitConvolverIR
+        int block_size;
+        int partition_mode;     //CONV_PARTITION_UNIFORM or CONV_PARTITION_NONUNIFORM
+
+        //IR length after truncation to CONV_MAX_IR_LEN
+        int ir_len;
+
+        //direct-form head, taps stored time reversed
+        int head_len;
+        float *p_head;
+
+        int num_segments;
+        t_conv_segment_ir segments[CONV_MAX_NUMOF_SEGMENTS];
+
+    }t_DAFX_ConvolverIR;
+
+    //per-instance state of one segment
+    typedef struct{
+
+        //last two input frames (2P samples), the newest frame is filled block by block
+        float *p_frame;
+        int frame_fill;
+
+        //frequency domain delay line: spectra of the last num_parts frames
+        float *p_fdl_re;
+        float *p_fdl_im;
+        int fdl_pos;
+
+        //spectrum accumulator and time domain result of the segment
+        float *p_acc_re;
+        float *p_acc_im;
+        float *p_time;
+
+        //the work on a frame (FFT, one MAC per partition, IFFT) is spread over the
+        //P / block_size blocks until the next frame is complete
+        int job_unit;           //next unit to run, 0: no job pending
+        int units_per_call;
+        int job_out_pos;        //output ring position of the first result sample
+
+    }t_conv_segment_state;
+
+    //an IR and the signal state laid out for it: what DAFXProcessConvolver runs on.
+    //A new IR comes with a new engine, swapped in as a whole
+    typedef struct{
+
+        t_DAFX_ConvolverIR *p_ir;
+        bool own_ir;            //private IR, freed with the engine
+
+        //input history of the head FIR (head_len - 1 + block_size samples)
+        float *p_head_hist;
+
+        t_conv_segment_state segments[CONV_MAX_NUMOF_SEGMENTS];
+
+        //segment results are added here ahead of time, read out block by block
+        float *p_out_ring;
+        int ring_mask;
+        int ring_pos;
+
+    }t_conv_engine;
+
+    /*
+     * Partitioned overlap-save convolution for cabinet and room impulse responses.
+     *
+     * Every segment of the IR runs as a uniformly partitioned convolution with
+     * its own partition size. A segment with partition P only starts at an
+     * offset of at least 2P - 2*block_size, which leaves it P / block_size blocks
+     * to compute the contribution of a frame, so its FFTs and spectral
+     * multiply-adds are spread evenly over those blocks and the cost of every
+     * block stays bounded. The part of the IR before the first segment is run
+     * as a direct-form FIR, so the convolver adds no latency.
+     *
+     * CONV_PARTITION_UNIFORM uses a single segment with block-sized partitions
+     * (cheapest for short IRs). CONV_PARTITION_NONUNIFORM doubles the partition
+     * size every CONV_PARTITIONS_PER_SIZE partitions up to CONV_MAX_PARTITION_SIZE
+     * (cheapest for IRs of a second or more).
+     */
+    typedef struct{
+
+        //general, wrapper
+        int block_size;         //power of two
+        int fs;
+        float *p_input_block;
+        float *p_output_block;
+
+        //layout used by CONV_LoadIR
+        int partition_mode;
+
+        //IR in use (private or shared) with its signal state, read once per block
+        t_conv_engine * volatile p_engine;
+
+        //engine swapped out while a block may still be running on it, freed by CONV_ReleaseRetiredIR
+        //once the audio thread has ended a block since (num_blocks is only written by the audio thread)
+        t_conv_engine *p_retired_engine;
+        unsigned int retired_at_block;
+        volatile unsigned int num_blocks;
+
+        //CONV_Reset: the history is cleared by the audio thread, at the start of the next block
+        volatile bool reset_pending;
+
+    }t_DAFXConvolver;
+
+
+    /*!
+     * @brief Prepare an impulse response: head taps and partition spectra
+     * block_size and partition_mode have to be set before calling this.
+     * Allocates and runs FFTs - not to be called from the audio thread
+     *
+     * @param pointer on a ConvolverIR structure
+     * @param IR samples
+     * @param IR length (truncated to CONV_MAX_IR_LEN)
+     * @return process status (false if block_size is not a power of two)
+     */
+    bool InitConvolverIR(t_DAFX_ConvolverIR *pIR, float *p_samples, int len);
+
+    /*!
+     * Deallocates allocated memory for the IR
+     *
+     * @param pointer on ConvolverIR structure
+     * @return void
+     */
+    void DeallocConvolverIR(t_DAFX_ConvolverIR *pIR);
+
+    /*!
+     * @brief Init Convolver struct and allocate memory
+     * block_size and fs have to be set before calling this.
+     * The convolver starts with a unit impulse (pass-through)
+     *
+     * @param pointer on a Convolver structure
+     * @return process status
+     */
+    bool InitDAFXConvolver(t_DAFXConvolver *pCONV);
+
+    /*!
+     * @brief Process and Apply Convolver to incoming signal
+     *
+     * @param pointer on Convolver structure
+     * @return process status
+     */
+    bool DAFXProcessConvolver(t_DAFXConvolver *pCONV);
+
+    /*!
+     * @brief Bypass Convolver of incoming signal
+     *
+     * @param pointer on Convolver structure
+     * @return process status
+     */
+    bool DAFXBypassConvolver(t_DAFXConvolver *pCONV);
+
+    /*!
+     * Deallocates allocated memory for the object (a shared IR is left alone)
+     *
+     * @param pointer on Convolver structure
+     * @return void
+     */
+    void DeallocDAFXConvolver(t_DAFXConvolver *pCONV);
+
+    //Loads a private copy of an IR, laid out according to partition_mode
+    //The IR is swapped in with a new signal state while the audio may be running; the previous one is
+    //retired, see CONV_ReleaseRetiredIR. False (nothing loaded) as long as the one retired before
+    //cannot be released yet
+    //Allocates - not to be called from the audio thread
+    bool CONV_LoadIR(t_DAFXConvolver *pCONV, float *p_samples, int len);
+
+    //Uses an IR prepared with InitConvolverIR, which has to outlive the convolver
+    //(or be replaced and released before it is deallocated). Its block_size has to match
+    //Swapped in like CONV_LoadIR
+    //Allocates - not to be called from the audio thread
+    bool CONV_SetSharedIR(t_DAFXConvolver *pCONV, t_DAFX_ConvolverIR *pIR);
+
+    //Frees the IR and signal state retired by the last swap, once a block has ended since (false while
+    //one may still be running on them). force frees them right away - only when no block can run,
+    //e.g. with the DSP off
+    //Not to be called from the audio thread
+    bool CONV_ReleaseRetiredIR(t_DAFXConvolver *pCONV, bool force);
+
+    //Layout of the next CONV_LoadIR call
+    bool CONV_SetPartitionMode(t_DAFXConvolver *pCONV, int mode);
+
+    //Clears the signal history (the IR is kept), at the start of the next block
+    bool CONV_Reset(t_DAFXConvolver *pCONV);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_Convolver_h */
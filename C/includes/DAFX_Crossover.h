@@ -19,7 +19,7 @@
 #include <Accelerate/Accelerate.h>
 #endif
 
-#include "DAFX_BiquadFilter.h"
+#include "DAFX_SOSCascade.h"
 #include "DAFX_LowFrequencyOscillator.h"
 
 #ifdef __cplusplus
@@ -38,9 +38,9 @@ extern "C" {
         float *p_lp_butter_coeffs;
         float *p_hp_butter_coeffs;
         
-        //Chain of LP and HP butterworth biquads
-        t_DAFX_BiquadFilter **pp_lp_biquads;
-        t_DAFX_BiquadFilter **pp_hp_biquads;
+        //Cascade of LP and HP butterworth biquads
+        t_DAFX_SOSCascade *p_lp_cascade;
+        t_DAFX_SOSCascade *p_hp_cascade;
         
         //higher orders are achievable by increasing the number of cascaded biquads
         int num_cascades;
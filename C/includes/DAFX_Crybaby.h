@@ -19,8 +19,12 @@
 #include <Accelerate/Accelerate.h>
 #endif
 
-#include "DAFX_BiquadFilter.h"
+#include "DAFX_SOSCascade.h"
 #include "DAFX_LowFrequencyOscillator.h"
+#include "DAFX_ModulationBus.h"
+#include "DAFX_ControlRate.h"
+#include "DAFX_EnvelopeFollower.h"
+#include "DAFX_InitCrybaby.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +38,24 @@ extern "C" {
         Crybaby_N_ALGOS,
     }t_cb_algo_select;
     
+    //how the auto-wah moves the filter between two pedal positions
+    typedef enum
+    {
+        CB_COEFF_UPDATE_PER_SAMPLE = 0,     //coeffs looked up in the pedal table for every sample (no exact design,
+                                            //the interpolated a1, a2 are within ~2e-5 of it)
+        CB_COEFF_UPDATE_BLOCK_RAMP,         //designed once per block, coeffs interpolated linearly
+        CB_COEFF_UPDATE_CONTROL_RATE,       //designed once per control period, coeffs interpolated linearly
+        Crybaby_N_COEFF_UPDATE_MODES,
+    }t_cb_coeff_update_mode;
+    
+    //what moves the pedal in auto mode
+    typedef enum
+    {
+        CB_MOD_SOURCE_LFO = 0,              //LFO, or the shared modulator of the bus
+        CB_MOD_SOURCE_ENVELOPE,             //envelope of the input signal
+        Crybaby_N_MOD_SOURCES,
+    }t_cb_mod_source;
+    
     typedef struct{
         
         int block_size;
@@ -43,14 +65,40 @@ extern "C" {
         float *p_output_block;
         float *p_biquad_coeffs;
         
-        t_DAFX_BiquadFilter *p_biquad;
+        t_DAFX_SOSCascade *p_biquad;
         t_DAFXLowFrequencyOscillator *pLFO;
+
+        //shared modulator (NULL: the LFO runs on its own), only its amp, offset and clipping are used then
+        //The audio thread reads both once per block: mod_slot is written first, p_mod_bus published last
+        t_DAFX_ModulationBus * volatile p_mod_bus;
+        volatile int mod_slot;
+        //division and phase offset of the subscription, a new LFO shape resubscribes with them
+        float mod_division;
+        float mod_phase_offset;
+        
+        //control points of the auto-wah (CB_COEFF_UPDATE_CONTROL_RATE), the coeffs
+        //are ramped in between, so its interpolation setting is not used
+        t_DAFX_ControlRate *p_ctrl;
+        
+        //auto-wah modulation source, the envelope follower maps straight to pedal positions
+        t_cb_mod_source mod_source;
+        t_DAFXEnvelopeFollower *pENV;
+        int pedal_period;       //samples per pedal position computed by the last auto-wah block
         
         float wah_balance;
         
+        //auto-wah coefficient update method
+        t_cb_coeff_update_mode coeff_update_mode;
+        
         //knob value
         float gp;
         
+        //normalized a1, a2 over the pedal range, interleaved (only the denominator
+        //moves with the pedal), rebuilt when fs changes
+        float *p_pedal_table;
+        float pedal_table_scale;    //table points per unit of pedal position
+        int pedal_table_fs;
+        
         //coeffs
         float a0;
         float a0b;
@@ -77,7 +125,7 @@ extern "C" {
     bool InitDAFXCrybaby( t_DAFXCrybaby *pCB);    
     
     /*!
-     * @brief Updates the pedal position and generates new 
+     * @brief Updates the pedal position and looks up new
      * biquad coefficients accordingly
      *
      * @param pointer on Crybaby structure
@@ -102,6 +150,16 @@ extern "C" {
      */
     bool DAFXProcessAutoCrybaby(t_DAFXCrybaby *pCB);
     
+    /*!
+     * @brief Pedal positions of the last auto-wah block, one per sample
+     * (each control point held over its control period)
+     *
+     * @param pointer on Crybaby structure
+     * @param output, block_size samples
+     * @return process status
+     */
+    bool Crybaby_GetPedalTrack(t_DAFXCrybaby *pCB, float *p_out);
+    
     /*!
      * @brief Bypass Crybaby of incoming signal
      *
@@ -127,6 +185,39 @@ extern "C" {
     bool Crybaby_SetLFOClipHigh(t_DAFXCrybaby *pCB, float clip_h);
     bool Crybaby_SetLFOClipLow(t_DAFXCrybaby *pCB, float clip_l);
     bool Crybaby_ReinitLFOPhase(t_DAFXCrybaby *pCB);
+    bool Crybaby_SetCoeffUpdateMode(t_DAFXCrybaby *pCB, t_cb_coeff_update_mode mode);
+    bool Crybaby_SetControlPeriod(t_DAFXCrybaby *pCB, int period);
+    bool Crybaby_SetModSource(t_DAFXCrybaby *pCB, t_cb_mod_source source);
+    bool Crybaby_SetEnvDetector(t_DAFXCrybaby *pCB, t_env_detector detector);
+    bool Crybaby_SetEnvAttack(t_DAFXCrybaby *pCB, float attack_ms);
+    bool Crybaby_SetEnvRelease(t_DAFXCrybaby *pCB, float release_ms);
+    bool Crybaby_SetEnvSensitivity(t_DAFXCrybaby *pCB, float sensitivity_db);
+    bool Crybaby_SetEnvRange(t_DAFXCrybaby *pCB, float pedal_lo, float pedal_hi);
+    
+    /*!
+     * @brief Changes the sample rate. The filter constants and the pedal table
+     * are only rebuilt if it differs from the one they were built for.
+     * Not to be called from the audio thread
+     *
+     * @param pointer on Crybaby structure
+     * @param sample rate in Hz
+     * @return process status
+     */
+    bool Crybaby_SetSampleRate(t_DAFXCrybaby *pCB, int fs);
+    
+    /*!
+     * @brief Takes the modulation from a shared bus instead of the own LFO
+     * The bus modulator replaces the LFO waveform and rate, the depth settings
+     * still apply. Changing the shape moves to the bus modulator of the new shape.
+     * NULL goes back to the own LFO. Not to be called from the audio thread
+     *
+     * @param pointer on Crybaby structure
+     * @param bus (same block size), or NULL
+     * @param length of one LFO cycle in beats
+     * @param phase offset in periods
+     * @return process status (false if the bus is full or runs another block size)
+     */
+    bool Crybaby_SetModulationBus(t_DAFXCrybaby *pCB, t_DAFX_ModulationBus *pBUS, float division, float phase_offset);
     
 #ifdef __cplusplus
 }
@@ -0,0 +1,157 @@
+//
+//  DAFX_Denormal.h
+//
+//  Denormal (subnormal) protection shared by the recursive modules.
+//
+//  Every block processing entry point brackets its work with
+//  DAFX_DenormalGuardBegin / DAFX_DenormalGuardEnd, which switch the FPU to
+//  flush-to-zero / denormals-are-zero for the duration of the call and
+//  restore the caller's mode afterwards. Where that is not possible (or not
+//  wanted), DAFX_DENORMAL_INJECT makes the modules flush their recursive
+//  states in software at the end of every block instead.
+//
+//  Build flags:
+//    DAFX_DENORMAL_NO_FTZ  - never touch the FPU control register
+//    DAFX_DENORMAL_INJECT  - software flush of the recursive states
+//                            (on by default when FTZ is not available)
+//    DAFX_DENORMAL_NO_INJECT - never flush in software (unprotected builds,
+//                            only for measurements)
+//
+
+
+#ifndef DAFX_Denormal_h
+#define DAFX_Denormal_h
+
+
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_SIMD.h"
+
+#if !defined(DAFX_DENORMAL_NO_FTZ) && defined(DAFX_SIMD_SSE)
+#define DAFX_DENORMAL_FTZ_SSE       1
+#include <xmmintrin.h>
+#elif !defined(DAFX_DENORMAL_NO_FTZ) && defined(DAFX_SIMD_NEON) && defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define DAFX_DENORMAL_FTZ_AARCH64   1
+#endif
+
+#if !defined(DAFX_DENORMAL_FTZ_SSE) && !defined(DAFX_DENORMAL_FTZ_AARCH64) && !defined(DAFX_DENORMAL_INJECT) && !defined(DAFX_DENORMAL_NO_INJECT)
+#define DAFX_DENORMAL_INJECT        1
+#endif
+
+#if defined(DAFX_DENORMAL_NO_INJECT)
+#undef DAFX_DENORMAL_INJECT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//MXCSR: flush-to-zero (bit 15) and denormals-are-zero (bit 6)
+#define DAFX_MXCSR_FTZ_DAZ          0x8040
+//FPCR: flush-to-zero (bit 24)
+#define DAFX_FPCR_FZ                (1 << 24)
+
+//software flush: states smaller than this are set to zero (about -300 dB)
+#define DAFX_DENORMAL_FLUSH_THRESHOLD   1e-15f
+
+    //FPU mode saved by DAFX_DenormalGuardBegin
+    typedef struct{
+        unsigned long long csr;
+    }t_dafx_fp_state;
+
+    //per-instance denormal report
+    typedef struct{
+
+        //number of blocks whose states were checked
+        unsigned int num_blocks;
+
+        //number of subnormal values found in the recursive states
+        unsigned int num_subnormals;
+
+        //number of states set to zero by the software flush (DAFX_DENORMAL_INJECT)
+        unsigned int num_flushes;
+
+    }t_dafx_denormal_stats;
+
+
+    static inline void DAFX_DenormalGuardBegin(t_dafx_fp_state *pState)
+    {
+#if defined(DAFX_DENORMAL_FTZ_SSE)
+        pState->csr = _mm_getcsr();
+        _mm_setcsr((unsigned int)pState->csr | DAFX_MXCSR_FTZ_DAZ);
+#elif defined(DAFX_DENORMAL_FTZ_AARCH64)
+        unsigned long long fpcr;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+        pState->csr = fpcr;
+        fpcr |= DAFX_FPCR_FZ;
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+#else
+        pState->csr = 0;
+#endif
+    }
+
+    static inline void DAFX_DenormalGuardEnd(t_dafx_fp_state *pState)
+    {
+#if defined(DAFX_DENORMAL_FTZ_SSE)
+        _mm_setcsr((unsigned int)pState->csr);
+#elif defined(DAFX_DENORMAL_FTZ_AARCH64)
+        unsigned long long fpcr = pState->csr;
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+#else
+        (void)pState;
+#endif
+    }
+
+    //bit level test, so that it also works while denormals-are-zero is active
+    static inline bool DAFX_IsSubnormal(float x)
+    {
+        unsigned int bits;
+        memcpy(&bits, &x, sizeof(bits));
+        return ((bits & 0x7F800000u) == 0) && ((bits & 0x007FFFFFu) != 0);
+    }
+
+    static inline void DAFX_DenormalResetStats(t_dafx_denormal_stats *pStats)
+    {
+        memset(pStats, 0, sizeof(t_dafx_denormal_stats));
+    }
+
+    //End of block check of n recursive states: counts subnormals and, with
+    //DAFX_DENORMAL_INJECT, flushes the states that are about to become subnormal
+    static inline void DAFX_DenormalCheckStates(t_dafx_denormal_stats *pStats, float *p_states, int n)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            float x = p_states[i];
+
+            if (DAFX_IsSubnormal(x)) {
+                pStats->num_subnormals++;
+            }
+#if defined(DAFX_DENORMAL_INJECT)
+            if (DAFX_IsSubnormal(x) || (x != 0.0f && x < DAFX_DENORMAL_FLUSH_THRESHOLD && x > -DAFX_DENORMAL_FLUSH_THRESHOLD)) {
+                p_states[i] = 0.0f;
+                pStats->num_flushes++;
+            }
+#endif
+        }
+    }
+
+    //to be called once per block, next to the state checks
+    static inline void DAFX_DenormalCountBlock(t_dafx_denormal_stats *pStats)
+    {
+        pStats->num_blocks++;
+    }
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_Denormal_h */
@@ -0,0 +1,124 @@
+//
+//  DAFX_EnvelopeFollower.h
+//
+
+
+#ifndef DAFX_EnvelopeFollower_h
+#define DAFX_EnvelopeFollower_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    typedef enum
+    {
+        ENV_DETECT_PEAK = 0,        //largest |x| of every control period
+        ENV_DETECT_RMS,             //square root of the mean square over ENV_RMS_WINDOW_MS
+        EnvelopeFollower_N_DETECTORS,
+    }t_env_detector;
+    
+    /*
+     * Envelope follower as a control-rate modulation source.
+     *
+     * The input block is cut into control periods (see t_DAFX_ControlRate):
+     * every period is reduced to one level on vectors, the level goes
+     * through the attack / release smoothing, and comes out mapped to
+     * [range_lo, range_hi]: range_lo + (range_hi - range_lo) * min(sensitivity * envelope, 1).
+     * The smoothing coefficients follow the control period, the mapping
+     * constants are computed by the setters.
+     */
+    typedef struct{
+        
+        //wrapper, general
+        int block_size;
+        int fs;
+        
+        t_env_detector detector;
+        
+        //params
+        float attack_ms;
+        float release_ms;
+        float sensitivity_db;
+        float range_lo;
+        float range_hi;
+        
+        //precomputed mapping
+        float sensitivity;          //linear gain
+        float range_span;           //range_hi - range_lo
+        
+        //smoothing coefficients per control period, valid for coeff_period samples
+        int coeff_period;
+        float k_attack;
+        float k_release;
+        float k_rms;
+        
+        //RMS detector: running mean square
+        float mean_square;
+        
+        //smoothed level
+        float env;
+        
+    }t_DAFXEnvelopeFollower;
+    
+    
+    /*!
+     * @brief Init EnvelopeFollower struct
+     *
+     * @param pointer on an EnvelopeFollower structure
+     * @return process status
+     */
+    bool InitDAFXEnvelopeFollower(t_DAFXEnvelopeFollower *pENV);
+    
+    /*!
+     * @brief Follows one input block, one mapped output per control period
+     *
+     * @param pointer on EnvelopeFollower structure
+     * @param input block (block_size samples)
+     * @param control period in samples (divides the block size)
+     * @param output, block_size / period points
+     * @return process status
+     */
+    bool DAFXEnvelopeFollower(t_DAFXEnvelopeFollower *pENV, float *p_input, int period, float *p_points);
+    
+    /*!
+     * @brief Current envelope, mapped to the range
+     *
+     * @param pointer on EnvelopeFollower structure
+     * @return mapped envelope
+     */
+    float ENV_GetMappedLevel(t_DAFXEnvelopeFollower *pENV);
+    
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on EnvelopeFollower structure
+     * @return void
+     */
+    void DeallocDAFXEnvelopeFollower(t_DAFXEnvelopeFollower *pENV);
+    
+    //Setters
+    bool ENV_SetDetector(t_DAFXEnvelopeFollower *pENV, t_env_detector detector);
+    bool ENV_SetAttackMs(t_DAFXEnvelopeFollower *pENV, float attack_ms);
+    bool ENV_SetReleaseMs(t_DAFXEnvelopeFollower *pENV, float release_ms);
+    bool ENV_SetSensitivityDb(t_DAFXEnvelopeFollower *pENV, float sensitivity_db);
+    bool ENV_SetRange(t_DAFXEnvelopeFollower *pENV, float range_lo, float range_hi);
+    
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_EnvelopeFollower_h */
@@ -0,0 +1,107 @@
+//
+//  DAFX_FFT.h
+//
+
+
+#ifndef DAFX_FFT_h
+#define DAFX_FFT_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Real FFT of a power of two size N, computed as a complex FFT of N/2
+     * points on the even/odd samples, followed by the usual split step.
+     * The complex FFT is an iterative radix-2 transform on split real and
+     * imaginary arrays, so every butterfly stage past the first two runs
+     * on whole vectors.
+     *
+     * Spectra are stored as two arrays of N/2 floats (real, imaginary):
+     * bins 0 .. N/2-1, except that the imaginary slot of bin 0 holds the
+     * (purely real) Nyquist bin. The struct only holds read-only tables,
+     * so one FFT can be used by any number of callers at the same time.
+     */
+    typedef struct{
+
+        //transform size (power of two, >= 16) - set before calling InitFFT
+        int size;
+
+        //size of the complex FFT (size / 2)
+        int half;
+
+        //butterfly twiddles, stage after stage (stage with span h starts at index h)
+        float *p_tw_re;
+        float *p_tw_im;
+
+        //twiddles of the real split step, exp(-2 pi i k / size) for k in [0, size/4]
+        float *p_split_re;
+        float *p_split_im;
+
+        //bit reversal permutation of the complex FFT
+        int *p_bitrev;
+
+    }t_DAFX_FFT;
+
+
+    /*!
+     * Init FFT struct and compute the tables
+     * size has to be set before calling this
+     *
+     * @param pointer on a FFT structure
+     * @return process status (false if size is not a power of two >= 16)
+     */
+    bool InitFFT(t_DAFX_FFT *pFFT);
+
+    /*!
+     * Forward transform of size real samples
+     *
+     * @param pointer on FFT structure
+     * @param input samples (size floats)
+     * @param real part of the spectrum (size/2 floats, DAFX_SIMD_ALIGN aligned)
+     * @param imaginary part of the spectrum (size/2 floats, aligned), [0] holds the Nyquist bin
+     * @return process status
+     */
+    bool FFTForwardReal(t_DAFX_FFT *pFFT, float *p_in, float *p_re, float *p_im);
+
+    /*!
+     * Inverse transform back to size real samples, scaled by size
+     * (forward then inverse multiplies the signal by size).
+     * p_re and p_im are used as scratch and overwritten
+     *
+     * @param pointer on FFT structure
+     * @param real part of the spectrum (size/2 floats, aligned)
+     * @param imaginary part of the spectrum (size/2 floats, aligned)
+     * @param output samples (size floats)
+     * @return process status
+     */
+    bool FFTInverseReal(t_DAFX_FFT *pFFT, float *p_re, float *p_im, float *p_out);
+
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on FFT structure
+     * @return void
+     */
+    void DeallocFFT(t_DAFX_FFT *pFFT);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_FFT_h */
@@ -0,0 +1,301 @@
+//
+//  DAFX_FilterDesign.hpp
+//
+//  C++ (C++14) layer beside the C API: biquad designs that can be evaluated at
+//  compile time. Every design returns normalized coefficients (a0 == 1) and works
+//  in double, so a constexpr preset is as accurate as the runtime C designs.
+//  Fixed stage count designs return t_dafx_sos<N>, to be run with dafx::SOSChain
+//  (DAFX_SOSChain.hpp) or loaded into a t_DAFX_SOSCascade.
+//
+
+
+#ifndef DAFX_FilterDesign_hpp
+#define DAFX_FilterDesign_hpp
+
+
+#include <cstddef>
+
+#include "DAFX_definitions.h"
+#include "DAFX_InitCrossover.h"
+#include "DAFX_InitCrybaby.h"
+
+
+namespace dafx {
+
+    //normalized biquad: y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+    struct t_dafx_biquad_coeffs
+    {
+        float b0, b1, b2, a1, a2;
+
+        //same layout as SetSOSCascadeStageCoeffs / SetBiquadFilterCoeffs expect
+        void ToArray6(float *p_coeffs) const
+        {
+            p_coeffs[0] = b0; p_coeffs[1] = b1; p_coeffs[2] = b2;
+            p_coeffs[3] = 1.0f; p_coeffs[4] = a1; p_coeffs[5] = a2;
+        }
+    };
+
+
+    //N biquads. A plain array wrapper, because std::array cannot be written in a
+    //C++14 constant expression
+    template <int N>
+    struct t_dafx_sos
+    {
+        static constexpr int kNumStages = N;
+
+        t_dafx_biquad_coeffs stage[N];
+
+        constexpr t_dafx_biquad_coeffs &operator[](int k) { return stage[k]; }
+        constexpr const t_dafx_biquad_coeffs &operator[](int k) const { return stage[k]; }
+    };
+
+
+    // ---- constexpr math (std:: functions are not constexpr) ---- //
+
+    namespace cmath {
+
+        constexpr double kPi = 3.14159265358979323846;
+        constexpr double kLn10 = 2.30258509299404568402;
+
+        constexpr double Abs(double x) { return (x < 0.0) ? -x : x; }
+
+        //Taylor series after reducing the argument to [-pi, pi]
+        constexpr double Sin(double x)
+        {
+            double k = (double)(long long)(x / (2.0 * kPi));
+            x -= k * 2.0 * kPi;
+            if (x > kPi)  x -= 2.0 * kPi;
+            if (x < -kPi) x += 2.0 * kPi;
+
+            double term = x, sum = x;
+            for (int n = 1; n < 20; n++) {
+                term *= -x * x / (double)((2 * n) * (2 * n + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr double Cos(double x) { return Sin(x + 0.5 * kPi); }
+
+        constexpr double Tan(double x) { return Sin(x) / Cos(x); }
+
+        constexpr double Sqrt(double x)
+        {
+            if (x <= 0.0)
+                return 0.0;
+            double r = (x > 1.0) ? x : 1.0;
+            for (int i = 0; i < 100; i++) {
+                double next = 0.5 * (r + x / r);
+                if (next == r)
+                    break;
+                r = next;
+            }
+            return r;
+        }
+
+        //exp(x) = exp(x / 2^k)^(2^k) with the series on the reduced argument
+        constexpr double Exp(double x)
+        {
+            int k = 0;
+            while (Abs(x) > 0.5 && k < 64) {
+                x *= 0.5;
+                k++;
+            }
+            double term = 1.0, sum = 1.0;
+            for (int n = 1; n < 20; n++) {
+                term *= x / (double)n;
+                sum += term;
+            }
+            for (int i = 0; i < k; i++) {
+                sum *= sum;
+            }
+            return sum;
+        }
+
+        constexpr double DbToLin(double db) { return Exp(db / 20.0 * kLn10); }
+    }
+
+
+    // ---- designs ---- //
+
+    namespace design {
+
+        constexpr t_dafx_biquad_coeffs Normalize(double b0, double b1, double b2, double a0, double a1, double a2)
+        {
+            return t_dafx_biquad_coeffs{ (float)(b0 / a0), (float)(b1 / a0), (float)(b2 / a0), (float)(a1 / a0), (float)(a2 / a0) };
+        }
+
+        //RBJ audio EQ cookbook
+        constexpr t_dafx_biquad_coeffs Lowpass(double f0, double q, double fs)
+        {
+            double w0 = 2.0 * cmath::kPi * f0 / fs, c = cmath::Cos(w0), alpha = cmath::Sin(w0) / (2.0 * q);
+            return Normalize((1.0 - c) * 0.5, 1.0 - c, (1.0 - c) * 0.5, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+        }
+
+        constexpr t_dafx_biquad_coeffs Highpass(double f0, double q, double fs)
+        {
+            double w0 = 2.0 * cmath::kPi * f0 / fs, c = cmath::Cos(w0), alpha = cmath::Sin(w0) / (2.0 * q);
+            return Normalize((1.0 + c) * 0.5, -(1.0 + c), (1.0 + c) * 0.5, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+        }
+
+        //constant 0 dB peak gain
+        constexpr t_dafx_biquad_coeffs Bandpass(double f0, double q, double fs)
+        {
+            double w0 = 2.0 * cmath::kPi * f0 / fs, c = cmath::Cos(w0), alpha = cmath::Sin(w0) / (2.0 * q);
+            return Normalize(alpha, 0.0, -alpha, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+        }
+
+        constexpr t_dafx_biquad_coeffs Notch(double f0, double q, double fs)
+        {
+            double w0 = 2.0 * cmath::kPi * f0 / fs, c = cmath::Cos(w0), alpha = cmath::Sin(w0) / (2.0 * q);
+            return Normalize(1.0, -2.0 * c, 1.0, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+        }
+
+        constexpr t_dafx_biquad_coeffs Peaking(double f0, double q, double gain_db, double fs)
+        {
+            double w0 = 2.0 * cmath::kPi * f0 / fs, c = cmath::Cos(w0), alpha = cmath::Sin(w0) / (2.0 * q);
+            double A = cmath::Sqrt(cmath::DbToLin(gain_db));
+            return Normalize(1.0 + alpha * A, -2.0 * c, 1.0 - alpha * A, 1.0 + alpha / A, -2.0 * c, 1.0 - alpha / A);
+        }
+
+        constexpr t_dafx_biquad_coeffs LowShelf(double f0, double q, double gain_db, double fs)
+        {
+            double w0 = 2.0 * cmath::kPi * f0 / fs, c = cmath::Cos(w0), alpha = cmath::Sin(w0) / (2.0 * q);
+            double A = cmath::Sqrt(cmath::DbToLin(gain_db)), sa = 2.0 * cmath::Sqrt(A) * alpha;
+            return Normalize(A * ((A + 1.0) - (A - 1.0) * c + sa), 2.0 * A * ((A - 1.0) - (A + 1.0) * c), A * ((A + 1.0) - (A - 1.0) * c - sa),
+                             (A + 1.0) + (A - 1.0) * c + sa, -2.0 * ((A - 1.0) + (A + 1.0) * c), (A + 1.0) + (A - 1.0) * c - sa);
+        }
+
+        constexpr t_dafx_biquad_coeffs HighShelf(double f0, double q, double gain_db, double fs)
+        {
+            double w0 = 2.0 * cmath::kPi * f0 / fs, c = cmath::Cos(w0), alpha = cmath::Sin(w0) / (2.0 * q);
+            double A = cmath::Sqrt(cmath::DbToLin(gain_db)), sa = 2.0 * cmath::Sqrt(A) * alpha;
+            return Normalize(A * ((A + 1.0) + (A - 1.0) * c + sa), -2.0 * A * ((A - 1.0) + (A + 1.0) * c), A * ((A + 1.0) + (A - 1.0) * c - sa),
+                             (A + 1.0) - (A - 1.0) * c + sa, 2.0 * ((A - 1.0) - (A + 1.0) * c), (A + 1.0) - (A - 1.0) * c - sa);
+        }
+
+        //Butterworth of order 2N as N biquads: pole pair k has Q = 1 / (2 sin((2k+1) pi / 4N))
+        template <int N>
+        constexpr t_dafx_sos<N> ButterworthLowpass(double fc, double fs)
+        {
+            t_dafx_sos<N> sos{};
+            for (int k = 0; k < N; k++) {
+                sos[k] = Lowpass(fc, 1.0 / (2.0 * cmath::Sin((2 * k + 1) * cmath::kPi / (4.0 * N))), fs);
+            }
+            return sos;
+        }
+
+        template <int N>
+        constexpr t_dafx_sos<N> ButterworthHighpass(double fc, double fs)
+        {
+            t_dafx_sos<N> sos{};
+            for (int k = 0; k < N; k++) {
+                sos[k] = Highpass(fc, 1.0 / (2.0 * cmath::Sin((2 * k + 1) * cmath::kPi / (4.0 * N))), fs);
+            }
+            return sos;
+        }
+
+        //Linkwitz-Riley of order 2N: two Butterworth filters of order N in series (N even)
+        template <int N>
+        constexpr t_dafx_sos<N> LinkwitzRileyLowpass(double fc, double fs)
+        {
+            static_assert(N % 2 == 0, "Linkwitz-Riley needs an even number of biquads");
+            t_dafx_sos<N> sos{};
+            t_dafx_sos<N / 2> half = ButterworthLowpass<N / 2>(fc, fs);
+            for (int k = 0; k < N / 2; k++) {
+                sos[2 * k] = half[k];
+                sos[2 * k + 1] = half[k];
+            }
+            return sos;
+        }
+
+        template <int N>
+        constexpr t_dafx_sos<N> LinkwitzRileyHighpass(double fc, double fs)
+        {
+            static_assert(N % 2 == 0, "Linkwitz-Riley needs an even number of biquads");
+            t_dafx_sos<N> sos{};
+            t_dafx_sos<N / 2> half = ButterworthHighpass<N / 2>(fc, fs);
+            for (int k = 0; k < N / 2; k++) {
+                sos[2 * k] = half[k];
+                sos[2 * k + 1] = half[k];
+            }
+            return sos;
+        }
+
+        //N identical Q = 1/sqrt(2) stages: the cascade DAFX_Crossover builds at runtime
+        template <int N>
+        constexpr t_dafx_sos<N> CrossoverLowpass(double fc, double fs)
+        {
+            t_dafx_sos<N> sos{};
+            for (int k = 0; k < N; k++) {
+                sos[k] = Lowpass(fc, INV_SQRT_TWO, fs);
+            }
+            return sos;
+        }
+
+        template <int N>
+        constexpr t_dafx_sos<N> CrossoverHighpass(double fc, double fs)
+        {
+            t_dafx_sos<N> sos{};
+            //DAFX_Crossover runs its high-pass with inverted polarity
+            t_dafx_biquad_coeffs hp = Highpass(fc, INV_SQRT_TWO, fs);
+            hp.b0 = -hp.b0;
+            hp.b1 = -hp.b1;
+            hp.b2 = -hp.b2;
+            for (int k = 0; k < N; k++) {
+                sos[k] = hp;
+            }
+            return sos;
+        }
+
+        //Crybaby wah filter for a pedal position gp (same model as DAFX_Crybaby)
+        constexpr t_dafx_biquad_coeffs Crybaby(double gp, double fs)
+        {
+            double w0 = 2.0 * cmath::kPi * CB_INIT_F0 / fs, c = cmath::Cos(w0), alpha = cmath::Sin(w0) / (2.0 * CB_INIT_Q);
+            double a0b = 1.0 + alpha, a1b = -2.0 * c, a2b = 1.0 - alpha;
+            double b0 = CB_INIT_GBPF * CB_INIT_Q * alpha + CB_INIT_GI * a0b;
+            double b1 = CB_INIT_GI * a1b;
+            double b2 = -CB_INIT_GBPF * CB_INIT_Q * alpha + CB_INIT_GI * a2b;
+            double a0 = a0b - gp * CB_INIT_GF * (1.0 + c) * 0.5;
+            double a1 = a1b + gp * CB_INIT_GF * (1.0 + c);
+            double a2 = a2b - gp * CB_INIT_GF * (1.0 + c) * 0.5;
+            //like DAFX_Crybaby, only the denominator is normalized to a0
+            return t_dafx_biquad_coeffs{ (float)b0, (float)b1, (float)b2, (float)(a1 / a0), (float)(a2 / a0) };
+        }
+    }
+
+
+    // ---- presets of the C modules, designed at compile time ---- //
+
+    namespace presets {
+
+        struct CrossoverInitLowpass
+        {
+            static constexpr t_dafx_sos<XOVER_INIT_NUMOF_BIQUADS> Coeffs()
+            {
+                return design::CrossoverLowpass<XOVER_INIT_NUMOF_BIQUADS>(XOVER_INIT_FC_HZ, DAFX_SAMPLE_RATE);
+            }
+        };
+
+        struct CrossoverInitHighpass
+        {
+            static constexpr t_dafx_sos<XOVER_INIT_NUMOF_BIQUADS> Coeffs()
+            {
+                return design::CrossoverHighpass<XOVER_INIT_NUMOF_BIQUADS>(XOVER_INIT_FC_HZ, DAFX_SAMPLE_RATE);
+            }
+        };
+
+        //wah filter with the pedal at rest (gp == 0), as set up by InitDAFXCrybaby
+        struct CrybabyInit
+        {
+            static constexpr t_dafx_sos<1> Coeffs()
+            {
+                return t_dafx_sos<1>{ { design::Crybaby(0.0, DAFX_SAMPLE_RATE) } };
+            }
+        };
+    }
+
+}
+
+
+#endif /* DAFX_FilterDesign_hpp */
@@ -0,0 +1,122 @@
+//
+//  DAFX_FixedPoint.h
+//
+//  Fixed-point sample format and saturating helpers used by the *Fixed modules
+//  (targets with slow or no floating point hardware).
+//
+//  The sample word is selected at compile time:
+//      default                     - Q31 samples (int32_t)
+//      DAFX_FIXED_POINT_Q15        - Q15 samples (int16_t), halves the memory of I/O and delay buffers
+//  Internally every module works with Q31 values and 64 bit accumulators either way.
+//
+
+
+#ifndef DAFX_FixedPoint_h
+#define DAFX_FixedPoint_h
+
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(DAFX_FIXED_POINT_Q15)
+    typedef int16_t t_dafx_fx;
+    #define DAFX_FX_FRAC_BITS   15
+    #define DAFX_FX_MAX         INT16_MAX
+    #define DAFX_FX_MIN         INT16_MIN
+#else
+    typedef int32_t t_dafx_fx;
+    #define DAFX_FX_FRAC_BITS   31
+    #define DAFX_FX_MAX         INT32_MAX
+    #define DAFX_FX_MIN         INT32_MIN
+#endif
+
+#define DAFX_Q31_ONE            2147483648.0    //2^31, scale of a Q31 value
+
+
+    // ---- saturation ---- //
+
+    static inline int32_t DAFX_SatQ31(int64_t x)
+    {
+        return (x > INT32_MAX) ? INT32_MAX : ((x < INT32_MIN) ? INT32_MIN : (int32_t)x);
+    }
+
+    static inline int16_t DAFX_SatQ15(int32_t x)
+    {
+        return (x > INT16_MAX) ? INT16_MAX : ((x < INT16_MIN) ? INT16_MIN : (int16_t)x);
+    }
+
+
+    // ---- Q31 arithmetic ---- //
+
+    static inline int32_t DAFX_AddSatQ31(int32_t a, int32_t b)
+    {
+        return DAFX_SatQ31((int64_t)a + b);
+    }
+
+    //a * b, the only overflowing case (-1 * -1) saturates
+    static inline int32_t DAFX_MulQ31(int32_t a, int32_t b)
+    {
+        return DAFX_SatQ31(((int64_t)a * b) >> 31);
+    }
+
+
+    // ---- conversions ---- //
+
+    //sample word <-> Q31 (Q15 samples are rounded to nearest)
+    static inline int32_t DAFX_FxToQ31(t_dafx_fx x)
+    {
+#if defined(DAFX_FIXED_POINT_Q15)
+        return (int32_t)x * (1 << 16);
+#else
+        return x;
+#endif
+    }
+
+    static inline t_dafx_fx DAFX_Q31ToFx(int32_t x)
+    {
+#if defined(DAFX_FIXED_POINT_Q15)
+        return DAFX_SatQ15((int32_t)(((int64_t)x + (1 << 15)) >> 16));
+#else
+        return x;
+#endif
+    }
+
+    //double <-> Q31, rounded and saturated. For tables: a float only carries 24 of the 31 bits
+    static inline int32_t DAFX_DoubleToQ31(double x)
+    {
+        double d = x * DAFX_Q31_ONE;
+        d += (d >= 0.0) ? 0.5 : -0.5;
+        return (d >= (double)INT32_MAX) ? INT32_MAX : ((d <= (double)INT32_MIN) ? INT32_MIN : (int32_t)d);
+    }
+
+    //float <-> Q31, rounded and saturated. Meant for control rate values, not for audio
+    static inline int32_t DAFX_FloatToQ31(float x)
+    {
+        return DAFX_DoubleToQ31((double)x);
+    }
+
+    static inline float DAFX_Q31ToFloat(int32_t x)
+    {
+        return (float)((double)x * (1.0 / DAFX_Q31_ONE));
+    }
+
+    static inline t_dafx_fx DAFX_FloatToFx(float x)
+    {
+        return DAFX_Q31ToFx(DAFX_FloatToQ31(x));
+    }
+
+    static inline float DAFX_FxToFloat(t_dafx_fx x)
+    {
+        return DAFX_Q31ToFloat(DAFX_FxToQ31(x));
+    }
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_FixedPoint_h */
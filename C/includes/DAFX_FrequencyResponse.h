@@ -0,0 +1,130 @@
+//
+//  DAFX_FrequencyResponse.h
+//
+
+
+#ifndef DAFX_FrequencyResponse_h
+#define DAFX_FrequencyResponse_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_SOSCascade.h"
+#include "DAFX_Crossover.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+    /*
+     * Magnitude and phase response of biquads / biquad cascades on a fixed,
+     * log-spaced frequency grid.
+     *
+     * cos/sin of w and 2w are precomputed for the grid at init, and the complex
+     * response of every stage is evaluated and multiplied up for DAFX_SIMD_LANES
+     * frequencies at a time. The last evaluated coefficient set is remembered by
+     * its hash: asking again for the same filter returns immediately, and
+     * 'version' only changes when the curve was actually recomputed, so a caller
+     * can poll it cheaply and only publish new curves.
+     */
+    typedef struct{
+        
+        //set before calling InitFrequencyResponse (0: defaults from DAFX_InitFrequencyResponse.h)
+        int num_points;
+        int fs;
+        float f_min;
+        float f_max;
+        
+        //the grid (Hz)
+        float *p_freqs;
+        
+        //results: magnitude in dB and phase in radians (wrapped to [-pi, pi])
+        float *p_magnitude_db;
+        float *p_phase;
+        
+        //incremented every time the curve is recomputed
+        int version;
+        
+        //private: precomputed cos(w), sin(w), cos(2w), sin(2w) of the grid, normalized
+        //coeffs of the stages being evaluated, hash of the last evaluated set
+        float *p_trig;
+        float *p_stage_coeffs;
+        uint32_t coeff_hash;
+        
+    }t_DAFX_FrequencyResponse;
+    
+    
+    /*!
+     * Init FrequencyResponse struct, allocate memory and precompute the grid
+     * num_points (512 .. 4096), fs, f_min and f_max have to be set before calling this
+     *
+     * @param pointer on a FrequencyResponse structure
+     * @return process status
+     */
+    bool InitFrequencyResponse(t_DAFX_FrequencyResponse *pFR);
+    
+    /*!
+     * Recompute the grid for a new sample rate or frequency range, in place
+     * (num_points is kept, nothing is reallocated). The next evaluation recomputes the curve
+     *
+     * @param pointer on an initialized FrequencyResponse structure
+     * @param sample rate
+     * @param lowest frequency of the grid (0: default)
+     * @param highest frequency of the grid (0: default), clipped to fs / 2
+     * @return false if fs is not valid
+     */
+    bool FR_SetGrid(t_DAFX_FrequencyResponse *pFR, int fs, float f_min, float f_max);
+    
+    /*!
+     * Evaluate a single biquad
+     *
+     * @param pointer on FrequencyResponse structure
+     * @param pointer on array of coefficients (b0, b1, b2, a0, a1, a2)
+     * @return process status
+     */
+    bool FR_EvaluateBiquad(t_DAFX_FrequencyResponse *pFR, float *p_coeffs);
+    
+    /*!
+     * Evaluate a whole SOS cascade (up to FR_MAX_STAGES stages)
+     *
+     * @param pointer on FrequencyResponse structure
+     * @param pointer on SOSCascade structure
+     * @return process status
+     */
+    bool FR_EvaluateSOSCascade(t_DAFX_FrequencyResponse *pFR, t_DAFX_SOSCascade *pSOS);
+    
+    /*!
+     * Evaluate one output band of a Crossover
+     *
+     * @param pointer on FrequencyResponse structure
+     * @param pointer on Crossover structure
+     * @param band index (0: lowpass, 1: highpass)
+     * @return process status
+     */
+    bool FR_EvaluateCrossoverBand(t_DAFX_FrequencyResponse *pFR, t_DAFXCrossover *pXOVER, int band);
+    
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on FrequencyResponse structure
+     * @return void
+     */
+    void DeallocFrequencyResponse(t_DAFX_FrequencyResponse *pFR);
+    
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_FrequencyResponse_h */
@@ -62,6 +62,18 @@ extern "C" {
      */
     float DAFXProcessDelaySingleSample(t_DAFXIntegerSampleDelayLine *pDEL, float x);
     
+    /*!
+     * @brief Process a block with a delay that changes every sample
+     *
+     * @param pointer on IntegerSampleDelayLine structure
+     * @param delay of every sample, in samples (truncated, limited to the line)
+     * @param input block
+     * @param output block
+     * @param number of samples
+     * @return process status
+     */
+    bool DAFXProcessDelayBlockModulated(t_DAFXIntegerSampleDelayLine *pDEL, float *p_delay_samples, float *p_in, float *p_out, int n);
+    
     /*!
      * @brief Bypass IntegerSampleDelayLine of incoming signal
      * processes a single sample at a time
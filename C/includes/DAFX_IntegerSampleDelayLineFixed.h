@@ -0,0 +1,94 @@
+//
+//  DAFX_IntegerSampleDelayLineFixed.h
+//
+
+
+#ifndef DAFX_IntegerSampleDelayLineFixed_h
+#define DAFX_IntegerSampleDelayLineFixed_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_FixedPoint.h"
+#include "DAFX_IntegerSampleDelayLine.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+    /*
+     * Fixed-point counterpart of DAFX_IntegerSampleDelayLine.
+     * The buffer holds t_dafx_fx samples (half the memory with DAFX_FIXED_POINT_Q15)
+     * and the pointers wrap with a compare instead of a modulo
+     */
+    typedef struct{
+        
+        int buf_size;
+        int fs;
+        t_dafx_fx *p_delay_buffer;
+        
+        float max_delay_ms;
+        float delay_ms;
+        
+        int delay_samples;
+        int rp;
+        int wp;
+        
+    }t_DAFXIntegerSampleDelayLineFixed;
+    
+    
+    /*!
+     * @brief Init IntegerSampleDelayLineFixed struct and allocate memory
+     *
+     * @param pointer on a IntegerSampleDelayLineFixed structure
+     * @param sampling rate
+     * @return process status
+     */
+    bool InitDAFXIntegerSampleDelayLineFixed(t_DAFXIntegerSampleDelayLineFixed *pDEL, int fs);
+    
+    /*!
+     * @brief Delay a single sample by an integer number of samples
+     *
+     * @param pointer on IntegerSampleDelayLineFixed structure
+     * @param input sample
+     * @return output sample
+     */
+    t_dafx_fx DAFXProcessDelaySingleSampleFixed(t_DAFXIntegerSampleDelayLineFixed *pDEL, t_dafx_fx x);
+    
+    /*!
+     * @brief Bypass IntegerSampleDelayLineFixed of incoming signal
+     *
+     * @param pointer on IntegerSampleDelayLineFixed structure
+     * @param input sample
+     * @return output sample
+     */
+    t_dafx_fx DAFXBypassDelaySingleSampleFixed(t_DAFXIntegerSampleDelayLineFixed *pDEL, t_dafx_fx x);
+    
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on IntegerSampleDelayLineFixed structure
+     * @return void
+     */
+    void DeallocDAFXIntegerSampleDelayLineFixed(t_DAFXIntegerSampleDelayLineFixed *pDEL);
+    
+    //Setters
+    bool DEL_FX_SetDelayMs(t_DAFXIntegerSampleDelayLineFixed *pDEL, float delay_ms);
+    bool DEL_FX_SetMaxDelayMs(t_DAFXIntegerSampleDelayLineFixed *pDEL, float max_delay_ms);
+    
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_IntegerSampleDelayLineFixed_h */
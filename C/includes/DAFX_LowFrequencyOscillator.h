@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 #include "DAFX_definitions.h"
@@ -19,6 +20,8 @@
 #include <Accelerate/Accelerate.h>
 #endif
 
+#include "DAFX_Denormal.h"
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,9 +31,22 @@ extern "C" {
     {
         LFO_ALGO_SELECT_SIN = 0,
         LFO_ALGO_SELECT_SAW,
+        LFO_ALGO_SELECT_TRIANGLE,       //wavetable shapes from here on (block generation only)
+        LFO_ALGO_SELECT_SQUARE,
+        LFO_ALGO_SELECT_EXP_RISE,
+        LFO_ALGO_SELECT_EXP_FALL,
+        LFO_ALGO_SELECT_SAMPLE_HOLD,
+        LFO_ALGO_SELECT_USER,
         LowFrequencyOscillator_N_ALGOS,
     }t_lfo_algo_select;
     
+    typedef enum
+    {
+        LFO_PROCESS_BLOCK = 0,          //output computed from the absolute sample position, one vectorized pass per block
+        LFO_PROCESS_RECURSIVE,          //sample by sample recursion through pf_process_func
+        LowFrequencyOscillator_N_PROCESS_MODES,
+    }t_lfo_process_mode;
+    
     typedef enum
     {
         LFO_STATE_RISING = 0,
@@ -47,6 +63,9 @@ extern "C" {
         //mode selector
         t_lfo_algo_select algo;
         
+        //generation method used by DAFXLowFrequencyOscillator
+        t_lfo_process_mode process_mode;
+        
         // common params
         float f;
         float amp;
@@ -71,9 +90,27 @@ extern "C" {
         float d_fall;
         t_lfo_state d_state;
         
-        //function pointer to LFO sample generation function (sine or sawtooth)
+        //wavetable specific params
+        float slew;             //square: share of each half period spent in the transition
+        int user_table;         //LFO_ALGO_SELECT_USER: slot of the shared user table
+        
+        //block mode: the phase of sample n is phase + n * phase_inc, a full period being 2^64
+        //(wraps around exactly in unsigned arithmetic)
+        uint64_t phase;
+        uint64_t phase_inc;
+        
+        //absolute position of the next block
+        uint64_t sample_pos;
+        
+        //function pointer to LFO sample generation function (sine or sawtooth), recursive mode only
         void *pf_process_func;
         
+        //samples left before the recursions are put back on the exact phase
+        int resync_count;
+        
+        //subnormals seen in the sine recursion (u, v), checked after every block
+        t_dafx_denormal_stats denormal_stats;
+        
     }t_DAFXLowFrequencyOscillator;
     
 
@@ -96,6 +133,20 @@ extern "C" {
      */
     bool DAFXLowFrequencyOscillator(t_DAFXLowFrequencyOscillator *pLFO);
     
+    /*!
+     * @brief Advances the LFO by one block, at control rate
+     *
+     * Only the last sample of every control period is computed (block mode),
+     * which is the control point convention of t_DAFX_ControlRate. p_output_block
+     * is not updated, except in recursive mode
+     *
+     * @param pointer on LowFrequencyOscillator structure
+     * @param control period in samples (divides the block size)
+     * @param output, block_size / period points
+     * @return process status
+     */
+    bool DAFXLowFrequencyOscillatorControlRate(t_DAFXLowFrequencyOscillator *pLFO, int period, float *p_points);
+    
     /*!
      * @brief Bypass LowFrequencyOscillator of incoming signal
      *
@@ -144,6 +195,55 @@ extern "C" {
      */
     bool LFO_ReinitPhase(t_DAFXLowFrequencyOscillator *pLFO);
     
+    /*!
+     * @brief Sets the phase of the next output sample (block and recursive mode alike)
+     *
+     * @param pointer on LowFrequencyOscillator structure
+     * @param phase in periods (0: zero crossing going up, 0.25: peak)
+     * @return process status
+     */
+    bool LFO_ReinitPhaseTo(t_DAFXLowFrequencyOscillator *pLFO, float phase);
+    
+    /*!
+     * @brief Moves the next block to an absolute sample position (block mode)
+     *
+     * The phase is a function of the position, so this is a seek: the
+     * output continues exactly as if the LFO had run up to sample_pos
+     *
+     * @param pointer on LowFrequencyOscillator structure
+     * @param absolute sample position
+     * @return process status
+     */
+    bool LFO_SetPosition(t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos);
+    
+    /*!
+     * @brief Computes n output samples starting at an absolute position
+     *
+     * Output of the block mode, without touching the LFO state: the samples
+     * only depend on their position and the parameters, so different threads
+     * can render different parts of a file with one LFO and the result is
+     * bit-identical to running it block by block from the start
+     *
+     * @param pointer on LowFrequencyOscillator structure (read only)
+     * @param absolute position of the first sample
+     * @param output buffer
+     * @param number of samples
+     * @return process status
+     */
+    bool LFO_RenderAt(const t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos, float *p_output, int n);
+    
+    /*!
+     * @brief Same as LFO_RenderAt, for every stride-th sample only
+     *
+     * @param pointer on LowFrequencyOscillator structure (read only)
+     * @param absolute position of the first sample
+     * @param distance between two output samples, in samples
+     * @param output buffer
+     * @param number of samples
+     * @return process status
+     */
+    bool LFO_RenderStrided(const t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos, int stride, float *p_output, int n);
+    
     /*!
      * @brief sets the LFO sample generation method
      *
@@ -152,6 +252,27 @@ extern "C" {
      */
     bool LFO_SetMode(t_DAFXLowFrequencyOscillator *pLFO, t_lfo_algo_select algo);
     
+    /*!
+     * @brief sets the generation method
+     *
+     * LFO_PROCESS_BLOCK fills the whole output block in one pass from the
+     * phase of each sample, computed from its absolute position: the sine is
+     * a polynomial of the phase, the sawtooth a piecewise-linear function of
+     * it, with offset and clipping done on the same vectors. The period is
+     * not rounded to whole samples.
+     * LFO_PROCESS_RECURSIVE runs the original recursions sample by sample
+     * (sine and sawtooth only, the wavetable shapes always run by block),
+     * restarted from the exact phase every LFO_RECURSIVE_RESYNC_PERIOD samples
+     * so that neither the amplitude nor the phase drift over long sessions.
+     * Both modes output the same phase for the same sample, so switching is seamless,
+     * and both start from 0 going up after LFO_ReinitPhase
+     *
+     * @param pointer on LowFrequencyOscillator structure
+     * @param processing mode
+     * @return process status
+     */
+    bool LFO_SetProcessMode(t_DAFXLowFrequencyOscillator *pLFO, t_lfo_process_mode mode);
+    
     /*!
      * @brief sets the frequency of the oscillator
      *
@@ -184,6 +305,39 @@ extern "C" {
      */
     bool LFO_SetOffset(t_DAFXLowFrequencyOscillator *pLFO, float off);
     
+    /*!
+     * @brief sets the transition time of the square wave
+     *
+     * @param pointer on LowFrequencyOscillator structure
+     * @param share of each half period spent going from one level to the other
+     * @return process status
+     */
+    bool LFO_SetSlew(t_DAFXLowFrequencyOscillator *pLFO, float slew);
+    
+    /*!
+     * @brief selects the user table read by LFO_ALGO_SELECT_USER
+     *
+     * @param pointer on LowFrequencyOscillator structure
+     * @param slot (0 .. LFO_NUMOF_USER_TABLES - 1)
+     * @return process status
+     */
+    bool LFO_SetUserShape(t_DAFXLowFrequencyOscillator *pLFO, int slot);
+    
+    /*!
+     * @brief draws one of the user tables, shared by every LFO of the process
+     *
+     * The points cover one period at equal spacing and are resampled
+     * (periodically, with linear interpolation) to LFO_TABLE_SIZE points,
+     * clipped to [-1, 1]. Every instance reading the slot picks up the new
+     * shape with its next block. Not to be called from the audio thread
+     *
+     * @param slot (0 .. LFO_NUMOF_USER_TABLES - 1)
+     * @param points of the shape
+     * @param number of points
+     * @return process status (false for an invalid slot or no points)
+     */
+    bool LFO_SetUserTable(int slot, float *p_points, int num_points);
+    
     /*!
      * @brief sets the upper clipping level of the oscillator
      *
@@ -0,0 +1,121 @@
+//
+//  DAFX_LowFrequencyOscillatorFixed.h
+//
+
+
+#ifndef DAFX_LowFrequencyOscillatorFixed_h
+#define DAFX_LowFrequencyOscillatorFixed_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_FixedPoint.h"
+#include "DAFX_LowFrequencyOscillator.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+    /*
+     * Fixed-point counterpart of DAFX_LowFrequencyOscillator.
+     *
+     * Both waveforms are functions of a 32 bit phase accumulator (a full period
+     * is 2^32, i.e. Q31 phase in units of half a turn), so the frequency is exact
+     * to 1/2^32 of the sampling rate and the oscillator never drifts. The sine is
+     * read from a shared table with linear interpolation, the sawtooth is computed
+     * from the phase in closed form.
+     * Amplitude, offset and clipping levels are Q31 values, so they are limited
+     * to [-1, 1] here, 1 being stored as the largest Q31 value (the float LFO
+     * allows larger values).
+     */
+    typedef struct{
+        
+        //wrapper, general
+        int block_size;
+        int fs;
+        t_dafx_fx *p_output_block;
+        
+        //mode selector
+        t_lfo_algo_select algo;
+        
+        // common params (float copies kept for recomputing the fixed-point values)
+        float f;
+        float balance;
+        int32_t amp;
+        int32_t offset;
+        int32_t clip_h;
+        int32_t clip_l;
+        
+        //phase accumulator: one period is 2^32
+        uint32_t phase;
+        uint32_t phase_inc;
+        
+        //sawtooth: phase at which the ramp turns, slopes of the rising / falling
+        //parts (Q16.16 multiples of full scale per half period)
+        uint32_t phase_turn;
+        uint32_t rise_slope;
+        uint32_t fall_slope;
+        
+    }t_DAFXLowFrequencyOscillatorFixed;
+    
+    
+    /*!
+     * @brief Init LowFrequencyOscillatorFixed struct and allocate memory
+     * block_size and fs have to be set before calling this
+     *
+     * @param pointer on a LowFrequencyOscillatorFixed structure
+     * @return process status
+     */
+    bool InitDAFXLowFrequencyOscillatorFixed(t_DAFXLowFrequencyOscillatorFixed *pLFO);
+    
+    /*!
+     * @brief Generate one block of the LFO into p_output_block
+     *
+     * @param pointer on LowFrequencyOscillatorFixed structure
+     * @return process status
+     */
+    bool DAFXLowFrequencyOscillatorFixed(t_DAFXLowFrequencyOscillatorFixed *pLFO);
+    
+    /*!
+     * @brief Bypass LowFrequencyOscillatorFixed (zero output)
+     *
+     * @param pointer on LowFrequencyOscillatorFixed structure
+     * @return process status
+     */
+    bool DAFXBypassLowFrequencyOscillatorFixed(t_DAFXLowFrequencyOscillatorFixed *pLFO);
+    
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on LowFrequencyOscillatorFixed structure
+     * @return void
+     */
+    void DeallocDAFXLowFrequencyOscillatorFixed(t_DAFXLowFrequencyOscillatorFixed *pLFO);
+    
+    //Setters - same meaning as the LFO_Set* functions of the float LFO
+    //Amplitude, offset and clipping levels outside [-1, 1] are rejected (false, the previous value is kept)
+    bool LFO_FX_ReinitPhase(t_DAFXLowFrequencyOscillatorFixed *pLFO);
+    bool LFO_FX_SetMode(t_DAFXLowFrequencyOscillatorFixed *pLFO, t_lfo_algo_select algo);
+    bool LFO_FX_SetFrequency(t_DAFXLowFrequencyOscillatorFixed *pLFO, float f);
+    bool LFO_FX_SetAmplitude(t_DAFXLowFrequencyOscillatorFixed *pLFO, float a);
+    bool LFO_FX_SetBalance(t_DAFXLowFrequencyOscillatorFixed *pLFO, float bal);
+    bool LFO_FX_SetOffset(t_DAFXLowFrequencyOscillatorFixed *pLFO, float off);
+    bool LFO_FX_SetClipHigh(t_DAFXLowFrequencyOscillatorFixed *pLFO, float clip_h);
+    bool LFO_FX_SetClipLow(t_DAFXLowFrequencyOscillatorFixed *pLFO, float clip_l);
+    
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_LowFrequencyOscillatorFixed_h */
@@ -0,0 +1,173 @@
+//
+//  DAFX_ModulationBus.h
+//
+
+
+#ifndef DAFX_ModulationBus_h
+#define DAFX_ModulationBus_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_LowFrequencyOscillator.h"
+#include "DAFX_InitModulationBus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    //one modulator on the bus, shared by every subscriber asking for the same one
+    typedef struct{
+        
+        //normalized waveform (amplitude 1, no offset), in block mode
+        t_DAFXLowFrequencyOscillator lfo;
+        
+        t_lfo_algo_select shape;
+        float division;         //length of one cycle in beats
+        float phase_offset;     //in periods
+        
+        int num_subscribers;    //0: slot free
+        
+        //position of the block currently in lfo.p_output_block, valid if is_rendered
+        uint64_t rendered_pos;
+        bool is_rendered;
+        
+    }t_modbus_slot;
+
+    /*
+     * Tempo clock and modulation bus shared by the modulated effects of a chain.
+     *
+     * The bus keeps the transport position and the tempo, and runs one
+     * block-mode LFO per distinct modulator. Every effect asking for the same
+     * shape, tempo division and phase offset reads the same block, which is
+     * generated only once per block, on the first request. The LFO output only
+     * depends on the transport position (see LFO_RenderAt), so all modulators
+     * stay phase-locked to the beat, whatever their division, and across
+     * tempo changes.
+     *
+     * The modulators are normalized: each effect maps the block through the
+     * amplitude, offset and clipping of its own LFO (MODBUS_Render).
+     */
+    typedef struct{
+        
+        //set before calling InitModulationBus, every subscriber has to run the same block size
+        int block_size;
+        int fs;
+        
+        float bpm;
+        
+        //transport position of the current block, and the beat it starts on
+        uint64_t sample_pos;
+        double beat_pos;
+        
+        t_modbus_slot slots[MODBUS_MAX_NUMOF_SLOTS];
+        
+    }t_DAFX_ModulationBus;
+    
+    
+    /*!
+     * @brief Init ModulationBus struct and allocate memory
+     * block_size and fs have to be set before calling this.
+     *
+     * @param pointer on a ModulationBus structure
+     * @return process status
+     */
+    bool InitModulationBus(t_DAFX_ModulationBus *pBUS);
+    
+    /*!
+     * Deallocates allocated memory for the bus
+     *
+     * @param pointer on ModulationBus structure
+     * @return void
+     */
+    void DeallocModulationBus(t_DAFX_ModulationBus *pBUS);
+    
+    /*!
+     * @brief Moves the transport to the next block
+     * To be called once per block, after every subscriber has processed it
+     *
+     * @param pointer on ModulationBus structure
+     * @return process status
+     */
+    bool MODBUS_Advance(t_DAFX_ModulationBus *pBUS);
+    
+    /*!
+     * @brief Registers a subscriber and returns the slot to read
+     * An existing slot is shared if shape, division and phase offset match.
+     * Not to be called from the audio thread
+     *
+     * @param pointer on ModulationBus structure
+     * @param LFO shape
+     * @param length of one cycle in beats (1: one cycle per beat, 4: one per bar in 4/4)
+     * @param phase offset in periods
+     * @return slot index, -1 if every slot is taken
+     */
+    int MODBUS_Subscribe(t_DAFX_ModulationBus *pBUS, t_lfo_algo_select shape, float division, float phase_offset);
+    
+    /*!
+     * @brief Releases a slot obtained with MODBUS_Subscribe
+     *
+     * @param pointer on ModulationBus structure
+     * @param slot index
+     * @return process status
+     */
+    bool MODBUS_Unsubscribe(t_DAFX_ModulationBus *pBUS, int slot);
+    
+    /*!
+     * @brief Normalized modulator block of a slot at the current position
+     * Generated on the first request of the block, shared afterwards
+     *
+     * @param pointer on ModulationBus structure
+     * @param slot index
+     * @return block_size samples
+     */
+    float *MODBUS_GetBlock(t_DAFX_ModulationBus *pBUS, int slot);
+    
+    /*!
+     * @brief Fills the output block of an effect's LFO from a slot
+     * The slot's block is mapped through the amplitude, offset and clipping
+     * of pLFO, whose own frequency and shape are not used
+     *
+     * @param pointer on ModulationBus structure
+     * @param slot index
+     * @param LFO of the subscriber
+     * @return process status
+     */
+    bool MODBUS_Render(t_DAFX_ModulationBus *pBUS, int slot, t_DAFXLowFrequencyOscillator *pLFO);
+    
+    /*!
+     * @brief Control-rate version of MODBUS_Render
+     * Maps only the last sample of every control period (see t_DAFX_ControlRate)
+     *
+     * @param pointer on ModulationBus structure
+     * @param slot index
+     * @param LFO of the subscriber
+     * @param control period in samples (divides the block size)
+     * @param output, block_size / period points
+     * @return process status
+     */
+    bool MODBUS_RenderControlRate(t_DAFX_ModulationBus *pBUS, int slot, t_DAFXLowFrequencyOscillator *pLFO, int period, float *p_points);
+    
+    //frequency of a slot at the current tempo, in Hz
+    float MODBUS_GetSlotFrequency(t_DAFX_ModulationBus *pBUS, int slot);
+    
+    //Setters
+    bool MODBUS_SetTempo(t_DAFX_ModulationBus *pBUS, float bpm);
+    bool MODBUS_SetPosition(t_DAFX_ModulationBus *pBUS, uint64_t sample_pos);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_ModulationBus_h */
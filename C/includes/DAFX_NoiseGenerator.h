@@ -0,0 +1,157 @@
+//
+//  DAFX_NoiseGenerator.h
+//
+
+
+#ifndef DAFX_NoiseGenerator_h
+#define DAFX_NoiseGenerator_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_SIMD.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    typedef enum
+    {
+        NOISE_ALGO_SELECT_WHITE = 0,        //uniform white noise, a new value every sample
+        NOISE_ALGO_SELECT_RANDOM_WALK,      //random walk with one step per period, smoothed in between (band-limited)
+        NOISE_ALGO_SELECT_SAMPLE_HOLD,      //a new random level every period
+        NoiseGenerator_N_ALGOS,
+    }t_noise_algo_select;
+    
+    /*
+     * Random modulation sources, used like t_DAFXLowFrequencyOscillator
+     * (same amplitude, offset and clipping stage, one block per call).
+     *
+     * Every instance draws from its own xorshift32 streams, seeded with
+     * NOISE_SetSeed: the same seed and the same sequence of calls always
+     * produce the same output, so offline renders are deterministic.
+     * White noise runs DAFX_SIMD_LANES interleaved streams on one vector,
+     * the stepped sources only draw one number per period.
+     */
+    typedef struct{
+        
+        //wrapper, general
+        int block_size;
+        int fs;
+        float *p_output_block;
+        
+        //mode selector
+        t_noise_algo_select algo;
+        
+        // common params
+        float f;                //periods per second (random walk, sample-and-hold)
+        float amp;
+        float offset;
+        float clip_h;
+        float clip_l;
+        
+        //random walk: largest move per step, the walk is reflected at -1 and 1
+        float walk_step;
+        
+        //random streams
+        uint32_t seed;
+        uint32_t lanes[DAFX_SIMD_LANES];    //white noise, one stream per vector lane
+        uint32_t step_state;                //one draw per period
+        
+        //levels around the current period: previous, current start, current end, next
+        float points[4];
+        
+        //phase within the period of the next sample, a full period being 2^64
+        uint64_t phase;
+        uint64_t phase_inc;
+        
+    }t_DAFXNoiseGenerator;
+    
+    
+    /*!
+     * @brief Init NoiseGenerator struct and allocate memory
+     *
+     * @param pointer on a NoiseGenerator structure
+     * @return process status
+     */
+    bool InitDAFXNoiseGenerator(t_DAFXNoiseGenerator *pNG);
+    
+    /*!
+     * @brief Generates the next block into p_output_block
+     *
+     * @param pointer on NoiseGenerator structure
+     * @return process status
+     */
+    bool DAFXNoiseGenerator(t_DAFXNoiseGenerator *pNG);
+    
+    /*!
+     * @brief Bypass NoiseGenerator (silent output block)
+     *
+     * @param pointer on NoiseGenerator structure
+     * @return process status
+     */
+    bool DAFXBypassNoiseGenerator(t_DAFXNoiseGenerator *pNG);
+    
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on NoiseGenerator structure
+     * @return void
+     */
+    void DeallocDAFXNoiseGenerator(t_DAFXNoiseGenerator *pNG);
+    
+    /*!
+     * @brief Restarts every stream from a seed
+     * The period restarts as well, from a fresh level
+     *
+     * @param pointer on NoiseGenerator structure
+     * @param seed (any value)
+     * @return process status
+     */
+    bool NOISE_SetSeed(t_DAFXNoiseGenerator *pNG, uint32_t seed);
+    
+    /*!
+     * @brief Starts a new period with the next sample
+     * Called on a beat, the periods then fall on the tempo divisions
+     *
+     * @param pointer on NoiseGenerator structure
+     * @return process status
+     */
+    bool NOISE_ReinitPhase(t_DAFXNoiseGenerator *pNG);
+    
+    /*!
+     * @brief sets the period to a division of the beat
+     *
+     * @param pointer on NoiseGenerator structure
+     * @param tempo in BPM
+     * @param length of one period in beats
+     * @return process status
+     */
+    bool NOISE_SetTempoDivision(t_DAFXNoiseGenerator *pNG, float bpm, float division);
+    
+    //Setters
+    bool NOISE_SetMode(t_DAFXNoiseGenerator *pNG, t_noise_algo_select algo);
+    bool NOISE_SetFrequency(t_DAFXNoiseGenerator *pNG, float f);
+    bool NOISE_SetAmplitude(t_DAFXNoiseGenerator *pNG, float a);
+    bool NOISE_SetOffset(t_DAFXNoiseGenerator *pNG, float off);
+    bool NOISE_SetClipHigh(t_DAFXNoiseGenerator *pNG, float clip_h);
+    bool NOISE_SetClipLow(t_DAFXNoiseGenerator *pNG, float clip_l);
+    bool NOISE_SetWalkStep(t_DAFXNoiseGenerator *pNG, float step);
+    
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_NoiseGenerator_h */
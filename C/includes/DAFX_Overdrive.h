@@ -19,6 +19,9 @@
 #include <Accelerate/Accelerate.h>
 #endif
 
+#include "DAFX_Saturation.h"
+#include "DAFX_Oversampler.h"
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,6 +32,7 @@ extern "C" {
         OD_ALGO_SELECT_TANH = 0,
         OD_ALGO_SELECT_SIN,
         OD_ALGO_SELECT_EXP,
+        OD_ALGO_SELECT_TABLE,
         Overdrive_N_ALGOS,
     }t_od_algo_select;
     
@@ -42,6 +46,28 @@ extern "C" {
         
         t_od_algo_select algo;
         
+        //tanh approximation used by the tanh algo and its gain curve
+        t_sat_tanh_tier tanh_tier;
+        
+        //antiderivative anti-aliasing of the audio path (the ADAA tanh always uses the exp approximation,
+        //the table algo runs without it)
+        t_sat_adaa_order adaa_order;
+        t_DAFXSaturationADAA adaa;
+        
+        //transfer curve of the table algo: either the private one or a shared one (not owned)
+        t_DAFXSaturationTable * volatile p_table;
+        t_DAFXSaturationTable *p_own_table;
+        
+        //private table swapped out while a block may still be reading it, freed by OD_ReleaseRetiredTable
+        //once the audio thread has ended a block since (num_blocks is only written by the audio thread)
+        t_DAFXSaturationTable *p_retired_table;
+        unsigned int retired_at_block;
+        volatile unsigned int num_blocks;
+        t_sat_table_interp table_interp;
+        
+        //the shaper (ADAA or not) runs at factor times the host rate, the gain curve does not
+        t_DAFXOversampler os;
+        
         float in_gain;
         float out_gain;
         float thresh;
@@ -49,13 +75,23 @@ extern "C" {
         float tan_param;
         float exp_param;
         
+        //function pointer to the block kernel of the current algo, also renders the gain curve
+        void *pf_gain_func;
+        
         // TODO: move this to the wrapper layer
         // Dependency - the displayed gain curve will be the same size as the input signal
         float *p_gain_curve;
         
+        //a shaping parameter has changed since the gain curve was last drawn
+        bool curve_dirty;
+        
     }t_DAFXOverdrive;
     
     
+    //function pointer type for the block kernels: p_out = shaper(in_gain * p_in), n samples
+    typedef bool (* tf_gain_function)(t_DAFXOverdrive *pOD, float *p_in, float *p_out, int n, float in_gain);
+    
+    
     /*!
      * @brief Init Overdrive struct and allocate memory
      *
@@ -83,7 +119,8 @@ extern "C" {
     
     // TODO: Move this to wrapper layer
     /*!
-     * @brief Redraws DisplayedGain Curve
+     * @brief Redraws DisplayedGain Curve, if a shaping parameter has changed
+     * since the last time. Not to be called from the audio thread
      *
      * @param pointer on Overdrive structure
      * @return process status
@@ -91,13 +128,47 @@ extern "C" {
     bool ReDrawGainCurve(t_DAFXOverdrive *pOD);
     
     /*!
-     * Deallocates allocated memory for the object
+     * Deallocates allocated memory for the object (a shared table is left alone)
      *
      * @param pointer on Overdrive structure
      * @return void
      */
     void DeallocDAFXOverdrive(t_DAFXOverdrive *pOD);    
     
+    //Setters (the gain curve is marked for redrawing when the shape changes)
+    bool OD_SetAlgo(t_DAFXOverdrive *pOD, t_od_algo_select algo);
+    bool OD_SetInGain(t_DAFXOverdrive *pOD, float in_gain);
+    bool OD_SetOutGain(t_DAFXOverdrive *pOD, float out_gain);
+    bool OD_SetTanParam(t_DAFXOverdrive *pOD, float tan_param);
+    bool OD_SetExpParam(t_DAFXOverdrive *pOD, float exp_param);
+    bool OD_SetThreshold(t_DAFXOverdrive *pOD, float thresh);
+    bool OD_SetTanhTier(t_DAFXOverdrive *pOD, t_sat_tanh_tier tier);
+    bool OD_SetADAAOrder(t_DAFXOverdrive *pOD, t_sat_adaa_order order);
+    bool OD_SetOversampling(t_DAFXOverdrive *pOD, int factor);
+    bool OD_SetOversamplingFilter(t_DAFXOverdrive *pOD, int filter);
+    bool OD_SetTableInterp(t_DAFXOverdrive *pOD, t_sat_table_interp interp);
+    
+    //Loads a private copy of a transfer curve for the table algo, points spread evenly over [x_min, x_max]
+    //The previous private table is retired, see OD_ReleaseRetiredTable. False (nothing loaded) as long as
+    //the one retired before cannot be released yet
+    //Allocates - not to be called from the audio thread
+    bool OD_LoadTable(t_DAFXOverdrive *pOD, float *p_y, int n_points, float x_min, float x_max);
+    
+    //Same from a curve file, see InitDAFXSaturationTableFile
+    //Allocates - not to be called from the audio thread
+    bool OD_LoadTableFile(t_DAFXOverdrive *pOD, const char *p_path);
+    
+    //Uses a table prepared with InitDAFXSaturationTable, which has to outlive the overdrive
+    bool OD_SetSharedTable(t_DAFXOverdrive *pOD, t_DAFXSaturationTable *pTable);
+    
+    //Frees the private table retired by the last swap, once a block has ended since (false while one may
+    //still be reading it). force frees it right away - only when no block can run, e.g. with the DSP off
+    //Not to be called from the audio thread
+    bool OD_ReleaseRetiredTable(t_DAFXOverdrive *pOD, bool force);
+    
+    //Latency of the audio path in host samples (oversampling filters and ADAA)
+    float OD_GetLatency(t_DAFXOverdrive *pOD);
+    
     
 #ifdef __cplusplus
 }
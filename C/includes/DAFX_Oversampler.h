@@ -0,0 +1,155 @@
+//
+//  DAFX_Oversampler.h
+//
+
+
+#ifndef DAFX_Oversampler_h
+#define DAFX_Oversampler_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_SIMD.h"
+#include "DAFX_Denormal.h"
+#include "DAFX_InitOversampler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    //block process function run at the oversampled rate: p_out = f(p_in), n samples
+    typedef bool (* tf_os_process_function)(void *p_process_state, float *p_in, float *p_out, int n);
+
+    //halfband states of one 2x stage, both directions
+    typedef struct{
+
+        //FIR: input history followed by the block, time ordered
+        float *p_up_hist;           //n_taps - 1 samples at the lower rate
+        float *p_down_even_hist;    //n_taps - 1 even samples at the higher rate
+        float *p_down_odd_hist;     //n_taps / 2 odd samples at the higher rate
+
+        //IIR: see OS_IIR_NUMOF_STATES
+        float iir_up[OS_IIR_NUMOF_STATES];
+        float iir_down[OS_IIR_NUMOF_STATES];
+
+    }t_os_stage;
+
+    /*
+     * Oversampling stage for nonlinear effects.
+     *
+     * The input is upsampled by a cascade of 2x polyphase halfband interpolators,
+     * the process function runs at the high rate, and the same cascade in reverse
+     * brings the result back down. The first stage (closest to the host rate) has
+     * the steepest filter, passing up to 0.42 fs and rejecting from 0.58 fs (about
+     * 20 kHz / 28 kHz at 48 kHz) by 100 dB; the later ones only have to keep the
+     * audio band, so they are much shorter.
+     *
+     * OS_FILTER_LINEAR_PHASE uses FIR halfbands (every other tap is zero, so each
+     * output phase is a single short convolution, computed 4 outputs at a time).
+     * OS_FILTER_MINIMUM_PHASE uses two-path allpass halfbands: same rejection for
+     * a fraction of the latency and cost, with a phase shift towards fs/2.
+     *
+     * Buffers are allocated for OS_MAX_FACTOR at init, so the factor and the
+     * filter can be changed per instance while running: the setters only post
+     * the change, the process call switches and resets the histories at the
+     * start of its next block.
+     */
+    typedef struct{
+
+        //largest host block, set before init
+        int block_size;
+
+        //1, 2, 4 or 8 and the number of 2x stages it takes, as last set
+        int factor;
+        volatile int n_stages;
+
+        //OS_FILTER_LINEAR_PHASE or OS_FILTER_MINIMUM_PHASE, as last set
+        volatile int filter;
+
+        //posted by the setters and OS_Reset: the next block takes the settings above
+        //into the ones below (only written by the audio thread) and clears the histories
+        volatile bool reset_pending;
+        int active_n_stages;
+        int active_filter;
+
+        t_os_stage stages[OS_MAX_NUMOF_STAGES];
+
+        //oversampled signal, OS_MAX_FACTOR * block_size samples each
+        float *p_buffer_a;
+        float *p_buffer_b;
+
+        //up + down delay in host samples (at DC for the IIR halfbands)
+        float latency;
+
+        //subnormals seen in the IIR states, checked after every block
+        t_dafx_denormal_stats denormal_stats;
+
+    }t_DAFXOversampler;
+
+
+    /*!
+     * @brief Init Oversampler struct and allocate memory
+     * block_size has to be set before calling this
+     *
+     * @param pointer on an Oversampler structure
+     * @return process status
+     */
+    bool InitDAFXOversampler(t_DAFXOversampler *pOS);
+
+    /*!
+     * @brief Run a block process function at factor times the host rate:
+     * upsample p_in, process, downsample into p_out.
+     * With a factor of 1 the function is called on p_in / p_out directly
+     *
+     * @param pointer on an Oversampler structure
+     * @param process function
+     * @param first argument of the process function
+     * @param input samples
+     * @param output samples
+     * @param number of samples, at most block_size
+     * @return status of the process function
+     */
+    bool DAFXOversampler(t_DAFXOversampler *pOS, tf_os_process_function pf_process, void *p_process_state,
+                         float *p_in, float *p_out, int n);
+
+    /*!
+     * @brief Forget the filter histories, as if the input had been silent
+     * (posted, done at the start of the next block)
+     *
+     * @param pointer on an Oversampler structure
+     * @return process status
+     */
+    bool OS_Reset(t_DAFXOversampler *pOS);
+
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on an Oversampler structure
+     * @return void
+     */
+    void DeallocDAFXOversampler(t_DAFXOversampler *pOS);
+
+    //Setters, the filter histories are reset on a change (false if the value is not supported)
+    //The change is posted, the next block applies it
+    bool OS_SetFactor(t_DAFXOversampler *pOS, int factor);
+    bool OS_SetFilter(t_DAFXOversampler *pOS, int filter);
+
+    //Round trip latency in host samples
+    float OS_GetLatency(t_DAFXOversampler *pOS);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_Oversampler_h */
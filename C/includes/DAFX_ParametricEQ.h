@@ -0,0 +1,131 @@
+//
+//  DAFX_ParametricEQ.h
+//
+
+
+#ifndef DAFX_ParametricEQ_h
+#define DAFX_ParametricEQ_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_SOSCascade.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+    //band filter types (RBJ audio EQ cookbook, as in matlab/mkbiquad.m)
+    typedef enum
+    {
+        PEQ_BAND_PEAKING = 0,
+        PEQ_BAND_LOW_SHELF,
+        PEQ_BAND_HIGH_SHELF,
+        PEQ_BAND_LOWPASS,
+        PEQ_BAND_HIGHPASS,
+        PEQ_BAND_BANDPASS,
+        PEQ_BAND_NOTCH,
+        ParametricEQ_N_BAND_TYPES,
+    }t_peq_band_type;
+    
+    typedef struct{
+        
+        t_peq_band_type type;
+        float f0;           //center / corner frequency (Hz)
+        float gain_db;      //peaking and shelves: boost/cut, other types: output gain
+        float q;
+        bool enabled;       //disabled bands are pass-through stages
+        
+        //parameters changed since the band was last designed (set by the setters, cleared by the audio thread)
+        volatile bool dirty;
+        
+    }t_peq_band;
+    
+    /*
+     * N band parametric equalizer. Every band is one biquad, and all the bands
+     * run as a single SOS cascade. Setters only store the parameters and flag
+     * the band; the flagged bands are redesigned once at the start of the next
+     * block, and that block moves to the new coefficients with a per-sample
+     * ramp so that parameter changes do not click.
+     */
+    typedef struct{
+        
+        //general, wrapper
+        int block_size;
+        int fs;
+        float *p_input_block;
+        float *p_output_block;
+        
+        //set before calling InitDAFXParametricEQ (0: PEQ_INIT_NUMOF_BANDS)
+        int num_bands;
+        
+        t_peq_band *p_bands;
+        
+        //current coeffs of every band, (b0, b1, b2, a0, a1, a2) one band after the other
+        float *p_band_coeffs;
+        
+        //all the bands in one cascade
+        t_DAFX_SOSCascade *p_cascade;
+        
+        //at least one band is flagged
+        volatile bool any_dirty;
+        
+    }t_DAFXParametricEQ;
+    
+    
+    /*!
+     * @brief Init ParametricEQ struct and allocate memory
+     * block_size, fs and num_bands have to be set before calling this
+     *
+     * @param pointer on a ParametricEQ structure
+     * @return process status
+     */
+    bool InitDAFXParametricEQ(t_DAFXParametricEQ *pEQ);
+    
+    /*!
+     * @brief Process and Apply ParametricEQ to incoming signal
+     *
+     * @param pointer on ParametricEQ structure
+     * @return process status
+     */
+    bool DAFXProcessParametricEQ(t_DAFXParametricEQ *pEQ);
+    
+    /*!
+     * @brief Bypass ParametricEQ of incoming signal
+     *
+     * @param pointer on ParametricEQ structure
+     * @return process status
+     */
+    bool DAFXBypassParametricEQ(t_DAFXParametricEQ *pEQ);
+    
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on ParametricEQ structure
+     * @return void
+     */
+    void DeallocDAFXParametricEQ(t_DAFXParametricEQ *pEQ);
+    
+    //Setters - band index is 0 .. num_bands-1, out of range indices and band types are ignored (return false)
+    bool PEQ_SetBand(t_DAFXParametricEQ *pEQ, int band, t_peq_band_type type, float f0, float gain_db, float q);
+    bool PEQ_SetBandType(t_DAFXParametricEQ *pEQ, int band, t_peq_band_type type);
+    bool PEQ_SetBandFrequency(t_DAFXParametricEQ *pEQ, int band, float f0);
+    bool PEQ_SetBandGain(t_DAFXParametricEQ *pEQ, int band, float gain_db);
+    bool PEQ_SetBandQ(t_DAFXParametricEQ *pEQ, int band, float q);
+    bool PEQ_SetBandEnabled(t_DAFXParametricEQ *pEQ, int band, bool enabled);
+    
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_ParametricEQ_h */
@@ -0,0 +1,451 @@
+//
+//  DAFX_SIMD.h
+//
+//  Thin 4-lane float vector layer shared by the block kernels.
+//  Maps onto SSE on x86, NEON on ARM and a plain C struct everywhere else,
+//  so every kernel written against it also builds on targets without SIMD.
+//
+
+
+#ifndef DAFX_SIMD_h
+#define DAFX_SIMD_h
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DAFX_SIMD_SSE   1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DAFX_SIMD_NEON  1
+#include <arm_neon.h>
+#else
+#define DAFX_SIMD_NONE  1
+#endif
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <malloc.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//number of float lanes in one vector
+#define DAFX_SIMD_LANES     4
+
+//alignment of every block allocated with DAFX_AlignedCalloc (enough for AVX loads as well)
+#define DAFX_SIMD_ALIGN     32
+
+#if defined(DAFX_SIMD_SSE)
+    typedef __m128 t_dafx_v4f;
+    typedef __m128i t_dafx_v4u;
+#elif defined(DAFX_SIMD_NEON)
+    typedef float32x4_t t_dafx_v4f;
+    typedef uint32x4_t t_dafx_v4u;
+#else
+    typedef struct { float f[DAFX_SIMD_LANES]; } t_dafx_v4f;
+    typedef struct { uint32_t u[DAFX_SIMD_LANES]; } t_dafx_v4u;
+#endif
+
+
+    // ---- aligned memory ---- //
+
+    //zero initialized, DAFX_SIMD_ALIGN aligned allocation. Must be released with DAFX_AlignedFree
+    static inline void *DAFX_AlignedCalloc(size_t num, size_t size)
+    {
+        size_t bytes = num * size;
+        void *p = NULL;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+        p = _aligned_malloc(bytes, DAFX_SIMD_ALIGN);
+#else
+        if (posix_memalign(&p, DAFX_SIMD_ALIGN, bytes) != 0) {
+            p = NULL;
+        }
+#endif
+        if (p != NULL) {
+            memset(p, 0, bytes);
+        }
+        return p;
+    }
+
+    static inline void DAFX_AlignedFree(void *p)
+    {
+        if (p != NULL) {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+            _aligned_free(p);
+#else
+            free(p);
+#endif
+        }
+    }
+
+
+    // ---- 4-lane float vector ops ---- //
+
+#if defined(DAFX_SIMD_SSE)
+
+    static inline t_dafx_v4f dafx_v4f_load(const float *p)              { return _mm_load_ps(p); }
+    static inline t_dafx_v4f dafx_v4f_loadu(const float *p)             { return _mm_loadu_ps(p); }
+    static inline void dafx_v4f_store(float *p, t_dafx_v4f a)           { _mm_store_ps(p, a); }
+    static inline void dafx_v4f_storeu(float *p, t_dafx_v4f a)          { _mm_storeu_ps(p, a); }
+    static inline t_dafx_v4f dafx_v4f_set1(float x)                     { return _mm_set1_ps(x); }
+    static inline t_dafx_v4f dafx_v4f_add(t_dafx_v4f a, t_dafx_v4f b)   { return _mm_add_ps(a, b); }
+    static inline t_dafx_v4f dafx_v4f_sub(t_dafx_v4f a, t_dafx_v4f b)   { return _mm_sub_ps(a, b); }
+    static inline t_dafx_v4f dafx_v4f_mul(t_dafx_v4f a, t_dafx_v4f b)   { return _mm_mul_ps(a, b); }
+    static inline t_dafx_v4f dafx_v4f_div(t_dafx_v4f a, t_dafx_v4f b)   { return _mm_div_ps(a, b); }
+    static inline t_dafx_v4f dafx_v4f_min(t_dafx_v4f a, t_dafx_v4f b)   { return _mm_min_ps(a, b); }
+    static inline t_dafx_v4f dafx_v4f_max(t_dafx_v4f a, t_dafx_v4f b)   { return _mm_max_ps(a, b); }
+
+    //returns {x, a0, a1, a2}: shifts every lane up by one and inserts x in lane 0
+    static inline t_dafx_v4f dafx_v4f_shift_in(t_dafx_v4f a, float x)
+    {
+        __m128 s = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a), 4));
+        return _mm_move_ss(s, _mm_set_ss(x));
+    }
+
+    //returns the value of the highest lane
+    static inline float dafx_v4f_last(t_dafx_v4f a)
+    {
+        return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+
+    //broadcasts lane 0 / lane 1 to all the lanes
+    static inline t_dafx_v4f dafx_v4f_splat0(t_dafx_v4f a)             { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)); }
+    static inline t_dafx_v4f dafx_v4f_splat1(t_dafx_v4f a)             { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)); }
+    //rounds toward zero, |a| < 2^31
+    static inline t_dafx_v4f dafx_v4f_trunc(t_dafx_v4f a)               { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); }
+    //2^n for whole numbers n in [-126, 127], built in the exponent field
+    static inline t_dafx_v4f dafx_v4f_pow2i(t_dafx_v4f n)
+    {
+        return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23));
+    }
+    //|a|, and |a| with the sign of s
+    static inline t_dafx_v4f dafx_v4f_abs(t_dafx_v4f a)                 { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static inline t_dafx_v4f dafx_v4f_copysign(t_dafx_v4f a, t_dafx_v4f s)
+    {
+        __m128 sign = _mm_set1_ps(-0.0f);
+        return _mm_or_ps(_mm_andnot_ps(sign, a), _mm_and_ps(sign, s));
+    }
+    //lane mask of a < b, and a where the mask is set, b elsewhere
+    static inline t_dafx_v4u dafx_v4f_cmplt(t_dafx_v4f a, t_dafx_v4f b) { return _mm_castps_si128(_mm_cmplt_ps(a, b)); }
+    static inline t_dafx_v4f dafx_v4f_select(t_dafx_v4u m, t_dafx_v4f a, t_dafx_v4f b)
+    {
+        __m128 mask = _mm_castsi128_ps(m);
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    //nonzero if any lane of the mask is set
+    static inline int dafx_v4u_any(t_dafx_v4u m)                        { return _mm_movemask_epi8(m) != 0; }
+
+#elif defined(DAFX_SIMD_NEON)
+
+    static inline t_dafx_v4f dafx_v4f_load(const float *p)              { return vld1q_f32(p); }
+    static inline t_dafx_v4f dafx_v4f_loadu(const float *p)             { return vld1q_f32(p); }
+    static inline void dafx_v4f_store(float *p, t_dafx_v4f a)           { vst1q_f32(p, a); }
+    static inline void dafx_v4f_storeu(float *p, t_dafx_v4f a)          { vst1q_f32(p, a); }
+    static inline t_dafx_v4f dafx_v4f_set1(float x)                     { return vdupq_n_f32(x); }
+    static inline t_dafx_v4f dafx_v4f_add(t_dafx_v4f a, t_dafx_v4f b)   { return vaddq_f32(a, b); }
+    static inline t_dafx_v4f dafx_v4f_sub(t_dafx_v4f a, t_dafx_v4f b)   { return vsubq_f32(a, b); }
+    static inline t_dafx_v4f dafx_v4f_mul(t_dafx_v4f a, t_dafx_v4f b)   { return vmulq_f32(a, b); }
+    static inline t_dafx_v4f dafx_v4f_div(t_dafx_v4f a, t_dafx_v4f b)
+    {
+#if defined(__aarch64__)
+        return vdivq_f32(a, b);
+#else
+        //reciprocal estimate refined by two Newton steps
+        float32x4_t r = vrecpeq_f32(b);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        return vmulq_f32(a, r);
+#endif
+    }
+    static inline t_dafx_v4f dafx_v4f_min(t_dafx_v4f a, t_dafx_v4f b)   { return vminq_f32(a, b); }
+    static inline t_dafx_v4f dafx_v4f_max(t_dafx_v4f a, t_dafx_v4f b)   { return vmaxq_f32(a, b); }
+
+    static inline t_dafx_v4f dafx_v4f_shift_in(t_dafx_v4f a, float x)
+    {
+        return vextq_f32(vdupq_n_f32(x), a, 3);
+    }
+
+    static inline float dafx_v4f_last(t_dafx_v4f a)
+    {
+        return vgetq_lane_f32(a, 3);
+    }
+
+    static inline t_dafx_v4f dafx_v4f_splat0(t_dafx_v4f a)             { return vdupq_n_f32(vgetq_lane_f32(a, 0)); }
+    static inline t_dafx_v4f dafx_v4f_splat1(t_dafx_v4f a)             { return vdupq_n_f32(vgetq_lane_f32(a, 1)); }
+    static inline t_dafx_v4f dafx_v4f_trunc(t_dafx_v4f a)               { return vcvtq_f32_s32(vcvtq_s32_f32(a)); }
+    static inline t_dafx_v4f dafx_v4f_pow2i(t_dafx_v4f n)
+    {
+        return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23));
+    }
+    static inline t_dafx_v4f dafx_v4f_abs(t_dafx_v4f a)                 { return vabsq_f32(a); }
+    static inline t_dafx_v4f dafx_v4f_copysign(t_dafx_v4f a, t_dafx_v4f s)
+    {
+        return vbslq_f32(vdupq_n_u32(0x80000000), s, a);
+    }
+    static inline t_dafx_v4u dafx_v4f_cmplt(t_dafx_v4f a, t_dafx_v4f b) { return vcltq_f32(a, b); }
+    static inline t_dafx_v4f dafx_v4f_select(t_dafx_v4u m, t_dafx_v4f a, t_dafx_v4f b)
+    {
+        return vbslq_f32(m, a, b);
+    }
+    static inline int dafx_v4u_any(t_dafx_v4u m)
+    {
+        uint32x2_t r = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+        return (vget_lane_u32(r, 0) | vget_lane_u32(r, 1)) != 0;
+    }
+
+#else
+
+    static inline t_dafx_v4f dafx_v4f_load(const float *p)
+    {
+        t_dafx_v4f r;
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) r.f[i] = p[i];
+        return r;
+    }
+    static inline t_dafx_v4f dafx_v4f_loadu(const float *p)             { return dafx_v4f_load(p); }
+    static inline void dafx_v4f_store(float *p, t_dafx_v4f a)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) p[i] = a.f[i];
+    }
+    static inline void dafx_v4f_storeu(float *p, t_dafx_v4f a)          { dafx_v4f_store(p, a); }
+    static inline t_dafx_v4f dafx_v4f_set1(float x)
+    {
+        t_dafx_v4f r;
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) r.f[i] = x;
+        return r;
+    }
+    static inline t_dafx_v4f dafx_v4f_add(t_dafx_v4f a, t_dafx_v4f b)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) a.f[i] += b.f[i];
+        return a;
+    }
+    static inline t_dafx_v4f dafx_v4f_sub(t_dafx_v4f a, t_dafx_v4f b)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) a.f[i] -= b.f[i];
+        return a;
+    }
+    static inline t_dafx_v4f dafx_v4f_mul(t_dafx_v4f a, t_dafx_v4f b)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) a.f[i] *= b.f[i];
+        return a;
+    }
+    static inline t_dafx_v4f dafx_v4f_div(t_dafx_v4f a, t_dafx_v4f b)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) a.f[i] /= b.f[i];
+        return a;
+    }
+    static inline t_dafx_v4f dafx_v4f_min(t_dafx_v4f a, t_dafx_v4f b)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) a.f[i] = (a.f[i] < b.f[i]) ? a.f[i] : b.f[i];
+        return a;
+    }
+    static inline t_dafx_v4f dafx_v4f_max(t_dafx_v4f a, t_dafx_v4f b)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) a.f[i] = (a.f[i] > b.f[i]) ? a.f[i] : b.f[i];
+        return a;
+    }
+    static inline t_dafx_v4f dafx_v4f_shift_in(t_dafx_v4f a, float x)
+    {
+        t_dafx_v4f r;
+        r.f[0] = x;
+        for (int i = 1; i < DAFX_SIMD_LANES; i++) r.f[i] = a.f[i-1];
+        return r;
+    }
+    static inline float dafx_v4f_last(t_dafx_v4f a)
+    {
+        return a.f[DAFX_SIMD_LANES - 1];
+    }
+    static inline t_dafx_v4f dafx_v4f_splat0(t_dafx_v4f a)             { return dafx_v4f_set1(a.f[0]); }
+    static inline t_dafx_v4f dafx_v4f_splat1(t_dafx_v4f a)             { return dafx_v4f_set1(a.f[1]); }
+    static inline t_dafx_v4f dafx_v4f_trunc(t_dafx_v4f a)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) a.f[i] = (float)(int)a.f[i];
+        return a;
+    }
+    static inline t_dafx_v4f dafx_v4f_pow2i(t_dafx_v4f n)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) {
+            uint32_t bits = (uint32_t)((int)n.f[i] + 127) << 23;
+            memcpy(&n.f[i], &bits, sizeof(float));
+        }
+        return n;
+    }
+    static inline t_dafx_v4f dafx_v4f_abs(t_dafx_v4f a)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) a.f[i] = (a.f[i] < 0.0f) ? -a.f[i] : a.f[i];
+        return a;
+    }
+    static inline t_dafx_v4f dafx_v4f_copysign(t_dafx_v4f a, t_dafx_v4f s)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) {
+            uint32_t ua, us;
+            memcpy(&ua, &a.f[i], sizeof(float));
+            memcpy(&us, &s.f[i], sizeof(float));
+            ua = (ua & 0x7fffffffu) | (us & 0x80000000u);
+            memcpy(&a.f[i], &ua, sizeof(float));
+        }
+        return a;
+    }
+    static inline t_dafx_v4u dafx_v4f_cmplt(t_dafx_v4f a, t_dafx_v4f b)
+    {
+        t_dafx_v4u m;
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) m.u[i] = (a.f[i] < b.f[i]) ? 0xffffffffu : 0u;
+        return m;
+    }
+    static inline t_dafx_v4f dafx_v4f_select(t_dafx_v4u m, t_dafx_v4f a, t_dafx_v4f b)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) a.f[i] = m.u[i] ? a.f[i] : b.f[i];
+        return a;
+    }
+    static inline int dafx_v4u_any(t_dafx_v4u m)
+    {
+        return (m.u[0] | m.u[1] | m.u[2] | m.u[3]) != 0;
+    }
+
+#endif
+
+    //a * b + c
+    static inline t_dafx_v4f dafx_v4f_madd(t_dafx_v4f a, t_dafx_v4f b, t_dafx_v4f c)
+    {
+        return dafx_v4f_add(dafx_v4f_mul(a, b), c);
+    }
+
+    //in-place 4x4 transpose: r[i] lane j <-> r[j] lane i
+    static inline void dafx_v4f_transpose(t_dafx_v4f *r)
+    {
+#if defined(DAFX_SIMD_SSE)
+        _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+#elif defined(DAFX_SIMD_NEON)
+        float32x4x2_t t01 = vtrnq_f32(r[0], r[1]);
+        float32x4x2_t t23 = vtrnq_f32(r[2], r[3]);
+        r[0] = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+        r[1] = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+        r[2] = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+        r[3] = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+#else
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) {
+            for (int j = i + 1; j < DAFX_SIMD_LANES; j++) {
+                float tmp = r[i].f[j];
+                r[i].f[j] = r[j].f[i];
+                r[j].f[i] = tmp;
+            }
+        }
+#endif
+    }
+
+    //stores lanes 0 and 1 to p (unaligned)
+    static inline void dafx_v4f_storeu2(float *p, t_dafx_v4f a)
+    {
+#if defined(DAFX_SIMD_SSE)
+        _mm_storel_pi((__m64 *)p, a);
+#elif defined(DAFX_SIMD_NEON)
+        vst1_f32(p, vget_low_f32(a));
+#else
+        p[0] = a.f[0];
+        p[1] = a.f[1];
+#endif
+    }
+
+    //stores {a0, b0, a1, b1, a2, b2, a3, b3} to p (unaligned)
+    static inline void dafx_v4f_storeu_interleaved(float *p, t_dafx_v4f a, t_dafx_v4f b)
+    {
+#if defined(DAFX_SIMD_SSE)
+        _mm_storeu_ps(p, _mm_unpacklo_ps(a, b));
+        _mm_storeu_ps(p + 4, _mm_unpackhi_ps(a, b));
+#elif defined(DAFX_SIMD_NEON)
+        float32x4x2_t ab = {{a, b}};
+        vst2q_f32(p, ab);
+#else
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) {
+            p[2 * i] = a.f[i];
+            p[2 * i + 1] = b.f[i];
+        }
+#endif
+    }
+
+
+    // ---- 4-lane uint32 random streams ---- //
+
+#if defined(DAFX_SIMD_SSE)
+
+    static inline t_dafx_v4u dafx_v4u_loadu(const uint32_t *p)         { return _mm_loadu_si128((const __m128i *)p); }
+    static inline void dafx_v4u_storeu(uint32_t *p, t_dafx_v4u a)       { _mm_storeu_si128((__m128i *)p, a); }
+
+    //one xorshift32 step (13, 17, 5) in every lane
+    static inline t_dafx_v4u dafx_v4u_xorshift32(t_dafx_v4u x)
+    {
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    }
+
+    //top 23 bits as the mantissa of a float in [1, 2), mapped to [-1, 1)
+    static inline t_dafx_v4f dafx_v4u_to_bipolar(t_dafx_v4u x)
+    {
+        __m128i m = _mm_or_si128(_mm_srli_epi32(x, 9), _mm_set1_epi32(0x3f800000));
+        return _mm_sub_ps(_mm_add_ps(_mm_castsi128_ps(m), _mm_castsi128_ps(m)), _mm_set1_ps(3.0f));
+    }
+
+#elif defined(DAFX_SIMD_NEON)
+
+    static inline t_dafx_v4u dafx_v4u_loadu(const uint32_t *p)         { return vld1q_u32(p); }
+    static inline void dafx_v4u_storeu(uint32_t *p, t_dafx_v4u a)       { vst1q_u32(p, a); }
+
+    static inline t_dafx_v4u dafx_v4u_xorshift32(t_dafx_v4u x)
+    {
+        x = veorq_u32(x, vshlq_n_u32(x, 13));
+        x = veorq_u32(x, vshrq_n_u32(x, 17));
+        return veorq_u32(x, vshlq_n_u32(x, 5));
+    }
+
+    static inline t_dafx_v4f dafx_v4u_to_bipolar(t_dafx_v4u x)
+    {
+        float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(vshrq_n_u32(x, 9), vdupq_n_u32(0x3f800000)));
+        return vsubq_f32(vaddq_f32(m, m), vdupq_n_f32(3.0f));
+    }
+
+#else
+
+    static inline t_dafx_v4u dafx_v4u_loadu(const uint32_t *p)
+    {
+        t_dafx_v4u r;
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) r.u[i] = p[i];
+        return r;
+    }
+    static inline void dafx_v4u_storeu(uint32_t *p, t_dafx_v4u a)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) p[i] = a.u[i];
+    }
+    static inline t_dafx_v4u dafx_v4u_xorshift32(t_dafx_v4u x)
+    {
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) {
+            x.u[i] ^= x.u[i] << 13;
+            x.u[i] ^= x.u[i] >> 17;
+            x.u[i] ^= x.u[i] << 5;
+        }
+        return x;
+    }
+    static inline t_dafx_v4f dafx_v4u_to_bipolar(t_dafx_v4u x)
+    {
+        t_dafx_v4f r;
+        for (int i = 0; i < DAFX_SIMD_LANES; i++) {
+            uint32_t m = (x.u[i] >> 9) | 0x3f800000u;
+            float f;
+            memcpy(&f, &m, sizeof(float));
+            r.f[i] = 2.0f * f - 3.0f;
+        }
+        return r;
+    }
+
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_SIMD_h */
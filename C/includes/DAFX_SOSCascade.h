@@ -0,0 +1,172 @@
+//
+//  DAFX_SOSCascade.h
+//
+
+
+#ifndef DAFX_SOSCascade_h
+#define DAFX_SOSCascade_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_Denormal.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Cascade of second order sections (biquads) in transposed direct form II.
+     *
+     * All coefficients and states live in a single aligned memory block,
+     * organized in groups of SOS_STAGES_PER_GROUP stages. Within a group every
+     * vector lane holds one stage, and the group is run as a pipeline:
+     * at step n, stage k processes sample n-k, taking as input what stage k-1
+     * produced at step n-1. The pipeline is filled and drained inside each call,
+     * so the cascade adds no latency compared to running the stages one by one.
+     * Stage counts that are not a multiple of the group size are padded with
+     * pass-through stages.
+     */
+    typedef struct{
+
+        //number of biquads in the cascade - set before calling InitSOSCascade
+        int num_stages;
+
+        //number of biquads the memory was allocated for (num_stages at init)
+        int max_stages;
+
+        //number of SIMD groups the stages are packed into
+        int num_groups;
+
+        //coeffs and states of all stages (num_groups * SOS_GROUP_SIZE floats)
+        float *p_memory;
+
+        //subnormals seen in the stage states, checked after every block
+        t_dafx_denormal_stats denormal_stats;
+
+    }t_DAFX_SOSCascade;
+
+
+    /*!
+     * Init SOSCascade struct and allocate memory
+     * num_stages has to be set before calling this.
+     * All stages are initialized to pass-through filters
+     *
+     * @param pointer on a SOSCascade structure
+     * @return process status
+     */
+    bool InitSOSCascade(t_DAFX_SOSCascade *pSOS);
+
+    /*!
+     * Change the number of stages in use, within the allocated max_stages
+     * (no allocation). Stages dropped become pass-through filters, stages
+     * added keep whatever coefficients they had: set them afterwards.
+     * States are not cleared
+     *
+     * @param pointer on SOSCascade structure
+     * @param number of stages, clamped to 1 .. max_stages
+     * @return process status
+     */
+    bool SetSOSCascadeNumStages(t_DAFX_SOSCascade *pSOS, int num_stages);
+
+    /*!
+     * Set the coefficients of one stage of the cascade
+     *
+     * Same format as SetBiquadFilterCoeffs: (b0, b1, b2, a0, a1, a2)
+     * The coefficients are normalized to a0 here
+     *
+     * @param pointer on SOSCascade structure
+     * @param index of the stage (0 .. num_stages-1)
+     * @param pointer on array of coefficients (b0, b1, b2, a0, a1, a2)
+     * @return process status
+     */
+    bool SetSOSCascadeStageCoeffs(t_DAFX_SOSCascade *pSOS, int stage, float *p_coeffs);
+
+    /*!
+     * Set the feedback coefficients of one stage, already normalized to a0
+     * (no division: meant for filters modulated every sample)
+     *
+     * @param pointer on SOSCascade structure
+     * @param index of the stage (0 .. num_stages-1)
+     * @param a1 / a0
+     * @param a2 / a0
+     * @return process status
+     */
+    bool SetSOSCascadeStageFeedbackCoeffs(t_DAFX_SOSCascade *pSOS, int stage, float a1, float a2);
+
+    /*!
+     * Read back the (normalized) coefficients of one stage of the cascade
+     *
+     * @param pointer on SOSCascade structure
+     * @param index of the stage (0 .. num_stages-1)
+     * @param pointer on array of 6 coefficients to fill (b0, b1, b2, a0, a1, a2), a0 is always 1
+     * @return process status
+     */
+    bool GetSOSCascadeStageCoeffs(t_DAFX_SOSCascade *pSOS, int stage, float *p_coeffs);
+
+    /*!
+     * Filter a block of samples through the whole cascade
+     * p_in and p_out may point to the same buffer
+     *
+     * @param pointer on SOSCascade structure
+     * @param input samples
+     * @param output samples
+     * @param number of samples
+     * @return process status
+     */
+    bool ProcessBlockSOSCascade(t_DAFX_SOSCascade *pSOS, float *p_in, float *p_out, int n);
+
+    /* same as above, but sample-based*/
+    float ProcessSingleSampleSOSCascade(t_DAFX_SOSCascade *pSOS, float x);
+
+    /*!
+     * Filter a block while moving every stage from its current coefficients
+     * to a new target set
+     *
+     * The normalized coefficients are interpolated linearly over the block,
+     * reaching the target exactly at the last sample. The target becomes the
+     * current coefficient set afterwards, so a modulated filter only needs
+     * to be designed once per block (or control period)
+     *
+     * @param pointer on SOSCascade structure
+     * @param target coeffs, (b0, b1, b2, a0, a1, a2) for every stage one after the other
+     * @param input samples
+     * @param output samples
+     * @param number of samples
+     * @return process status
+     */
+    bool ProcessBlockSOSCascadeRamp(t_DAFX_SOSCascade *pSOS, float *p_target_coeffs, float *p_in, float *p_out, int n);
+
+    /*!
+     * Clears the internal states of all stages (coefficients are kept)
+     *
+     * @param pointer on SOSCascade structure
+     * @return process status
+     */
+    bool ResetSOSCascade(t_DAFX_SOSCascade *pSOS);
+
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on SOSCascade structure
+     * @return void
+     */
+    void DeallocSOSCascade(t_DAFX_SOSCascade *pSOS);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_SOSCascade_h */
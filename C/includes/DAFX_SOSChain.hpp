@@ -0,0 +1,227 @@
+//
+//  DAFX_SOSChain.hpp
+//
+//  C++ (C++14) biquad chains with the number of stages as a template parameter.
+//  With N known at compile time the stage loop is fully unrolled and coefficients
+//  and states live in registers for the whole block. FixedSOSChain goes one step
+//  further and takes its coefficients from a compile-time design (see
+//  DAFX_FilterDesign.hpp), so they end up as immediate constants in the code.
+//  Both use the transposed direct form II, like t_DAFX_SOSCascade.
+//
+
+
+#ifndef DAFX_SOSChain_hpp
+#define DAFX_SOSChain_hpp
+
+
+#include "DAFX_FilterDesign.hpp"
+
+
+namespace dafx {
+
+    namespace detail {
+
+        //one sample through all the stages, stage after stage
+        template <int N>
+        inline float SOSChainStep(const t_dafx_sos<N> &c, float *w1, float *w2, float x)
+        {
+            for (int k = 0; k < N; k++) {
+                float y = c[k].b0 * x + w1[k];
+                w1[k] = c[k].b1 * x - c[k].a1 * y + w2[k];
+                w2[k] = c[k].b2 * x - c[k].a2 * y;
+                x = y;
+            }
+            return x;
+        }
+
+        //one pipeline step: stage k works on sample t-k, fed by what stage k-1 produced
+        //in the previous step. Stages are updated from the last to the first, so y[k-1]
+        //is still the previous output when stage k reads it. Only stages [k_first, k_last]
+        //are active (all of them once the pipeline is full)
+        template <int N>
+        inline void SOSChainPipelineStep(const t_dafx_sos<N> &c, float *w1, float *w2, float *y,
+                                         const float *p_in, int t, int k_first, int k_last)
+        {
+            for (int k = N - 1; k >= 0; k--) {
+                if (k > k_last || k < k_first)
+                    continue;
+                float x = (k == 0) ? p_in[t] : y[k-1];
+                float yk = c[k].b0 * x + w1[k];
+                w1[k] = c[k].b1 * x - c[k].a1 * yk + w2[k];
+                w2[k] = c[k].b2 * x - c[k].a2 * yk;
+                y[k] = yk;
+            }
+        }
+
+        //Same step with every stage active, unrolled through the template so that all
+        //indices are constants and the states can be kept in registers
+        template <int K, int N>
+        struct SOSChainFullStep
+        {
+            static inline void Run(const t_dafx_sos<N> &c, float *w1, float *w2, float *y, float x_in)
+            {
+                float x = (K == 0) ? x_in : y[K == 0 ? 0 : K-1];
+                float yk = c[K].b0 * x + w1[K];
+                w1[K] = c[K].b1 * x - c[K].a1 * yk + w2[K];
+                w2[K] = c[K].b2 * x - c[K].a2 * yk;
+                y[K] = yk;
+                SOSChainFullStep<K-1, N>::Run(c, w1, w2, y, x_in);
+            }
+        };
+
+        template <int N>
+        struct SOSChainFullStep<-1, N>
+        {
+            static inline void Run(const t_dafx_sos<N> &, float *, float *, float *, float) {}
+        };
+
+        //Runs a block through the chain as a pipeline across the stages (same scheme as
+        //t_DAFX_SOSCascade, in scalar registers): the N stage updates of one step are
+        //independent, so they overlap instead of waiting on each other. The pipeline is
+        //filled and drained inside the call, no latency is added.
+        template <int N>
+        inline void SOSChainBlock(const t_dafx_sos<N> &c, float *w1, float *w2, const float *p_in, float *p_out, int n)
+        {
+            if (N == 1 || n < N) {
+                for (int i = 0; i < n; i++) {
+                    p_out[i] = SOSChainStep<N>(c, w1, w2, p_in[i]);
+                }
+                return;
+            }
+
+            float y[N] = {};
+            int t;
+
+            //fill
+            for (t = 0; t < N - 1; t++) {
+                SOSChainPipelineStep<N>(c, w1, w2, y, p_in, t, 0, t);
+            }
+
+            //steady state: every stage busy
+            for (t = N - 1; t < n; t++) {
+                SOSChainFullStep<N - 1, N>::Run(c, w1, w2, y, p_in[t]);
+                p_out[t - (N - 1)] = y[N - 1];
+            }
+
+            //drain
+            for (t = n; t < n + N - 1; t++) {
+                SOSChainPipelineStep<N>(c, w1, w2, y, p_in, t, t - n + 1, N - 1);
+                p_out[t - (N - 1)] = y[N - 1];
+            }
+        }
+    }
+
+
+    //Runtime coefficients, compile-time stage count
+    template <int N>
+    class SOSChain
+    {
+    public:
+
+        static_assert(N > 0, "SOSChain needs at least one stage");
+
+        explicit SOSChain(const t_dafx_sos<N> &coeffs) : m_coeffs(coeffs)
+        {
+            Reset();
+        }
+
+        void SetCoeffs(const t_dafx_sos<N> &coeffs)
+        {
+            m_coeffs = coeffs;
+        }
+
+        void Reset()
+        {
+            for (int k = 0; k < N; k++) {
+                m_w1[k] = 0.0f;
+                m_w2[k] = 0.0f;
+            }
+        }
+
+        float ProcessSingleSample(float x)
+        {
+            return detail::SOSChainStep<N>(m_coeffs, m_w1, m_w2, x);
+        }
+
+        //p_in and p_out may point to the same buffer
+        void ProcessBlock(const float *p_in, float *p_out, int n)
+        {
+            //local copies: nothing the output writes could alias, so all of it stays in registers
+            const t_dafx_sos<N> c = m_coeffs;
+            float w1[N], w2[N];
+            for (int k = 0; k < N; k++) {
+                w1[k] = m_w1[k];
+                w2[k] = m_w2[k];
+            }
+
+            detail::SOSChainBlock<N>(c, w1, w2, p_in, p_out, n);
+
+            for (int k = 0; k < N; k++) {
+                m_w1[k] = w1[k];
+                m_w2[k] = w2[k];
+            }
+        }
+
+    private:
+
+        t_dafx_sos<N> m_coeffs;
+        float m_w1[N];
+        float m_w2[N];
+    };
+
+
+    //Compile-time coefficients: Design::Coeffs() has to be a constexpr function returning
+    //t_dafx_sos<N>, e.g. one of dafx::presets
+    template <class Design>
+    class FixedSOSChain
+    {
+    public:
+
+        static constexpr int N = decltype(Design::Coeffs())::kNumStages;
+
+        FixedSOSChain()
+        {
+            Reset();
+        }
+
+        void Reset()
+        {
+            for (int k = 0; k < N; k++) {
+                m_w1[k] = 0.0f;
+                m_w2[k] = 0.0f;
+            }
+        }
+
+        float ProcessSingleSample(float x)
+        {
+            constexpr t_dafx_sos<N> c = Design::Coeffs();
+            return detail::SOSChainStep<N>(c, m_w1, m_w2, x);
+        }
+
+        void ProcessBlock(const float *p_in, float *p_out, int n)
+        {
+            constexpr t_dafx_sos<N> c = Design::Coeffs();
+            float w1[N], w2[N];
+            for (int k = 0; k < N; k++) {
+                w1[k] = m_w1[k];
+                w2[k] = m_w2[k];
+            }
+
+            detail::SOSChainBlock<N>(c, w1, w2, p_in, p_out, n);
+
+            for (int k = 0; k < N; k++) {
+                m_w1[k] = w1[k];
+                m_w2[k] = w2[k];
+            }
+        }
+
+    private:
+
+        float m_w1[N];
+        float m_w2[N];
+    };
+
+}
+
+
+#endif /* DAFX_SOSChain_hpp */
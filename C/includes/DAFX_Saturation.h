@@ -0,0 +1,262 @@
+//
+//  DAFX_Saturation.h
+//
+
+
+#ifndef DAFX_Saturation_h
+#define DAFX_Saturation_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_SIMD.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * tanh approximations, from the most accurate to the cheapest.
+     * Max errors are absolute, against double precision tanh, over all inputs.
+     * None of them leaves [-1, 1], and they are monotonic up to float rounding
+     */
+    typedef enum
+    {
+        SAT_TANH_LIBM = 0,      //libm tanhf, one sample at a time (reference)
+        SAT_TANH_EXP,           //(1 - e^-2x) / (1 + e^-2x) with a polynomial 2^x, max error 1.5e-7
+        SAT_TANH_PADE,          //[7/6] Pade approximant, input clamped at 4.76, max error 7.9e-5
+        SAT_TANH_POLY,          //odd 11th order polynomial, input clamped at its maximum (2.947), max error 3.6e-3
+        Saturation_N_TANH_TIERS,
+    }t_sat_tanh_tier;
+
+    //shaping functions, the tanh one uses the SAT_TANH_EXP approximation
+    typedef enum
+    {
+        SAT_SHAPE_TANH = 0,
+        SAT_SHAPE_SINE,
+        SAT_SHAPE_EXP,
+        Saturation_N_SHAPES,
+    }t_sat_shape;
+
+    /*
+     * Antiderivative anti-aliasing. Instead of the shaper itself, the output is the divided
+     * difference of its 1st / 2nd antiderivative over the last 2 / 3 inputs, which low-passes
+     * the aliases of the shaper's harmonics. Costs half a sample / one sample of latency
+     * and a slight high-frequency roll-off
+     */
+    typedef enum
+    {
+        SAT_ADAA_OFF = 0,
+        SAT_ADAA_FIRST_ORDER,
+        SAT_ADAA_SECOND_ORDER,
+        Saturation_N_ADAA_ORDERS,
+    }t_sat_adaa_order;
+
+    //input history and scratch buffers of an ADAA shaper
+    typedef struct{
+
+        int block_size;     //largest block processed, set before init
+
+        //shaper arguments of the block, led by the last 2 of the previous block
+        float *p_u;
+        //1st antiderivative and 2nd antiderivative terms at the same points
+        float *p_r;
+        float *p_q;
+        //mean of the 1st antiderivative term between consecutive points
+        float *p_s;
+
+    }t_DAFXSaturationADAA;
+
+    //size limits of a transfer curve table
+    #define SAT_TABLE_MIN_NUMOF_POINTS  2
+    #define SAT_TABLE_MAX_NUMOF_POINTS  65536
+
+    //interpolation between the points of a transfer curve table
+    typedef enum
+    {
+        SAT_TABLE_LINEAR = 0,       //straight segments, 2 floats per segment
+        SAT_TABLE_CUBIC,            //Catmull-Rom tangents limited so the curve does not overshoot the points
+        Saturation_N_TABLE_INTERPS,
+    }t_sat_table_interp;
+
+    /*
+     * Transfer curve given as a table, e.g. measured on a pedal.
+     *
+     * The points are spread evenly over [x_min, x_max], so finding the segment of an
+     * input is a multiply and a truncation, and the cost of a sample does not depend on
+     * the number of points. Every segment is stored as the coefficients of its own
+     * polynomial, one cache line fetch per sample and lane. Inputs beyond the range
+     * hold the end values.
+     * The object is read-only once initialized, so one table can be used by any number
+     * of shaper instances.
+     */
+    typedef struct{
+
+        //input range covered by the points
+        float x_min;
+        float x_max;
+
+        int n_points;
+
+        //segments per input unit: (n_points - 1) / (x_max - x_min)
+        float scale;
+
+        //per segment: {y0, y1 - y0}
+        float *p_linear;
+
+        //per segment: {c0, c1, c2, c3} of c0 + c1 t + c2 t^2 + c3 t^3, t in [0, 1], one aligned 16 byte row each
+        float *p_cubic;
+
+    }t_DAFXSaturationTable;
+
+
+    /*!
+     * @brief post_gain * tanh(pre_gain * x) over a block
+     * p_in and p_out may point to the same buffer
+     *
+     * @param approximation to use
+     * @param input samples
+     * @param output samples
+     * @param number of samples
+     * @param gain applied before the tanh
+     * @param gain applied after the tanh
+     * @return process status
+     */
+    bool SAT_TanhBlock(t_sat_tanh_tier tier, float *p_in, float *p_out, int n, float pre_gain, float post_gain);
+
+    /*!
+     * @brief post_gain * sin(pi/2 * u), u = pre_gain * x clipped to [-1, 1]
+     * (hard clipping with a sine knee, max error 2e-7)
+     *
+     * @param input samples
+     * @param output samples
+     * @param number of samples
+     * @param gain applied before the shaper (1 / clipping threshold)
+     * @param gain applied after the shaper
+     * @return process status
+     */
+    bool SAT_SineClipBlock(float *p_in, float *p_out, int n, float pre_gain, float post_gain);
+
+    /*!
+     * @brief post_gain * sign(u) * (1 - e^-|u|), u = pre_gain * x
+     * (exponential soft clipping, max error 1.5e-7)
+     *
+     * @param input samples
+     * @param output samples
+     * @param number of samples
+     * @param gain applied before the shaper (slope at zero)
+     * @param gain applied after the shaper
+     * @return process status
+     */
+    bool SAT_ExpClipBlock(float *p_in, float *p_out, int n, float pre_gain, float post_gain);
+
+    /*!
+     * @brief Init an ADAA shaper and allocate its buffers
+     *
+     * @param pointer on a SaturationADAA structure
+     * @return process status
+     */
+    bool InitDAFXSaturationADAA(t_DAFXSaturationADAA *pADAA);
+
+    /*!
+     * @brief Forget the input history, as if the input had been silent
+     *
+     * @param pointer on a SaturationADAA structure
+     * @return process status
+     */
+    bool SAT_ResetADAA(t_DAFXSaturationADAA *pADAA);
+
+    /*!
+     * @brief post_gain * shaper(pre_gain * x) over a block, antialiased.
+     * The input history carries over from the previous block (in shaper units, so gain
+     * changes stay smooth). p_in and p_out may point to the same buffer
+     *
+     * @param pointer on a SaturationADAA structure
+     * @param shaping function
+     * @param ADAA order (SAT_ADAA_OFF runs the plain shaper)
+     * @param input samples
+     * @param output samples
+     * @param number of samples, at most block_size
+     * @param gain applied before the shaper
+     * @param gain applied after the shaper
+     * @return process status
+     */
+    bool SAT_ADAABlock(t_DAFXSaturationADAA *pADAA, t_sat_shape shape, t_sat_adaa_order order,
+                       float *p_in, float *p_out, int n, float pre_gain, float post_gain);
+
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on a SaturationADAA structure
+     * @return void
+     */
+    void DeallocDAFXSaturationADAA(t_DAFXSaturationADAA *pADAA);
+
+    /*!
+     * @brief Init a transfer curve table from points spread evenly over [x_min, x_max]
+     * and allocate memory. Allocates - not to be called from the audio thread
+     *
+     * @param pointer on a SaturationTable structure
+     * @param output values of the points
+     * @param number of points, SAT_TABLE_MIN_NUMOF_POINTS to SAT_TABLE_MAX_NUMOF_POINTS
+     * @param input value of the first point
+     * @param input value of the last point, above x_min
+     * @return false (and nothing allocated) if the points or the range are not valid
+     */
+    bool InitDAFXSaturationTable(t_DAFXSaturationTable *pTable, float *p_y, int n_points, float x_min, float x_max);
+
+    /*!
+     * @brief Init a transfer curve table from a text file.
+     * Numbers are separated by white space, commas or semicolons, '#' starts a comment.
+     * One number per line: output values over [-1, 1].
+     * Two numbers per line: (input, output) pairs with increasing inputs, resampled to
+     * as many evenly spread points.
+     * Allocates - not to be called from the audio thread
+     *
+     * @param pointer on a SaturationTable structure
+     * @param path of the file
+     * @return false (and nothing allocated) if the file cannot be read or is not a valid curve
+     */
+    bool InitDAFXSaturationTableFile(t_DAFXSaturationTable *pTable, const char *p_path);
+
+    /*!
+     * @brief post_gain * curve(pre_gain * x) over a block
+     * p_in and p_out may point to the same buffer
+     *
+     * @param pointer on an initialized SaturationTable structure
+     * @param interpolation between the points
+     * @param input samples
+     * @param output samples
+     * @param number of samples
+     * @param gain applied before the curve
+     * @param gain applied after the curve
+     * @return process status
+     */
+    bool SAT_TableBlock(const t_DAFXSaturationTable *pTable, t_sat_table_interp interp,
+                        float *p_in, float *p_out, int n, float pre_gain, float post_gain);
+
+    /*!
+     * Deallocates allocated memory for the table
+     *
+     * @param pointer on a SaturationTable structure
+     * @return void
+     */
+    void DeallocDAFXSaturationTable(t_DAFXSaturationTable *pTable);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_Saturation_h */
@@ -0,0 +1,137 @@
+//
+//  DAFX_StateVariableFilter.h
+//
+
+
+#ifndef DAFX_StateVariableFilter_h
+#define DAFX_StateVariableFilter_h
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include "DAFX_definitions.h"
+#else
+#include <libkern/OSAtomic.h>
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include "DAFX_Denormal.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+    /*
+     * Zero-delay-feedback state variable filter (topology preserving transform
+     * of the analog SVF). One pass produces the lowpass, bandpass, highpass and
+     * notch outputs. The cutoff enters only through g = tan(pi * fc / fs),
+     * which is read from a table shared by all instances, so moving the
+     * cutoff costs a table lookup and one division instead of a full biquad
+     * redesign. The trapezoidal integrator states stay well behaved when the
+     * cutoff jumps from one sample to the next, so fast sweeps are stable.
+     */
+    typedef struct{
+        
+        //wrapper, general
+        int block_size;
+        int fs;
+        float *p_input_block;
+        
+        //simultaneous outputs
+        float *p_lp_block;
+        float *p_bp_block;
+        float *p_hp_block;
+        float *p_notch_block;
+        
+        //per-sample cutoff in Hz, used by DAFXProcessStateVariableFilterModulated
+        float *p_cutoff_block;
+        
+        //scratch of the modulated kernel: per-sample coeffs derived from g
+        float *p_a1_block;
+        float *p_a2_block;
+        float *p_a3_block;
+        
+        //params
+        float fc;
+        float q;
+        
+        //derived: k = 1/Q, g = tan(pi * fc / fs)
+        float k;
+        float g;
+        
+        //integrator states
+        float ic1eq;
+        float ic2eq;
+        
+        //subnormals seen in the integrator states, checked after every block
+        t_dafx_denormal_stats denormal_stats;
+        
+    }t_DAFXStateVariableFilter;
+    
+    
+    /*!
+     * @brief Init StateVariableFilter struct and allocate memory
+     * block_size and fs have to be set before calling this
+     *
+     * @param pointer on a StateVariableFilter structure
+     * @return process status
+     */
+    bool InitDAFXStateVariableFilter(t_DAFXStateVariableFilter *pSVF);
+    
+    /*!
+     * @brief Filter p_input_block with the current (fixed) cutoff
+     *
+     * @param pointer on StateVariableFilter structure
+     * @return process status
+     */
+    bool DAFXProcessStateVariableFilter(t_DAFXStateVariableFilter *pSVF);
+    
+    /*!
+     * @brief Filter p_input_block with a per-sample cutoff taken from p_cutoff_block
+     * The cutoff of the last sample becomes the current cutoff
+     *
+     * @param pointer on StateVariableFilter structure
+     * @return process status
+     */
+    bool DAFXProcessStateVariableFilterModulated(t_DAFXStateVariableFilter *pSVF);
+    
+    /*!
+     * @brief Bypass StateVariableFilter of incoming signal (copied to all outputs)
+     *
+     * @param pointer on StateVariableFilter structure
+     * @return process status
+     */
+    bool DAFXBypassStateVariableFilter(t_DAFXStateVariableFilter *pSVF);
+    
+    /*!
+     * Deallocates allocated memory for the object
+     *
+     * @param pointer on StateVariableFilter structure
+     * @return void
+     */
+    void DeallocDAFXStateVariableFilter(t_DAFXStateVariableFilter *pSVF);
+    
+    /*!
+     * @brief Prewarped integrator gain tan(pi * fc / fs) from the shared table
+     *
+     * @param cutoff frequency in Hz
+     * @param sampling rate
+     * @return g
+     */
+    float SVF_LookupG(float fc, int fs);
+    
+    //Setters
+    bool SVF_SetCutoff(t_DAFXStateVariableFilter *pSVF, float fc);
+    bool SVF_SetQ(t_DAFXStateVariableFilter *pSVF, float q);
+    bool SVF_Reset(t_DAFXStateVariableFilter *pSVF);
+    
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* DAFX_StateVariableFilter_h */
@@ -20,6 +20,7 @@
 #endif
 
 #include "DAFX_LowFrequencyOscillator.h"
+#include "DAFX_ModulationBus.h"
 
 
 #ifdef __cplusplus
@@ -35,6 +36,14 @@ extern "C" {
         float *p_output_block;
         
         t_DAFXLowFrequencyOscillator *p_LFO;
+
+        //shared modulator (NULL: the LFO runs on its own), only its amp, offset and clipping are used then
+        //The audio thread reads both once per block: mod_slot is written first, p_mod_bus published last
+        t_DAFX_ModulationBus * volatile p_mod_bus;
+        volatile int mod_slot;
+        //division and phase offset of the subscription, a new LFO shape resubscribes with them
+        float mod_division;
+        float mod_phase_offset;
         
         // tremolo params
         int rate_bpm;
@@ -89,6 +98,21 @@ extern "C" {
     bool SetDepth(t_DAFXTremolo *pTREM, int depth_percent);
     bool SetSharpness(t_DAFXTremolo *pTREM, float sharpness);
     bool SetPostGain(t_DAFXTremolo *pTREM, float gain);
+    bool SetShape(t_DAFXTremolo *pTREM, t_lfo_algo_select shape);
+    
+    /*!
+     * @brief Takes the modulation from a shared bus instead of the own LFO
+     * The bus modulator replaces the LFO waveform and rate, the depth settings
+     * still apply. Changing the shape moves to the bus modulator of the new shape.
+     * NULL goes back to the own LFO. Not to be called from the audio thread
+     *
+     * @param pointer on Tremolo structure
+     * @param bus (same block size), or NULL
+     * @param length of one LFO cycle in beats
+     * @param phase offset in periods
+     * @return process status (false if the bus is full or runs another block size)
+     */
+    bool SetModulationBus(t_DAFXTremolo *pTREM, t_DAFX_ModulationBus *pBUS, float division, float phase_offset);
     
 #ifdef __cplusplus
 }
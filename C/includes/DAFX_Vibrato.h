@@ -20,6 +20,8 @@
 
 #include "DAFX_IntegerSampleDelayLine.h"
 #include "DAFX_LowFrequencyOscillator.h"
+#include "DAFX_ModulationBus.h"
+#include "DAFX_ControlRate.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +36,17 @@ extern "C" {
         
         t_DAFXIntegerSampleDelayLine *pDEL;
         t_DAFXLowFrequencyOscillator *pLFO;
+
+        //shared modulator (NULL: the LFO runs on its own), only its amp, offset and clipping are used then
+        //The audio thread reads both once per block: mod_slot is written first, p_mod_bus published last
+        t_DAFX_ModulationBus * volatile p_mod_bus;
+        volatile int mod_slot;
+        //division and phase offset of the subscription, a new LFO shape resubscribes with them
+        float mod_division;
+        float mod_phase_offset;
+        
+        //the LFO and the delay mapping run at control rate, the delay is interpolated per sample
+        t_DAFX_ControlRate *p_ctrl;
         
         // Vibrato params
         int rate_bpm;
@@ -77,6 +90,32 @@ extern "C" {
     //Setters
     bool VIB_SetRate(t_DAFXVibrato *pVIB, int rate_bpm);
     bool VIB_SetDepth(t_DAFXVibrato *pVIB, float depth);
+    bool VIB_SetShape(t_DAFXVibrato *pVIB, t_lfo_algo_select shape);
+    
+    /*!
+     * @brief sets how often the delay is recomputed from the LFO
+     *
+     * @param pointer on Vibrato structure
+     * @param samples between two control points (1: every sample, at most VIB_CTRL_MAX_PERIOD)
+     * @param interpolation of the delay in between
+     * @return process status
+     */
+    bool VIB_SetControlRate(t_DAFXVibrato *pVIB, int period, t_ctrl_interp_mode interp);
+    
+    /*!
+     * @brief Takes the modulation from a shared bus instead of the own LFO
+     * The bus modulator replaces the LFO waveform and rate, the depth settings
+     * still apply (the depth follows the tempo of the bus, checked every block).
+     * Changing the shape moves to the bus modulator of the new shape.
+     * NULL goes back to the own LFO. Not to be called from the audio thread
+     *
+     * @param pointer on Vibrato structure
+     * @param bus (same block size), or NULL
+     * @param length of one LFO cycle in beats
+     * @param phase offset in periods
+     * @return process status (false if the bus is full or runs another block size)
+     */
+    bool VIB_SetModulationBus(t_DAFXVibrato *pVIB, t_DAFX_ModulationBus *pBUS, float division, float phase_offset);
     
 #ifdef __cplusplus
 }
@@ -42,6 +42,12 @@ extern "C" {
 
     // FREE with null checking
     #define FREE(x) {if(x !=NULL) free(x);}
+
+    // Values shared between the audio and the message thread (declared volatile,
+    // which MSVC reads and writes atomically, the fence orders the store before later loads)
+    #include <emmintrin.h>
+    #define DAFX_ATOMIC_LOAD(x) (x)
+    #define DAFX_ATOMIC_STORE(x, v) {(x) = (v); _mm_mfence();}
 #else
     // MIN MAX definitions
     #define DAFX_MAX(x, y) ({x < y ? y: x;})
@@ -49,6 +55,10 @@ extern "C" {
 
     // FREE with null checking
     #define FREE(x) ({if(x !=NULL) free(x);})
+
+    // Values shared between the audio and the message thread (sequentially consistent)
+    #define DAFX_ATOMIC_LOAD(x) __atomic_load_n(&(x), __ATOMIC_SEQ_CST)
+    #define DAFX_ATOMIC_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_SEQ_CST)
 #endif
     
     
@@ -0,0 +1,33 @@
+//
+//  DAFX_InitBiquadBank.h
+//
+
+
+#ifndef DAFX_InitBiquadBank_h
+#define DAFX_InitBiquadBank_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+//max. number of independent channels in one bank
+#define BQBANK_MAX_CHANNELS         16
+
+//memory layout - every row holds one value per channel (structure of arrays)
+#define BQBANK_ROW_B0               0
+#define BQBANK_ROW_B1               1
+#define BQBANK_ROW_B2               2
+#define BQBANK_ROW_A1               3
+#define BQBANK_ROW_A2               4
+#define BQBANK_ROW_W1               5   //TDF-II state 1
+#define BQBANK_ROW_W2               6   //TDF-II state 2
+#define BQBANK_NUMOF_ROWS           7
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitBiquadBank_h */
@@ -20,6 +20,21 @@ extern "C" {
 #define BIQUAD_NUMERATOR_SIZE       3   //number of b's
 #define BIQUAD_DENOMINATOR_SIZE     3   //number of a's
 #define BIQUAD_FILTER_ORDER         2
+
+//state-space block mode: outputs computed per step
+#define BIQUAD_SS_STEP              4
+
+//state-space block mode: layout of the precomputed matrices (one column of BIQUAD_SS_STEP floats each)
+#define BIQUAD_SS_Y_W1              0                                       //w1 -> outputs
+#define BIQUAD_SS_Y_W2              (1 * BIQUAD_SS_STEP)                    //w2 -> outputs
+#define BIQUAD_SS_Y_X               (2 * BIQUAD_SS_STEP)                    //inputs -> outputs (BIQUAD_SS_STEP columns)
+#define BIQUAD_SS_S_W1              ((2 + BIQUAD_SS_STEP) * BIQUAD_SS_STEP) //w1 -> new state
+#define BIQUAD_SS_S_W2              ((3 + BIQUAD_SS_STEP) * BIQUAD_SS_STEP) //w2 -> new state
+#define BIQUAD_SS_S_X               ((4 + BIQUAD_SS_STEP) * BIQUAD_SS_STEP) //inputs -> new state (BIQUAD_SS_STEP columns)
+#define BIQUAD_SS_MATRIX_SIZE       ((4 + 2 * BIQUAD_SS_STEP) * BIQUAD_SS_STEP)
+
+//fixed-point path: coefficients in Q3.29 (range +-4), accumulator in Q60 (range +-8)
+#define BIQUAD_FX_COEFF_FRAC_BITS   29
     
 #ifdef __cplusplus
 }
@@ -0,0 +1,23 @@
+//
+//  DAFX_InitControlRate.h
+//
+
+
+#ifndef DAFX_InitControlRate_h
+#define DAFX_InitControlRate_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CTRL_INIT_PERIOD                16
+#define CTRL_INIT_INTERP                CTRL_INTERP_LINEAR
+
+//past control points kept from one block to the next (the cubic tangents need three)
+#define CTRL_NUMOF_HISTORY_POINTS       3
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitControlRate_h */
@@ -0,0 +1,39 @@
+//
+//  DAFX_InitConvolver.h
+//
+
+
+#ifndef DAFX_InitConvolver_h
+#define DAFX_InitConvolver_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "DAFX_definitions.h"
+
+//partitioning schemes
+#define CONV_PARTITION_UNIFORM          0   //every partition is one block long, no head
+#define CONV_PARTITION_NONUNIFORM       1   //direct-form head, then partitions growing up to CONV_MAX_PARTITION_SIZE
+
+#define CONV_INIT_PARTITION_MODE        CONV_PARTITION_NONUNIFORM
+
+//longest impulse response accepted (longer ones are truncated)
+#define CONV_MAX_IR_LEN                 (4 * DAFX_SAMPLE_RATE)
+
+//non-uniform layout: partition sizes double from 2 * block_size up to this size,
+//every size but the last one is used for this many partitions
+#define CONV_MAX_PARTITION_SIZE         1024
+#define CONV_PARTITIONS_PER_SIZE        4
+
+//smallest partition (FFT size 16)
+#define CONV_MIN_PARTITION_SIZE         8
+
+//upper bound of distinct partition sizes: log2(CONV_MAX_PARTITION_SIZE / CONV_MIN_PARTITION_SIZE) + 1
+#define CONV_MAX_NUMOF_SEGMENTS         8
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitConvolver_h */
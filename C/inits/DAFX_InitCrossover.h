@@ -18,6 +18,8 @@ extern "C" {
     
 //number of cascaded biquads
 #define XOVER_INIT_NUMOF_BIQUADS       2
+//cascades are allocated for this many biquads, the order setter stays within it
+#define XOVER_MAX_NUMOF_BIQUADS        8
     
 //number of channels (split signals)
 #define XOVER_INIT_NUMOF_CHANNELS      2
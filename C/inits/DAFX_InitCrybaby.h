@@ -51,7 +51,25 @@ extern "C" {
 #define CB_PEDAL_MAX    0.99f
 #define CB_PEDAL_MIN    0.01f
     
+// Slight gain adjustment of the pedal position to match analog curves
+#define CB_PEDAL_GAIN_TILT  -0.15f
+    
+// Points of the (a1, a2) table over the pedal range, interpolated linearly
+#define CB_PEDAL_TABLE_SIZE 1024
+    
 #define CB_INIT_WAH_BALANCE  0.75f
+    
+// Auto-wah coefficient update method
+#define CB_INIT_COEFF_UPDATE_MODE   CB_COEFF_UPDATE_CONTROL_RATE
+    
+// Auto-wah control rate: the sweep is slow next to 32 samples, the coeff ramps hide the steps
+#define CB_CTRL_MAX_PERIOD          32
+#define CB_INIT_CTRL_PERIOD         16
+    
+// Auto-wah modulation source, envelope follower: pedal positions at silence and full scale
+#define CB_INIT_MOD_SOURCE          CB_MOD_SOURCE_LFO
+#define CB_INIT_ENV_PEDAL_LO        0.1f
+#define CB_INIT_ENV_PEDAL_HI        0.9f
 
     
 #ifdef __cplusplus
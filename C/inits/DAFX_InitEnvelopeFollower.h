@@ -0,0 +1,32 @@
+//
+//  DAFX_InitEnvelopeFollower.h
+//
+
+
+#ifndef DAFX_InitEnvelopeFollower_h
+#define DAFX_InitEnvelopeFollower_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ENV_INIT_DETECTOR               ENV_DETECT_PEAK
+#define ENV_INIT_ATTACK_MS              5.0
+#define ENV_INIT_RELEASE_MS             150.0
+#define ENV_INIT_SENSITIVITY_DB         12.0    //envelope gain before the range mapping
+#define ENV_INIT_RANGE_LO               0.0     //output at silence
+#define ENV_INIT_RANGE_HI               1.0     //output at full scale (after sensitivity)
+
+//averaging time of the RMS detector, before the attack / release
+#define ENV_RMS_WINDOW_MS               10.0
+
+#define ENV_MIN_TIME_MS                 0.1
+#define ENV_MAX_TIME_MS                 5000.0
+#define ENV_MIN_SENSITIVITY_DB          -24.0
+#define ENV_MAX_SENSITIVITY_DB          48.0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitEnvelopeFollower_h */
@@ -0,0 +1,34 @@
+//
+//  DAFX_InitFrequencyResponse.h
+//
+
+
+#ifndef DAFX_InitFrequencyResponse_h
+#define DAFX_InitFrequencyResponse_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+#include "DAFX_definitions.h"
+    
+//size of the log-spaced frequency grid
+#define FR_MIN_NUM_POINTS           512
+#define FR_MAX_NUM_POINTS           4096
+#define FR_INIT_NUM_POINTS          FR_MIN_NUM_POINTS
+    
+//default grid limits (Hz) - the upper one is bounded by fs/2
+#define FR_INIT_F_MIN               20.0
+#define FR_INIT_F_MAX               20000.0
+    
+//largest number of biquads evaluated at once
+#define FR_MAX_STAGES               32
+    
+//floor of the magnitude (dB), avoids log(0) at the zeros of the response
+#define FR_MIN_MAGNITUDE_DB         -200.0
+    
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitFrequencyResponse_h */
@@ -18,10 +18,31 @@ extern "C" {
 #define LFO_INIT_DEFAULT_CLIP_H     1.0
 #define LFO_INIT_DEFAULT_CLIP_L     -1.0
 #define LFO_INIT_DEFAULT_BALANCE    0.5  
+#define LFO_INIT_PROCESS_MODE       LFO_PROCESS_BLOCK
+#define LFO_INIT_DEFAULT_SLEW       0.1
     
 #define LFO_MAX_BALANCE             0.95
 #define LFO_MIN_BALANCE             0.05
     
+//recursive mode: the float recursions are put back on the exact phase every so many samples
+//(one sin/cos in double, the error built up in between stays below 1e-5)
+#define LFO_RECURSIVE_RESYNC_PERIOD 1024
+    
+#define LFO_MAX_SLEW                1.0
+#define LFO_MIN_SLEW                0.001
+
+//wavetable shapes: 2^LFO_TABLE_BITS points per period, one table per shape for the whole process
+#define LFO_TABLE_BITS              10
+#define LFO_TABLE_SIZE              (1 << LFO_TABLE_BITS)
+#define LFO_NUMOF_USER_TABLES       8
+#define LFO_SH_STEPS_PER_PERIOD     16      //sample-and-hold: random levels per period
+#define LFO_SH_SEED                 12345   //so that every instance (and every run) gets the same levels
+#define LFO_EXP_CURVATURE           4.0     //exponential ramps follow exp(LFO_EXP_CURVATURE * phase)
+
+//fixed-point path: the sine is read from a table of 2^LFO_FX_SINE_TABLE_BITS points per period
+#define LFO_FX_SINE_TABLE_BITS      10
+#define LFO_FX_SINE_TABLE_SIZE      (1 << LFO_FX_SINE_TABLE_BITS)
+    
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,29 @@
+//
+//  DAFX_InitModulationBus.h
+//
+
+
+#ifndef DAFX_InitModulationBus_h
+#define DAFX_InitModulationBus_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODBUS_INIT_DEFAULT_BPM         120.0
+    
+//largest number of distinct modulators (shape, division, phase offset) on one bus
+#define MODBUS_MAX_NUMOF_SLOTS          16
+
+//tempo range accepted by MODBUS_SetTempo
+#define MODBUS_MIN_BPM                  1.0
+#define MODBUS_MAX_BPM                  999.0
+
+//shortest cycle, in beats (1/64 note at one beat per quarter note)
+#define MODBUS_MIN_DIVISION             0.0625
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitModulationBus_h */
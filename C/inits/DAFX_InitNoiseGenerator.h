@@ -0,0 +1,28 @@
+//
+//  DAFX_InitNoiseGenerator.h
+//
+
+
+#ifndef DAFX_InitNoiseGenerator_h
+#define DAFX_InitNoiseGenerator_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NOISE_INIT_DEFAULT_FREQ_HZ      4.0     //steps per second (random walk, sample-and-hold)
+#define NOISE_INIT_DEFAULT_AMP          1.0
+#define NOISE_INIT_DEFAULT_OFFSET       0.0
+#define NOISE_INIT_DEFAULT_CLIP_H       1.0
+#define NOISE_INIT_DEFAULT_CLIP_L       -1.0
+#define NOISE_INIT_DEFAULT_SEED         1
+#define NOISE_INIT_DEFAULT_WALK_STEP    0.5     //largest move of the random walk per step
+
+#define NOISE_MAX_WALK_STEP             1.0
+#define NOISE_MIN_WALK_STEP             0.0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitNoiseGenerator_h */
@@ -12,12 +12,19 @@ extern "C" {
 #endif
     
 #include "DAFX_definitions.h"
+#include "DAFX_Saturation.h"
+#include "DAFX_InitOversampler.h"
     
 #define OD_INIT_DEFAULT_IN_GAIN        1.0
 #define OD_INIT_DEFAULT_OUT_GAIN       0.75
 #define OD_INIT_DEFAULT_THRESHOLD      0.66
 #define OD_INIT_DEFAULT_TAN_PARAM      5.0
 #define OD_INIT_DEFAULT_EXP_PARAM      2.0
+#define OD_INIT_DEFAULT_TANH_TIER      SAT_TANH_EXP
+#define OD_INIT_DEFAULT_ADAA_ORDER     SAT_ADAA_OFF
+#define OD_INIT_DEFAULT_OS_FACTOR      1
+#define OD_INIT_DEFAULT_OS_FILTER      OS_FILTER_LINEAR_PHASE
+#define OD_INIT_DEFAULT_TABLE_INTERP   SAT_TABLE_CUBIC
     
 #define OD_INIT_THRESH_MIN             0.01
 #define OD_INIT_THRESH_MAX             1.0
@@ -0,0 +1,37 @@
+//
+//  DAFX_InitOversampler.h
+//
+
+
+#ifndef DAFX_InitOversampler_h
+#define DAFX_InitOversampler_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "DAFX_definitions.h"
+
+//halfband filter families
+#define OS_FILTER_LINEAR_PHASE          0   //FIR halfbands, constant latency
+#define OS_FILTER_MINIMUM_PHASE         1   //polyphase allpass (IIR) halfbands, low latency, phase shift near fs/2
+
+#define OS_INIT_DEFAULT_FACTOR          1
+#define OS_INIT_DEFAULT_FILTER          OS_FILTER_LINEAR_PHASE
+
+//one 2x stage per octave, up to 8x
+#define OS_MAX_NUMOF_STAGES             3
+#define OS_MAX_FACTOR                   (1 << OS_MAX_NUMOF_STAGES)
+
+//allpass coefficients of the longest IIR halfband (both paths)
+#define OS_IIR_MAX_NUMOF_COEFS          8
+
+//IIR states of one direction: the last input of both paths, the last output of every
+//allpass section and the odd input sample the downsampler carries over
+#define OS_IIR_NUMOF_STATES             (OS_IIR_MAX_NUMOF_COEFS + 3)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitOversampler_h */
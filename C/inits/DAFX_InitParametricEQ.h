@@ -0,0 +1,38 @@
+//
+//  DAFX_InitParametricEQ.h
+//
+
+
+#ifndef DAFX_InitParametricEQ_h
+#define DAFX_InitParametricEQ_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+#include "DAFX_definitions.h"
+    
+//number of bands
+#define PEQ_INIT_NUMOF_BANDS        5
+#define PEQ_MAX_NUMOF_BANDS         16
+    
+//initial band setup: peaking filters at 0 dB, log-spaced between these two frequencies
+#define PEQ_INIT_BAND_TYPE          PEQ_BAND_PEAKING
+#define PEQ_INIT_F_LOW_HZ           80.0
+#define PEQ_INIT_F_HIGH_HZ          6000.0
+#define PEQ_INIT_GAIN_DB            0.0
+#define PEQ_INIT_Q                  1.0
+    
+//parameter limits
+#define PEQ_MIN_FREQ_HZ             10.0
+#define PEQ_MAX_FREQ_RATIO          0.49    //fraction of fs
+#define PEQ_MIN_GAIN_DB             -48.0
+#define PEQ_MAX_GAIN_DB             48.0
+#define PEQ_MIN_Q                   0.05
+#define PEQ_MAX_Q                   50.0
+    
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitParametricEQ_h */
@@ -0,0 +1,39 @@
+//
+//  DAFX_InitSOSCascade.h
+//
+
+
+#ifndef DAFX_InitSOSCascade_h
+#define DAFX_InitSOSCascade_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+//number of stages processed side by side (one stage per vector lane)
+#define SOS_STAGES_PER_GROUP        DAFX_SIMD_LANES
+
+//memory layout of one group of stages - every row is one vector (one value per stage)
+#define SOS_ROW_B0                  0
+#define SOS_ROW_B1                  1
+#define SOS_ROW_B2                  2
+#define SOS_ROW_A1                  3
+#define SOS_ROW_A2                  4
+#define SOS_ROW_W1                  5   //TDF-II state 1
+#define SOS_ROW_W2                  6   //TDF-II state 2
+#define SOS_ROW_Y                   7   //last output of each stage (feeds the next lane)
+#define SOS_NUMOF_ROWS              8
+
+#define SOS_GROUP_SIZE              (SOS_NUMOF_ROWS * SOS_STAGES_PER_GROUP)
+
+//coefficient ramping: per-sample coefficients are generated in chunks of this many samples
+#define SOS_RAMP_CHUNK              64
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitSOSCascade_h */
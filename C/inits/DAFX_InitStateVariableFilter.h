@@ -0,0 +1,32 @@
+//
+//  DAFX_InitStateVariableFilter.h
+//
+
+
+#ifndef DAFX_InitStateVariableFilter_h
+#define DAFX_InitStateVariableFilter_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+#include "DAFX_definitions.h"
+    
+#define SVF_INIT_DEFAULT_CUTOFF_HZ      1000.0f
+#define SVF_INIT_DEFAULT_Q              0.7071068f
+    
+#define SVF_MIN_Q                       0.1f
+#define SVF_MAX_Q                       50.0f
+    
+//cutoff limits (Hz and as a fraction of the sampling rate)
+#define SVF_MIN_CUTOFF_HZ               10.0f
+#define SVF_MAX_CUTOFF_RATIO            0.49f
+    
+//number of points of the tan() prewarping table over 0 .. fs/2 (plus the guard point)
+#define SVF_TAN_TABLE_SIZE              4096
+    
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAFX_InitStateVariableFilter_h */
@@ -15,6 +15,12 @@ extern "C" {
     
 #define VIB_INIT_DEFAULT_RATE_BPM              60
 #define VIB_INIT_DEFAULT_DEPTH                 5.0
+    
+//control rate of the delay modulation: at a few Hz, linear interpolation over 32 samples
+//stays within a hundredth of a sample of the exact delay
+#define VIB_CTRL_MAX_PERIOD                    32
+#define VIB_INIT_CTRL_PERIOD                   16
+#define VIB_INIT_CTRL_INTERP                   CTRL_INTERP_LINEAR
 
     
 #ifdef __cplusplus
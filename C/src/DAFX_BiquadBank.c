@@ -0,0 +1,268 @@
+//
+//  DAFX_BiquadBank.c
+//
+
+#include "DAFX_BiquadBank.h"
+#include "DAFX_InitBiquadBank.h"
+
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#define V   DAFX_SIMD_LANES
+
+
+//coeffs and states of DAFX_SIMD_LANES neighbouring channels, held in registers while processing
+typedef struct{
+    t_dafx_v4f b0, b1, b2, a1, a2;
+    t_dafx_v4f w1, w2;
+}t_bqbank_lanes;
+
+static inline void _LoadLanes(t_DAFX_BiquadBank *pBANK, int c0, t_bqbank_lanes *l)
+{
+    float *m = pBANK->p_memory + c0;
+    int stride = pBANK->num_lanes;
+
+    l->b0 = dafx_v4f_load(m + BQBANK_ROW_B0 * stride);
+    l->b1 = dafx_v4f_load(m + BQBANK_ROW_B1 * stride);
+    l->b2 = dafx_v4f_load(m + BQBANK_ROW_B2 * stride);
+    l->a1 = dafx_v4f_load(m + BQBANK_ROW_A1 * stride);
+    l->a2 = dafx_v4f_load(m + BQBANK_ROW_A2 * stride);
+    l->w1 = dafx_v4f_load(m + BQBANK_ROW_W1 * stride);
+    l->w2 = dafx_v4f_load(m + BQBANK_ROW_W2 * stride);
+}
+
+static inline void _StoreLaneStates(t_DAFX_BiquadBank *pBANK, int c0, t_bqbank_lanes *l)
+{
+    float *m = pBANK->p_memory + c0;
+    int stride = pBANK->num_lanes;
+
+    dafx_v4f_store(m + BQBANK_ROW_W1 * stride, l->w1);
+    dafx_v4f_store(m + BQBANK_ROW_W2 * stride, l->w2);
+}
+
+//one TDF-II step for all the lanes
+static inline t_dafx_v4f _LanesStep(t_bqbank_lanes *l, t_dafx_v4f x)
+{
+    t_dafx_v4f y = dafx_v4f_madd(l->b0, x, l->w1);
+    l->w1 = dafx_v4f_add(dafx_v4f_sub(dafx_v4f_mul(l->b1, x), dafx_v4f_mul(l->a1, y)), l->w2);
+    l->w2 = dafx_v4f_sub(dafx_v4f_mul(l->b2, x), dafx_v4f_mul(l->a2, y));
+    return y;
+}
+
+//sample by sample gather/scatter - partial lane groups and block tails
+static void _ProcessLanesGather(t_bqbank_lanes *l, float **pp_in, float **pp_out, int active, int i0, int n)
+{
+    float tmp[V];
+
+    for (int i = i0; i < n; i++)
+    {
+        for (int k = 0; k < V; k++) {
+            tmp[k] = (k < active) ? pp_in[k][i] : 0.0f;
+        }
+        dafx_v4f_storeu(tmp, _LanesStep(l, dafx_v4f_loadu(tmp)));
+        for (int k = 0; k < active; k++) {
+            pp_out[k][i] = tmp[k];
+        }
+    }
+}
+
+bool InitBiquadBank(t_DAFX_BiquadBank *pBANK)
+{
+    pBANK->num_channels = DAFX_MAX(DAFX_MIN(pBANK->num_channels, BQBANK_MAX_CHANNELS), 1);
+    pBANK->num_lanes = ((pBANK->num_channels + V - 1) / V) * V;
+
+    pBANK->p_memory = (float *) DAFX_AlignedCalloc(BQBANK_NUMOF_ROWS * pBANK->num_lanes, sizeof(float));
+    if (pBANK->p_memory == NULL)
+        return false;
+
+    //Initializing to pass-through filters
+    for (int c = 0; c < pBANK->num_lanes; c++) {
+        pBANK->p_memory[BQBANK_ROW_B0 * pBANK->num_lanes + c] = 1.0;
+    }
+
+    DAFX_DenormalResetStats(&pBANK->denormal_stats);
+
+    return true;
+}
+
+bool SetBiquadBankChannelCoeffs(t_DAFX_BiquadBank *pBANK, int ch, float *p_coeffs)
+{
+    if (ch < 0 || ch >= pBANK->num_channels)
+        return false;
+
+    float *m = pBANK->p_memory + ch;
+    int stride = pBANK->num_lanes;
+
+    //expected coeff order: b0, b1, b2, a0, a1, a2
+    float ax = 1.0 / p_coeffs[3];
+
+    m[BQBANK_ROW_B0 * stride] = p_coeffs[0] * ax;
+    m[BQBANK_ROW_B1 * stride] = p_coeffs[1] * ax;
+    m[BQBANK_ROW_B2 * stride] = p_coeffs[2] * ax;
+    m[BQBANK_ROW_A1 * stride] = p_coeffs[4] * ax;
+    m[BQBANK_ROW_A2 * stride] = p_coeffs[5] * ax;
+
+    return true;
+}
+
+static void _ProcessBlockPlanar(t_DAFX_BiquadBank *pBANK, float **pp_in, float **pp_out, int n)
+{
+    t_bqbank_lanes l;
+    t_dafx_v4f r[V];
+
+    for (int c0 = 0; c0 < pBANK->num_channels; c0 += V)
+    {
+        int active = DAFX_MIN(V, pBANK->num_channels - c0);
+        float **pp_i = pp_in + c0;
+        float **pp_o = pp_out + c0;
+        int i = 0;
+
+        _LoadLanes(pBANK, c0, &l);
+
+        if (active == V)
+        {
+            //V samples of V channels at a time: transpose to one vector per sample,
+            //run the recursion, transpose back to one vector per channel
+            for (; i + V <= n; i += V)
+            {
+                for (int k = 0; k < V; k++) {
+                    r[k] = dafx_v4f_loadu(pp_i[k] + i);
+                }
+                dafx_v4f_transpose(r);
+                for (int k = 0; k < V; k++) {
+                    r[k] = _LanesStep(&l, r[k]);
+                }
+                dafx_v4f_transpose(r);
+                for (int k = 0; k < V; k++) {
+                    dafx_v4f_storeu(pp_o[k] + i, r[k]);
+                }
+            }
+        }
+
+        _ProcessLanesGather(&l, pp_i, pp_o, active, i, n);
+
+        _StoreLaneStates(pBANK, c0, &l);
+    }
+}
+
+static void _ProcessBlockInterleaved(t_DAFX_BiquadBank *pBANK, float *p_in, float *p_out, int n)
+{
+    int nc = pBANK->num_channels;
+    int c0 = 0;
+
+#if defined(__AVX__)
+    //8 channels per instruction
+    if (nc % 8 == 0)
+    {
+        int stride = pBANK->num_lanes;
+
+        for (; c0 < nc; c0 += 8)
+        {
+            float *m = pBANK->p_memory + c0;
+            __m256 b0 = _mm256_loadu_ps(m + BQBANK_ROW_B0 * stride);
+            __m256 b1 = _mm256_loadu_ps(m + BQBANK_ROW_B1 * stride);
+            __m256 b2 = _mm256_loadu_ps(m + BQBANK_ROW_B2 * stride);
+            __m256 a1 = _mm256_loadu_ps(m + BQBANK_ROW_A1 * stride);
+            __m256 a2 = _mm256_loadu_ps(m + BQBANK_ROW_A2 * stride);
+            __m256 w1 = _mm256_loadu_ps(m + BQBANK_ROW_W1 * stride);
+            __m256 w2 = _mm256_loadu_ps(m + BQBANK_ROW_W2 * stride);
+
+            for (int i = 0; i < n; i++)
+            {
+                __m256 x = _mm256_loadu_ps(p_in + i * nc + c0);
+                __m256 y = _mm256_add_ps(_mm256_mul_ps(b0, x), w1);
+                w1 = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(b1, x), _mm256_mul_ps(a1, y)), w2);
+                w2 = _mm256_sub_ps(_mm256_mul_ps(b2, x), _mm256_mul_ps(a2, y));
+                _mm256_storeu_ps(p_out + i * nc + c0, y);
+            }
+
+            _mm256_storeu_ps(m + BQBANK_ROW_W1 * stride, w1);
+            _mm256_storeu_ps(m + BQBANK_ROW_W2 * stride, w2);
+        }
+        return;
+    }
+#endif
+
+    t_bqbank_lanes l;
+    float tmp[V];
+
+    for (; c0 < nc; c0 += V)
+    {
+        int active = DAFX_MIN(V, nc - c0);
+
+        _LoadLanes(pBANK, c0, &l);
+
+        if (active == V)
+        {
+            //a frame of V channels is contiguous - straight vector loads
+            for (int i = 0; i < n; i++) {
+                dafx_v4f_storeu(p_out + i * nc + c0, _LanesStep(&l, dafx_v4f_loadu(p_in + i * nc + c0)));
+            }
+        }
+        else
+        {
+            for (int i = 0; i < n; i++)
+            {
+                for (int k = 0; k < V; k++) {
+                    tmp[k] = (k < active) ? p_in[i * nc + c0 + k] : 0.0f;
+                }
+                dafx_v4f_storeu(tmp, _LanesStep(&l, dafx_v4f_loadu(tmp)));
+                for (int k = 0; k < active; k++) {
+                    p_out[i * nc + c0 + k] = tmp[k];
+                }
+            }
+        }
+
+        _StoreLaneStates(pBANK, c0, &l);
+    }
+}
+
+bool ProcessBlockBiquadBank(t_DAFX_BiquadBank *pBANK, float **pp_in, float **pp_out, int n)
+{
+    t_dafx_fp_state fp_state;
+
+    DAFX_DenormalGuardBegin(&fp_state);
+    _ProcessBlockPlanar(pBANK, pp_in, pp_out, n);
+    DAFX_DenormalCountBlock(&pBANK->denormal_stats);
+    DAFX_DenormalCheckStates(&pBANK->denormal_stats, pBANK->p_memory + BQBANK_ROW_W1 * pBANK->num_lanes, 2 * pBANK->num_lanes);
+    DAFX_DenormalGuardEnd(&fp_state);
+
+    return true;
+}
+
+bool ProcessBlockBiquadBankInterleaved(t_DAFX_BiquadBank *pBANK, float *p_in, float *p_out, int n)
+{
+    t_dafx_fp_state fp_state;
+
+    DAFX_DenormalGuardBegin(&fp_state);
+    _ProcessBlockInterleaved(pBANK, p_in, p_out, n);
+    DAFX_DenormalCountBlock(&pBANK->denormal_stats);
+    DAFX_DenormalCheckStates(&pBANK->denormal_stats, pBANK->p_memory + BQBANK_ROW_W1 * pBANK->num_lanes, 2 * pBANK->num_lanes);
+    DAFX_DenormalGuardEnd(&fp_state);
+
+    return true;
+}
+
+bool ResetBiquadBank(t_DAFX_BiquadBank *pBANK)
+{
+    memset(pBANK->p_memory + BQBANK_ROW_W1 * pBANK->num_lanes, 0, sizeof(float) * 2 * pBANK->num_lanes);
+    return true;
+}
+
+void DeallocBiquadBank(t_DAFX_BiquadBank *pBANK)
+{
+    if(pBANK != NULL) {
+        DAFX_AlignedFree(pBANK->p_memory);
+        pBANK->p_memory = NULL;
+    }
+}
@@ -10,6 +10,7 @@
 #include "DAFX_InitBiquadFilter.h"
 
 #include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 #include <math.h>
@@ -35,6 +36,82 @@ bool InitBiquadFilter(t_DAFX_BiquadFilter *pBQF)
     pBQF->b[0] = 1.0;
     pBQF->a[0] = 1.0; //not necessary to set
     
+    //sample based processing by default, the state-space matrices are only filled in when needed
+    pBQF->mode = BIQUAD_MODE_SAMPLE;
+    pBQF->pStateSpaceMatrices = (float *) DAFX_AlignedCalloc(BIQUAD_SS_MATRIX_SIZE, sizeof(float));
+    if (pBQF->pStateSpaceMatrices == NULL)
+        return false;
+    
+    DAFX_DenormalResetStats(&pBQF->denormal_stats);
+    
+    return true;
+}
+
+//Precomputes the state-space block matrices from the normalized coeffs
+//With the TDF-II states s = [w1 w2]:   s(n+1) = A*s(n) + B*x(n),   y(n) = C*s(n) + D*x(n)
+//    A = [-a1 1; -a2 0],  B = [b1 - a1*b0; b2 - a2*b0],  C = [1 0],  D = b0
+//For a step of N samples:
+//    y(n+k)  = C*A^k*s(n) + D*x(n+k) + sum_{j<k} C*A^(k-1-j)*B*x(n+j)
+//    s(n+N)  = A^N*s(n) + sum_{j<N} A^(N-1-j)*B*x(n+j)
+static void _UpdateStateSpaceMatrices(t_DAFX_BiquadFilter *pBQF)
+{
+    float *m = pBQF->pStateSpaceMatrices;
+    double a1 = pBQF->a[1];
+    double a2 = pBQF->a[2];
+    double d = pBQF->b[0];
+    double B[2] = {pBQF->b[1] - a1 * d, pBQF->b[2] - a2 * d};
+    double Ap[BIQUAD_SS_STEP + 1][2][2]; //powers of A
+    double AB[BIQUAD_SS_STEP][2];        //A^k * B
+    
+    Ap[0][0][0] = 1.0; Ap[0][0][1] = 0.0;
+    Ap[0][1][0] = 0.0; Ap[0][1][1] = 1.0;
+    for (int k = 1; k <= BIQUAD_SS_STEP; k++) {
+        //A^k = A * A^(k-1)
+        for (int c = 0; c < 2; c++) {
+            Ap[k][0][c] = -a1 * Ap[k-1][0][c] + Ap[k-1][1][c];
+            Ap[k][1][c] = -a2 * Ap[k-1][0][c];
+        }
+    }
+    for (int k = 0; k < BIQUAD_SS_STEP; k++) {
+        AB[k][0] = Ap[k][0][0] * B[0] + Ap[k][0][1] * B[1];
+        AB[k][1] = Ap[k][1][0] * B[0] + Ap[k][1][1] * B[1];
+    }
+    
+    memset(m, 0, sizeof(float) * BIQUAD_SS_MATRIX_SIZE);
+    
+    for (int k = 0; k < BIQUAD_SS_STEP; k++)
+    {
+        // state -> output k
+        m[BIQUAD_SS_Y_W1 + k] = (float)Ap[k][0][0];
+        m[BIQUAD_SS_Y_W2 + k] = (float)Ap[k][0][1];
+        
+        // input j -> output k (lower triangular Toeplitz of the impulse response)
+        for (int j = 0; j <= k; j++) {
+            m[BIQUAD_SS_Y_X + j * BIQUAD_SS_STEP + k] = (j == k) ? (float)d : (float)AB[k-1-j][0];
+        }
+        
+        // input k -> next state
+        m[BIQUAD_SS_S_X + k * BIQUAD_SS_STEP + 0] = (float)AB[BIQUAD_SS_STEP-1-k][0];
+        m[BIQUAD_SS_S_X + k * BIQUAD_SS_STEP + 1] = (float)AB[BIQUAD_SS_STEP-1-k][1];
+    }
+    
+    // state -> next state
+    m[BIQUAD_SS_S_W1 + 0] = (float)Ap[BIQUAD_SS_STEP][0][0];
+    m[BIQUAD_SS_S_W1 + 1] = (float)Ap[BIQUAD_SS_STEP][1][0];
+    m[BIQUAD_SS_S_W2 + 0] = (float)Ap[BIQUAD_SS_STEP][0][1];
+    m[BIQUAD_SS_S_W2 + 1] = (float)Ap[BIQUAD_SS_STEP][1][1];
+}
+
+bool SetBiquadProcessMode(t_DAFX_BiquadFilter *pBQF, t_biquad_process_mode mode)
+{
+    if (mode != BIQUAD_MODE_SAMPLE && mode != BIQUAD_MODE_STATE_SPACE)
+        return false;
+    
+    if (mode == BIQUAD_MODE_STATE_SPACE) {
+        _UpdateStateSpaceMatrices(pBQF);
+    }
+    pBQF->mode = mode;
+    
     return true;
 }
 
@@ -52,20 +129,95 @@ bool SetBiquadFilterCoeffs(t_DAFX_BiquadFilter *pBQF, float *p_coeffs)
     pBQF->a[1] = p_coeffs[4] * ax;
     pBQF->a[2] = p_coeffs[5] * ax;
     
+    if (pBQF->mode == BIQUAD_MODE_STATE_SPACE) {
+        _UpdateStateSpaceMatrices(pBQF);
+    }
+    
     return true;
 }
 
+//the kernel below is unrolled for one vector of outputs per step
+#if BIQUAD_SS_STEP != 4 || DAFX_SIMD_LANES != 4
+#error "_ProcessBlockBiquadStateSpace is written for BIQUAD_SS_STEP == DAFX_SIMD_LANES == 4"
+#endif
+
+//State-space block kernel - BIQUAD_SS_STEP outputs per step, tail is finished sample by sample
+static void _ProcessBlockBiquadStateSpace(t_DAFX_BiquadFilter *pBQF, float *p_in, float *p_out, int n)
+{
+    float *m = pBQF->pStateSpaceMatrices;
+    float *w = pBQF->pInternalMemory;
+    float s_tmp[DAFX_SIMD_LANES] = {w[0], w[1], 0.0f, 0.0f};
+    int i = 0;
+    
+    t_dafx_v4f y_w1 = dafx_v4f_load(m + BIQUAD_SS_Y_W1);
+    t_dafx_v4f y_w2 = dafx_v4f_load(m + BIQUAD_SS_Y_W2);
+    t_dafx_v4f y_x0 = dafx_v4f_load(m + BIQUAD_SS_Y_X + 0 * BIQUAD_SS_STEP);
+    t_dafx_v4f y_x1 = dafx_v4f_load(m + BIQUAD_SS_Y_X + 1 * BIQUAD_SS_STEP);
+    t_dafx_v4f y_x2 = dafx_v4f_load(m + BIQUAD_SS_Y_X + 2 * BIQUAD_SS_STEP);
+    t_dafx_v4f y_x3 = dafx_v4f_load(m + BIQUAD_SS_Y_X + 3 * BIQUAD_SS_STEP);
+    t_dafx_v4f s_w1 = dafx_v4f_load(m + BIQUAD_SS_S_W1);
+    t_dafx_v4f s_w2 = dafx_v4f_load(m + BIQUAD_SS_S_W2);
+    t_dafx_v4f s_x0 = dafx_v4f_load(m + BIQUAD_SS_S_X + 0 * BIQUAD_SS_STEP);
+    t_dafx_v4f s_x1 = dafx_v4f_load(m + BIQUAD_SS_S_X + 1 * BIQUAD_SS_STEP);
+    t_dafx_v4f s_x2 = dafx_v4f_load(m + BIQUAD_SS_S_X + 2 * BIQUAD_SS_STEP);
+    t_dafx_v4f s_x3 = dafx_v4f_load(m + BIQUAD_SS_S_X + 3 * BIQUAD_SS_STEP);
+    
+    //state vector: lane 0 - w1, lane 1 - w2
+    t_dafx_v4f s = dafx_v4f_loadu(s_tmp);
+    
+    for (; i + BIQUAD_SS_STEP <= n; i += BIQUAD_SS_STEP)
+    {
+        t_dafx_v4f x0 = dafx_v4f_set1(p_in[i]);
+        t_dafx_v4f x1 = dafx_v4f_set1(p_in[i+1]);
+        t_dafx_v4f x2 = dafx_v4f_set1(p_in[i+2]);
+        t_dafx_v4f x3 = dafx_v4f_set1(p_in[i+3]);
+        t_dafx_v4f w1 = dafx_v4f_splat0(s);
+        t_dafx_v4f w2 = dafx_v4f_splat1(s);
+        
+        //input contributions don't depend on the state - only the last two products are on the recursive path
+        t_dafx_v4f y = dafx_v4f_madd(y_x3, x3, dafx_v4f_madd(y_x2, x2, dafx_v4f_madd(y_x1, x1, dafx_v4f_mul(y_x0, x0))));
+        t_dafx_v4f sn = dafx_v4f_madd(s_x3, x3, dafx_v4f_madd(s_x2, x2, dafx_v4f_madd(s_x1, x1, dafx_v4f_mul(s_x0, x0))));
+        
+        y = dafx_v4f_madd(y_w2, w2, dafx_v4f_madd(y_w1, w1, y));
+        s = dafx_v4f_madd(s_w2, w2, dafx_v4f_madd(s_w1, w1, sn));
+        
+        dafx_v4f_storeu(p_out + i, y);
+    }
+    
+    dafx_v4f_storeu(s_tmp, s);
+    w[0] = s_tmp[0];
+    w[1] = s_tmp[1];
+    
+    for (; i < n; i++) {
+        p_out[i] = ProcessSingleSampleBiquad(pBQF, p_in[i]);
+    }
+}
+
 
 bool ProcessBlockBiquad(t_DAFX_BiquadFilter *pBQF)
 {
     float * p_in = pBQF->pInBuff;
     float * p_out = pBQF->pOutBuff;
     int buffer_len = pBQF->buffer_len;
+    t_dafx_fp_state fp_state;
     
-    for (int i=0; i < buffer_len; i++)// loop through all samples in inBuff
-    {        
-        p_out[i] = ProcessSingleSampleBiquad(pBQF, p_in[i]);
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    if (pBQF->mode == BIQUAD_MODE_STATE_SPACE)
+    {
+        _ProcessBlockBiquadStateSpace(pBQF, p_in, p_out, buffer_len);
     }
+    else
+    {
+        for (int i=0; i < buffer_len; i++)// loop through all samples in inBuff
+        {
+            p_out[i] = ProcessSingleSampleBiquad(pBQF, p_in[i]);
+        }
+    }
+    
+    DAFX_DenormalCountBlock(&pBQF->denormal_stats);
+    DAFX_DenormalCheckStates(&pBQF->denormal_stats, pBQF->pInternalMemory, BIQUAD_FILTER_ORDER);
+    DAFX_DenormalGuardEnd(&fp_state);
     
     return true;
 }
@@ -96,5 +248,6 @@ void DeallocBiquadFilter(t_DAFX_BiquadFilter *pBQF)
            FREE(pBQF->pInternalMemory);
            FREE(pBQF->b);
            FREE(pBQF->a);
+           DAFX_AlignedFree(pBQF->pStateSpaceMatrices);
     }
 }
\ No newline at end of file
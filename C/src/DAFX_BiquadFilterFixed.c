@@ -0,0 +1,137 @@
+//
+//  DAFX_BiquadFilterFixed.c
+//
+
+#include "DAFX_BiquadFilterFixed.h"
+#include "DAFX_InitBiquadFilter.h"
+
+#include "DAFX_definitions.h"
+#include "DAFX_FixedPoint.h"
+
+#define COEFF_SHIFT     BIQUAD_FX_COEFF_FRAC_BITS
+#define COEFF_ONE       ((double)(1 << COEFF_SHIFT))
+#define FRAC_MASK       (((int64_t)1 << COEFF_SHIFT) - 1)
+
+
+//rounded to Q3.29, false if it does not fit: [-4, 4)
+static bool _CoeffToFixed(double c, int32_t *p_fixed)
+{
+    double d = c * COEFF_ONE;
+    d += (d >= 0.0) ? 0.5 : -0.5;
+    if (!(d < (double)INT32_MAX + 1.0 && d > (double)INT32_MIN - 1.0))
+        return false;
+    
+    *p_fixed = (int32_t)d;
+    return true;
+}
+
+//One DF-I step on Q31 values
+//The accumulator is summed as unsigned, so intermediate wrap-arounds are harmless
+//as long as the final (unsaturated) output stays within the Q60 range
+static inline int32_t _BiquadFixedStep(t_DAFX_BiquadFilterFixed *pBQF, int32_t x)
+{
+    uint64_t acc = (uint64_t)pBQF->err;
+    acc += (uint64_t)((int64_t)pBQF->b[0] * x);
+    acc += (uint64_t)((int64_t)pBQF->b[1] * pBQF->x1);
+    acc += (uint64_t)((int64_t)pBQF->b[2] * pBQF->x2);
+    acc -= (uint64_t)((int64_t)pBQF->a[1] * pBQF->y1);
+    acc -= (uint64_t)((int64_t)pBQF->a[2] * pBQF->y2);
+    
+    int64_t s = (int64_t)acc;
+    
+    //keep the dropped fraction for the next sample, saturate the output
+    pBQF->err = s & FRAC_MASK;
+    int32_t y = DAFX_SatQ31(s >> COEFF_SHIFT);
+    
+    pBQF->x2 = pBQF->x1;
+    pBQF->x1 = x;
+    pBQF->y2 = pBQF->y1;
+    pBQF->y1 = y;
+    
+    return y;
+}
+
+bool InitBiquadFilterFixed(t_DAFX_BiquadFilterFixed *pBQF)
+{
+    //Allocating I/O buffers
+    pBQF->pInBuff = (t_dafx_fx *) calloc(sizeof(t_dafx_fx), pBQF->buffer_len);
+    pBQF->pOutBuff = (t_dafx_fx *) calloc(sizeof(t_dafx_fx), pBQF->buffer_len);
+    
+    //Initializing to a pass-through filter
+    memset(pBQF->b, 0, sizeof(pBQF->b));
+    memset(pBQF->a, 0, sizeof(pBQF->a));
+    pBQF->b[0] = 1 << COEFF_SHIFT;
+    pBQF->a[0] = 1 << COEFF_SHIFT;
+    
+    ResetBiquadFilterFixed(pBQF);
+    
+    return true;
+}
+
+bool SetBiquadFilterCoeffsFixed(t_DAFX_BiquadFilterFixed *pBQF, float *p_coeffs)
+{
+    //expected coeff order: b0, b1, b2, a0, a1, a2
+    double ax = 1.0 / (double)p_coeffs[3];
+    int32_t b[3], a[3];
+    
+    //all or nothing: a filter with some of its coeffs clipped would be another filter
+    if (!_CoeffToFixed(p_coeffs[0] * ax, &b[0]) ||
+        !_CoeffToFixed(p_coeffs[1] * ax, &b[1]) ||
+        !_CoeffToFixed(p_coeffs[2] * ax, &b[2]) ||
+        !_CoeffToFixed(p_coeffs[4] * ax, &a[1]) ||
+        !_CoeffToFixed(p_coeffs[5] * ax, &a[2]))
+    {
+        return false;
+    }
+    
+    pBQF->b[0] = b[0];
+    pBQF->b[1] = b[1];
+    pBQF->b[2] = b[2];
+    pBQF->a[0] = 1 << COEFF_SHIFT;
+    pBQF->a[1] = a[1];
+    pBQF->a[2] = a[2];
+    
+    return true;
+}
+
+bool ProcessBlockBiquadFixed(t_DAFX_BiquadFilterFixed *pBQF)
+{
+    //local copy, so coeffs and states stay in registers (the output buffer could alias them otherwise)
+    t_DAFX_BiquadFilterFixed bq = *pBQF;
+    
+    for (int i = 0; i < bq.buffer_len; i++) {
+        bq.pOutBuff[i] = DAFX_Q31ToFx(_BiquadFixedStep(&bq, DAFX_FxToQ31(bq.pInBuff[i])));
+    }
+    
+    pBQF->x1 = bq.x1;
+    pBQF->x2 = bq.x2;
+    pBQF->y1 = bq.y1;
+    pBQF->y2 = bq.y2;
+    pBQF->err = bq.err;
+    
+    return true;
+}
+
+t_dafx_fx ProcessSingleSampleBiquadFixed(t_DAFX_BiquadFilterFixed *pBQF, t_dafx_fx x)
+{
+    return DAFX_Q31ToFx(_BiquadFixedStep(pBQF, DAFX_FxToQ31(x)));
+}
+
+bool ResetBiquadFilterFixed(t_DAFX_BiquadFilterFixed *pBQF)
+{
+    pBQF->x1 = 0;
+    pBQF->x2 = 0;
+    pBQF->y1 = 0;
+    pBQF->y2 = 0;
+    pBQF->err = 0;
+    
+    return true;
+}
+
+void DeallocBiquadFilterFixed(t_DAFX_BiquadFilterFixed *pBQF)
+{
+    if(pBQF != NULL) {
+        FREE(pBQF->pInBuff);
+        FREE(pBQF->pOutBuff);
+    }
+}
@@ -0,0 +1,175 @@
+//
+//  DAFX_ControlRate.c
+//
+
+#include "DAFX_ControlRate.h"
+#include "DAFX_InitControlRate.h"
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+bool CTRL_SetPeriod(t_DAFX_ControlRate *pCR, int period)
+{
+    int p = 1;
+    int limit = DAFX_MIN(DAFX_MAX(period, 1), pCR->max_period);
+    
+    //largest power of two within the limit that divides the block size
+    while (2 * p <= limit && pCR->block_size % (2 * p) == 0) {
+        p *= 2;
+    }
+    pCR->period = p;
+    pCR->num_points = pCR->block_size / p;
+    
+    return true;
+}
+
+bool CTRL_SetInterpolation(t_DAFX_ControlRate *pCR, t_ctrl_interp_mode interp)
+{
+    if (interp < ControlRate_N_INTERP_MODES)
+        pCR->interp = interp;
+    return true;
+}
+
+bool InitControlRate(t_DAFX_ControlRate *pCR)
+{
+    pCR->max_period = DAFX_MAX(pCR->max_period, 1);
+    
+    pCR->p_points = (float *) calloc(CTRL_NUMOF_HISTORY_POINTS + pCR->block_size, sizeof(float));
+    pCR->p_output_block = (float *) calloc(pCR->block_size, sizeof(float));
+    pCR->is_primed = false;
+    
+    CTRL_SetPeriod(pCR, CTRL_INIT_PERIOD);
+    CTRL_SetInterpolation(pCR, CTRL_INIT_INTERP);
+    
+    return true;
+}
+
+float *CTRL_GetPoints(t_DAFX_ControlRate *pCR)
+{
+    return pCR->p_points + CTRL_NUMOF_HISTORY_POINTS;
+}
+
+bool CTRL_Reset(t_DAFX_ControlRate *pCR)
+{
+    pCR->is_primed = false;
+    return true;
+}
+
+//fills in the past points on the first block, so that it starts flat
+static void _Prime(t_DAFX_ControlRate *pCR)
+{
+    if (!pCR->is_primed) {
+        float *p = CTRL_GetPoints(pCR);
+        for (int k = 1; k <= CTRL_NUMOF_HISTORY_POINTS; k++) {
+            p[-k] = p[0];
+        }
+        pCR->is_primed = true;
+    }
+}
+
+bool CTRL_Advance(t_DAFX_ControlRate *pCR)
+{
+    _Prime(pCR);
+    
+    //the last points of the block are the past points of the next one
+    memmove(pCR->p_points, pCR->p_points + pCR->num_points, sizeof(float) * CTRL_NUMOF_HISTORY_POINTS);
+    
+    return true;
+}
+
+//Every control period is a cubic c0 + c1 t + c2 t^2 + c3 t^3 of t = (j + 1) / period,
+//hold and linear being the degenerate cases
+static inline void _SegmentPoly(t_ctrl_interp_mode interp, const float *p, int k, float *c)
+{
+    float p0 = p[k - 1];
+    float p1 = p[k];
+    
+    switch (interp) {
+        case CTRL_INTERP_HOLD:
+            c[0] = p1; c[1] = 0.0f; c[2] = 0.0f; c[3] = 0.0f;
+            break;
+        case CTRL_INTERP_CUBIC:
+        {
+            //one-sided second-order differences: the tangent at a point only uses the
+            //points before it, so every segment joins the next with the same slope
+            float m0 = 0.5f * (3.0f * p0 - 4.0f * p[k - 2] + p[k - 3]);
+            float m1 = 0.5f * (3.0f * p1 - 4.0f * p0 + p[k - 2]);
+            c[0] = p0;
+            c[1] = m0;
+            c[2] = 3.0f * (p1 - p0) - 2.0f * m0 - m1;
+            c[3] = 2.0f * (p0 - p1) + m0 + m1;
+            break;
+        }
+        default:
+            c[0] = p0; c[1] = p1 - p0; c[2] = 0.0f; c[3] = 0.0f;
+            break;
+    }
+}
+
+bool CTRL_Interpolate(t_DAFX_ControlRate *pCR)
+{
+    int period = pCR->period;
+    float *p = CTRL_GetPoints(pCR);
+    float *pOutput = pCR->p_output_block;
+    float inv_period = 1.0f / (float)period;
+    float c[4];
+    
+    _Prime(pCR);
+    
+    if (period == 1)
+    {
+        memcpy(pOutput, p, sizeof(float) * pCR->block_size);
+    }
+    else if (period < DAFX_SIMD_LANES)
+    {
+        for (int k = 0; k < pCR->num_points; k++)
+        {
+            _SegmentPoly(pCR->interp, p, k, c);
+            for (int j = 0; j < period; j++) {
+                float t = (float)(j + 1) * inv_period;
+                pOutput[k * period + j] = c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+            }
+        }
+    }
+    else
+    {
+        float t0[DAFX_SIMD_LANES];
+        for (int j = 0; j < DAFX_SIMD_LANES; j++) {
+            t0[j] = (float)(j + 1) * inv_period;
+        }
+        t_dafx_v4f v_t0 = dafx_v4f_loadu(t0);
+        t_dafx_v4f v_step = dafx_v4f_set1((float)DAFX_SIMD_LANES * inv_period);
+        
+        for (int k = 0; k < pCR->num_points; k++)
+        {
+            _SegmentPoly(pCR->interp, p, k, c);
+            t_dafx_v4f c0 = dafx_v4f_set1(c[0]);
+            t_dafx_v4f c1 = dafx_v4f_set1(c[1]);
+            t_dafx_v4f c2 = dafx_v4f_set1(c[2]);
+            t_dafx_v4f c3 = dafx_v4f_set1(c[3]);
+            t_dafx_v4f t = v_t0;
+            
+            for (int j = 0; j < period; j += DAFX_SIMD_LANES) {
+                t_dafx_v4f y = dafx_v4f_madd(t, c3, c2);
+                y = dafx_v4f_madd(t, y, c1);
+                y = dafx_v4f_madd(t, y, c0);
+                dafx_v4f_storeu(pOutput + k * period + j, y);
+                t = dafx_v4f_add(t, v_step);
+            }
+        }
+    }
+    
+    return CTRL_Advance(pCR);
+}
+
+void DeallocControlRate(t_DAFX_ControlRate *pCR)
+{
+    FREE(pCR->p_points);
+    FREE(pCR->p_output_block);
+}
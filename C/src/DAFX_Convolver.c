@@ -0,0 +1,496 @@
+//
+//  DAFX_Convolver.c
+//
+
+#include "DAFX_Convolver.h"
+#include "DAFX_InitConvolver.h"
+#include "DAFX_FFT.h"
+#include "DAFX_definitions.h"
+#include "DAFX_Denormal.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+static bool _IsPowerOfTwo(int n)
+{
+    return (n > 0) && ((n & (n - 1)) == 0);
+}
+
+static void _FreeEngine(t_conv_engine *pEngine)
+{
+    if (pEngine == NULL)
+        return;
+
+    for (int s = 0; s < CONV_MAX_NUMOF_SEGMENTS; s++)
+    {
+        t_conv_segment_state *pSeg = &pEngine->segments[s];
+        DAFX_AlignedFree(pSeg->p_frame);
+        DAFX_AlignedFree(pSeg->p_fdl_re);
+        DAFX_AlignedFree(pSeg->p_fdl_im);
+        DAFX_AlignedFree(pSeg->p_acc_re);
+        DAFX_AlignedFree(pSeg->p_acc_im);
+        DAFX_AlignedFree(pSeg->p_time);
+    }
+    FREE(pEngine->p_head_hist);
+    FREE(pEngine->p_out_ring);
+    if (pEngine->own_ir) {
+        DeallocConvolverIR(pEngine->p_ir);
+        FREE(pEngine->p_ir);
+    }
+    FREE(pEngine);
+}
+
+//Allocates the signal state for the layout of pIR (NULL if out of memory, a private IR is freed then)
+static t_conv_engine *_NewEngine(t_DAFXConvolver *pCONV, t_DAFX_ConvolverIR *pIR, bool own_ir)
+{
+    int B = pCONV->block_size;
+    bool ok;
+
+    t_conv_engine *pEngine = (t_conv_engine *) calloc(1, sizeof(t_conv_engine));
+    if (pEngine == NULL) {
+        if (own_ir) {
+            DeallocConvolverIR(pIR);
+            FREE(pIR);
+        }
+        return NULL;
+    }
+    pEngine->p_ir = pIR;
+    pEngine->own_ir = own_ir;
+
+    pEngine->p_head_hist = (float *) calloc(DAFX_MAX(pIR->head_len - 1, 0) + B, sizeof(float));
+    ok = (pEngine->p_head_hist != NULL);
+
+    //farthest ahead a segment writes: B + offset (see DAFXProcessConvolver)
+    int reach = 2 * B;
+    for (int s = 0; s < pIR->num_segments; s++)
+    {
+        t_conv_segment_ir *pSegIR = &pIR->segments[s];
+        t_conv_segment_state *pSeg = &pEngine->segments[s];
+        int P = pSegIR->part_size;
+
+        pSeg->p_frame = (float *) DAFX_AlignedCalloc(2 * P, sizeof(float));
+        pSeg->p_fdl_re = (float *) DAFX_AlignedCalloc(pSegIR->num_parts * P, sizeof(float));
+        pSeg->p_fdl_im = (float *) DAFX_AlignedCalloc(pSegIR->num_parts * P, sizeof(float));
+        pSeg->p_acc_re = (float *) DAFX_AlignedCalloc(P, sizeof(float));
+        pSeg->p_acc_im = (float *) DAFX_AlignedCalloc(P, sizeof(float));
+        pSeg->p_time = (float *) DAFX_AlignedCalloc(2 * P, sizeof(float));
+        ok = ok && pSeg->p_frame && pSeg->p_fdl_re && pSeg->p_fdl_im && pSeg->p_acc_re && pSeg->p_acc_im && pSeg->p_time;
+
+        //FFT + MACs + IFFT spread over the P / B blocks until the next frame
+        int num_calls = P / B;
+        pSeg->units_per_call = (pSegIR->num_parts + 2 + num_calls - 1) / num_calls;
+
+        reach = DAFX_MAX(reach, 2 * B + pSegIR->offset);
+    }
+
+    int ring_size = 1;
+    while (ring_size < reach) {
+        ring_size <<= 1;
+    }
+    pEngine->p_out_ring = (float *) calloc(ring_size, sizeof(float));
+    pEngine->ring_mask = ring_size - 1;
+    pEngine->ring_pos = 0;
+
+    if (!ok || pEngine->p_out_ring == NULL) {
+        _FreeEngine(pEngine);
+        return NULL;
+    }
+    return pEngine;
+}
+
+bool CONV_ReleaseRetiredIR(t_DAFXConvolver *pCONV, bool force)
+{
+    if (pCONV->p_retired_engine == NULL)
+        return true;
+
+    //the block that may have started on it before the swap has not ended yet
+    if (!force && DAFX_ATOMIC_LOAD(pCONV->num_blocks) == pCONV->retired_at_block)
+        return false;
+
+    _FreeEngine(pCONV->p_retired_engine);
+    pCONV->p_retired_engine = NULL;
+    return true;
+}
+
+//swaps the engine in, the previous one is retired until the audio thread is done with it
+//(false if the one retired before is still in use, nothing is swapped then)
+static bool _SwapEngine(t_DAFXConvolver *pCONV, t_conv_engine *pEngine)
+{
+    if (!CONV_ReleaseRetiredIR(pCONV, false))
+        return false;
+
+    pCONV->p_retired_engine = pCONV->p_engine;
+    DAFX_ATOMIC_STORE(pCONV->p_engine, pEngine);
+
+    //read after the store: a block ending from now on has started on the new engine, or was already running
+    pCONV->retired_at_block = DAFX_ATOMIC_LOAD(pCONV->num_blocks);
+    return true;
+}
+
+//acc += x * h over P / 2 complex bins; bin 0 packs the real DC and Nyquist values
+static void _SpectrumMultiplyAdd(float *acc_re, float *acc_im, float *x_re, float *x_im, float *h_re, float *h_im, int len)
+{
+    float dc = acc_re[0] + x_re[0] * h_re[0];
+    float ny = acc_im[0] + x_im[0] * h_im[0];
+
+    for (int k = 0; k < len; k += DAFX_SIMD_LANES)
+    {
+        t_dafx_v4f xr = dafx_v4f_load(x_re + k);
+        t_dafx_v4f xi = dafx_v4f_load(x_im + k);
+        t_dafx_v4f hr = dafx_v4f_load(h_re + k);
+        t_dafx_v4f hi = dafx_v4f_load(h_im + k);
+        t_dafx_v4f ar = dafx_v4f_load(acc_re + k);
+        t_dafx_v4f ai = dafx_v4f_load(acc_im + k);
+
+        ar = dafx_v4f_sub(dafx_v4f_madd(xr, hr, ar), dafx_v4f_mul(xi, hi));
+        ai = dafx_v4f_madd(xi, hr, dafx_v4f_madd(xr, hi, ai));
+
+        dafx_v4f_store(acc_re + k, ar);
+        dafx_v4f_store(acc_im + k, ai);
+    }
+
+    acc_re[0] = dc;
+    acc_im[0] = ny;
+}
+
+//Runs the pending work units of a segment, up to unit_end (exclusive)
+//unit 0: FFT of the frame, 1 .. num_parts: one partition each, num_parts + 1: IFFT
+static void _RunSegmentUnits(t_conv_engine *pEngine, t_conv_segment_ir *pSegIR, t_conv_segment_state *pSeg, int unit_end)
+{
+    int P = pSegIR->part_size;
+    int n = pSegIR->num_parts;
+
+    while (pSeg->job_unit > 0 && pSeg->job_unit < unit_end)
+    {
+        int u = pSeg->job_unit;
+
+        if (u <= n)
+        {
+            int j = u - 1;
+            int slot = (pSeg->fdl_pos - j + n) % n;
+            _SpectrumMultiplyAdd(pSeg->p_acc_re, pSeg->p_acc_im,
+                                 pSeg->p_fdl_re + slot * P, pSeg->p_fdl_im + slot * P,
+                                 pSegIR->p_spec_re + j * P, pSegIR->p_spec_im + j * P, P);
+            pSeg->job_unit++;
+        }
+        else
+        {
+            //overlap-save: the second half of the result is valid
+            FFTInverseReal(&pSegIR->fft, pSeg->p_acc_re, pSeg->p_acc_im, pSeg->p_time);
+
+            float *p_ring = pEngine->p_out_ring;
+            int mask = pEngine->ring_mask;
+            for (int i = 0; i < P; i++) {
+                p_ring[(pSeg->job_out_pos + i) & mask] += pSeg->p_time[P + i];
+            }
+
+            //job done
+            pSeg->job_unit = 0;
+        }
+    }
+}
+
+bool InitConvolverIR(t_DAFX_ConvolverIR *pIR, float *p_samples, int len)
+{
+    int B = pIR->block_size;
+
+    if (!_IsPowerOfTwo(B))
+        return false;
+
+    len = DAFX_MAX(DAFX_MIN(len, CONV_MAX_IR_LEN), 1);
+    pIR->ir_len = len;
+    pIR->num_segments = 0;
+
+    //first partition size; a segment of partition P needs an offset of at least 2P - 2B
+    bool uniform = (pIR->partition_mode == CONV_PARTITION_UNIFORM);
+    int P = DAFX_MAX((uniform ? B : 2 * B), CONV_MIN_PARTITION_SIZE);
+    if (P > CONV_MAX_PARTITION_SIZE) {
+        //blocks this long: a single size, one block per partition
+        uniform = true;
+        P = B;
+    }
+
+    //direct-form head
+    pIR->head_len = DAFX_MIN(2 * P - 2 * B, len);
+    pIR->p_head = (float *) calloc(DAFX_MAX(pIR->head_len, 1), sizeof(float));
+    for (int t = 0; t < pIR->head_len; t++) {
+        pIR->p_head[pIR->head_len - 1 - t] = p_samples[t];
+    }
+
+    int offset = pIR->head_len;
+    while (offset < len && pIR->num_segments < CONV_MAX_NUMOF_SEGMENTS)
+    {
+        t_conv_segment_ir *pSegIR = &pIR->segments[pIR->num_segments];
+        bool last_size = uniform || (P >= CONV_MAX_PARTITION_SIZE) || (pIR->num_segments == CONV_MAX_NUMOF_SEGMENTS - 1);
+        int parts_left = (len - offset + P - 1) / P;
+
+        pSegIR->part_size = P;
+        pSegIR->offset = offset;
+        pSegIR->num_parts = last_size ? parts_left : DAFX_MIN(parts_left, CONV_PARTITIONS_PER_SIZE);
+
+        pSegIR->fft.size = 2 * P;
+        InitFFT(&pSegIR->fft);
+
+        pSegIR->p_spec_re = (float *) DAFX_AlignedCalloc(pSegIR->num_parts * P, sizeof(float));
+        pSegIR->p_spec_im = (float *) DAFX_AlignedCalloc(pSegIR->num_parts * P, sizeof(float));
+
+        //partition zero padded to 2P, normalization of the inverse FFT folded in
+        float *p_buf = (float *) calloc(2 * P, sizeof(float));
+        float scale = 1.0f / (float)(2 * P);
+        for (int j = 0; j < pSegIR->num_parts; j++)
+        {
+            int start = offset + j * P;
+            for (int t = 0; t < P; t++) {
+                p_buf[t] = (start + t < len) ? p_samples[start + t] * scale : 0.0f;
+            }
+            memset(p_buf + P, 0, P * sizeof(float));
+            FFTForwardReal(&pSegIR->fft, p_buf, pSegIR->p_spec_re + j * P, pSegIR->p_spec_im + j * P);
+        }
+        FREE(p_buf);
+
+        offset += pSegIR->num_parts * P;
+        pIR->num_segments++;
+
+        if (!uniform && P < CONV_MAX_PARTITION_SIZE) {
+            P *= 2;
+        }
+    }
+
+    return true;
+}
+
+void DeallocConvolverIR(t_DAFX_ConvolverIR *pIR)
+{
+    if(pIR != NULL) {
+        FREE(pIR->p_head);
+        pIR->p_head = NULL;
+        for (int s = 0; s < pIR->num_segments; s++) {
+            DeallocFFT(&pIR->segments[s].fft);
+            DAFX_AlignedFree(pIR->segments[s].p_spec_re);
+            DAFX_AlignedFree(pIR->segments[s].p_spec_im);
+        }
+        pIR->num_segments = 0;
+    }
+}
+
+bool CONV_LoadIR(t_DAFXConvolver *pCONV, float *p_samples, int len)
+{
+    t_DAFX_ConvolverIR *pIR = (t_DAFX_ConvolverIR *) calloc(1, sizeof(t_DAFX_ConvolverIR));
+    if (pIR == NULL)
+        return false;
+    pIR->block_size = pCONV->block_size;
+    pIR->partition_mode = pCONV->partition_mode;
+
+    if (!InitConvolverIR(pIR, p_samples, len))
+    {
+        DeallocConvolverIR(pIR);
+        FREE(pIR);
+        return false;
+    }
+
+    //the engine owns the IR from here on
+    t_conv_engine *pEngine = _NewEngine(pCONV, pIR, true);
+    if (pEngine == NULL)
+        return false;
+
+    if (!_SwapEngine(pCONV, pEngine))
+    {
+        _FreeEngine(pEngine);
+        return false;
+    }
+    return true;
+}
+
+bool CONV_SetSharedIR(t_DAFXConvolver *pCONV, t_DAFX_ConvolverIR *pIR)
+{
+    if (pIR == NULL || pIR->block_size != pCONV->block_size)
+        return false;
+
+    t_conv_engine *pEngine = _NewEngine(pCONV, pIR, false);
+    if (pEngine == NULL)
+        return false;
+
+    if (!_SwapEngine(pCONV, pEngine))
+    {
+        _FreeEngine(pEngine);
+        return false;
+    }
+    return true;
+}
+
+bool CONV_SetPartitionMode(t_DAFXConvolver *pCONV, int mode)
+{
+    if (mode != CONV_PARTITION_UNIFORM && mode != CONV_PARTITION_NONUNIFORM)
+        return false;
+
+    pCONV->partition_mode = mode;
+    return true;
+}
+
+bool CONV_Reset(t_DAFXConvolver *pCONV)
+{
+    DAFX_ATOMIC_STORE(pCONV->reset_pending, true);
+    return true;
+}
+
+//the history the engine holds goes back to silence
+static void _ResetEngine(t_DAFXConvolver *pCONV, t_conv_engine *pEngine)
+{
+    t_DAFX_ConvolverIR *pIR = pEngine->p_ir;
+
+    memset(pEngine->p_head_hist, 0, (DAFX_MAX(pIR->head_len - 1, 0) + pCONV->block_size) * sizeof(float));
+    memset(pEngine->p_out_ring, 0, (pEngine->ring_mask + 1) * sizeof(float));
+
+    for (int s = 0; s < pIR->num_segments; s++)
+    {
+        t_conv_segment_state *pSeg = &pEngine->segments[s];
+        int P = pIR->segments[s].part_size;
+        int fdl_len = pIR->segments[s].num_parts * P;
+
+        memset(pSeg->p_frame, 0, 2 * P * sizeof(float));
+        memset(pSeg->p_fdl_re, 0, fdl_len * sizeof(float));
+        memset(pSeg->p_fdl_im, 0, fdl_len * sizeof(float));
+        pSeg->frame_fill = 0;
+        pSeg->fdl_pos = 0;
+        pSeg->job_unit = 0;
+    }
+}
+
+bool InitDAFXConvolver(t_DAFXConvolver *pCONV)
+{
+    //Signal vector size
+    int block_size = pCONV->block_size;
+
+    // memory allocation
+    pCONV->p_input_block = (float *) calloc(block_size, sizeof(float));
+    pCONV->p_output_block = (float *) calloc(block_size, sizeof(float));
+
+    pCONV->partition_mode = CONV_INIT_PARTITION_MODE;
+    pCONV->p_engine = NULL;
+    pCONV->p_retired_engine = NULL;
+    pCONV->retired_at_block = 0;
+    pCONV->num_blocks = 0;
+    pCONV->reset_pending = false;
+
+    //unit impulse until an IR is loaded
+    float dirac = 1.0f;
+    return CONV_LoadIR(pCONV, &dirac, 1);
+}
+
+bool DAFXProcessConvolver(t_DAFXConvolver *pCONV)
+{
+    //read once: a new IR comes with its own state, swapped in between blocks
+    t_conv_engine *pEngine = DAFX_ATOMIC_LOAD(pCONV->p_engine);
+    t_DAFX_ConvolverIR *pIR = pEngine->p_ir;
+    int B = pCONV->block_size;
+    float *p_in = pCONV->p_input_block;
+    float *p_out = pCONV->p_output_block;
+    float *p_ring = pEngine->p_out_ring;
+    int mask = pEngine->ring_mask;
+    t_dafx_fp_state fp_state;
+
+    DAFX_DenormalGuardBegin(&fp_state);
+
+    if (DAFX_ATOMIC_LOAD(pCONV->reset_pending)) {
+        DAFX_ATOMIC_STORE(pCONV->reset_pending, false);
+        _ResetEngine(pCONV, pEngine);
+    }
+
+    //segments: collect the input, start a job for every completed frame, run this block's share of the work
+    for (int s = 0; s < pIR->num_segments; s++)
+    {
+        t_conv_segment_ir *pSegIR = &pIR->segments[s];
+        t_conv_segment_state *pSeg = &pEngine->segments[s];
+        int P = pSegIR->part_size;
+        int unit_budget = pSeg->units_per_call;
+
+        memcpy(pSeg->p_frame + P + pSeg->frame_fill, p_in, B * sizeof(float));
+        pSeg->frame_fill += B;
+
+        if (pSeg->frame_fill == P)
+        {
+            //the previous job is always complete by now: it had P / B blocks
+            pSeg->fdl_pos = (pSeg->fdl_pos + 1) % pSegIR->num_parts;
+            FFTForwardReal(&pSegIR->fft, pSeg->p_frame,
+                           pSeg->p_fdl_re + pSeg->fdl_pos * P, pSeg->p_fdl_im + pSeg->fdl_pos * P);
+            memcpy(pSeg->p_frame, pSeg->p_frame + P, P * sizeof(float));
+            pSeg->frame_fill = 0;
+
+            memset(pSeg->p_acc_re, 0, P * sizeof(float));
+            memset(pSeg->p_acc_im, 0, P * sizeof(float));
+
+            //the frame ends with this block; its result covers [end + offset - P, end + offset)
+            pSeg->job_out_pos = (pEngine->ring_pos + B + pSegIR->offset - P) & mask;
+            pSeg->job_unit = 1;
+            unit_budget--;
+        }
+
+        if (pSeg->job_unit > 0) {
+            _RunSegmentUnits(pEngine, pSegIR, pSeg, pSeg->job_unit + unit_budget);
+        }
+    }
+
+    //head: direct-form FIR over the newest samples, four outputs per vector
+    int H = pIR->head_len;
+    int H_past = DAFX_MAX(H - 1, 0);
+    float *p_hist = pEngine->p_head_hist;
+    memcpy(p_hist + H_past, p_in, B * sizeof(float));
+
+    int i = 0;
+    for (; i + DAFX_SIMD_LANES <= B; i += DAFX_SIMD_LANES)
+    {
+        t_dafx_v4f acc = dafx_v4f_loadu(p_ring + ((pEngine->ring_pos + i) & mask));
+        for (int t = 0; t < H; t++) {
+            acc = dafx_v4f_madd(dafx_v4f_set1(pIR->p_head[t]), dafx_v4f_loadu(p_hist + i + t), acc);
+        }
+        dafx_v4f_storeu(p_out + i, acc);
+    }
+    for (; i < B; i++)
+    {
+        float acc = p_ring[(pEngine->ring_pos + i) & mask];
+        for (int t = 0; t < H; t++) {
+            acc += pIR->p_head[t] * p_hist[i + t];
+        }
+        p_out[i] = acc;
+    }
+
+    if (H_past > 0) {
+        memmove(p_hist, p_hist + B, H_past * sizeof(float));
+    }
+
+    //the block has been read out: clear it for the results to come
+    for (i = 0; i < B; i++) {
+        p_ring[(pEngine->ring_pos + i) & mask] = 0.0f;
+    }
+    pEngine->ring_pos = (pEngine->ring_pos + B) & mask;
+
+    DAFX_DenormalGuardEnd(&fp_state);
+
+    //done with the engine read at the start of the block (see CONV_ReleaseRetiredIR)
+    DAFX_ATOMIC_STORE(pCONV->num_blocks, pCONV->num_blocks + 1);
+
+    return true;
+}
+
+bool DAFXBypassConvolver(t_DAFXConvolver *pCONV)
+{
+    memcpy(pCONV->p_output_block, pCONV->p_input_block, pCONV->block_size * sizeof(float));
+    DAFX_ATOMIC_STORE(pCONV->num_blocks, pCONV->num_blocks + 1);
+    return true;
+}
+
+void DeallocDAFXConvolver(t_DAFXConvolver *pCONV)
+{
+    if(pCONV != NULL) {
+        FREE(pCONV->p_input_block);
+        FREE(pCONV->p_output_block);
+        CONV_ReleaseRetiredIR(pCONV, true);
+        _FreeEngine(pCONV->p_engine);
+        pCONV->p_engine = NULL;
+    }
+}
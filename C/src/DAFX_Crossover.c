@@ -5,9 +5,10 @@
 
 #include "DAFX_Crossover.h"
 #include "DAFX_InitCrossover.h"
-#include "DAFX_BiquadFilter.h"
+#include "DAFX_SOSCascade.h"
 #include "DAFX_InitBiquadFilter.h"
 #include "DAFX_definitions.h"
+#include "DAFX_Denormal.h"
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 #include <math.h>
@@ -75,11 +76,10 @@ bool XOVER_SetCutoffFrequency(t_DAFXCrossover *pXOVER, int fc)
     pXOVER->p_hp_butter_coeffs[4] = a1_hp;
     pXOVER->p_hp_butter_coeffs[5] = a2_hp;
     
-    //Set up LP and HP biquad filter coeffs
+    //Set up LP and HP stage coeffs
     for (int i = 0; i < pXOVER->num_cascades; i++) {
-        //Yet another copy operation inside this set function - complete bullshit implementation
-        SetBiquadFilterCoeffs(pXOVER->pp_lp_biquads[i], pXOVER->p_lp_butter_coeffs);
-        SetBiquadFilterCoeffs(pXOVER->pp_hp_biquads[i], pXOVER->p_hp_butter_coeffs);
+        SetSOSCascadeStageCoeffs(pXOVER->p_lp_cascade, i, pXOVER->p_lp_butter_coeffs);
+        SetSOSCascadeStageCoeffs(pXOVER->p_hp_cascade, i, pXOVER->p_hp_butter_coeffs);
     }
     
     return true;
@@ -87,7 +87,27 @@ bool XOVER_SetCutoffFrequency(t_DAFXCrossover *pXOVER, int fc)
 
 bool XOVER_SetCascadeOrder(t_DAFXCrossover *pXOVER, int order)
 {
-    //Not implemented yet
+    //order == number of cascaded biquads in each channel
+    order = DAFX_MAX(DAFX_MIN(order, XOVER_MAX_NUMOF_BIQUADS), 1);
+    if (order == pXOVER->num_cascades)
+        return true;
+    
+    pXOVER->num_cascades = order;
+    
+    //the cascades were allocated for the maximum order, only the stages in use change
+    SetSOSCascadeNumStages(pXOVER->p_lp_cascade, order);
+    SetSOSCascadeNumStages(pXOVER->p_hp_cascade, order);
+    
+    //coeffs are shared across the stages, only need to be redistributed
+    for (int i = 0; i < pXOVER->num_cascades; i++) {
+        SetSOSCascadeStageCoeffs(pXOVER->p_lp_cascade, i, pXOVER->p_lp_butter_coeffs);
+        SetSOSCascadeStageCoeffs(pXOVER->p_hp_cascade, i, pXOVER->p_hp_butter_coeffs);
+    }
+    
+    //the states of the other order do not belong to this filter
+    ResetSOSCascade(pXOVER->p_lp_cascade);
+    ResetSOSCascade(pXOVER->p_hp_cascade);
+    
     return true;
 }
 
@@ -108,35 +128,16 @@ bool InitDAFXCrossover(t_DAFXCrossover *pXOVER)
     pXOVER->p_lp_butter_coeffs = (float *) calloc(BIQUAD_DENOMINATOR_SIZE + BIQUAD_NUMERATOR_SIZE, sizeof(float));
     pXOVER->p_hp_butter_coeffs = (float *) calloc(BIQUAD_DENOMINATOR_SIZE + BIQUAD_NUMERATOR_SIZE, sizeof(float));
     
-    pXOVER->pp_lp_biquads = (t_DAFX_BiquadFilter **) malloc(pXOVER->num_cascades * sizeof(t_DAFX_BiquadFilter *));
-    pXOVER->pp_hp_biquads = (t_DAFX_BiquadFilter **) malloc(pXOVER->num_cascades * sizeof(t_DAFX_BiquadFilter *));
-    for (int i = 0; i < pXOVER->num_cascades; i++) {
-        pXOVER->pp_lp_biquads[i] = (t_DAFX_BiquadFilter *) calloc(1, sizeof(t_DAFX_BiquadFilter));
-        pXOVER->pp_hp_biquads[i] = (t_DAFX_BiquadFilter *) calloc(1, sizeof(t_DAFX_BiquadFilter));
-    }
-    
-    //Init and set up LP and HP biquad filters
-    for (int i = 0; i < pXOVER->num_cascades; i++) {
-        pXOVER->pp_lp_biquads[i]->buffer_len = block_size;
-        pXOVER->pp_hp_biquads[i]->buffer_len = block_size;
-        InitBiquadFilter(pXOVER->pp_lp_biquads[i]);
-        InitBiquadFilter(pXOVER->pp_hp_biquads[i]);
-    }
-    
-    //Connecting biquad filters - again, stupid implementation because now there are
-    //some output sample buffers that are allocated but never used. I DONT CARE
-    for (int i = 1; i < pXOVER->num_cascades; i++) {
-        pXOVER->pp_lp_biquads[i-1]->pOutBuff = pXOVER->pp_lp_biquads[i]->pInBuff;
-        pXOVER->pp_hp_biquads[i-1]->pOutBuff = pXOVER->pp_hp_biquads[i]->pInBuff;
-    }
-    
-    //connect the input buffer to the first biquad of each channel
-    pXOVER->pp_lp_biquads[0]->pInBuff = pXOVER->p_input_block;
-    pXOVER->pp_hp_biquads[0]->pInBuff = pXOVER->p_input_block;
-    
-    //connect the output buffers of the last biquads to the main outputs
-    pXOVER->pp_lp_biquads[pXOVER->num_cascades-1]->pOutBuff = pXOVER->pp_output_blocks[0];
-    pXOVER->pp_hp_biquads[pXOVER->num_cascades-1]->pOutBuff = pXOVER->pp_output_blocks[1];
+    //LP and HP cascades - all stages of a channel share a single memory block
+    pXOVER->p_lp_cascade = (t_DAFX_SOSCascade *) calloc(1, sizeof(t_DAFX_SOSCascade));
+    pXOVER->p_hp_cascade = (t_DAFX_SOSCascade *) calloc(1, sizeof(t_DAFX_SOSCascade));
+    //allocated once for the highest order, so the order can change while running
+    pXOVER->p_lp_cascade->num_stages = XOVER_MAX_NUMOF_BIQUADS;
+    pXOVER->p_hp_cascade->num_stages = XOVER_MAX_NUMOF_BIQUADS;
+    if (!InitSOSCascade(pXOVER->p_lp_cascade) || !InitSOSCascade(pXOVER->p_hp_cascade))
+        return false;
+    SetSOSCascadeNumStages(pXOVER->p_lp_cascade, pXOVER->num_cascades);
+    SetSOSCascadeNumStages(pXOVER->p_hp_cascade, pXOVER->num_cascades);
     
     //calculating and setting up coeffs
     XOVER_SetCutoffFrequency(pXOVER, XOVER_INIT_FC_HZ);
@@ -146,10 +147,14 @@ bool InitDAFXCrossover(t_DAFXCrossover *pXOVER)
 
 bool DAFXProcessCrossover(t_DAFXCrossover *pXOVER)
 {
-    for (int i = 0; i < pXOVER->num_cascades; i++) {
-        ProcessBlockBiquad(pXOVER->pp_lp_biquads[i]);
-        ProcessBlockBiquad(pXOVER->pp_hp_biquads[i]);
-    }
+    t_dafx_fp_state fp_state;
+    
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    ProcessBlockSOSCascade(pXOVER->p_lp_cascade, pXOVER->p_input_block, pXOVER->pp_output_blocks[0], pXOVER->block_size);
+    ProcessBlockSOSCascade(pXOVER->p_hp_cascade, pXOVER->p_input_block, pXOVER->pp_output_blocks[1], pXOVER->block_size);
+    
+    DAFX_DenormalGuardEnd(&fp_state);
     
     return true;
 }
@@ -171,12 +176,8 @@ void DeallocDAFXCrossover(t_DAFXCrossover *pXOVER)
     FREE(pXOVER->pp_output_blocks);
     FREE(pXOVER->p_lp_butter_coeffs);
     FREE(pXOVER->p_hp_butter_coeffs);
-    for (int i = 0; i < pXOVER->num_cascades; i++) {
-        //DeallocBiquadFilter(pXOVER->pp_lp_biquads[i]);
-        FREE(pXOVER->pp_lp_biquads[i]);
-        //DeallocBiquadFilter(pXOVER->pp_hp_biquads[i]);
-        FREE(pXOVER->pp_hp_biquads[i]);
-    }
-    FREE(pXOVER->pp_lp_biquads);
-    FREE(pXOVER->pp_hp_biquads);
+    DeallocSOSCascade(pXOVER->p_lp_cascade);
+    DeallocSOSCascade(pXOVER->p_hp_cascade);
+    FREE(pXOVER->p_lp_cascade);
+    FREE(pXOVER->p_hp_cascade);
 }
@@ -5,10 +5,13 @@
 
 #include "DAFX_Crybaby.h"
 #include "DAFX_InitCrybaby.h"
-#include "DAFX_BiquadFilter.h"
+#include "DAFX_SOSCascade.h"
 #include "DAFX_InitBiquadFilter.h"
 #include "DAFX_LowFrequencyOscillator.h"
+#include "DAFX_ControlRate.h"
+#include "DAFX_EnvelopeFollower.h"
 #include "DAFX_definitions.h"
+#include "DAFX_Denormal.h"
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 #include <math.h>
@@ -24,7 +27,17 @@ bool Crybaby_ReinitLFOPhase(t_DAFXCrybaby *pCB)
 
 bool Crybaby_SetLFOMode(t_DAFXCrybaby *pCB, t_lfo_algo_select mode)
 {
+    t_lfo_algo_select prev_mode = pCB->pLFO->algo;
+    
     LFO_SetMode(pCB->pLFO, mode);
+    
+    //the bus slot carries the shape: move to the one of the new shape (kept as it was if the bus is full)
+    if (pCB->p_mod_bus != NULL && pCB->pLFO->algo != prev_mode &&
+        !Crybaby_SetModulationBus(pCB, pCB->p_mod_bus, pCB->mod_division, pCB->mod_phase_offset))
+    {
+        LFO_SetMode(pCB->pLFO, prev_mode);
+        return false;
+    }
     return true;
 }
 
@@ -65,6 +78,174 @@ bool Crybaby_SetLFOClipLow(t_DAFXCrybaby *pCB, float clip_l)
     return true;
 }
 
+bool Crybaby_SetCoeffUpdateMode(t_DAFXCrybaby *pCB, t_cb_coeff_update_mode mode)
+{
+    if ((int)mode >= 0 && mode < Crybaby_N_COEFF_UPDATE_MODES)
+        pCB->coeff_update_mode = mode;
+    return true;
+}
+
+bool Crybaby_SetModSource(t_DAFXCrybaby *pCB, t_cb_mod_source source)
+{
+    if ((int)source >= 0 && source < Crybaby_N_MOD_SOURCES)
+        pCB->mod_source = source;
+    return true;
+}
+
+bool Crybaby_SetEnvDetector(t_DAFXCrybaby *pCB, t_env_detector detector)
+{
+    ENV_SetDetector(pCB->pENV, detector);
+    return true;
+}
+
+bool Crybaby_SetEnvAttack(t_DAFXCrybaby *pCB, float attack_ms)
+{
+    ENV_SetAttackMs(pCB->pENV, attack_ms);
+    return true;
+}
+
+bool Crybaby_SetEnvRelease(t_DAFXCrybaby *pCB, float release_ms)
+{
+    ENV_SetReleaseMs(pCB->pENV, release_ms);
+    return true;
+}
+
+bool Crybaby_SetEnvSensitivity(t_DAFXCrybaby *pCB, float sensitivity_db)
+{
+    ENV_SetSensitivityDb(pCB->pENV, sensitivity_db);
+    return true;
+}
+
+bool Crybaby_SetEnvRange(t_DAFXCrybaby *pCB, float pedal_lo, float pedal_hi)
+{
+    ENV_SetRange(pCB->pENV, pedal_lo, pedal_hi);
+    return true;
+}
+
+bool Crybaby_SetControlPeriod(t_DAFXCrybaby *pCB, int period)
+{
+    CTRL_SetPeriod(pCB->p_ctrl, period);
+    return true;
+}
+
+bool Crybaby_SetModulationBus(t_DAFXCrybaby *pCB, t_DAFX_ModulationBus *pBUS, float division, float phase_offset)
+{
+    int slot = -1;
+    
+    if (pBUS != NULL)
+    {
+        if (pBUS->block_size != pCB->block_size)
+            return false;
+        
+        slot = MODBUS_Subscribe(pBUS, pCB->pLFO->algo, division, phase_offset);
+        if (slot < 0)
+            return false;
+    }
+    
+    t_DAFX_ModulationBus *pOldBUS = pCB->p_mod_bus;
+    int old_slot = pCB->mod_slot;
+    
+    //the slot first, the bus published last: a block that sees the new bus sees its slot too
+    DAFX_ATOMIC_STORE(pCB->mod_slot, slot);
+    DAFX_ATOMIC_STORE(pCB->p_mod_bus, pBUS);
+    pCB->mod_division = division;
+    pCB->mod_phase_offset = phase_offset;
+    
+    //the old slot may be handed out again from here on
+    if (pOldBUS != NULL)
+        MODBUS_Unsubscribe(pOldBUS, old_slot);
+    
+    return true;
+}
+
+//Filter constants that only depend on fs (the pedal moves the denominator only)
+static void _DesignFilterConstants(t_DAFXCrybaby *pCB)
+{
+    //Useful params
+    float w0 = 2.0 * ONE_PI * CB_INIT_F0 / (float)pCB->fs;
+    float c = cosf(w0);
+    float s = sinf(w0);
+    float alpha = s / (2.0 * CB_INIT_Q);
+    
+    //high-pass filter coeffs
+    float b0h = (1.0 + c) * 0.5;
+    float b1h = -(1.0 + c);
+    float b2h = (1.0 + c) * 0.5;
+    
+    //bandpass filter coeffs
+    float b0b = CB_INIT_Q * alpha;
+    //float b1b = 0.0;
+    float b2b = -1.0*CB_INIT_Q * alpha;
+    pCB->a0b = 1.0 + alpha;
+    pCB->a1b = -2.0 * c;
+    pCB->a2b = 1.0 - alpha;
+    
+    //numerator coeffs
+    pCB->b0 = CB_INIT_GBPF * b0b + CB_INIT_GI * pCB->a0b;
+    pCB->b1 = CB_INIT_GI * pCB->a1b;
+    pCB->b2 = CB_INIT_GBPF * b2b + CB_INIT_GI * pCB->a2b;
+    
+    // Constants to make denominator coefficients computation more efficient
+    pCB->a0c = -1.0*CB_INIT_GF * b0h;
+    pCB->a1c = -1.0*CB_INIT_GF * b1h;
+    pCB->a2c = -1.0*CB_INIT_GF * b2h;
+}
+
+//Normalized denominator coeffs for a knob value
+static void _ExactFeedbackCoeffs(t_DAFXCrybaby *pCB, float gp, float *p_a1, float *p_a2)
+{
+    float ax = 1.0 / (pCB->a0b + gp * pCB->a0c);
+    *p_a1 = (pCB->a1b + gp * pCB->a1c) * ax;
+    *p_a2 = (pCB->a2b + gp * pCB->a2c) * ax;
+}
+
+//a1, a2 on CB_PEDAL_TABLE_SIZE evenly spaced pedal positions from CB_PEDAL_MIN to CB_PEDAL_MAX
+static void _BuildPedalTable(t_DAFXCrybaby *pCB)
+{
+    for (int i = 0; i < CB_PEDAL_TABLE_SIZE; i++)
+    {
+        float gx = CB_PEDAL_MIN + (float)i * ((CB_PEDAL_MAX - CB_PEDAL_MIN) / (float)(CB_PEDAL_TABLE_SIZE - 1));
+        
+        // Ever so slight gain adjustment to match analog curves.
+        // This is not necessary in a real implementation since it represents
+        // a fraction of a degree tilt on the treadle (6 degrees pot rotation)
+        _ExactFeedbackCoeffs(pCB, gx * (1.0 + CB_PEDAL_GAIN_TILT), &pCB->p_pedal_table[2 * i], &pCB->p_pedal_table[2 * i + 1]);
+    }
+    pCB->pedal_table_fs = pCB->fs;
+}
+
+bool Crybaby_SetSampleRate(t_DAFXCrybaby *pCB, int fs)
+{
+    if (fs <= 0)
+        return false;
+    
+    pCB->fs = fs;
+    
+    //modulation sources
+    pCB->pLFO->fs = fs;
+    LFO_SetFrequency(pCB->pLFO, pCB->pLFO->f);
+    pCB->pENV->fs = fs;
+    pCB->pENV->coeff_period = 0; //coeffs recomputed with the next block
+    
+    //the filter constants and the table only depend on fs
+    if (fs != pCB->pedal_table_fs)
+    {
+        _DesignFilterConstants(pCB);
+        _BuildPedalTable(pCB);
+        
+        //same knob value, new coeffs
+        _ExactFeedbackCoeffs(pCB, pCB->gp, &pCB->a1, &pCB->a2);
+        pCB->p_biquad_coeffs[0] = pCB->b0;
+        pCB->p_biquad_coeffs[1] = pCB->b1;
+        pCB->p_biquad_coeffs[2] = pCB->b2;
+        pCB->p_biquad_coeffs[4] = pCB->a1;
+        pCB->p_biquad_coeffs[5] = pCB->a2;
+        SetSOSCascadeStageCoeffs(pCB->p_biquad, 0, pCB->p_biquad_coeffs);
+    }
+    
+    return true;
+}
+
 bool InitDAFXCrybaby(t_DAFXCrybaby *pCB)
 {
     //Signal vector size
@@ -75,7 +256,7 @@ bool InitDAFXCrybaby(t_DAFXCrybaby *pCB)
     pCB->p_input_block = (float *) calloc(block_size, sizeof(float));
     pCB->p_output_block = (float *) calloc(block_size, sizeof(float));
     pCB->p_biquad_coeffs = (float *) calloc(BIQUAD_DENOMINATOR_SIZE + BIQUAD_NUMERATOR_SIZE, sizeof(float));
-    pCB->p_biquad = (t_DAFX_BiquadFilter *) calloc(1, sizeof(t_DAFX_BiquadFilter));
+    pCB->p_biquad = (t_DAFX_SOSCascade *) calloc(1, sizeof(t_DAFX_SOSCascade));
     
     //allocate and init LFO
     pCB->pLFO = (t_DAFXLowFrequencyOscillator *) calloc(1, sizeof(t_DAFXLowFrequencyOscillator));
@@ -83,6 +264,26 @@ bool InitDAFXCrybaby(t_DAFXCrybaby *pCB)
     pCB->pLFO->block_size = block_size;
     InitDAFXLowFrequencyOscillator(pCB->pLFO);
     LFO_SetMode(pCB->pLFO, CB_INIT_LFO_MODE);
+    pCB->p_mod_bus = NULL;
+    pCB->mod_slot = -1;
+    pCB->mod_division = 1.0;
+    pCB->mod_phase_offset = 0.0;
+    
+    //allocate and init control-rate track
+    pCB->p_ctrl = (t_DAFX_ControlRate *) calloc(1, sizeof(t_DAFX_ControlRate));
+    pCB->p_ctrl->block_size = block_size;
+    pCB->p_ctrl->max_period = CB_CTRL_MAX_PERIOD;
+    InitControlRate(pCB->p_ctrl);
+    Crybaby_SetControlPeriod(pCB, CB_INIT_CTRL_PERIOD);
+    
+    //allocate and init envelope follower (dynamics-driven auto-wah)
+    pCB->pENV = (t_DAFXEnvelopeFollower *) calloc(1, sizeof(t_DAFXEnvelopeFollower));
+    pCB->pENV->block_size = block_size;
+    pCB->pENV->fs = fs;
+    InitDAFXEnvelopeFollower(pCB->pENV);
+    ENV_SetRange(pCB->pENV, CB_INIT_ENV_PEDAL_LO, CB_INIT_ENV_PEDAL_HI);
+    pCB->mod_source = CB_INIT_MOD_SOURCE;
+    pCB->pedal_period = pCB->block_size;
     LFO_SetFrequency(pCB->pLFO, CB_INIT_LFO_FREQ_HZ);
     LFO_SetAmplitude(pCB->pLFO, CB_INIT_LFO_AMP);
     LFO_SetOffset(pCB->pLFO, CB_INIT_LFO_OFFSET);
@@ -90,49 +291,23 @@ bool InitDAFXCrybaby(t_DAFXCrybaby *pCB)
     LFO_SetClipLow(pCB->pLFO, CB_INIT_LFO_CLIP_L);
     LFO_SetBalance(pCB->pLFO, CB_INIT_LFO_BALANCE);
    
-    //Useful params
-    float w0 = 2.0 * ONE_PI * CB_INIT_F0 / (float)fs;
-    float c = cosf(w0);
-    float s = sinf(w0);
-    float alpha = s / (2.0 * CB_INIT_Q);
-    
     //init knob value
     pCB->gp = 0.0;
     
     //balance between clean and wah-ed signal
     pCB->wah_balance = CB_INIT_WAH_BALANCE;
     
-    //high-pass filter coeffs
-    float b0h = (1.0 + c) * 0.5;
-    float b1h = -(1.0 + c);
-    float b2h = (1.0 + c) * 0.5;
-    float a0h = 1.0 + alpha;
-    float a1h = -2.0 * c;
-    float a2h = 1.0 - alpha;
+    //auto-wah: filter designed once per block by default
+    pCB->coeff_update_mode = CB_INIT_COEFF_UPDATE_MODE;
     
-    //bandpass filter coeffs
-    float b0b = CB_INIT_Q * alpha;
-    //float b1b = 0.0;
-    float b2b = -1.0*CB_INIT_Q * alpha;
-    pCB->a0b = 1.0 + alpha;
-    pCB->a1b = -2.0 * c;
-    pCB->a2b = 1.0 - alpha;
-    
-    //numerator coeffs
-    pCB->b0 = CB_INIT_GBPF * b0b + CB_INIT_GI * pCB->a0b;
-    pCB->b1 = CB_INIT_GI * pCB->a1b;
-    pCB->b2 = CB_INIT_GBPF * b2b + CB_INIT_GI * pCB->a2b;
-    
-    // Constants to make denominator coefficients computation more efficient
-    pCB->a0c = -1.0*CB_INIT_GF * b0h;
-    pCB->a1c = -1.0*CB_INIT_GF * b1h;
-    pCB->a2c = -1.0*CB_INIT_GF * b2h;
+    //fs dependent constants and the pedal position table
+    pCB->p_pedal_table = (float *) calloc(2 * CB_PEDAL_TABLE_SIZE, sizeof(float));
+    pCB->pedal_table_scale = (float)(CB_PEDAL_TABLE_SIZE - 1) / (CB_PEDAL_MAX - CB_PEDAL_MIN);
+    _DesignFilterConstants(pCB);
+    _BuildPedalTable(pCB);
     
     //denominator coeffs (init)
-    pCB->a0 = pCB->a0b + pCB->gp * pCB->a0c;
-    float ax = 1.0 / pCB->a0;
-    pCB->a1 = (pCB->a1b + pCB->gp * pCB->a1c) * ax;
-    pCB->a2 = (pCB->a2b + pCB->gp * pCB->a2c) * ax;
+    _ExactFeedbackCoeffs(pCB, pCB->gp, &pCB->a1, &pCB->a2);
     pCB->a0 = 1.0;
     
     //coeffs are being copied - not the nicest implementation
@@ -143,45 +318,39 @@ bool InitDAFXCrybaby(t_DAFXCrybaby *pCB)
     pCB->p_biquad_coeffs[4] = pCB->a1;
     pCB->p_biquad_coeffs[5] = pCB->a2;
 
-    //Init biquad filter
-    pCB->p_biquad->buffer_len = block_size;
-    InitBiquadFilter(pCB->p_biquad);
-    SetBiquadFilterCoeffs(pCB->p_biquad, pCB->p_biquad_coeffs);
+    //Init biquad filter (single stage cascade)
+    pCB->p_biquad->num_stages = 1;
+    InitSOSCascade(pCB->p_biquad);
+    SetSOSCascadeStageCoeffs(pCB->p_biquad, 0, pCB->p_biquad_coeffs);
     
     return true;
 }
 
-bool UpdatePedalPos(t_DAFXCrybaby *pCB, float pedal_pos)
+//Looks up the coeffs belonging to a pedal position into p_biquad_coeffs
+//(only a1 and a2 move with the pedal, b0, b1, b2 and a0 = 1 are constant)
+static inline void _LookupPedalPosCoeffs(t_DAFXCrybaby *pCB, float pedal_pos)
 {
     // bound the pedal pos. between min and max values
     float gx = DAFX_MAX(DAFX_MIN(pedal_pos, CB_PEDAL_MAX), CB_PEDAL_MIN);
     
-    // Ever so slight gain adjustment to match analog curves.
-    // This is not necessary in a real implementation since it represents
-    // a fraction of a degree tilt on the treadle (6 degrees pot rotation)
-    float aa = -0.15;
-    pCB->gp = gx * (1.0 + aa);
-    
-    // denominator coefficients need to be computed for every change in the pot position
-    // This costs 3 multiply and add plus a single 1/x operation for computation of coefficients
-    // Then add 2 more multiplications for denominator and one for numerator.
-    // Sum is 6 multiply and one 1/x operation per sample.  It's approximately the same
-    // as running 2 fixed biquad filters, so not too bad when all is refactored
-    pCB->a0 = pCB->a0b + pCB->gp * pCB->a0c;
-    float ax = 1.0 / pCB->a0;
-    pCB->a1 = (pCB->a1b + pCB->gp * pCB->a1c) * ax;
-    pCB->a2 = (pCB->a2b + pCB->gp * pCB->a2c) * ax;
-    pCB->a0 = 1.0;
+    //linear interpolation between the two nearest table points
+    float x = (gx - CB_PEDAL_MIN) * pCB->pedal_table_scale;
+    int i = DAFX_MIN((int)x, CB_PEDAL_TABLE_SIZE - 2);
+    float frac = x - (float)i;
+    float *t = pCB->p_pedal_table + 2 * i;
+    
+    pCB->gp = gx * (1.0 + CB_PEDAL_GAIN_TILT);
+    pCB->a1 = t[0] + frac * (t[2] - t[0]);
+    pCB->a2 = t[1] + frac * (t[3] - t[1]);
     
-    //coeffs are being copied - not the nicest implementation
-    pCB->p_biquad_coeffs[0] = pCB->b0;
-    pCB->p_biquad_coeffs[1] = pCB->b1;
-    pCB->p_biquad_coeffs[2] = pCB->b2;
-    pCB->p_biquad_coeffs[3] = pCB->a0;
     pCB->p_biquad_coeffs[4] = pCB->a1;
     pCB->p_biquad_coeffs[5] = pCB->a2;
-    
-    SetBiquadFilterCoeffs(pCB->p_biquad, pCB->p_biquad_coeffs);
+}
+
+bool UpdatePedalPos(t_DAFXCrybaby *pCB, float pedal_pos)
+{
+    _LookupPedalPosCoeffs(pCB, pedal_pos);
+    SetSOSCascadeStageFeedbackCoeffs(pCB->p_biquad, 0, pCB->a1, pCB->a2);
     
     return true;
 }
@@ -190,52 +359,126 @@ bool DAFXProcessCrybaby(t_DAFXCrybaby *pCB)
 {
     float *p_input_block = pCB->p_input_block;
     float *p_output_block = pCB->p_output_block;
-    float *p_bq_inbuf = pCB->p_biquad->pInBuff;
-    float *p_bq_outbuf = pCB->p_biquad->pOutBuff;
     float balance = pCB->wah_balance;
     float inv_balance = 1.0 - pCB->wah_balance;
+    t_dafx_fp_state fp_state;
     
-    //copying samples to biquad input buffer (I know I know... I don't care now.)
-    for (int i = 0; i < pCB->block_size; i++) {
-        p_bq_inbuf[i] = p_input_block[i];
-    }
+    DAFX_DenormalGuardBegin(&fp_state);
     
-    ProcessBlockBiquad(pCB->p_biquad);
+    //filter straight into the output block
+    ProcessBlockSOSCascade(pCB->p_biquad, p_input_block, p_output_block, pCB->block_size);
     
     //summing the wah-ed and clean signals
     for (int i = 0; i < pCB->block_size; i++) {
-        p_output_block[i] = balance * p_bq_outbuf[i] + inv_balance * p_input_block[i];
+        p_output_block[i] = balance * p_output_block[i] + inv_balance * p_input_block[i];
     }    
     
+    DAFX_DenormalGuardEnd(&fp_state);
+    
     return true;
 }
 
+//Pedal positions for the last sample of every control period, from the modulation source
+static void _PedalControlPoints(t_DAFXCrybaby *pCB, int period, float *p_points)
+{
+    int num_points = pCB->block_size / period;
+    
+    pCB->pedal_period = period;
+    
+    if (pCB->mod_source == CB_MOD_SOURCE_ENVELOPE)
+    {
+        //the envelope range is set in pedal positions
+        DAFXEnvelopeFollower(pCB->pENV, pCB->p_input_block, period, p_points);
+        for (int k = 0; k < num_points; k++) {
+            p_points[k] = DAFX_MAX(DAFX_MIN(p_points[k], CB_PEDAL_MAX), CB_PEDAL_MIN);
+        }
+        return;
+    }
+    
+    //LFO (or the shared modulator mapped through the LFO's depth settings)
+    //read once: the bus may be switched by the message thread (see Crybaby_SetModulationBus)
+    t_DAFX_ModulationBus *pBUS = DAFX_ATOMIC_LOAD(pCB->p_mod_bus);
+    int slot = DAFX_ATOMIC_LOAD(pCB->mod_slot);
+    if (pBUS != NULL && slot >= 0) {
+        MODBUS_RenderControlRate(pBUS, slot, pCB->pLFO, period, p_points);
+    } else {
+        DAFXLowFrequencyOscillatorControlRate(pCB->pLFO, period, p_points);
+    }
+    for (int k = 0; k < num_points; k++) {
+        float pedal_pos = DAFX_MAX(DAFX_MIN(p_points[k], CB_PEDAL_MAX), CB_PEDAL_MIN);
+        p_points[k] = 1.0 - pedal_pos;
+    }
+}
+
 bool DAFXProcessAutoCrybaby(t_DAFXCrybaby *pCB)
 {
     float *p_input_block = pCB->p_input_block;
     float *p_output_block = pCB->p_output_block;
     float balance = pCB->wah_balance;
     float inv_balance = 1.0 - pCB->wah_balance;
-    float *p_lfo_buff = pCB->pLFO->p_output_block;
+    t_DAFX_ControlRate *pCTRL = pCB->p_ctrl;
+    float *p_points = CTRL_GetPoints(pCTRL);
+    t_dafx_fp_state fp_state;
     
-    float pedal_pos, out;
+    DAFX_DenormalGuardBegin(&fp_state);
     
-    //First, generate the LFO signal with a single call to its sample generator function
-    DAFXLowFrequencyOscillator(pCB->pLFO);
-    
-    //Loop through the input buffers (signal buff and LFO control buff are of same length)
-    // --> update pedal position, re-generate coeffs, process filter
-    for (int i = 0; i < pCB->block_size; i++)
+    switch (pCB->coeff_update_mode)
     {
-        pedal_pos = DAFX_MAX(DAFX_MIN(p_lfo_buff[i], CB_PEDAL_MAX), CB_PEDAL_MIN);
-        pedal_pos = 1.0 - pedal_pos;
-        
-        UpdatePedalPos(pCB, pedal_pos);
-        out = ProcessSingleSampleBiquad(pCB->p_biquad, p_input_block[i]);
-        
-        p_output_block[i] = balance * out + inv_balance * p_input_block[i];
+        case CB_COEFF_UPDATE_CONTROL_RATE:
+        {
+            //filter designed for every control point, the coeffs are
+            //interpolated from the previous one over the control period
+            int period = pCTRL->period;
+            
+            _PedalControlPoints(pCB, period, p_points);
+            for (int k = 0; k < pCTRL->num_points; k++)
+            {
+                _LookupPedalPosCoeffs(pCB, p_points[k]);
+                ProcessBlockSOSCascadeRamp(pCB->p_biquad, pCB->p_biquad_coeffs, p_input_block + k * period, p_output_block + k * period, period);
+            }
+            CTRL_Advance(pCTRL);
+            break;
+        }
+        case CB_COEFF_UPDATE_BLOCK_RAMP:
+        {
+            //design the filter only for the pedal position at the end of the block,
+            //the coeffs are interpolated from the previous position sample by sample
+            _PedalControlPoints(pCB, pCB->block_size, p_points);
+            _LookupPedalPosCoeffs(pCB, p_points[0]);
+            ProcessBlockSOSCascadeRamp(pCB->p_biquad, pCB->p_biquad_coeffs, p_input_block, p_output_block, pCB->block_size);
+            break;
+        }
+        default:
+        {
+            //update pedal position, look up coeffs, process filter - for every sample
+            _PedalControlPoints(pCB, 1, p_points);
+            for (int i = 0; i < pCB->block_size; i++)
+            {
+                UpdatePedalPos(pCB, p_points[i]);
+                p_output_block[i] = ProcessSingleSampleSOSCascade(pCB->p_biquad, p_input_block[i]);
+            }
+            break;
+        }
+    }
+    
+    //summing the wah-ed and clean signals
+    for (int i = 0; i < pCB->block_size; i++) {
+        p_output_block[i] = balance * p_output_block[i] + inv_balance * p_input_block[i];
     }
     
+    DAFX_DenormalGuardEnd(&fp_state);
+    
+    return true;
+}
+
+bool Crybaby_GetPedalTrack(t_DAFXCrybaby *pCB, float *p_out)
+{
+    float *p_points = CTRL_GetPoints(pCB->p_ctrl);
+    int period = pCB->pedal_period;
+    
+    for (int i = 0; i < pCB->block_size; i++) {
+        p_out[i] = p_points[i / period];
+    }
     return true;
 }
 
@@ -247,8 +490,16 @@ bool DAFXBypassCrybaby(t_DAFXCrybaby *pCB)
 
 void DeallocDAFXCrybaby(t_DAFXCrybaby *pCB)
 {
+    if (pCB->p_mod_bus != NULL)
+        MODBUS_Unsubscribe(pCB->p_mod_bus, pCB->mod_slot);
+    DeallocControlRate(pCB->p_ctrl);
+    FREE(pCB->p_ctrl);
+    DeallocDAFXEnvelopeFollower(pCB->pENV);
+    FREE(pCB->pENV);
     FREE(pCB->p_input_block);
     FREE(pCB->p_output_block);
     FREE(pCB->p_biquad_coeffs);
-    DeallocBiquadFilter(pCB->p_biquad);
+    FREE(pCB->p_pedal_table);
+    DeallocSOSCascade(pCB->p_biquad);
+    FREE(pCB->p_biquad);
 }
@@ -0,0 +1,176 @@
+//
+//  DAFX_EnvelopeFollower.c
+//
+
+#include "DAFX_EnvelopeFollower.h"
+#include "DAFX_InitEnvelopeFollower.h"
+#include "DAFX_definitions.h"
+#include "DAFX_Denormal.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+bool ENV_SetDetector(t_DAFXEnvelopeFollower *pENV, t_env_detector detector)
+{
+    if (detector < EnvelopeFollower_N_DETECTORS && detector != pENV->detector) {
+        pENV->detector = detector;
+        pENV->env = 0.0;
+        pENV->mean_square = 0.0;
+    }
+    return true;
+}
+
+bool ENV_SetAttackMs(t_DAFXEnvelopeFollower *pENV, float attack_ms)
+{
+    pENV->attack_ms = DAFX_MAX(DAFX_MIN(attack_ms, ENV_MAX_TIME_MS), ENV_MIN_TIME_MS);
+    pENV->coeff_period = 0; //coeffs recomputed with the next block
+    return true;
+}
+
+bool ENV_SetReleaseMs(t_DAFXEnvelopeFollower *pENV, float release_ms)
+{
+    pENV->release_ms = DAFX_MAX(DAFX_MIN(release_ms, ENV_MAX_TIME_MS), ENV_MIN_TIME_MS);
+    pENV->coeff_period = 0;
+    return true;
+}
+
+bool ENV_SetSensitivityDb(t_DAFXEnvelopeFollower *pENV, float sensitivity_db)
+{
+    pENV->sensitivity_db = DAFX_MAX(DAFX_MIN(sensitivity_db, ENV_MAX_SENSITIVITY_DB), ENV_MIN_SENSITIVITY_DB);
+    pENV->sensitivity = powf(10.0, pENV->sensitivity_db * 0.05);
+    return true;
+}
+
+bool ENV_SetRange(t_DAFXEnvelopeFollower *pENV, float range_lo, float range_hi)
+{
+    pENV->range_lo = range_lo;
+    pENV->range_hi = range_hi;
+    pENV->range_span = range_hi - range_lo;
+    return true;
+}
+
+bool InitDAFXEnvelopeFollower(t_DAFXEnvelopeFollower *pENV)
+{
+    pENV->detector = ENV_INIT_DETECTOR;
+    pENV->env = 0.0;
+    pENV->mean_square = 0.0;
+    
+    ENV_SetAttackMs(pENV, ENV_INIT_ATTACK_MS);
+    ENV_SetReleaseMs(pENV, ENV_INIT_RELEASE_MS);
+    ENV_SetSensitivityDb(pENV, ENV_INIT_SENSITIVITY_DB);
+    ENV_SetRange(pENV, ENV_INIT_RANGE_LO, ENV_INIT_RANGE_HI);
+    
+    return true;
+}
+
+//one-pole coefficients for one step of period samples
+static void _UpdateCoeffs(t_DAFXEnvelopeFollower *pENV, int period)
+{
+    pENV->k_attack = expf(-(float)period / (0.001f * pENV->attack_ms * (float)pENV->fs));
+    pENV->k_release = expf(-(float)period / (0.001f * pENV->release_ms * (float)pENV->fs));
+    pENV->k_rms = expf(-(float)period / (0.001f * ENV_RMS_WINDOW_MS * (float)pENV->fs));
+    pENV->coeff_period = period;
+}
+
+//largest |x| over n samples
+static float _PeakLevel(const float *p, int n)
+{
+    int i = 0;
+    float peak = 0.0f;
+    
+    if (n >= DAFX_SIMD_LANES)
+    {
+        t_dafx_v4f zero = dafx_v4f_set1(0.0f);
+        t_dafx_v4f m = zero;
+        for (; i + DAFX_SIMD_LANES <= n; i += DAFX_SIMD_LANES) {
+            t_dafx_v4f x = dafx_v4f_loadu(p + i);
+            m = dafx_v4f_max(m, dafx_v4f_max(x, dafx_v4f_sub(zero, x)));
+        }
+        float lanes[DAFX_SIMD_LANES];
+        dafx_v4f_storeu(lanes, m);
+        for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+            peak = DAFX_MAX(peak, lanes[k]);
+        }
+    }
+    for (; i < n; i++) {
+        peak = DAFX_MAX(peak, fabsf(p[i]));
+    }
+    return peak;
+}
+
+//mean of x^2 over n samples
+static float _MeanSquare(const float *p, int n)
+{
+    int i = 0;
+    float sum = 0.0f;
+    
+    if (n >= DAFX_SIMD_LANES)
+    {
+        t_dafx_v4f acc = dafx_v4f_set1(0.0f);
+        for (; i + DAFX_SIMD_LANES <= n; i += DAFX_SIMD_LANES) {
+            t_dafx_v4f x = dafx_v4f_loadu(p + i);
+            acc = dafx_v4f_madd(x, x, acc);
+        }
+        float lanes[DAFX_SIMD_LANES];
+        dafx_v4f_storeu(lanes, acc);
+        for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+            sum += lanes[k];
+        }
+    }
+    for (; i < n; i++) {
+        sum += p[i] * p[i];
+    }
+    return sum / (float)n;
+}
+
+float ENV_GetMappedLevel(t_DAFXEnvelopeFollower *pENV)
+{
+    return pENV->range_lo + pENV->range_span * DAFX_MIN(pENV->sensitivity * pENV->env, 1.0f);
+}
+
+bool DAFXEnvelopeFollower(t_DAFXEnvelopeFollower *pENV, float *p_input, int period, float *p_points)
+{
+    int num_points = pENV->block_size / period;
+    t_dafx_fp_state fp_state;
+    
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    if (period != pENV->coeff_period)
+        _UpdateCoeffs(pENV, period);
+    
+    for (int k = 0; k < num_points; k++)
+    {
+        float *p = p_input + k * period;
+        float level;
+        
+        if (pENV->detector == ENV_DETECT_RMS) {
+            //the mean square is averaged over ENV_RMS_WINDOW_MS first, so that the
+            //attack does not lock onto the crests of low notes
+            float ms = _MeanSquare(p, period);
+            pENV->mean_square = ms + pENV->k_rms * (pENV->mean_square - ms);
+            level = sqrtf(pENV->mean_square);
+        } else {
+            level = _PeakLevel(p, period);
+        }
+        
+        //attack when the level goes up, release when it goes down
+        float coeff = (level > pENV->env) ? pENV->k_attack : pENV->k_release;
+        pENV->env = level + coeff * (pENV->env - level);
+        
+        p_points[k] = ENV_GetMappedLevel(pENV);
+    }
+    
+    DAFX_DenormalGuardEnd(&fp_state);
+    
+    return true;
+}
+
+void DeallocDAFXEnvelopeFollower(t_DAFXEnvelopeFollower *pENV)
+{
+    //nothing allocated
+}
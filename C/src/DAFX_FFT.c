@@ -0,0 +1,227 @@
+//
+//  DAFX_FFT.c
+//
+
+#include "DAFX_FFT.h"
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+//In-place complex FFT of pFFT->half points on split arrays, input already in bit reversed order
+static void _FFTComplexBitrevInput(t_DAFX_FFT *pFFT, float *re, float *im)
+{
+    int m = pFFT->half;
+
+    //first two stages (span 1 and 2) together as one radix-4 pass
+    for (int g = 0; g < m; g += 4)
+    {
+        float r0 = re[g] + re[g+1], i0 = im[g] + im[g+1];
+        float r1 = re[g] - re[g+1], i1 = im[g] - im[g+1];
+        float r2 = re[g+2] + re[g+3], i2 = im[g+2] + im[g+3];
+        float r3 = re[g+2] - re[g+3], i3 = im[g+2] - im[g+3];
+
+        //span 2 twiddles: 1 and -i
+        re[g]   = r0 + r2;  im[g]   = i0 + i2;
+        re[g+2] = r0 - r2;  im[g+2] = i0 - i2;
+        re[g+1] = r1 + i3;  im[g+1] = i1 - r3;
+        re[g+3] = r1 - i3;  im[g+3] = i1 + r3;
+    }
+
+    //remaining stages, four butterflies per vector
+    for (int h = 4; h < m; h <<= 1)
+    {
+        float *tw_re = pFFT->p_tw_re + h;
+        float *tw_im = pFFT->p_tw_im + h;
+
+        for (int g = 0; g < m; g += 2 * h)
+        {
+            float *ar = re + g, *ai = im + g;
+            float *br = re + g + h, *bi = im + g + h;
+
+            for (int j = 0; j < h; j += DAFX_SIMD_LANES)
+            {
+                t_dafx_v4f wr = dafx_v4f_load(tw_re + j);
+                t_dafx_v4f wi = dafx_v4f_load(tw_im + j);
+                t_dafx_v4f xr = dafx_v4f_load(br + j);
+                t_dafx_v4f xi = dafx_v4f_load(bi + j);
+
+                //t = b * w
+                t_dafx_v4f tr = dafx_v4f_sub(dafx_v4f_mul(xr, wr), dafx_v4f_mul(xi, wi));
+                t_dafx_v4f ti = dafx_v4f_madd(xr, wi, dafx_v4f_mul(xi, wr));
+
+                t_dafx_v4f yr = dafx_v4f_load(ar + j);
+                t_dafx_v4f yi = dafx_v4f_load(ai + j);
+
+                dafx_v4f_store(ar + j, dafx_v4f_add(yr, tr));
+                dafx_v4f_store(ai + j, dafx_v4f_add(yi, ti));
+                dafx_v4f_store(br + j, dafx_v4f_sub(yr, tr));
+                dafx_v4f_store(bi + j, dafx_v4f_sub(yi, ti));
+            }
+        }
+    }
+}
+
+bool InitFFT(t_DAFX_FFT *pFFT)
+{
+    int n = pFFT->size;
+
+    if (n < 16 || (n & (n - 1)) != 0)
+        return false;
+
+    int m = n / 2;
+    int log2_m = 0;
+    while ((1 << log2_m) < m) {
+        log2_m++;
+    }
+
+    pFFT->half = m;
+    pFFT->p_tw_re = (float *) DAFX_AlignedCalloc(m, sizeof(float));
+    pFFT->p_tw_im = (float *) DAFX_AlignedCalloc(m, sizeof(float));
+    pFFT->p_split_re = (float *) calloc(m / 2 + 1, sizeof(float));
+    pFFT->p_split_im = (float *) calloc(m / 2 + 1, sizeof(float));
+    pFFT->p_bitrev = (int *) calloc(m, sizeof(int));
+
+    //tables computed in double, stage with span h: exp(-i pi j / h)
+    for (int h = 1; h < m; h <<= 1) {
+        for (int j = 0; j < h; j++) {
+            double w = -ONE_PI * (double)j / (double)h;
+            pFFT->p_tw_re[h + j] = (float)cos(w);
+            pFFT->p_tw_im[h + j] = (float)sin(w);
+        }
+    }
+
+    for (int k = 0; k <= m / 2; k++) {
+        double w = -2.0 * ONE_PI * (double)k / (double)n;
+        pFFT->p_split_re[k] = (float)cos(w);
+        pFFT->p_split_im[k] = (float)sin(w);
+    }
+
+    for (int i = 0; i < m; i++) {
+        int r = 0;
+        for (int b = 0; b < log2_m; b++) {
+            r |= ((i >> b) & 1) << (log2_m - 1 - b);
+        }
+        pFFT->p_bitrev[i] = r;
+    }
+
+    return true;
+}
+
+bool FFTForwardReal(t_DAFX_FFT *pFFT, float *p_in, float *p_re, float *p_im)
+{
+    int m = pFFT->half;
+
+    //z[k] = x[2k] + i x[2k+1], gathered in bit reversed order
+    for (int k = 0; k < m; k++) {
+        int r = pFFT->p_bitrev[k];
+        p_re[k] = p_in[2 * r];
+        p_im[k] = p_in[2 * r + 1];
+    }
+
+    _FFTComplexBitrevInput(pFFT, p_re, p_im);
+
+    //split: with A = Z[k], B = conj(Z[m-k]), E = (A + B) / 2, O = -i (A - B) / 2
+    //X[k] = E + W^k O and X[m-k] = conj(E - W^k O)
+    float z0r = p_re[0];
+    float z0i = p_im[0];
+    p_re[0] = z0r + z0i;   //DC
+    p_im[0] = z0r - z0i;   //Nyquist
+
+    for (int k = 1; k <= m / 2; k++)
+    {
+        float ar = p_re[k], ai = p_im[k];
+        float br = p_re[m - k], bi = -p_im[m - k];
+
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+
+        float wr = pFFT->p_split_re[k], wi = pFFT->p_split_im[k];
+        float tr = wr * or_ - wi * oi;
+        float ti = wr * oi + wi * or_;
+
+        p_re[k] = er + tr;
+        p_im[k] = ei + ti;
+        p_re[m - k] = er - tr;
+        p_im[m - k] = -(ei - ti);
+    }
+
+    return true;
+}
+
+bool FFTInverseReal(t_DAFX_FFT *pFFT, float *p_re, float *p_im, float *p_out)
+{
+    int m = pFFT->half;
+
+    //undo the split (without the 1/2 factors, so the result comes out scaled by size):
+    //E = X[k] + conj(X[m-k]), W^k O = X[k] - conj(X[m-k]), Z[k] = E + i O, Z[m-k] = conj(E - i O)
+    float dc = p_re[0];
+    float ny = p_im[0];
+    p_re[0] = dc + ny;
+    p_im[0] = dc - ny;
+
+    for (int k = 1; k <= m / 2; k++)
+    {
+        float ar = p_re[k], ai = p_im[k];
+        float br = p_re[m - k], bi = -p_im[m - k];
+
+        float er = ar + br, ei = ai + bi;
+        float dr = ar - br, di = ai - bi;
+
+        //O = (W^k O) * conj(W^k)
+        float wr = pFFT->p_split_re[k], wi = pFFT->p_split_im[k];
+        float or_ = dr * wr + di * wi;
+        float oi = di * wr - dr * wi;
+
+        //the inverse runs as a forward FFT on the conjugate: store conj(Z)
+        p_re[k] = er - oi;
+        p_im[k] = -(ei + or_);
+        p_re[m - k] = er + oi;
+        p_im[m - k] = ei - or_;
+    }
+
+    //conj(Z[0])
+    p_im[0] = -p_im[0];
+
+    //in-place bit reversal
+    for (int k = 0; k < m; k++)
+    {
+        int r = pFFT->p_bitrev[k];
+        if (r > k)
+        {
+            float t = p_re[k]; p_re[k] = p_re[r]; p_re[r] = t;
+            t = p_im[k]; p_im[k] = p_im[r]; p_im[r] = t;
+        }
+    }
+
+    _FFTComplexBitrevInput(pFFT, p_re, p_im);
+
+    //z = conj(FFT(conj(Z))), x[2k] = Re z[k], x[2k+1] = Im z[k]
+    for (int k = 0; k < m; k++) {
+        p_out[2 * k] = p_re[k];
+        p_out[2 * k + 1] = -p_im[k];
+    }
+
+    return true;
+}
+
+void DeallocFFT(t_DAFX_FFT *pFFT)
+{
+    if(pFFT != NULL) {
+        DAFX_AlignedFree(pFFT->p_tw_re);
+        DAFX_AlignedFree(pFFT->p_tw_im);
+        FREE(pFFT->p_split_re);
+        FREE(pFFT->p_split_im);
+        FREE(pFFT->p_bitrev);
+        pFFT->p_tw_re = NULL;
+        pFFT->p_tw_im = NULL;
+        pFFT->p_split_re = NULL;
+        pFFT->p_split_im = NULL;
+        pFFT->p_bitrev = NULL;
+    }
+}
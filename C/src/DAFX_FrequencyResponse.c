@@ -0,0 +1,249 @@
+//
+//  DAFX_FrequencyResponse.c
+//
+
+#include "DAFX_FrequencyResponse.h"
+#include "DAFX_InitFrequencyResponse.h"
+#include "DAFX_InitBiquadFilter.h"
+
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+#define V               DAFX_SIMD_LANES
+#define COEFFS_6        (BIQUAD_NUMERATOR_SIZE + BIQUAD_DENOMINATOR_SIZE)
+
+//normalized coeffs per stage: b0, b1, b2, a1, a2
+#define FR_STAGE_SIZE   5
+
+//rows of the precomputed grid
+enum { FR_TRIG_C1 = 0, FR_TRIG_S1, FR_TRIG_C2, FR_TRIG_S2, FR_NUMOF_TRIG_ROWS };
+
+
+//grid length rounded up to whole vectors
+static inline int _PaddedPoints(t_DAFX_FrequencyResponse *pFR)
+{
+    return ((pFR->num_points + V - 1) / V) * V;
+}
+
+//FNV-1a over the bit patterns of the normalized coeffs
+static uint32_t _HashCoeffs(float *p_coeffs, int num_floats)
+{
+    uint32_t h = 2166136261u;
+    const unsigned char *p = (const unsigned char *)p_coeffs;
+    
+    for (size_t i = 0; i < sizeof(float) * (size_t)num_floats; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    h = (h ^ (uint32_t)num_floats) * 16777619u;
+    
+    return h;
+}
+
+//p_stage: b0, b1, b2, a0, a1, a2 -> normalized b0, b1, b2, a1, a2
+static void _NormalizeStage(float *p_dst, float *p_coeffs)
+{
+    float ax = 1.0 / p_coeffs[3];
+    
+    p_dst[0] = p_coeffs[0] * ax;
+    p_dst[1] = p_coeffs[1] * ax;
+    p_dst[2] = p_coeffs[2] * ax;
+    p_dst[3] = p_coeffs[4] * ax;
+    p_dst[4] = p_coeffs[5] * ax;
+}
+
+//Complex response of the cascade in p_stage_coeffs, V grid points at a time
+//For one stage, with z^-1 = cos(w) - j*sin(w):
+//    N = b0 + b1*cos(w) + b2*cos(2w) - j*(b1*sin(w) + b2*sin(2w))
+//    D = 1  + a1*cos(w) + a2*cos(2w) - j*(a1*sin(w) + a2*sin(2w))
+//    H = N * conj(D) / |D|^2
+static void _EvaluateStages(t_DAFX_FrequencyResponse *pFR, int num_stages)
+{
+    int np = _PaddedPoints(pFR);
+    float *p_re = pFR->p_magnitude_db;  //real and imaginary parts are parked in the
+    float *p_im = pFR->p_phase;         //output arrays until the final conversion
+    t_dafx_v4f one = dafx_v4f_set1(1.0f);
+    t_dafx_v4f zero = dafx_v4f_set1(0.0f);
+    
+    for (int i = 0; i < np; i += V)
+    {
+        t_dafx_v4f c1 = dafx_v4f_load(pFR->p_trig + FR_TRIG_C1 * np + i);
+        t_dafx_v4f s1 = dafx_v4f_load(pFR->p_trig + FR_TRIG_S1 * np + i);
+        t_dafx_v4f c2 = dafx_v4f_load(pFR->p_trig + FR_TRIG_C2 * np + i);
+        t_dafx_v4f s2 = dafx_v4f_load(pFR->p_trig + FR_TRIG_S2 * np + i);
+        t_dafx_v4f h_re = one;
+        t_dafx_v4f h_im = zero;
+        
+        for (int s = 0; s < num_stages; s++)
+        {
+            float *c = pFR->p_stage_coeffs + s * FR_STAGE_SIZE;
+            t_dafx_v4f b0 = dafx_v4f_set1(c[0]);
+            t_dafx_v4f b1 = dafx_v4f_set1(c[1]);
+            t_dafx_v4f b2 = dafx_v4f_set1(c[2]);
+            t_dafx_v4f a1 = dafx_v4f_set1(c[3]);
+            t_dafx_v4f a2 = dafx_v4f_set1(c[4]);
+            
+            t_dafx_v4f n_re = dafx_v4f_madd(b2, c2, dafx_v4f_madd(b1, c1, b0));
+            t_dafx_v4f n_im = dafx_v4f_sub(zero, dafx_v4f_madd(b2, s2, dafx_v4f_mul(b1, s1)));
+            t_dafx_v4f d_re = dafx_v4f_madd(a2, c2, dafx_v4f_madd(a1, c1, one));
+            t_dafx_v4f d_im = dafx_v4f_sub(zero, dafx_v4f_madd(a2, s2, dafx_v4f_mul(a1, s1)));
+            
+            t_dafx_v4f inv = dafx_v4f_div(one, dafx_v4f_madd(d_re, d_re, dafx_v4f_mul(d_im, d_im)));
+            t_dafx_v4f q_re = dafx_v4f_mul(dafx_v4f_madd(n_re, d_re, dafx_v4f_mul(n_im, d_im)), inv);
+            t_dafx_v4f q_im = dafx_v4f_mul(dafx_v4f_sub(dafx_v4f_mul(n_im, d_re), dafx_v4f_mul(n_re, d_im)), inv);
+            
+            //h *= q
+            t_dafx_v4f t_re = dafx_v4f_sub(dafx_v4f_mul(h_re, q_re), dafx_v4f_mul(h_im, q_im));
+            h_im = dafx_v4f_madd(h_re, q_im, dafx_v4f_mul(h_im, q_re));
+            h_re = t_re;
+        }
+        
+        dafx_v4f_store(p_re + i, h_re);
+        dafx_v4f_store(p_im + i, h_im);
+    }
+    
+    for (int i = 0; i < pFR->num_points; i++)
+    {
+        float re = p_re[i];
+        float im = p_im[i];
+        float mag2 = re * re + im * im;
+        
+        p_re[i] = (mag2 > 0.0f) ? DAFX_MAX(10.0f * log10f(mag2), FR_MIN_MAGNITUDE_DB) : FR_MIN_MAGNITUDE_DB;
+        p_im[i] = atan2f(im, re);
+    }
+}
+
+//Evaluates the stages in p_stage_coeffs unless they are the ones evaluated last time
+static bool _EvaluateIfChanged(t_DAFX_FrequencyResponse *pFR, int num_stages)
+{
+    uint32_t h = _HashCoeffs(pFR->p_stage_coeffs, num_stages * FR_STAGE_SIZE);
+    
+    if (pFR->version > 0 && h == pFR->coeff_hash)
+        return true;
+    
+    _EvaluateStages(pFR, num_stages);
+    pFR->coeff_hash = h;
+    pFR->version++;
+    
+    return true;
+}
+
+//clips the frequency range to fs and fills the grid and its trig values (padding points repeat the last frequency)
+static void _ComputeGrid(t_DAFX_FrequencyResponse *pFR)
+{
+    int np = _PaddedPoints(pFR);
+    
+    if (pFR->f_min <= 0.0)
+        pFR->f_min = FR_INIT_F_MIN;
+    if (pFR->f_max <= 0.0)
+        pFR->f_max = FR_INIT_F_MAX;
+    
+    pFR->f_max = DAFX_MIN(pFR->f_max, 0.5 * pFR->fs);
+    pFR->f_min = DAFX_MIN(pFR->f_min, 0.5 * pFR->f_max);
+    
+    //log-spaced grid
+    double ratio = log((double)pFR->f_max / (double)pFR->f_min) / (double)(pFR->num_points - 1);
+    for (int i = 0; i < np; i++)
+    {
+        double f = pFR->f_min * exp(ratio * (double)DAFX_MIN(i, pFR->num_points - 1));
+        double w = 2.0 * ONE_PI * f / (double)pFR->fs;
+        
+        if (i < pFR->num_points)
+            pFR->p_freqs[i] = (float)f;
+        
+        pFR->p_trig[FR_TRIG_C1 * np + i] = (float)cos(w);
+        pFR->p_trig[FR_TRIG_S1 * np + i] = (float)sin(w);
+        pFR->p_trig[FR_TRIG_C2 * np + i] = (float)cos(2.0 * w);
+        pFR->p_trig[FR_TRIG_S2 * np + i] = (float)sin(2.0 * w);
+    }
+    
+    //nothing evaluated yet
+    pFR->version = 0;
+    pFR->coeff_hash = 0;
+}
+
+bool InitFrequencyResponse(t_DAFX_FrequencyResponse *pFR)
+{
+    if (pFR->num_points <= 0)
+        pFR->num_points = FR_INIT_NUM_POINTS;
+    
+    pFR->num_points = DAFX_MAX(DAFX_MIN(pFR->num_points, FR_MAX_NUM_POINTS), FR_MIN_NUM_POINTS);
+    
+    int np = _PaddedPoints(pFR);
+    
+    // memory allocation
+    pFR->p_freqs = (float *) calloc(pFR->num_points, sizeof(float));
+    pFR->p_magnitude_db = (float *) DAFX_AlignedCalloc(np, sizeof(float));
+    pFR->p_phase = (float *) DAFX_AlignedCalloc(np, sizeof(float));
+    pFR->p_trig = (float *) DAFX_AlignedCalloc(FR_NUMOF_TRIG_ROWS * np, sizeof(float));
+    pFR->p_stage_coeffs = (float *) calloc(FR_MAX_STAGES * FR_STAGE_SIZE, sizeof(float));
+    
+    _ComputeGrid(pFR);
+    
+    return true;
+}
+
+bool FR_SetGrid(t_DAFX_FrequencyResponse *pFR, int fs, float f_min, float f_max)
+{
+    if (fs <= 0)
+        return false;
+    
+    pFR->fs = fs;
+    pFR->f_min = f_min;
+    pFR->f_max = f_max;
+    _ComputeGrid(pFR);
+    
+    return true;
+}
+
+bool FR_EvaluateBiquad(t_DAFX_FrequencyResponse *pFR, float *p_coeffs)
+{
+    _NormalizeStage(pFR->p_stage_coeffs, p_coeffs);
+    return _EvaluateIfChanged(pFR, 1);
+}
+
+bool FR_EvaluateSOSCascade(t_DAFX_FrequencyResponse *pFR, t_DAFX_SOSCascade *pSOS)
+{
+    float c[COEFFS_6];
+    
+    if (pSOS->num_stages > FR_MAX_STAGES)
+        return false;
+    
+    for (int s = 0; s < pSOS->num_stages; s++) {
+        GetSOSCascadeStageCoeffs(pSOS, s, c);
+        _NormalizeStage(pFR->p_stage_coeffs + s * FR_STAGE_SIZE, c);
+    }
+    
+    return _EvaluateIfChanged(pFR, pSOS->num_stages);
+}
+
+bool FR_EvaluateCrossoverBand(t_DAFX_FrequencyResponse *pFR, t_DAFXCrossover *pXOVER, int band)
+{
+    switch (band) {
+        case 0:
+            return FR_EvaluateSOSCascade(pFR, pXOVER->p_lp_cascade);
+        case 1:
+            return FR_EvaluateSOSCascade(pFR, pXOVER->p_hp_cascade);
+        default:
+            return false;
+    }
+}
+
+void DeallocFrequencyResponse(t_DAFX_FrequencyResponse *pFR)
+{
+    if(pFR != NULL) {
+        FREE(pFR->p_freqs);
+        FREE(pFR->p_stage_coeffs);
+        DAFX_AlignedFree(pFR->p_magnitude_db);
+        DAFX_AlignedFree(pFR->p_phase);
+        DAFX_AlignedFree(pFR->p_trig);
+        pFR->p_magnitude_db = NULL;
+        pFR->p_phase = NULL;
+        pFR->p_trig = NULL;
+    }
+}
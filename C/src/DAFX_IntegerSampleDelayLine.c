@@ -94,6 +94,40 @@ float DAFXProcessDelaySingleSample(t_DAFXIntegerSampleDelayLine *pDEL, float x)
     return y;
 }
 
+bool DAFXProcessDelayBlockModulated(t_DAFXIntegerSampleDelayLine *pDEL, float *p_delay_samples, float *p_in, float *p_out, int n)
+{
+    float *p_buffer = pDEL->p_delay_buffer;
+    int buf_size = pDEL->buf_size;
+    int wp = pDEL->wp;
+    int rp = pDEL->rp;
+    int d = pDEL->delay_samples;
+    
+    //same as DEL_SetDelayMs + DAFXProcessDelaySingleSample for every sample, without the modulos
+    for (int i = 0; i < n; i++)
+    {
+        d = DAFX_MIN(DAFX_MAX((int)p_delay_samples[i], 0), buf_size - 1);
+        
+        p_buffer[wp] = p_in[i];
+        rp = wp - d;
+        if (rp < 0)
+            rp += buf_size;
+        p_out[i] = p_buffer[rp];
+        
+        if (++wp == buf_size)
+            wp = 0;
+    }
+    
+    //leave the line as if the last delay had been set with DEL_SetDelayMs
+    if (n > 0) {
+        pDEL->delay_samples = d;
+        pDEL->delay_ms = (float)d * 1000.0 / (float)pDEL->fs;
+        pDEL->rp = (rp + 1 == buf_size) ? 0 : rp + 1;
+    }
+    pDEL->wp = wp;
+    
+    return true;
+}
+
 float DAFXBypassDelaySingleSample(t_DAFXIntegerSampleDelayLine *pDEL, float x)
 {
     return x;
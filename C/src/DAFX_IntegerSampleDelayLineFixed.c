@@ -0,0 +1,88 @@
+//
+//  DAFX_IntegerSampleDelayLineFixed.c
+//
+
+#include "DAFX_IntegerSampleDelayLineFixed.h"
+#include "DAFX_definitions.h"
+
+bool DEL_FX_SetDelayMs(t_DAFXIntegerSampleDelayLineFixed *pDEL, float delay_ms)
+{
+    //delay can't be negative and can't be larger than the max
+    pDEL->delay_ms = DAFX_MIN(DAFX_MAX(delay_ms, 0.0), pDEL->max_delay_ms);
+    
+    //convert to samples, can't be larger than the buffer size
+    int d_samples = (int)(pDEL->delay_ms * 0.001 * pDEL->fs);
+    pDEL->delay_samples = DAFX_MIN(d_samples, pDEL->buf_size - 1);
+    
+    //update the read pointer with the new delay
+    pDEL->rp = pDEL->wp - pDEL->delay_samples;
+    if (pDEL->rp < 0)
+        pDEL->rp += pDEL->buf_size;
+    
+    return true;
+}
+
+bool DEL_FX_SetMaxDelayMs(t_DAFXIntegerSampleDelayLineFixed *pDEL, float max_delay_ms)
+{
+    //max delay cant be lower than the minimum size or the current delay
+    float d_max_ms = DAFX_MAX(max_delay_ms, MIN_DELAYLINE_SIZE_MS);
+    pDEL->max_delay_ms = DAFX_MAX(d_max_ms, pDEL->delay_ms);
+    
+    // free up current buffer
+    FREE(pDEL->p_delay_buffer);
+    
+    //Allocate new buffer to new size
+    pDEL->buf_size = (int)(pDEL->max_delay_ms * 0.001 * pDEL->fs) + 1;
+    pDEL->p_delay_buffer = (t_dafx_fx *) calloc(pDEL->buf_size, sizeof(t_dafx_fx));
+    
+    //reinit read and write pointers
+    pDEL->wp = 0;
+    pDEL->rp = (pDEL->delay_samples > 0) ? pDEL->buf_size - pDEL->delay_samples : 0;
+    
+    return true;
+}
+
+bool InitDAFXIntegerSampleDelayLineFixed(t_DAFXIntegerSampleDelayLineFixed *pDEL, int fs)
+{
+    pDEL->fs = fs;
+    
+    //Allocate to inital max delay value - can be changed later
+    pDEL->buf_size = (int)(INIT_DELAYLINE_MAX_DELAY_MS * 0.001 * fs) + 1;
+    pDEL->max_delay_ms = INIT_DELAYLINE_MAX_DELAY_MS;
+    pDEL->p_delay_buffer = (t_dafx_fx *) calloc(pDEL->buf_size, sizeof(t_dafx_fx));
+    
+    //init to default delay
+    pDEL->delay_samples = (int)(INIT_DELAYLINE_DELAY_MS * 0.001 * fs);
+    pDEL->delay_ms = INIT_DELAYLINE_DELAY_MS;
+    
+    //init read and write pointers
+    pDEL->wp = 0;
+    pDEL->rp = pDEL->buf_size - pDEL->delay_samples;
+    
+    return true;
+}
+
+t_dafx_fx DAFXProcessDelaySingleSampleFixed(t_DAFXIntegerSampleDelayLineFixed *pDEL, t_dafx_fx x)
+{
+    //write new sample into delay line, read out buffered sample
+    pDEL->p_delay_buffer[pDEL->wp] = x;
+    t_dafx_fx y = pDEL->p_delay_buffer[pDEL->rp];
+    
+    //advance read and write pointers circularly
+    if (++pDEL->wp == pDEL->buf_size)
+        pDEL->wp = 0;
+    if (++pDEL->rp == pDEL->buf_size)
+        pDEL->rp = 0;
+    
+    return y;
+}
+
+t_dafx_fx DAFXBypassDelaySingleSampleFixed(t_DAFXIntegerSampleDelayLineFixed *pDEL, t_dafx_fx x)
+{
+    return x;
+}
+
+void DeallocDAFXIntegerSampleDelayLineFixed(t_DAFXIntegerSampleDelayLineFixed *pDEL)
+{
+    FREE(pDEL->p_delay_buffer);
+}
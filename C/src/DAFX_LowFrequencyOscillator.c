@@ -6,6 +6,7 @@
 #include "DAFX_LowFrequencyOscillator.h"
 #include "DAFX_InitLowFrequencyOscillator.h"
 #include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 #include <math.h>
@@ -13,6 +14,103 @@
 #include <Accelerate/Accelerate.h>
 #endif
 
+//block mode phase: a full period is 2^64
+#define LFO_PHASE_ONE           18446744073709551616.0
+//the top 24 bits of the phase, as a float in [0, 1)
+#define LFO_PHASE_TO_FLOAT(q)   ((float)((q) >> 40) * (1.0f / 16777216.0f))
+
+//Wavetable shapes: one period each plus the wrap-around point, shared by every instance
+enum
+{
+    LFO_TABLE_TRIANGLE = 0,     //also read by the square
+    LFO_TABLE_EXP_RISE,
+    LFO_TABLE_EXP_FALL,
+    LFO_TABLE_SAMPLE_HOLD,
+    LFO_TABLE_USER,             //LFO_NUMOF_USER_TABLES slots
+    LFO_NUMOF_TABLES = LFO_TABLE_USER + LFO_NUMOF_USER_TABLES,
+};
+
+static float s_shape_tables[LFO_NUMOF_TABLES][LFO_TABLE_SIZE + 1];
+static bool s_shape_tables_ready = false;
+
+static void _FillShapeTables(void)
+{
+    if (s_shape_tables_ready)
+        return;
+    
+    double c = LFO_EXP_CURVATURE;
+    unsigned int seed = LFO_SH_SEED;
+    float level = 0.0;
+    
+    for (int i = 0; i < LFO_TABLE_SIZE; i++)
+    {
+        double p = (double)i / (double)LFO_TABLE_SIZE;
+        
+        //triangle: 0 at phase 0, going up
+        double q = p + 0.25 - floor(p + 0.25);
+        s_shape_tables[LFO_TABLE_TRIANGLE][i] = (float)(q < 0.5 ? -1.0 + 4.0 * q : 3.0 - 4.0 * q);
+        
+        //exponential ramps from -1 to 1, resp. decaying from 1 to -1
+        s_shape_tables[LFO_TABLE_EXP_RISE][i] = (float)(2.0 * (exp(c * p) - 1.0) / (exp(c) - 1.0) - 1.0);
+        s_shape_tables[LFO_TABLE_EXP_FALL][i] = (float)(2.0 * (exp(-c * p) - exp(-c)) / (1.0 - exp(-c)) - 1.0);
+        
+        //sample-and-hold: a new level every LFO_TABLE_SIZE / LFO_SH_STEPS_PER_PERIOD points
+        if (i % (LFO_TABLE_SIZE / LFO_SH_STEPS_PER_PERIOD) == 0) {
+            seed = seed * 1664525u + 1013904223u;
+            level = (float)(seed >> 8) / 8388608.0f - 1.0f;
+        }
+        s_shape_tables[LFO_TABLE_SAMPLE_HOLD][i] = level;
+        
+        //user tables start out as a sine
+        for (int u = 0; u < LFO_NUMOF_USER_TABLES; u++) {
+            s_shape_tables[LFO_TABLE_USER + u][i] = (float)sin(TWO_PI * p);
+        }
+    }
+    
+    for (int t = 0; t < LFO_NUMOF_TABLES; t++) {
+        s_shape_tables[t][LFO_TABLE_SIZE] = s_shape_tables[t][0];
+    }
+    
+    s_shape_tables_ready = true;
+}
+
+bool LFO_SetUserTable(int slot, float *p_points, int num_points)
+{
+    if (slot < 0 || slot >= LFO_NUMOF_USER_TABLES || num_points < 1)
+        return false;
+    
+    _FillShapeTables();
+    float *p_table = s_shape_tables[LFO_TABLE_USER + slot];
+    
+    for (int i = 0; i < LFO_TABLE_SIZE; i++)
+    {
+        double pos = (double)i * (double)num_points / (double)LFO_TABLE_SIZE;
+        int j = (int)pos;
+        float frac = (float)(pos - (double)j);
+        float y = p_points[j] + frac * (p_points[(j + 1) % num_points] - p_points[j]);
+        
+        p_table[i] = DAFX_MAX(DAFX_MIN(y, 1.0f), -1.0f);
+    }
+    p_table[LFO_TABLE_SIZE] = p_table[0];
+    
+    return true;
+}
+
+bool LFO_SetUserShape(t_DAFXLowFrequencyOscillator *pLFO, int slot)
+{
+    if (slot >= 0 && slot < LFO_NUMOF_USER_TABLES)
+        pLFO->user_table = slot;
+    return true;
+}
+
+bool LFO_SetSlew(t_DAFXLowFrequencyOscillator *pLFO, float slew)
+{
+    pLFO->slew = DAFX_MAX(DAFX_MIN(slew, LFO_MAX_SLEW), LFO_MIN_SLEW);
+    return true;
+}
+
+static void _ResyncRecursiveState(t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos);
+
 bool LFO_SetMode(t_DAFXLowFrequencyOscillator *pLFO, t_lfo_algo_select alg)
 {
     switch(alg) {
@@ -24,10 +122,33 @@ bool LFO_SetMode(t_DAFXLowFrequencyOscillator *pLFO, t_lfo_algo_select alg)
             pLFO->algo = LFO_ALGO_SELECT_SAW;
             pLFO->pf_process_func = &_GenerateSawtoothLFO;
             break;
+        case LFO_ALGO_SELECT_TRIANGLE:
+        case LFO_ALGO_SELECT_SQUARE:
+        case LFO_ALGO_SELECT_EXP_RISE:
+        case LFO_ALGO_SELECT_EXP_FALL:
+        case LFO_ALGO_SELECT_SAMPLE_HOLD:
+        case LFO_ALGO_SELECT_USER:
+            pLFO->algo = alg;
+            break;
         default:
             break;
     }
+    
+    //the recursion of the new shape has not been running
+    _ResyncRecursiveState(pLFO, pLFO->sample_pos);
+
+    return true;
+}
 
+bool LFO_SetProcessMode(t_DAFXLowFrequencyOscillator *pLFO, t_lfo_process_mode mode)
+{
+    if ((int)mode < 0 || mode >= LowFrequencyOscillator_N_PROCESS_MODES)
+        return true;
+    
+    //the recursions continue from the phase block mode had reached
+    if (mode == LFO_PROCESS_RECURSIVE && pLFO->process_mode != LFO_PROCESS_RECURSIVE)
+        _ResyncRecursiveState(pLFO, pLFO->sample_pos);
+    pLFO->process_mode = mode;
     return true;
 }
 
@@ -75,18 +196,62 @@ bool LFO_SetClipLow(t_DAFXLowFrequencyOscillator *pLFO, float clip_l)
 
 
 bool LFO_ReinitPhase(t_DAFXLowFrequencyOscillator *pLFO)
+{
+    return LFO_ReinitPhaseTo(pLFO, 0.0);
+}
+
+//state of the recursions (sine and sawtooth) at phase p in [0, 1): the next generated sample is one step further
+static void _SetRecursiveState(t_DAFXLowFrequencyOscillator *pLFO, double p)
 {
     if(pLFO->algo == LFO_ALGO_SELECT_SIN)
     {
-        pLFO->u = 1.0;
-        pLFO->v = 0.0;
+        pLFO->u = cos(TWO_PI * p);
+        pLFO->v = sin(TWO_PI * p);
     }
     else
     {
-        pLFO->y = 0.0;
-        pLFO->d = pLFO->d_rise;
-        pLFO->d_state = LFO_STATE_RISING;
+        //position on the sawtooth: rising over [0, balance) of the shifted phase
+        double bal = pLFO->balance;
+        double q = p + 0.5 * bal - floor(p + 0.5 * bal);
+        
+        if (q < bal) {
+            pLFO->y = pLFO->amp * (2.0 * q / bal - 1.0);
+            pLFO->d = pLFO->d_rise;
+            pLFO->d_state = LFO_STATE_RISING;
+        } else {
+            pLFO->y = pLFO->amp * (1.0 - 2.0 * (q - bal) / (1.0 - bal));
+            pLFO->d = pLFO->d_fall;
+            pLFO->d_state = LFO_STATE_FALLING;
+        }
     }
+    pLFO->resync_count = LFO_RECURSIVE_RESYNC_PERIOD;
+}
+
+//puts the recursions back on the exact phase of the sample at sample_pos (block mode phase):
+//whatever amplitude and phase error the float recursion built up is dropped.
+//The state is seeded one step back, so the next generated sample is the one at sample_pos
+static void _ResyncRecursiveState(t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos)
+{
+    uint64_t q = pLFO->phase + sample_pos * pLFO->phase_inc - pLFO->phase_inc;
+    _SetRecursiveState(pLFO, (double)(q >> 11) * (1.0 / 9007199254740992.0)); // 2^-53
+}
+
+bool LFO_ReinitPhaseTo(t_DAFXLowFrequencyOscillator *pLFO, float phase)
+{
+    double p = (double)phase - floor((double)phase);
+    
+    //block mode: the phase at the current position becomes the target phase
+    pLFO->phase = (uint64_t)(p * LFO_PHASE_ONE) - pLFO->sample_pos * pLFO->phase_inc;
+    
+    //the recursions pick up from the same phase
+    _ResyncRecursiveState(pLFO, pLFO->sample_pos);
+    
+    return true;
+}
+
+bool LFO_SetPosition(t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos)
+{
+    pLFO->sample_pos = sample_pos;
     return true;
 }
 
@@ -100,8 +265,14 @@ bool _RecalculatePrivateVariables(t_DAFXLowFrequencyOscillator *pLFO)
     pLFO->k1 = tanf(0.5 * TWO_PI * pLFO->f / (float) pLFO->fs);
     pLFO->k2 = 2.0 * pLFO->k1 / (1.0 + pLFO->k1 * pLFO->k1);
     
+    // --- block mode phase increment, the phase at the current position is kept
+    uint64_t phase_now = pLFO->phase + pLFO->sample_pos * pLFO->phase_inc;
+    double inc = (double)pLFO->f / (double)pLFO->fs;
+    pLFO->phase_inc = (uint64_t)((inc - floor(inc)) * LFO_PHASE_ONE);
+    pLFO->phase = phase_now - pLFO->sample_pos * pLFO->phase_inc;
+    
     // --- sawtooth specific parameters
-    pLFO->T = roundf((float)pLFO->fs / pLFO->f);  //duration of a full period in samples (rounded to the nearest sample)
+    pLFO->T = (float)pLFO->fs / pLFO->f;  //duration of a full period in samples (fractional, see _GenerateSawtoothLFO)
     //duration of rise and fall periods
     pLFO->t1 = pLFO->T * pLFO->balance;
     pLFO->t2 = pLFO->T - pLFO->t1;
@@ -137,28 +308,242 @@ float _GenerateSawtoothLFO(t_DAFXLowFrequencyOscillator *pLFO)
 {
     // recursive modified sawtooth waveform generation
     
-    //Change direction if amplitude limit exceeded
-    if (pLFO->y >= pLFO->amp)
+    //update new sample with differential
+    pLFO->y += pLFO->d;
+    
+    //Change direction if amplitude limit exceeded. The part of the step past the limit is
+    //folded onto the other slope, so that the corners fall between samples and the period
+    //is not rounded to whole samples
+    if (pLFO->d_state == LFO_STATE_RISING && pLFO->y > pLFO->amp)
     {
+        pLFO->y = pLFO->amp + (pLFO->y - pLFO->amp) * (pLFO->d_fall / pLFO->d_rise);
         pLFO->d = pLFO->d_fall;
         pLFO->d_state = LFO_STATE_FALLING;
     }
-    else if (pLFO->y <= -1.0 * pLFO->amp)
+    else if (pLFO->d_state == LFO_STATE_FALLING && pLFO->y < -1.0 * pLFO->amp)
     {
+        pLFO->y = -pLFO->amp + (pLFO->y + pLFO->amp) * (pLFO->d_rise / pLFO->d_fall);
         pLFO->d = pLFO->d_rise;
         pLFO->d_state = LFO_STATE_RISING;
     }
     
-    //update new sample with differential
-    pLFO->y += pLFO->d;
-    
     //offset and clip output
     return (DAFX_MAX(DAFX_MIN(pLFO->y + pLFO->offset, pLFO->clip_h), pLFO->clip_l));
 }
 
 
+//sin(2 pi z) for z in [-1/4, 1/4]: Taylor series in 2 pi z up to the 11th power (error < 1e-7)
+#define SIN_C1      6.28318530718f
+#define SIN_C3      -41.3417022404f
+#define SIN_C5      81.6052492761f
+#define SIN_C7      -76.7058597531f
+#define SIN_C9      42.0586939449f
+#define SIN_C11     -15.0946425768f
+
+//frac(p) for p >= 0
+static inline t_dafx_v4f _Wrap(t_dafx_v4f p)
+{
+    return dafx_v4f_sub(p, dafx_v4f_trunc(p));
+}
+
+//sin(2 pi p) for p in [0, 1)
+static inline t_dafx_v4f _SinFromPhase(t_dafx_v4f p)
+{
+    //sin(2 pi p) = -sin(2 pi x) with x = p - 1/2 in [-1/2, 1/2),
+    //folded onto [-1/4, 1/4] with sin(2 pi x) = sin(2 pi (+-1/2 - x))
+    t_dafx_v4f x = dafx_v4f_sub(p, dafx_v4f_set1(0.5f));
+    x = dafx_v4f_min(x, dafx_v4f_sub(dafx_v4f_set1(0.5f), x));
+    x = dafx_v4f_max(x, dafx_v4f_sub(dafx_v4f_set1(-0.5f), x));
+    
+    t_dafx_v4f x2 = dafx_v4f_mul(x, x);
+    t_dafx_v4f y = dafx_v4f_madd(x2, dafx_v4f_set1(SIN_C11), dafx_v4f_set1(SIN_C9));
+    y = dafx_v4f_madd(x2, y, dafx_v4f_set1(SIN_C7));
+    y = dafx_v4f_madd(x2, y, dafx_v4f_set1(SIN_C5));
+    y = dafx_v4f_madd(x2, y, dafx_v4f_set1(SIN_C3));
+    y = dafx_v4f_madd(x2, y, dafx_v4f_set1(SIN_C1));
+    
+    return dafx_v4f_sub(dafx_v4f_set1(0.0f), dafx_v4f_mul(x, y));
+}
+
+//Rises from -amp to amp over balance, falls back over (1 - balance): the smaller of the two lines.
+//The phase is shifted by balance / 2, so that phase 0 is the zero crossing going up
+static inline t_dafx_v4f _SawFromPhase(t_dafx_v4f p, t_dafx_v4f half_bal, t_dafx_v4f bal, t_dafx_v4f k_rise, t_dafx_v4f k_fall, t_dafx_v4f amp)
+{
+    t_dafx_v4f q = _Wrap(dafx_v4f_add(p, half_bal));
+    t_dafx_v4f rise = dafx_v4f_sub(dafx_v4f_mul(k_rise, q), amp);
+    t_dafx_v4f fall = dafx_v4f_sub(amp, dafx_v4f_mul(k_fall, dafx_v4f_sub(q, bal)));
+    
+    return dafx_v4f_min(rise, fall);
+}
+
+//per-block constants of the block generators
+typedef struct{
+    uint64_t phase;         //phase of the first sample
+    uint64_t inc;           //phase increment from one output sample to the next
+    t_dafx_v4f offset;
+    t_dafx_v4f clip_h;
+    t_dafx_v4f clip_l;
+    t_dafx_v4f amp;
+}t_lfo_block_consts;
+
+static inline void _LoadBlockConsts(const t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos, int stride, t_lfo_block_consts *c)
+{
+    c->phase = pLFO->phase + sample_pos * pLFO->phase_inc;
+    c->inc = pLFO->phase_inc * (uint64_t)stride;
+    c->offset = dafx_v4f_set1(pLFO->offset);
+    c->clip_h = dafx_v4f_set1(pLFO->clip_h);
+    c->clip_l = dafx_v4f_set1(pLFO->clip_l);
+    c->amp = dafx_v4f_set1(pLFO->amp);
+}
+
+//phase of the samples i .. i + DAFX_SIMD_LANES - 1. The 64-bit phase is exact, so every sample
+//only depends on its absolute position, however the signal is split into blocks
+static inline t_dafx_v4f _LanesPhase(t_lfo_block_consts *c, int i)
+{
+    uint64_t q = c->phase + (uint64_t)i * c->inc;
+    float p[DAFX_SIMD_LANES];
+    
+    for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+        p[k] = LFO_PHASE_TO_FLOAT(q);
+        q += c->inc;
+    }
+    return dafx_v4f_loadu(p);
+}
+
+//offset and clip, then store (partial vector at the end)
+static inline void _StoreLFOLanes(float *pOutput, int i, int n, t_lfo_block_consts *c, t_dafx_v4f y)
+{
+    y = dafx_v4f_add(y, c->offset);
+    y = dafx_v4f_max(dafx_v4f_min(y, c->clip_h), c->clip_l);
+    
+    if (i + DAFX_SIMD_LANES <= n) {
+        dafx_v4f_storeu(pOutput + i, y);
+    } else {
+        float tail[DAFX_SIMD_LANES];
+        dafx_v4f_storeu(tail, y);
+        memcpy(pOutput + i, tail, sizeof(float) * (n - i));
+    }
+}
+
+static void _GenerateSinusoidalBlockLFO(const t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos, int stride, float *pOutput, int n)
+{
+    t_lfo_block_consts c;
+    
+    _LoadBlockConsts(pLFO, sample_pos, stride, &c);
+    
+    for (int i = 0; i < n; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f y = dafx_v4f_mul(c.amp, _SinFromPhase(_LanesPhase(&c, i)));
+        _StoreLFOLanes(pOutput, i, n, &c, y);
+    }
+}
+
+static void _GenerateSawtoothBlockLFO(const t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos, int stride, float *pOutput, int n)
+{
+    float bal = pLFO->balance;
+    t_lfo_block_consts c;
+    
+    _LoadBlockConsts(pLFO, sample_pos, stride, &c);
+    
+    t_dafx_v4f half_bal = dafx_v4f_set1(0.5f * bal);
+    t_dafx_v4f v_bal = dafx_v4f_set1(bal);
+    t_dafx_v4f k_rise = dafx_v4f_set1(2.0f * pLFO->amp / bal);
+    t_dafx_v4f k_fall = dafx_v4f_set1(2.0f * pLFO->amp / (1.0f - bal));
+    
+    for (int i = 0; i < n; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f y = _SawFromPhase(_LanesPhase(&c, i), half_bal, v_bal, k_rise, k_fall, c.amp);
+        _StoreLFOLanes(pOutput, i, n, &c, y);
+    }
+}
+
+//linear interpolation in a shape table, phase in [0, 1)
+static inline t_dafx_v4f _TableLookup(const float *p_table, t_dafx_v4f w)
+{
+    t_dafx_v4f pos = dafx_v4f_mul(w, dafx_v4f_set1((float)LFO_TABLE_SIZE));
+    t_dafx_v4f idx = dafx_v4f_trunc(pos);
+    t_dafx_v4f frac = dafx_v4f_sub(pos, idx);
+    float f_idx[DAFX_SIMD_LANES], y0[DAFX_SIMD_LANES], y1[DAFX_SIMD_LANES];
+    
+    //no gather before AVX2: fetch the points lane by lane, interpolate on vectors
+    dafx_v4f_storeu(f_idx, idx);
+    for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+        int j = DAFX_MIN((int)f_idx[k], LFO_TABLE_SIZE - 1);
+        y0[k] = p_table[j];
+        y1[k] = p_table[j + 1];
+    }
+    t_dafx_v4f a = dafx_v4f_loadu(y0);
+    
+    return dafx_v4f_madd(frac, dafx_v4f_sub(dafx_v4f_loadu(y1), a), a);
+}
+
+//Wavetable shapes. The square is the triangle scaled by 1 / slew and clipped to [-1, 1]
+static void _GenerateTableBlockLFO(const t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos, int stride, float *pOutput, int n)
+{
+    const float *p_table;
+    float gain = 1.0;
+    t_lfo_block_consts c;
+    
+    switch (pLFO->algo) {
+        case LFO_ALGO_SELECT_SQUARE:
+            gain = 1.0 / pLFO->slew;
+            p_table = s_shape_tables[LFO_TABLE_TRIANGLE];
+            break;
+        case LFO_ALGO_SELECT_EXP_RISE:
+            p_table = s_shape_tables[LFO_TABLE_EXP_RISE];
+            break;
+        case LFO_ALGO_SELECT_EXP_FALL:
+            p_table = s_shape_tables[LFO_TABLE_EXP_FALL];
+            break;
+        case LFO_ALGO_SELECT_SAMPLE_HOLD:
+            p_table = s_shape_tables[LFO_TABLE_SAMPLE_HOLD];
+            break;
+        case LFO_ALGO_SELECT_USER:
+            p_table = s_shape_tables[LFO_TABLE_USER + pLFO->user_table];
+            break;
+        default:
+            p_table = s_shape_tables[LFO_TABLE_TRIANGLE];
+            break;
+    }
+    
+    _LoadBlockConsts(pLFO, sample_pos, stride, &c);
+    
+    t_dafx_v4f v_gain = dafx_v4f_set1(gain);
+    t_dafx_v4f one = dafx_v4f_set1(1.0f);
+    t_dafx_v4f minus_one = dafx_v4f_set1(-1.0f);
+    
+    for (int i = 0; i < n; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f w = dafx_v4f_mul(v_gain, _TableLookup(p_table, _LanesPhase(&c, i)));
+        t_dafx_v4f y = dafx_v4f_mul(c.amp, dafx_v4f_max(dafx_v4f_min(w, one), minus_one));
+        _StoreLFOLanes(pOutput, i, n, &c, y);
+    }
+}
+
+bool LFO_RenderStrided(const t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos, int stride, float *p_output, int n)
+{
+    switch (pLFO->algo) {
+        case LFO_ALGO_SELECT_SIN:
+            _GenerateSinusoidalBlockLFO(pLFO, sample_pos, stride, p_output, n);
+            break;
+        case LFO_ALGO_SELECT_SAW:
+            _GenerateSawtoothBlockLFO(pLFO, sample_pos, stride, p_output, n);
+            break;
+        default:
+            _GenerateTableBlockLFO(pLFO, sample_pos, stride, p_output, n);
+            break;
+    }
+    return true;
+}
+
+bool LFO_RenderAt(const t_DAFXLowFrequencyOscillator *pLFO, uint64_t sample_pos, float *p_output, int n)
+{
+    return LFO_RenderStrided(pLFO, sample_pos, 1, p_output, n);
+}
+
+
 bool InitDAFXLowFrequencyOscillator(t_DAFXLowFrequencyOscillator *pLFO)
 {
+    //process-wide shape tables, filled by the first instance
+    _FillShapeTables();
+    
     // ---- general, wrapper ---- //
     //Signal vector size
     int block_size = pLFO->block_size;
@@ -169,6 +554,10 @@ bool InitDAFXLowFrequencyOscillator(t_DAFXLowFrequencyOscillator *pLFO)
     pLFO->algo = LFO_ALGO_SELECT_SIN;
     //set sample generation function accordingly
     pLFO->pf_process_func = &_GenerateSinusoidalLFO;
+    pLFO->process_mode = LFO_INIT_PROCESS_MODE;
+    pLFO->phase = 0;
+    pLFO->phase_inc = 0;
+    pLFO->sample_pos = 0;
     
     //common params
     pLFO->f = LFO_INIT_DEFAULT_FREQ_HZ;
@@ -180,6 +569,7 @@ bool InitDAFXLowFrequencyOscillator(t_DAFXLowFrequencyOscillator *pLFO)
     //sine specific params
     pLFO->u = 1.0;
     pLFO->v = 0.0;
+    pLFO->resync_count = LFO_RECURSIVE_RESYNC_PERIOD;
     _RecalculatePrivateVariables(pLFO);
     
     //sawtooth specific params
@@ -188,6 +578,15 @@ bool InitDAFXLowFrequencyOscillator(t_DAFXLowFrequencyOscillator *pLFO)
     _RecalculatePrivateVariables(pLFO);
     pLFO->y = 0.0; // output sample
     
+    //wavetable specific params
+    pLFO->slew = LFO_INIT_DEFAULT_SLEW;
+    pLFO->user_table = 0;
+    
+    //recursions seeded so their first sample is the one at phase 0, like block mode
+    _ResyncRecursiveState(pLFO, 0);
+    
+    DAFX_DenormalResetStats(&pLFO->denormal_stats);
+    
     return true;
 }
 
@@ -196,11 +595,56 @@ bool DAFXLowFrequencyOscillator(t_DAFXLowFrequencyOscillator *pLFO)
     int block_size = pLFO->block_size;
     float *pOutput = pLFO->p_output_block;
     tf_process_function pf_generate = (tf_process_function) pLFO->pf_process_func; //Sample generation function currently pointed at
+    t_dafx_fp_state fp_state;
+    
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    if (pLFO->process_mode == LFO_PROCESS_BLOCK || pLFO->algo >= LFO_ALGO_SELECT_TRIANGLE)
+    {
+        LFO_RenderAt(pLFO, pLFO->sample_pos, pOutput, block_size);
+    }
+    else
+    {
+        for (int i = 0; i < block_size; i++) {
+            if (--pLFO->resync_count <= 0)
+                _ResyncRecursiveState(pLFO, pLFO->sample_pos + i);
+            pOutput[i] = pf_generate(pLFO);
+        }
+        
+        DAFX_DenormalCountBlock(&pLFO->denormal_stats);
+        DAFX_DenormalCheckStates(&pLFO->denormal_stats, &pLFO->u, 1);
+        DAFX_DenormalCheckStates(&pLFO->denormal_stats, &pLFO->v, 1);
+    }
+    pLFO->sample_pos += block_size;
     
-    for (int i = 0; i < block_size; i++) {
-        pOutput[i] = pf_generate(pLFO);
+    DAFX_DenormalGuardEnd(&fp_state);
+    
+    return true;
+}
+
+bool DAFXLowFrequencyOscillatorControlRate(t_DAFXLowFrequencyOscillator *pLFO, int period, float *p_points)
+{
+    int num_points = pLFO->block_size / period;
+    t_dafx_fp_state fp_state;
+    
+    if (pLFO->process_mode == LFO_PROCESS_RECURSIVE && pLFO->algo < LFO_ALGO_SELECT_TRIANGLE)
+    {
+        //the recursions have to run through every sample anyway
+        DAFXLowFrequencyOscillator(pLFO);
+        for (int k = 0; k < num_points; k++) {
+            p_points[k] = pLFO->p_output_block[(k + 1) * period - 1];
+        }
+        return true;
     }
     
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    //the last sample of every control period
+    LFO_RenderStrided(pLFO, pLFO->sample_pos + period - 1, period, p_points, num_points);
+    pLFO->sample_pos += pLFO->block_size;
+    
+    DAFX_DenormalGuardEnd(&fp_state);
+    
     return true;
 }
 
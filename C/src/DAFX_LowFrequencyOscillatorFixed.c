@@ -0,0 +1,216 @@
+//
+//  DAFX_LowFrequencyOscillatorFixed.c
+//
+
+#include "DAFX_LowFrequencyOscillatorFixed.h"
+#include "DAFX_InitLowFrequencyOscillator.h"
+#include "DAFX_definitions.h"
+#include "DAFX_FixedPoint.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+#define FRAC_BITS   (32 - LFO_FX_SINE_TABLE_BITS)   //phase bits below the table index
+
+//TWO_PI is a float constant, the table needs the full 31 bits
+#define LFO_FX_TWO_PI   6.283185307179586476925
+
+
+//One period of the sine in Q31 (plus the wrap-around point), shared by every instance
+static int32_t s_sine_table[LFO_FX_SINE_TABLE_SIZE + 1];
+static bool s_sine_table_ready = false;
+
+static void _FillSineTable(void)
+{
+    if (s_sine_table_ready)
+        return;
+    
+    for (int i = 0; i <= LFO_FX_SINE_TABLE_SIZE; i++) {
+        s_sine_table[i] = DAFX_DoubleToQ31(sin(LFO_FX_TWO_PI * (double)i / (double)LFO_FX_SINE_TABLE_SIZE));
+    }
+    s_sine_table_ready = true;
+}
+
+static inline int32_t _SineFromPhase(uint32_t phase)
+{
+    uint32_t i = phase >> FRAC_BITS;
+    int32_t frac = (int32_t)((phase & ((1u << FRAC_BITS) - 1)) >> (FRAC_BITS - 15)); //Q15
+    int32_t s0 = s_sine_table[i];
+    int32_t s1 = s_sine_table[i + 1];
+    
+    return s0 + (int32_t)(((int64_t)(s1 - s0) * frac) >> 15);
+}
+
+//Rises from -1 to 1 over [0, phase_turn), then falls back to -1
+static inline int32_t _SawFromPhase(t_DAFXLowFrequencyOscillatorFixed *pLFO, uint32_t phase)
+{
+    int64_t y;
+    
+    if (phase < pLFO->phase_turn) {
+        y = (int64_t)INT32_MIN + (int64_t)(((uint64_t)phase * pLFO->rise_slope) >> 17);
+    } else {
+        y = (int64_t)INT32_MAX - (int64_t)(((uint64_t)(phase - pLFO->phase_turn) * pLFO->fall_slope) >> 17);
+    }
+    return DAFX_SatQ31(y);
+}
+
+static inline t_dafx_fx _ScaleAndClip(t_DAFXLowFrequencyOscillatorFixed *pLFO, int32_t w)
+{
+    int32_t y = DAFX_AddSatQ31(DAFX_MulQ31(w, pLFO->amp), pLFO->offset);
+    return DAFX_Q31ToFx(DAFX_MAX(DAFX_MIN(y, pLFO->clip_h), pLFO->clip_l));
+}
+
+static void _RecalculatePrivateVariablesFixed(t_DAFXLowFrequencyOscillatorFixed *pLFO)
+{
+    //phase increment per sample, a full period being 2^32
+    double inc = (double)pLFO->f / (double)pLFO->fs * 4294967296.0 + 0.5;
+    pLFO->phase_inc = (uint32_t) DAFX_MIN(DAFX_MAX(inc, 0.0), 4294967295.0);
+    
+    //the ramp covers 2 (full scale) over balance resp. (1 - balance) of the period
+    //slope in Q16.16 such that (phase * slope) >> 17 is the Q31 ramp
+    double bal = pLFO->balance;
+    pLFO->phase_turn = (uint32_t)(bal * 4294967296.0);
+    pLFO->rise_slope = (uint32_t)(2.0 / bal * 65536.0);
+    pLFO->fall_slope = (uint32_t)(2.0 / (1.0 - bal) * 65536.0);
+}
+
+bool LFO_FX_SetMode(t_DAFXLowFrequencyOscillatorFixed *pLFO, t_lfo_algo_select algo)
+{
+    //no wavetable shapes in the fixed-point path
+    if (algo == LFO_ALGO_SELECT_SIN || algo == LFO_ALGO_SELECT_SAW)
+        pLFO->algo = algo;
+    return true;
+}
+
+bool LFO_FX_SetFrequency(t_DAFXLowFrequencyOscillatorFixed *pLFO, float f)
+{
+    pLFO->f = DAFX_MAX(f, 0.0);
+    _RecalculatePrivateVariablesFixed(pLFO);
+    return true;
+}
+
+//levels beyond full scale would be saturated to another value, 1 itself is the largest Q31 value
+static bool _IsQ31Level(float x)
+{
+    return x >= -1.0f && x <= 1.0f;
+}
+
+bool LFO_FX_SetAmplitude(t_DAFXLowFrequencyOscillatorFixed *pLFO, float a)
+{
+    a = DAFX_MAX(a, 0.0);
+    if (!_IsQ31Level(a))
+        return false;
+    
+    pLFO->amp = DAFX_FloatToQ31(a);
+    return true;
+}
+
+bool LFO_FX_SetBalance(t_DAFXLowFrequencyOscillatorFixed *pLFO, float bal)
+{
+    pLFO->balance = DAFX_MAX(DAFX_MIN(bal, LFO_MAX_BALANCE), LFO_MIN_BALANCE);
+    _RecalculatePrivateVariablesFixed(pLFO);
+    return true;
+}
+
+bool LFO_FX_SetOffset(t_DAFXLowFrequencyOscillatorFixed *pLFO, float off)
+{
+    if (!_IsQ31Level(off))
+        return false;
+    
+    pLFO->offset = DAFX_FloatToQ31(off);
+    return true;
+}
+
+bool LFO_FX_SetClipHigh(t_DAFXLowFrequencyOscillatorFixed *pLFO, float clip_h)
+{
+    if (!_IsQ31Level(clip_h))
+        return false;
+    
+    pLFO->clip_h = DAFX_FloatToQ31(clip_h);
+    return true;
+}
+
+bool LFO_FX_SetClipLow(t_DAFXLowFrequencyOscillatorFixed *pLFO, float clip_l)
+{
+    if (!_IsQ31Level(clip_l))
+        return false;
+    
+    pLFO->clip_l = DAFX_FloatToQ31(clip_l);
+    return true;
+}
+
+bool LFO_FX_ReinitPhase(t_DAFXLowFrequencyOscillatorFixed *pLFO)
+{
+    //both waveforms restart from 0, going up (as the float LFO does)
+    if (pLFO->algo == LFO_ALGO_SELECT_SIN) {
+        pLFO->phase = 0;
+    } else {
+        pLFO->phase = pLFO->phase_turn >> 1;
+    }
+    return true;
+}
+
+bool InitDAFXLowFrequencyOscillatorFixed(t_DAFXLowFrequencyOscillatorFixed *pLFO)
+{
+    _FillSineTable();
+    
+    // I/O buffers
+    pLFO->p_output_block = (t_dafx_fx *) calloc(pLFO->block_size, sizeof(t_dafx_fx));
+    
+    //default mode
+    pLFO->algo = LFO_ALGO_SELECT_SIN;
+    
+    //common params
+    pLFO->f = LFO_INIT_DEFAULT_FREQ_HZ;
+    pLFO->balance = LFO_INIT_DEFAULT_BALANCE;
+    LFO_FX_SetAmplitude(pLFO, LFO_INIT_DEFAULT_AMP);
+    LFO_FX_SetOffset(pLFO, LFO_INIT_DEFAULT_OFFSET);
+    LFO_FX_SetClipHigh(pLFO, LFO_INIT_DEFAULT_CLIP_H);
+    LFO_FX_SetClipLow(pLFO, LFO_INIT_DEFAULT_CLIP_L);
+    _RecalculatePrivateVariablesFixed(pLFO);
+    
+    LFO_FX_ReinitPhase(pLFO);
+    
+    return true;
+}
+
+bool DAFXLowFrequencyOscillatorFixed(t_DAFXLowFrequencyOscillatorFixed *pLFO)
+{
+    t_dafx_fx *pOutput = pLFO->p_output_block;
+    uint32_t phase = pLFO->phase;
+    uint32_t inc = pLFO->phase_inc;
+    
+    //waveform chosen once per block
+    if (pLFO->algo == LFO_ALGO_SELECT_SIN)
+    {
+        for (int i = 0; i < pLFO->block_size; i++) {
+            pOutput[i] = _ScaleAndClip(pLFO, _SineFromPhase(phase));
+            phase += inc;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < pLFO->block_size; i++) {
+            pOutput[i] = _ScaleAndClip(pLFO, _SawFromPhase(pLFO, phase));
+            phase += inc;
+        }
+    }
+    
+    pLFO->phase = phase;
+    
+    return true;
+}
+
+bool DAFXBypassLowFrequencyOscillatorFixed(t_DAFXLowFrequencyOscillatorFixed *pLFO)
+{
+    memset(pLFO->p_output_block, 0, sizeof(t_dafx_fx) * pLFO->block_size);
+    return true;
+}
+
+void DeallocDAFXLowFrequencyOscillatorFixed(t_DAFXLowFrequencyOscillatorFixed *pLFO)
+{
+    FREE(pLFO->p_output_block);
+}
@@ -0,0 +1,203 @@
+//
+//  DAFX_ModulationBus.c
+//
+
+#include "DAFX_ModulationBus.h"
+#include "DAFX_InitModulationBus.h"
+#include "DAFX_LowFrequencyOscillator.h"
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+static inline float _SlotFrequency(t_DAFX_ModulationBus *pBUS, t_modbus_slot *pSlot)
+{
+    return (float)((double)pBUS->bpm / (60.0 * (double)pSlot->division));
+}
+
+//puts the slot's LFO on the transport: position, frequency, and the phase of the current beat
+static void _LockSlot(t_DAFX_ModulationBus *pBUS, t_modbus_slot *pSlot)
+{
+    double phase = (double)pSlot->phase_offset + pBUS->beat_pos / (double)pSlot->division;
+    
+    LFO_SetPosition(&pSlot->lfo, pBUS->sample_pos);
+    LFO_SetFrequency(&pSlot->lfo, _SlotFrequency(pBUS, pSlot));
+    LFO_ReinitPhaseTo(&pSlot->lfo, (float)(phase - floor(phase)));
+    pSlot->is_rendered = false;
+}
+
+bool MODBUS_SetTempo(t_DAFX_ModulationBus *pBUS, float bpm)
+{
+    pBUS->bpm = DAFX_MAX(DAFX_MIN(bpm, MODBUS_MAX_BPM), MODBUS_MIN_BPM);
+    
+    //the phases at the current position are kept, only the rates change. The phases are
+    //taken from the beat position rather than from the LFOs, so that the rounding of the
+    //LFO frequencies does not pile up from one tempo change to the next
+    for (int s = 0; s < MODBUS_MAX_NUMOF_SLOTS; s++) {
+        if (pBUS->slots[s].num_subscribers > 0)
+            _LockSlot(pBUS, pBUS->slots + s);
+    }
+    return true;
+}
+
+//a seek assumes the current tempo since the start
+bool MODBUS_SetPosition(t_DAFX_ModulationBus *pBUS, uint64_t sample_pos)
+{
+    pBUS->sample_pos = sample_pos;
+    pBUS->beat_pos = (double)sample_pos * (double)pBUS->bpm / (60.0 * (double)pBUS->fs);
+    
+    for (int s = 0; s < MODBUS_MAX_NUMOF_SLOTS; s++) {
+        if (pBUS->slots[s].num_subscribers > 0)
+            _LockSlot(pBUS, pBUS->slots + s);
+    }
+    return true;
+}
+
+bool InitModulationBus(t_DAFX_ModulationBus *pBUS)
+{
+    pBUS->bpm = MODBUS_INIT_DEFAULT_BPM;
+    pBUS->sample_pos = 0;
+    pBUS->beat_pos = 0.0;
+    
+    //every slot's LFO is allocated here, so that subscribing does not allocate
+    for (int s = 0; s < MODBUS_MAX_NUMOF_SLOTS; s++)
+    {
+        t_modbus_slot *pSlot = pBUS->slots + s;
+        
+        pSlot->lfo.block_size = pBUS->block_size;
+        pSlot->lfo.fs = pBUS->fs;
+        InitDAFXLowFrequencyOscillator(&pSlot->lfo);
+        LFO_SetProcessMode(&pSlot->lfo, LFO_PROCESS_BLOCK);
+        LFO_SetAmplitude(&pSlot->lfo, 1.0);
+        LFO_SetOffset(&pSlot->lfo, 0.0);
+        
+        pSlot->num_subscribers = 0;
+        pSlot->is_rendered = false;
+        pSlot->rendered_pos = 0;
+    }
+    
+    return true;
+}
+
+int MODBUS_Subscribe(t_DAFX_ModulationBus *pBUS, t_lfo_algo_select shape, float division, float phase_offset)
+{
+    int free_slot = -1;
+    
+    division = DAFX_MAX(division, MODBUS_MIN_DIVISION);
+    phase_offset = phase_offset - floorf(phase_offset);
+    
+    for (int s = 0; s < MODBUS_MAX_NUMOF_SLOTS; s++)
+    {
+        t_modbus_slot *pSlot = pBUS->slots + s;
+        
+        if (pSlot->num_subscribers == 0) {
+            if (free_slot < 0)
+                free_slot = s;
+        } else if (pSlot->shape == shape && pSlot->division == division && pSlot->phase_offset == phase_offset) {
+            pSlot->num_subscribers++;
+            return s;
+        }
+    }
+    
+    if (free_slot < 0)
+        return -1;
+    
+    t_modbus_slot *pSlot = pBUS->slots + free_slot;
+    pSlot->shape = shape;
+    pSlot->division = division;
+    pSlot->phase_offset = phase_offset;
+    pSlot->num_subscribers = 1;
+    LFO_SetMode(&pSlot->lfo, shape);
+    _LockSlot(pBUS, pSlot);
+    
+    return free_slot;
+}
+
+bool MODBUS_Unsubscribe(t_DAFX_ModulationBus *pBUS, int slot)
+{
+    if (slot < 0 || slot >= MODBUS_MAX_NUMOF_SLOTS || pBUS->slots[slot].num_subscribers == 0)
+        return false;
+    
+    pBUS->slots[slot].num_subscribers--;
+    return true;
+}
+
+float *MODBUS_GetBlock(t_DAFX_ModulationBus *pBUS, int slot)
+{
+    t_modbus_slot *pSlot = pBUS->slots + slot;
+    
+    if (!pSlot->is_rendered || pSlot->rendered_pos != pBUS->sample_pos)
+    {
+        LFO_RenderAt(&pSlot->lfo, pBUS->sample_pos, pSlot->lfo.p_output_block, pBUS->block_size);
+        pSlot->rendered_pos = pBUS->sample_pos;
+        pSlot->is_rendered = true;
+    }
+    
+    return pSlot->lfo.p_output_block;
+}
+
+bool MODBUS_Render(t_DAFX_ModulationBus *pBUS, int slot, t_DAFXLowFrequencyOscillator *pLFO)
+{
+    float *p_in = MODBUS_GetBlock(pBUS, slot);
+    float *p_out = pLFO->p_output_block;
+    int n = pBUS->block_size;
+    int i = 0;
+    
+    t_dafx_v4f amp = dafx_v4f_set1(pLFO->amp);
+    t_dafx_v4f offset = dafx_v4f_set1(pLFO->offset);
+    t_dafx_v4f clip_h = dafx_v4f_set1(pLFO->clip_h);
+    t_dafx_v4f clip_l = dafx_v4f_set1(pLFO->clip_l);
+    
+    //same mapping as the LFO itself applies to its waveform
+    for (; i + DAFX_SIMD_LANES <= n; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f y = dafx_v4f_madd(amp, dafx_v4f_loadu(p_in + i), offset);
+        dafx_v4f_storeu(p_out + i, dafx_v4f_max(dafx_v4f_min(y, clip_h), clip_l));
+    }
+    for (; i < n; i++) {
+        float y = pLFO->amp * p_in[i] + pLFO->offset;
+        p_out[i] = DAFX_MAX(DAFX_MIN(y, pLFO->clip_h), pLFO->clip_l);
+    }
+    
+    return true;
+}
+
+bool MODBUS_RenderControlRate(t_DAFX_ModulationBus *pBUS, int slot, t_DAFXLowFrequencyOscillator *pLFO, int period, float *p_points)
+{
+    float *p_in = MODBUS_GetBlock(pBUS, slot);
+    int num_points = pBUS->block_size / period;
+    
+    //the shared block is rendered at audio rate anyway, only the mapping runs at control rate
+    for (int k = 0; k < num_points; k++) {
+        float y = pLFO->amp * p_in[(k + 1) * period - 1] + pLFO->offset;
+        p_points[k] = DAFX_MAX(DAFX_MIN(y, pLFO->clip_h), pLFO->clip_l);
+    }
+    
+    return true;
+}
+
+float MODBUS_GetSlotFrequency(t_DAFX_ModulationBus *pBUS, int slot)
+{
+    return _SlotFrequency(pBUS, pBUS->slots + slot);
+}
+
+bool MODBUS_Advance(t_DAFX_ModulationBus *pBUS)
+{
+    pBUS->sample_pos += pBUS->block_size;
+    pBUS->beat_pos += (double)pBUS->block_size * (double)pBUS->bpm / (60.0 * (double)pBUS->fs);
+    
+    return true;
+}
+
+void DeallocModulationBus(t_DAFX_ModulationBus *pBUS)
+{
+    if(pBUS != NULL) {
+        for (int s = 0; s < MODBUS_MAX_NUMOF_SLOTS; s++) {
+            DeallocDAFXLowFrequencyOscillator(&pBUS->slots[s].lfo);
+        }
+    }
+}
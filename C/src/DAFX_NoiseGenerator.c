@@ -0,0 +1,302 @@
+//
+//  DAFX_NoiseGenerator.c
+//
+
+#include "DAFX_NoiseGenerator.h"
+#include "DAFX_InitNoiseGenerator.h"
+#include "DAFX_definitions.h"
+#include "DAFX_Denormal.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+//integer hash (lowbias32), spreads the seed over the stream states
+static uint32_t _Hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return (x != 0) ? x : 0x9e3779b9; //xorshift states must not be zero
+}
+
+//next number of the per-period stream, in [-1, 1)
+static float _NextBipolar(t_DAFXNoiseGenerator *pNG)
+{
+    uint32_t x = pNG->step_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pNG->step_state = x;
+    
+    uint32_t m = (x >> 9) | 0x3f800000u;
+    float f;
+    memcpy(&f, &m, sizeof(float));
+    return 2.0f * f - 3.0f;
+}
+
+//level of the period following the one at prev
+static float _NextLevel(t_DAFXNoiseGenerator *pNG, float prev)
+{
+    if (pNG->algo == NOISE_ALGO_SELECT_RANDOM_WALK)
+    {
+        //reflected at the bounds, so that the walk never sticks to them
+        float y = prev + pNG->walk_step * _NextBipolar(pNG);
+        if (y > 1.0f)
+            y = 2.0f - y;
+        else if (y < -1.0f)
+            y = -2.0f - y;
+        return y;
+    }
+    return _NextBipolar(pNG);
+}
+
+//starts a new period: the levels move by one
+static void _NextPeriod(t_DAFXNoiseGenerator *pNG)
+{
+    pNG->points[0] = pNG->points[1];
+    pNG->points[1] = pNG->points[2];
+    pNG->points[2] = pNG->points[3];
+    pNG->points[3] = _NextLevel(pNG, pNG->points[3]);
+}
+
+bool NOISE_SetSeed(t_DAFXNoiseGenerator *pNG, uint32_t seed)
+{
+    pNG->seed = seed;
+    for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+        pNG->lanes[k] = _Hash(seed + 0x9e3779b9u * (uint32_t)(k + 1));
+    }
+    pNG->step_state = _Hash(seed ^ 0x85ebca6bu);
+    
+    //the walk starts from 0, without a step before it
+    pNG->points[1] = (pNG->algo == NOISE_ALGO_SELECT_RANDOM_WALK) ? 0.0f : _NextBipolar(pNG);
+    pNG->points[0] = pNG->points[1];
+    pNG->points[2] = _NextLevel(pNG, pNG->points[1]);
+    pNG->points[3] = _NextLevel(pNG, pNG->points[2]);
+    pNG->phase = 0;
+    
+    return true;
+}
+
+bool NOISE_ReinitPhase(t_DAFXNoiseGenerator *pNG)
+{
+    if (pNG->phase != 0)
+        _NextPeriod(pNG);
+    pNG->phase = 0;
+    return true;
+}
+
+bool NOISE_SetMode(t_DAFXNoiseGenerator *pNG, t_noise_algo_select algo)
+{
+    if (algo < NoiseGenerator_N_ALGOS)
+        pNG->algo = algo;
+    return true;
+}
+
+bool NOISE_SetFrequency(t_DAFXNoiseGenerator *pNG, float f)
+{
+    pNG->f = DAFX_MAX(f, 0.0);
+    
+    double inc = (double)pNG->f / (double)pNG->fs;
+    pNG->phase_inc = (inc >= 1.0) ? UINT64_MAX : (uint64_t)(inc * 18446744073709551616.0); // * 2^64
+    
+    return true;
+}
+
+bool NOISE_SetTempoDivision(t_DAFXNoiseGenerator *pNG, float bpm, float division)
+{
+    return NOISE_SetFrequency(pNG, bpm / (60.0 * DAFX_MAX(division, 1e-3)));
+}
+
+bool NOISE_SetAmplitude(t_DAFXNoiseGenerator *pNG, float a)
+{
+    pNG->amp = DAFX_MAX(a, 0.0);
+    return true;
+}
+
+bool NOISE_SetOffset(t_DAFXNoiseGenerator *pNG, float off)
+{
+    pNG->offset = off;
+    return true;
+}
+
+bool NOISE_SetClipHigh(t_DAFXNoiseGenerator *pNG, float clip_h)
+{
+    pNG->clip_h = clip_h;
+    return true;
+}
+
+bool NOISE_SetClipLow(t_DAFXNoiseGenerator *pNG, float clip_l)
+{
+    pNG->clip_l = clip_l;
+    return true;
+}
+
+bool NOISE_SetWalkStep(t_DAFXNoiseGenerator *pNG, float step)
+{
+    pNG->walk_step = DAFX_MAX(DAFX_MIN(step, NOISE_MAX_WALK_STEP), NOISE_MIN_WALK_STEP);
+    return true;
+}
+
+bool InitDAFXNoiseGenerator(t_DAFXNoiseGenerator *pNG)
+{
+    // ---- general, wrapper ---- //
+    pNG->p_output_block = (float *) calloc(pNG->block_size, sizeof(float));
+    
+    //default mode
+    pNG->algo = NOISE_ALGO_SELECT_RANDOM_WALK;
+    
+    //common params
+    NOISE_SetFrequency(pNG, NOISE_INIT_DEFAULT_FREQ_HZ);
+    pNG->amp = NOISE_INIT_DEFAULT_AMP;
+    pNG->offset = NOISE_INIT_DEFAULT_OFFSET;
+    pNG->clip_h = NOISE_INIT_DEFAULT_CLIP_H;
+    pNG->clip_l = NOISE_INIT_DEFAULT_CLIP_L;
+    pNG->walk_step = NOISE_INIT_DEFAULT_WALK_STEP;
+    
+    NOISE_SetSeed(pNG, NOISE_INIT_DEFAULT_SEED);
+    
+    return true;
+}
+
+//stores a vector, partial at the end of a segment
+static inline void _StoreLanes(float *pOutput, int i, int n, t_dafx_v4f y)
+{
+    if (i + DAFX_SIMD_LANES <= n) {
+        dafx_v4f_storeu(pOutput + i, y);
+    } else {
+        float tail[DAFX_SIMD_LANES];
+        dafx_v4f_storeu(tail, y);
+        memcpy(pOutput + i, tail, sizeof(float) * (n - i));
+    }
+}
+
+static void _GenerateWhiteNoise(t_DAFXNoiseGenerator *pNG, float *pOutput, int n)
+{
+    t_dafx_v4u x = dafx_v4u_loadu(pNG->lanes);
+    
+    for (int i = 0; i < n; i += DAFX_SIMD_LANES) {
+        x = dafx_v4u_xorshift32(x);
+        _StoreLanes(pOutput, i, n, dafx_v4u_to_bipolar(x));
+    }
+    dafx_v4u_storeu(pNG->lanes, x);
+}
+
+//one period or part of it: the level held, or the Catmull-Rom spline through the walk
+//(points[1] at the start of the period, points[2] at the end)
+static void _FillSegment(t_DAFXNoiseGenerator *pNG, float *pOutput, int n)
+{
+    if (pNG->algo == NOISE_ALGO_SELECT_SAMPLE_HOLD)
+    {
+        t_dafx_v4f level = dafx_v4f_set1(pNG->points[1]);
+        for (int i = 0; i < n; i += DAFX_SIMD_LANES) {
+            _StoreLanes(pOutput, i, n, level);
+        }
+        return;
+    }
+    
+    float *p = pNG->points;
+    t_dafx_v4f c0 = dafx_v4f_set1(p[1]);
+    t_dafx_v4f c1 = dafx_v4f_set1(0.5f * (p[2] - p[0]));
+    t_dafx_v4f c2 = dafx_v4f_set1(p[0] - 2.5f * p[1] + 2.0f * p[2] - 0.5f * p[3]);
+    t_dafx_v4f c3 = dafx_v4f_set1(0.5f * (p[3] - p[0]) + 1.5f * (p[1] - p[2]));
+    
+    //position in the period: t0 + i * dt, with i exact in float
+    float t0 = (float)((double)pNG->phase * (1.0 / 18446744073709551616.0));
+    float dt = (float)((double)pNG->phase_inc * (1.0 / 18446744073709551616.0));
+    float idx0[DAFX_SIMD_LANES];
+    for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+        idx0[k] = (float)k;
+    }
+    t_dafx_v4f idx = dafx_v4f_loadu(idx0);
+    t_dafx_v4f v_t0 = dafx_v4f_set1(t0);
+    t_dafx_v4f v_dt = dafx_v4f_set1(dt);
+    t_dafx_v4f v_step = dafx_v4f_set1((float)DAFX_SIMD_LANES);
+    
+    for (int i = 0; i < n; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f t = dafx_v4f_madd(idx, v_dt, v_t0);
+        t_dafx_v4f y = dafx_v4f_madd(t, c3, c2);
+        y = dafx_v4f_madd(t, y, c1);
+        y = dafx_v4f_madd(t, y, c0);
+        _StoreLanes(pOutput, i, n, y);
+        idx = dafx_v4f_add(idx, v_step);
+    }
+}
+
+static void _GenerateSteppedNoise(t_DAFXNoiseGenerator *pNG, float *pOutput, int n)
+{
+    int i = 0;
+    
+    while (i < n)
+    {
+        //samples up to the end of the period (the phase wraps around after the last one)
+        int len = n - i;
+        bool period_ends = false;
+        if (pNG->phase_inc > 0) {
+            uint64_t left = (~pNG->phase) / pNG->phase_inc + 1;
+            if (left <= (uint64_t)len) {
+                len = (int)left;
+                period_ends = true;
+            }
+        }
+        
+        _FillSegment(pNG, pOutput + i, len);
+        pNG->phase += (uint64_t)len * pNG->phase_inc;
+        i += len;
+        
+        if (period_ends)
+            _NextPeriod(pNG);
+    }
+}
+
+bool DAFXNoiseGenerator(t_DAFXNoiseGenerator *pNG)
+{
+    int n = pNG->block_size;
+    float *pOutput = pNG->p_output_block;
+    t_dafx_fp_state fp_state;
+    
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    if (pNG->algo == NOISE_ALGO_SELECT_WHITE) {
+        _GenerateWhiteNoise(pNG, pOutput, n);
+        pNG->phase += (uint64_t)n * pNG->phase_inc;
+    } else {
+        _GenerateSteppedNoise(pNG, pOutput, n);
+    }
+    
+    //amplitude, offset and clipping, as in the LFO
+    t_dafx_v4f amp = dafx_v4f_set1(pNG->amp);
+    t_dafx_v4f offset = dafx_v4f_set1(pNG->offset);
+    t_dafx_v4f clip_h = dafx_v4f_set1(pNG->clip_h);
+    t_dafx_v4f clip_l = dafx_v4f_set1(pNG->clip_l);
+    int i = 0;
+    for (; i + DAFX_SIMD_LANES <= n; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f y = dafx_v4f_madd(amp, dafx_v4f_loadu(pOutput + i), offset);
+        dafx_v4f_storeu(pOutput + i, dafx_v4f_max(dafx_v4f_min(y, clip_h), clip_l));
+    }
+    for (; i < n; i++) {
+        float y = pNG->amp * pOutput[i] + pNG->offset;
+        pOutput[i] = DAFX_MAX(DAFX_MIN(y, pNG->clip_h), pNG->clip_l);
+    }
+    
+    DAFX_DenormalGuardEnd(&fp_state);
+    
+    return true;
+}
+
+bool DAFXBypassNoiseGenerator(t_DAFXNoiseGenerator *pNG)
+{
+    memset(pNG->p_output_block, 0, sizeof(float) * pNG->block_size);
+    return true;
+}
+
+void DeallocDAFXNoiseGenerator(t_DAFXNoiseGenerator *pNG)
+{
+    FREE(pNG->p_output_block);
+}
@@ -6,6 +6,8 @@
 #include "DAFX_Overdrive.h"
 #include "DAFX_InitOverdrive.h"
 #include "DAFX_definitions.h"
+#include "DAFX_Denormal.h"
+#include "DAFX_Saturation.h"
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 #include <math.h>
@@ -13,6 +15,277 @@
 #include <Accelerate/Accelerate.h>
 #endif
 
+
+// ---- block kernels, one per algo ---- //
+
+//tanh(tan_param * x)
+static bool _OverdriveTanh(t_DAFXOverdrive *pOD, float *p_in, float *p_out, int n, float in_gain)
+{
+    return SAT_TanhBlock(pOD->tanh_tier, p_in, p_out, n, in_gain * pOD->tan_param, pOD->out_gain);
+}
+
+//sin(pi/2 * x / thresh), clipped beyond the threshold
+static bool _OverdriveSin(t_DAFXOverdrive *pOD, float *p_in, float *p_out, int n, float in_gain)
+{
+    return SAT_SineClipBlock(p_in, p_out, n, in_gain * pOD->inv_thresh, pOD->out_gain);
+}
+
+//sign(x) * (1 - e^(-exp_param * |x| / thresh))
+static bool _OverdriveExp(t_DAFXOverdrive *pOD, float *p_in, float *p_out, int n, float in_gain)
+{
+    return SAT_ExpClipBlock(p_in, p_out, n, in_gain * pOD->exp_param * pOD->inv_thresh, pOD->out_gain);
+}
+
+//measured transfer curve (only selectable once a table is loaded)
+static bool _OverdriveTable(t_DAFXOverdrive *pOD, float *p_in, float *p_out, int n, float in_gain)
+{
+    return SAT_TableBlock(DAFX_ATOMIC_LOAD(pOD->p_table), pOD->table_interp, p_in, p_out, n, in_gain, pOD->out_gain);
+}
+
+//antialiased counterpart of the analytic kernels above. It keeps an input history, so it only runs on the audio path
+static bool _OverdriveADAA(t_DAFXOverdrive *pOD, float *p_in, float *p_out, int n, float in_gain)
+{
+    switch (pOD->algo) {
+        case OD_ALGO_SELECT_SIN:
+            return SAT_ADAABlock(&pOD->adaa, SAT_SHAPE_SINE, pOD->adaa_order, p_in, p_out, n, in_gain * pOD->inv_thresh, pOD->out_gain);
+        case OD_ALGO_SELECT_EXP:
+            return SAT_ADAABlock(&pOD->adaa, SAT_SHAPE_EXP, pOD->adaa_order, p_in, p_out, n, in_gain * pOD->exp_param * pOD->inv_thresh, pOD->out_gain);
+        default:
+            return SAT_ADAABlock(&pOD->adaa, SAT_SHAPE_TANH, pOD->adaa_order, p_in, p_out, n, in_gain * pOD->tan_param, pOD->out_gain);
+    }
+}
+
+//the shaper of the audio path, run by the oversampler (straight away at a factor of 1)
+static bool _OverdriveShaper(void *p_process_state, float *p_in, float *p_out, int n)
+{
+    t_DAFXOverdrive *pOD = (t_DAFXOverdrive *)p_process_state;
+    tf_gain_function pf_gain = (tf_gain_function) pOD->pf_gain_func; //Overdrive kernel currently pointed at
+    
+    if (pOD->adaa_order != SAT_ADAA_OFF && pOD->algo != OD_ALGO_SELECT_TABLE)
+        return _OverdriveADAA(pOD, p_in, p_out, n, pOD->in_gain);
+    return pf_gain(pOD, p_in, p_out, n, pOD->in_gain);
+}
+
+// ---- setters ---- //
+
+bool OD_SetAlgo(t_DAFXOverdrive *pOD, t_od_algo_select algo)
+{
+    switch (algo) {
+        case OD_ALGO_SELECT_TANH:
+            pOD->pf_gain_func = &_OverdriveTanh;
+            break;
+        case OD_ALGO_SELECT_SIN:
+            pOD->pf_gain_func = &_OverdriveSin;
+            break;
+        case OD_ALGO_SELECT_EXP:
+            pOD->pf_gain_func = &_OverdriveExp;
+            break;
+        case OD_ALGO_SELECT_TABLE:
+            if (pOD->p_table == NULL)
+                return true;
+            pOD->pf_gain_func = &_OverdriveTable;
+            break;
+        default:
+            return true;
+    }
+    
+    //the ADAA history went stale while the table ran
+    if (pOD->algo == OD_ALGO_SELECT_TABLE && algo != OD_ALGO_SELECT_TABLE)
+        SAT_ResetADAA(&pOD->adaa);
+    if (algo != pOD->algo)
+        pOD->curve_dirty = true;
+    pOD->algo = algo;
+    
+    return true;
+}
+
+//the gain curve is drawn without the input gain
+bool OD_SetInGain(t_DAFXOverdrive *pOD, float in_gain)
+{
+    pOD->in_gain = DAFX_MAX(DAFX_MIN(in_gain, OD_INIT_IN_GAIN_MAX), OD_INIT_IN_GAIN_MIN);
+    return true;
+}
+
+bool OD_SetOutGain(t_DAFXOverdrive *pOD, float out_gain)
+{
+    out_gain = DAFX_MAX(DAFX_MIN(out_gain, OD_INIT_OUT_GAIN_MAX), OD_INIT_OUT_GAIN_MIN);
+    if (out_gain != pOD->out_gain)
+        pOD->curve_dirty = true;
+    pOD->out_gain = out_gain;
+    return true;
+}
+
+bool OD_SetTanParam(t_DAFXOverdrive *pOD, float tan_param)
+{
+    tan_param = DAFX_MAX(DAFX_MIN(tan_param, OD_INIT_TAN_MAX), OD_INIT_TAN_MIN);
+    if (tan_param != pOD->tan_param && pOD->algo == OD_ALGO_SELECT_TANH)
+        pOD->curve_dirty = true;
+    pOD->tan_param = tan_param;
+    return true;
+}
+
+bool OD_SetExpParam(t_DAFXOverdrive *pOD, float exp_param)
+{
+    exp_param = DAFX_MAX(DAFX_MIN(exp_param, OD_INIT_EXP_MAX), OD_INIT_EXP_MIN);
+    if (exp_param != pOD->exp_param && pOD->algo == OD_ALGO_SELECT_EXP)
+        pOD->curve_dirty = true;
+    pOD->exp_param = exp_param;
+    return true;
+}
+
+bool OD_SetThreshold(t_DAFXOverdrive *pOD, float thresh)
+{
+    thresh = DAFX_MAX(DAFX_MIN(thresh, OD_INIT_THRESH_MAX), OD_INIT_THRESH_MIN);
+    if (thresh != pOD->thresh && pOD->algo != OD_ALGO_SELECT_TANH)
+        pOD->curve_dirty = true;
+    pOD->thresh = thresh;
+    pOD->inv_thresh = 1.0f / thresh;
+    return true;
+}
+
+bool OD_SetTanhTier(t_DAFXOverdrive *pOD, t_sat_tanh_tier tier)
+{
+    if (tier >= Saturation_N_TANH_TIERS)
+        return true;
+    
+    if (tier != pOD->tanh_tier && pOD->algo == OD_ALGO_SELECT_TANH)
+        pOD->curve_dirty = true;
+    pOD->tanh_tier = tier;
+    return true;
+}
+
+//the gain curve shows the plain shaper either way
+bool OD_SetADAAOrder(t_DAFXOverdrive *pOD, t_sat_adaa_order order)
+{
+    if (order >= Saturation_N_ADAA_ORDERS)
+        return true;
+    
+    //whatever history is left from the last time it was on is stale
+    if (pOD->adaa_order == SAT_ADAA_OFF && order != SAT_ADAA_OFF)
+        SAT_ResetADAA(&pOD->adaa);
+    pOD->adaa_order = order;
+    return true;
+}
+
+bool OD_SetOversampling(t_DAFXOverdrive *pOD, int factor)
+{
+    int prev_factor = pOD->os.factor;
+    
+    if (!OS_SetFactor(&pOD->os, factor))
+        return true;
+    
+    //the ADAA history was taken at the old rate
+    if (factor != prev_factor)
+        SAT_ResetADAA(&pOD->adaa);
+    return true;
+}
+
+bool OD_SetOversamplingFilter(t_DAFXOverdrive *pOD, int filter)
+{
+    OS_SetFilter(&pOD->os, filter);
+    return true;
+}
+
+bool OD_SetTableInterp(t_DAFXOverdrive *pOD, t_sat_table_interp interp)
+{
+    if (interp >= Saturation_N_TABLE_INTERPS)
+        return true;
+    
+    if (interp != pOD->table_interp && pOD->algo == OD_ALGO_SELECT_TABLE)
+        pOD->curve_dirty = true;
+    pOD->table_interp = interp;
+    return true;
+}
+
+bool OD_ReleaseRetiredTable(t_DAFXOverdrive *pOD, bool force)
+{
+    if (pOD->p_retired_table == NULL)
+        return true;
+    
+    //the block that may have read it before the swap has not ended yet
+    if (!force && DAFX_ATOMIC_LOAD(pOD->num_blocks) == pOD->retired_at_block)
+        return false;
+    
+    DeallocDAFXSaturationTable(pOD->p_retired_table);
+    FREE(pOD->p_retired_table);
+    pOD->p_retired_table = NULL;
+    return true;
+}
+
+//swaps the table in, the previous private one is retired until the audio thread is done with it
+//(false if the one retired before is still in use, nothing is swapped then)
+static bool _SwapTable(t_DAFXOverdrive *pOD, t_DAFXSaturationTable *pTable, bool own)
+{
+    if (!OD_ReleaseRetiredTable(pOD, false))
+        return false;
+    
+    pOD->p_retired_table = pOD->p_own_table;
+    pOD->p_own_table = own ? pTable : NULL;
+    DAFX_ATOMIC_STORE(pOD->p_table, pTable);
+    
+    //read after the store: a block ending from now on has started with the new table, or was already running
+    pOD->retired_at_block = DAFX_ATOMIC_LOAD(pOD->num_blocks);
+    
+    if (pOD->algo == OD_ALGO_SELECT_TABLE)
+        pOD->curve_dirty = true;
+    return true;
+}
+
+bool OD_LoadTable(t_DAFXOverdrive *pOD, float *p_y, int n_points, float x_min, float x_max)
+{
+    t_DAFXSaturationTable *pTable = (t_DAFXSaturationTable *) calloc(1, sizeof(t_DAFXSaturationTable));
+    
+    if (!InitDAFXSaturationTable(pTable, p_y, n_points, x_min, x_max))
+    {
+        FREE(pTable);
+        return false;
+    }
+    
+    if (!_SwapTable(pOD, pTable, true))
+    {
+        DeallocDAFXSaturationTable(pTable);
+        FREE(pTable);
+        return false;
+    }
+    return true;
+}
+
+bool OD_LoadTableFile(t_DAFXOverdrive *pOD, const char *p_path)
+{
+    t_DAFXSaturationTable *pTable = (t_DAFXSaturationTable *) calloc(1, sizeof(t_DAFXSaturationTable));
+    
+    if (!InitDAFXSaturationTableFile(pTable, p_path))
+    {
+        FREE(pTable);
+        return false;
+    }
+    
+    if (!_SwapTable(pOD, pTable, true))
+    {
+        DeallocDAFXSaturationTable(pTable);
+        FREE(pTable);
+        return false;
+    }
+    return true;
+}
+
+bool OD_SetSharedTable(t_DAFXOverdrive *pOD, t_DAFXSaturationTable *pTable)
+{
+    if (pTable == NULL)
+        return false;
+    
+    return _SwapTable(pOD, pTable, false);
+}
+
+//ADAA delays by half a sample per order, at the oversampled rate
+float OD_GetLatency(t_DAFXOverdrive *pOD)
+{
+    float adaa_delay = (pOD->algo == OD_ALGO_SELECT_TABLE) ? 0.0f : 0.5f * (float)pOD->adaa_order;
+    
+    return OS_GetLatency(&pOD->os) + adaa_delay / (float)pOD->os.factor;
+}
+
+
 bool InitDAFXOverdrive(t_DAFXOverdrive *pOD)
 {
     //Signal vector size
@@ -24,6 +297,7 @@ bool InitDAFXOverdrive(t_DAFXOverdrive *pOD)
     
     //degault overdrive method
     pOD->algo = OD_ALGO_SELECT_TANH;
+    OD_SetAlgo(pOD, OD_ALGO_SELECT_TANH);
     
     //OD params
     pOD->in_gain = OD_INIT_DEFAULT_IN_GAIN;
@@ -32,10 +306,30 @@ bool InitDAFXOverdrive(t_DAFXOverdrive *pOD)
     pOD->inv_thresh = 1.0 / OD_INIT_DEFAULT_THRESHOLD;
     pOD->tan_param = OD_INIT_DEFAULT_TAN_PARAM;
     pOD->exp_param = OD_INIT_DEFAULT_EXP_PARAM;
+    pOD->tanh_tier = OD_INIT_DEFAULT_TANH_TIER;
+    
+    //no transfer curve until one is loaded
+    pOD->p_table = NULL;
+    pOD->p_own_table = NULL;
+    pOD->p_retired_table = NULL;
+    pOD->retired_at_block = 0;
+    pOD->num_blocks = 0;
+    pOD->table_interp = OD_INIT_DEFAULT_TABLE_INTERP;
+    
+    //ADAA input history and scratch, sized for a full block at the highest oversampling factor
+    pOD->adaa.block_size = OS_MAX_FACTOR * block_size;
+    InitDAFXSaturationADAA(&pOD->adaa);
+    pOD->adaa_order = OD_INIT_DEFAULT_ADAA_ORDER;
+    
+    pOD->os.block_size = block_size;
+    InitDAFXOversampler(&pOD->os);
+    OS_SetFactor(&pOD->os, OD_INIT_DEFAULT_OS_FACTOR);
+    OS_SetFilter(&pOD->os, OD_INIT_DEFAULT_OS_FILTER);
     
     //Allocate memory for the displayed gain curve
     // Dependency - the displayed gain curve is the same size as the signal block length
     pOD->p_gain_curve = (float *) calloc(block_size, sizeof(float));
+    pOD->curve_dirty = true;
     ReDrawGainCurve(pOD);
     
     return true;
@@ -43,40 +337,17 @@ bool InitDAFXOverdrive(t_DAFXOverdrive *pOD)
 
 bool DAFXOverdrive(t_DAFXOverdrive *pOD)
 {
-    int block_size = pOD->block_size;
-    float *pInput = pOD->p_input_block;
-    float *pOutput = pOD->p_output_block;
-    
-    float in_gain = pOD->in_gain;
-    float out_gain = pOD->out_gain;
-    float tan_param = pOD->tan_param;
-    float exp_param = pOD->exp_param;
-    float thresh = pOD->thresh;
-    float saturation = 0.5 * pOD->inv_thresh; //for sinus only
-    
-    //TODO: TURN THE THREE METHODS INTO 3 DIFFERENT PROCESS FUNCTIONS SO THAT THE GAIN PLOTTER CAN CALL THEM TOO
-    for (int i = 0; i < block_size; i++)
-    {
-        //apply input gain
-        float x = in_gain * pInput[i];
-        
-        // tanh
-        pOutput[i] = out_gain * tanh(tan_param * x);
-        
-        //sin
-    //    if (x > thresh)
-    //    {
-    //        pOutput[i] = out_gain;
-    //    }
-    //    else if (x < -1.0*thresh)
-    //    {
-    //        pOutput[i] = -1.0 * out_gain;
-    //    }
-    //    else
-    //    {
-    //        pOutput[i] = out_gain * sinf(saturation * ONE_PI * x);
-    //    }
-    }
+    t_dafx_fp_state fp_state;
+    
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    //the algo is picked once for the whole block
+    DAFXOversampler(&pOD->os, &_OverdriveShaper, pOD, pOD->p_input_block, pOD->p_output_block, pOD->block_size);
+    
+    DAFX_DenormalGuardEnd(&fp_state);
+    
+    //done with the table read at the start of the block (see OD_ReleaseRetiredTable)
+    DAFX_ATOMIC_STORE(pOD->num_blocks, pOD->num_blocks + 1);
     
     return true;
 }
@@ -84,6 +355,7 @@ bool DAFXOverdrive(t_DAFXOverdrive *pOD)
 bool DAFXBypassOverdrive(t_DAFXOverdrive *pOD)
 {
     memcpy(pOD->p_output_block, pOD->p_input_block, sizeof(float) * pOD->block_size);
+    DAFX_ATOMIC_STORE(pOD->num_blocks, pOD->num_blocks + 1);
     return true;
 }
 
@@ -92,43 +364,21 @@ bool DAFXBypassOverdrive(t_DAFXOverdrive *pOD)
 //Calculates the output gain for all input gain values
 bool ReDrawGainCurve(t_DAFXOverdrive *pOD)
 {
+    tf_gain_function pf_gain = (tf_gain_function) pOD->pf_gain_func; //Overdrive kernel currently pointed at
+    
     // The displayed gain curve is the same length as teh signal block size
     float increment = 1.0f / (float)pOD->block_size;
-    float x = 0.0;
     
-    //TODO delete these when the function pointers will be implemented properly
-    float in_gain = pOD->in_gain;
-    float out_gain = pOD->out_gain;
-    float tan_param = pOD->tan_param;
-    float exp_param = pOD->exp_param;
-    float thresh = pOD->thresh;
-    float saturation = 0.5 * pOD->inv_thresh; //for sinus only
+    if (!pOD->curve_dirty)
+        return true;
     
-  //  tf_gain_function pf_calculate_gain = (tf_gain_function) pOD->pf_gain_func; //Overdrive function currently pointed at
-    
-    for (int i = 0; i < pOD->block_size; i++)
-    {
-        //TODO: CALL THE CURRENT OVERDRIVE PROCESS FUNCTION HERE
-        
-        //tanh
-        pOD->p_gain_curve[i] = pOD->out_gain * tanh(pOD->tan_param * x);
-        
-        //sin
- //       if (x > thresh)
- //       {
- //           pOD->p_gain_curve[i] = out_gain;
- //       }
- //       else if (x < -1.0*thresh)
- //       {
- //           pOD->p_gain_curve[i] = -1.0 * out_gain;
- //       }
- //       else
- //       {
- //           pOD->p_gain_curve[i] = out_gain * sinf(saturation * ONE_PI * x);
- //       }
-               
-        x += increment;
+    //input values first, then the same kernel as the audio path over them in place
+    for (int i = 0; i < pOD->block_size; i++) {
+        pOD->p_gain_curve[i] = (float)i * increment;
     }
+    pf_gain(pOD, pOD->p_gain_curve, pOD->p_gain_curve, pOD->block_size, 1.0f);
+    
+    pOD->curve_dirty = false;
     
     return true;
 }
@@ -138,4 +388,11 @@ void DeallocDAFXOverdrive(t_DAFXOverdrive *pOD)
     FREE(pOD->p_input_block);
     FREE(pOD->p_output_block);
     FREE(pOD->p_gain_curve);
+    DeallocDAFXSaturationADAA(&pOD->adaa);
+    DeallocDAFXOversampler(&pOD->os);
+    if (pOD->p_own_table != NULL) {
+        DeallocDAFXSaturationTable(pOD->p_own_table);
+        FREE(pOD->p_own_table);
+    }
+    OD_ReleaseRetiredTable(pOD, true);
 }
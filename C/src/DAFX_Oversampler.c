@@ -0,0 +1,548 @@
+//
+//  DAFX_Oversampler.c
+//
+
+#include "DAFX_Oversampler.h"
+#include "DAFX_definitions.h"
+
+
+//nonzero taps of a FIR halfband h[n] of length 2 * n_taps - 1: p_taps[k] = h[2k],
+//the center tap h[n_taps - 1] = 0.5 aside. Symmetric, so they read the same either way
+typedef struct{
+    int n_taps;
+    const float *p_taps;
+}t_os_fir_halfband;
+
+//allpass coefficients of a two-path IIR halfband, ascending and zero padded. Path 0 gets the even ones,
+//path 1 the odd ones: H(z) = 0.5 * (A0(z^2) + z^-1 * A1(z^2)), A(z^2) = (a + z^-2) / (1 + a * z^-2)
+typedef struct{
+    int n_coefs;
+    const float *p_coefs;
+}t_os_iir_halfband;
+
+
+// ---- halfband designs, from the host rate up ---- //
+
+//Kaiser windowed (beta 10), 83 taps: 0.21 / 0.29 fs, 100 dB
+static const float c_fir_taps_0[42] = {
+    2.757259679e-6f, -1.516192367e-5f, 4.513716575e-5f, -1.060330210e-4f, 2.169511322e-4f, -4.038455313e-4f,
+    7.005470293e-4f, -1.149733963e-3f, 1.803982258e-3f, -2.727214491e-3f, 3.997185773e-3f, -5.710215137e-3f,
+    7.990479640e-3f, -1.100854790e-2f, 1.501937487e-2f, -2.044452978e-2f, 2.806704457e-2f, -3.956306911e-2f,
+    5.931134014e-2f, -1.034396051e-1f, 3.174131561e-1f, 3.174131561e-1f, -1.034396051e-1f, 5.931134014e-2f,
+    -3.956306911e-2f, 2.806704457e-2f, -2.044452978e-2f, 1.501937487e-2f, -1.100854790e-2f, 7.990479640e-3f,
+    -5.710215137e-3f, 3.997185773e-3f, -2.727214491e-3f, 1.803982258e-3f, -1.149733963e-3f, 7.005470293e-4f,
+    -4.038455313e-4f, 2.169511322e-4f, -1.060330210e-4f, 4.513716575e-5f, -1.516192367e-5f, 2.757259679e-6f
+};
+
+//27 taps: 0.104 / 0.396 fs, 100 dB
+static const float c_fir_taps_1[14] = {
+    8.696009455e-6f, -3.761803433e-4f, 2.587052407e-3f, -1.029718454e-2f, 3.073974203e-2f, -8.215219506e-2f,
+    3.094900695e-1f, 3.094900695e-1f, -8.215219506e-2f, 3.073974203e-2f, -1.029718454e-2f, 2.587052407e-3f,
+    -3.761803433e-4f, 8.696009455e-6f
+};
+
+//19 taps: 0.052 / 0.448 fs, 90 dB
+static const float c_fir_taps_2[10] = {
+    1.256047195e-5f, -1.409581036e-3f, 1.298121918e-2f, -6.173016829e-2f, 3.001459697e-1f, 3.001459697e-1f,
+    -6.173016829e-2f, 1.298121918e-2f, -1.409581036e-3f, 1.256047195e-5f
+};
+
+//elliptic (transition bandwidth 0.04 fs), 100 dB
+static const float c_iir_coefs_0[OS_IIR_MAX_NUMOF_COEFS] = {
+    4.063346092e-2f, 1.505051290e-1f, 3.007570560e-1f, 4.607745050e-1f, 6.095243149e-1f, 7.385038411e-1f,
+    8.492238104e-1f, 9.497427837e-1f
+};
+
+//transition bandwidth 0.146 fs, 120 dB
+static const float c_iir_coefs_1[OS_IIR_MAX_NUMOF_COEFS] = {
+    3.002451776e-2f, 1.160311839e-1f, 2.480958174e-1f, 4.160222901e-1f, 6.158400280e-1f, 8.562802746e-1f
+};
+
+//transition bandwidth 0.198 fs, 100 dB
+static const float c_iir_coefs_2[OS_IIR_MAX_NUMOF_COEFS] = {
+    4.990330084e-2f, 1.946846943e-1f, 4.283277272e-1f, 7.680577432e-1f
+};
+
+static const t_os_fir_halfband c_fir_halfbands[OS_MAX_NUMOF_STAGES] = {
+    {42, c_fir_taps_0},
+    {14, c_fir_taps_1},
+    {10, c_fir_taps_2},
+};
+
+static const t_os_iir_halfband c_iir_halfbands[OS_MAX_NUMOF_STAGES] = {
+    {8, c_iir_coefs_0},
+    {6, c_iir_coefs_1},
+    {4, c_iir_coefs_2},
+};
+
+
+// ---- FIR halfbands ---- //
+
+//p_acc[0] += sum g[k] x[k .. k + 3]
+static inline void _FIRDot(const float *g, int K, const float *p_x, t_dafx_v4f *p_acc)
+{
+    t_dafx_v4f acc = p_acc[0];
+
+    for (int k = 0; k < K; k++) {
+        acc = dafx_v4f_madd(dafx_v4f_set1(g[k]), dafx_v4f_loadu(p_x + k), acc);
+    }
+    p_acc[0] = acc;
+}
+
+//Same for 4 vectors of consecutive outputs, with an accumulator each so that the
+//multiply-add chains overlap and every tap is broadcast once
+static inline void _FIRDot4(const float *g, int K, const float *p_x, t_dafx_v4f *p_acc)
+{
+    t_dafx_v4f acc0 = p_acc[0];
+    t_dafx_v4f acc1 = p_acc[1];
+    t_dafx_v4f acc2 = p_acc[2];
+    t_dafx_v4f acc3 = p_acc[3];
+
+    for (int k = 0; k < K; k++)
+    {
+        t_dafx_v4f gk = dafx_v4f_set1(g[k]);
+        acc0 = dafx_v4f_madd(gk, dafx_v4f_loadu(p_x + k), acc0);
+        acc1 = dafx_v4f_madd(gk, dafx_v4f_loadu(p_x + k + 4), acc1);
+        acc2 = dafx_v4f_madd(gk, dafx_v4f_loadu(p_x + k + 8), acc2);
+        acc3 = dafx_v4f_madd(gk, dafx_v4f_loadu(p_x + k + 12), acc3);
+    }
+    p_acc[0] = acc0;
+    p_acc[1] = acc1;
+    p_acc[2] = acc2;
+    p_acc[3] = acc3;
+}
+
+//Even outputs: 2 * sum g[k] x[i - k], odd outputs: x[i - n_taps / 2 + 1] (the center tap)
+static void _FIRUp(const t_os_fir_halfband *pHB, float *p_hist, float *p_in, float *p_out, int n)
+{
+    const float *g = pHB->p_taps;
+    int K = pHB->n_taps;
+    float *x = p_hist + K - 1;
+    int i = 0;
+
+    memcpy(x, p_in, sizeof(float) * n);
+
+    for (; i + 4 * DAFX_SIMD_LANES <= n; i += 4 * DAFX_SIMD_LANES)
+    {
+        t_dafx_v4f acc[4];
+        for (int v = 0; v < 4; v++) {
+            acc[v] = dafx_v4f_set1(0.0f);
+        }
+        _FIRDot4(g, K, p_hist + i, acc);
+        for (int v = 0; v < 4; v++) {
+            int j = i + v * DAFX_SIMD_LANES;
+            dafx_v4f_storeu_interleaved(p_out + 2 * j, dafx_v4f_add(acc[v], acc[v]), dafx_v4f_loadu(x + j - K / 2 + 1));
+        }
+    }
+    for (; i + DAFX_SIMD_LANES <= n; i += DAFX_SIMD_LANES)
+    {
+        t_dafx_v4f acc = dafx_v4f_set1(0.0f);
+        _FIRDot(g, K, p_hist + i, &acc);
+        dafx_v4f_storeu_interleaved(p_out + 2 * i, dafx_v4f_add(acc, acc), dafx_v4f_loadu(x + i - K / 2 + 1));
+    }
+    for (; i < n; i++)
+    {
+        float acc = 0.0f;
+        for (int k = 0; k < K; k++) {
+            acc += g[k] * p_hist[i + k];
+        }
+        p_out[2 * i] = 2.0f * acc;
+        p_out[2 * i + 1] = x[i - K / 2 + 1];
+    }
+
+    memmove(p_hist, p_hist + n, sizeof(float) * (K - 1));
+}
+
+//n outputs from 2n inputs: sum g[k] xe[i - k] + 0.5 * xo[i - n_taps / 2]
+static void _FIRDown(const t_os_fir_halfband *pHB, float *p_even_hist, float *p_odd_hist, float *p_in, float *p_out, int n)
+{
+    const float *g = pHB->p_taps;
+    int K = pHB->n_taps;
+    float *xe = p_even_hist + K - 1;
+    float *xo = p_odd_hist + K / 2;
+    t_dafx_v4f v_half = dafx_v4f_set1(0.5f);
+    int i = 0;
+
+    for (int j = 0; j < n; j++) {
+        xe[j] = p_in[2 * j];
+        xo[j] = p_in[2 * j + 1];
+    }
+
+    for (; i + 4 * DAFX_SIMD_LANES <= n; i += 4 * DAFX_SIMD_LANES)
+    {
+        t_dafx_v4f acc[4];
+        for (int v = 0; v < 4; v++) {
+            acc[v] = dafx_v4f_mul(v_half, dafx_v4f_loadu(p_odd_hist + i + v * DAFX_SIMD_LANES));
+        }
+        _FIRDot4(g, K, p_even_hist + i, acc);
+        for (int v = 0; v < 4; v++) {
+            dafx_v4f_storeu(p_out + i + v * DAFX_SIMD_LANES, acc[v]);
+        }
+    }
+    for (; i + DAFX_SIMD_LANES <= n; i += DAFX_SIMD_LANES)
+    {
+        t_dafx_v4f acc = dafx_v4f_mul(v_half, dafx_v4f_loadu(p_odd_hist + i));
+        _FIRDot(g, K, p_even_hist + i, &acc);
+        dafx_v4f_storeu(p_out + i, acc);
+    }
+    for (; i < n; i++)
+    {
+        float acc = 0.5f * p_odd_hist[i];
+        for (int k = 0; k < K; k++) {
+            acc += g[k] * p_even_hist[i + k];
+        }
+        p_out[i] = acc;
+    }
+
+    memmove(p_even_hist, p_even_hist + n, sizeof(float) * (K - 1));
+    memmove(p_odd_hist, p_odd_hist + n, sizeof(float) * (K / 2));
+}
+
+
+// ---- IIR halfbands ---- //
+
+/*
+ * Both allpass paths run at the lower rate, path 0 in lane 0 and path 1 in lane 1
+ * (lanes 2 and 3 repeat lane 1), one sample per iteration. Per path the states are
+ * its last input followed by the last output of every section, which is also the
+ * last input of the next one: state j of both paths is stored as a pair at 2j.
+ * Coefficients and states are held in vector locals for the whole block
+ */
+
+//{x0, x1, x1, x1}
+static inline t_dafx_v4f _Pair(float x0, float x1)
+{
+    return dafx_v4f_shift_in(dafx_v4f_set1(x1), x0);
+}
+
+//y = x1 + a * (x - y1), written as (x1 + a * x) - a * y1 so that the recursion through
+//y1 is a single multiply-add. The section input becomes its new x1
+static inline t_dafx_v4f _IIRSection(t_dafx_v4f a, t_dafx_v4f x, t_dafx_v4f *p_x1, t_dafx_v4f y1)
+{
+    t_dafx_v4f y = dafx_v4f_sub(dafx_v4f_madd(a, x, *p_x1), dafx_v4f_mul(a, y1));
+    *p_x1 = x;
+    return y;
+}
+
+//2 to 4 sections per path
+static inline t_dafx_v4f _IIRCascade(const t_dafx_v4f *a, t_dafx_v4f *s, t_dafx_v4f x, int n_sec)
+{
+    x = _IIRSection(a[0], x, &s[0], s[1]);
+    x = _IIRSection(a[1], x, &s[1], s[2]);
+    if (n_sec == 2) {
+        s[2] = x;
+        return x;
+    }
+    x = _IIRSection(a[2], x, &s[2], s[3]);
+    if (n_sec == 3) {
+        s[3] = x;
+        return x;
+    }
+    x = _IIRSection(a[3], x, &s[3], s[4]);
+    s[4] = x;
+    return x;
+}
+
+//coefficient tables are zero padded to OS_IIR_MAX_NUMOF_COEFS, unused states stay at zero
+static inline void _IIRLoad(const float *c, const float *p_state, t_dafx_v4f *a, t_dafx_v4f *s)
+{
+    a[0] = _Pair(c[0], c[1]);
+    a[1] = _Pair(c[2], c[3]);
+    a[2] = _Pair(c[4], c[5]);
+    a[3] = _Pair(c[6], c[7]);
+
+    s[0] = _Pair(p_state[0], p_state[1]);
+    s[1] = _Pair(p_state[2], p_state[3]);
+    s[2] = _Pair(p_state[4], p_state[5]);
+    s[3] = _Pair(p_state[6], p_state[7]);
+    s[4] = _Pair(p_state[8], p_state[9]);
+}
+
+static inline void _IIRStore(float *p_state, const t_dafx_v4f *s)
+{
+    dafx_v4f_storeu2(p_state, s[0]);
+    dafx_v4f_storeu2(p_state + 2, s[1]);
+    dafx_v4f_storeu2(p_state + 4, s[2]);
+    dafx_v4f_storeu2(p_state + 6, s[3]);
+    dafx_v4f_storeu2(p_state + 8, s[4]);
+}
+
+//even outputs from path 0, odd outputs from path 1, both fed with the same input
+static void _IIRUp(const t_os_iir_halfband *pHB, float *p_state, float *p_in, float *p_out, int n)
+{
+    int n_sec = pHB->n_coefs / 2;
+    t_dafx_v4f a[OS_IIR_MAX_NUMOF_COEFS / 2];
+    t_dafx_v4f s[OS_IIR_MAX_NUMOF_COEFS / 2 + 1];
+
+    _IIRLoad(pHB->p_coefs, p_state, a, s);
+
+    for (int i = 0; i < n; i++) {
+        dafx_v4f_storeu2(p_out + 2 * i, _IIRCascade(a, s, dafx_v4f_set1(p_in[i]), n_sec));
+    }
+
+    _IIRStore(p_state, s);
+}
+
+//path 0 takes the even inputs, path 1 the odd ones one sample late (the z^-1 of the odd path)
+static void _IIRDown(const t_os_iir_halfband *pHB, float *p_state, float *p_in, float *p_out, int n)
+{
+    int n_sec = pHB->n_coefs / 2;
+    t_dafx_v4f a[OS_IIR_MAX_NUMOF_COEFS / 2];
+    t_dafx_v4f s[OS_IIR_MAX_NUMOF_COEFS / 2 + 1];
+    float odd = p_state[OS_IIR_NUMOF_STATES - 1];
+
+    _IIRLoad(pHB->p_coefs, p_state, a, s);
+
+    for (int i = 0; i < n; i++)
+    {
+        t_dafx_v4f y = _IIRCascade(a, s, _Pair(p_in[2 * i], odd), n_sec);
+        odd = p_in[2 * i + 1];
+        p_out[i] = 0.5f * dafx_v4f_last(dafx_v4f_add(dafx_v4f_splat0(y), dafx_v4f_splat1(y)));
+    }
+
+    _IIRStore(p_state, s);
+    p_state[OS_IIR_NUMOF_STATES - 1] = odd;
+}
+
+//group delay at DC in samples of the higher rate: the mean of the two paths
+//(an allpass section in z^2 delays DC by 2 (1 - a) / (1 + a))
+static float _IIRGroupDelay(const t_os_iir_halfband *pHB)
+{
+    float delay = 1.0f;     //the z^-1 of path 1
+
+    for (int i = 0; i < pHB->n_coefs; i++) {
+        float a = pHB->p_coefs[i];
+        delay += 2.0f * (1.0f - a) / (1.0f + a);
+    }
+    return 0.5f * delay;
+}
+
+
+// ---- stages ---- //
+
+//history lengths of stage s, n_lo samples at its lower rate
+static int _UpHistLen(int s, int n_lo)      { return c_fir_halfbands[s].n_taps - 1 + n_lo; }
+static int _EvenHistLen(int s, int n_lo)    { return c_fir_halfbands[s].n_taps - 1 + n_lo; }
+static int _OddHistLen(int s, int n_lo)     { return c_fir_halfbands[s].n_taps / 2 + n_lo; }
+
+//n samples at the lower rate of stage s into 2n
+static void _Upsample(t_DAFXOversampler *pOS, int filter, int s, float *p_in, float *p_out, int n)
+{
+    t_os_stage *pStage = &pOS->stages[s];
+
+    if (filter == OS_FILTER_MINIMUM_PHASE)
+        _IIRUp(&c_iir_halfbands[s], pStage->iir_up, p_in, p_out, n);
+    else
+        _FIRUp(&c_fir_halfbands[s], pStage->p_up_hist, p_in, p_out, n);
+}
+
+//2n samples at the higher rate of stage s into n
+static void _Downsample(t_DAFXOversampler *pOS, int filter, int s, float *p_in, float *p_out, int n)
+{
+    t_os_stage *pStage = &pOS->stages[s];
+
+    if (filter == OS_FILTER_MINIMUM_PHASE)
+        _IIRDown(&c_iir_halfbands[s], pStage->iir_down, p_in, p_out, n);
+    else
+        _FIRDown(&c_fir_halfbands[s], pStage->p_down_even_hist, pStage->p_down_odd_hist, p_in, p_out, n);
+}
+
+static void _UpdateLatency(t_DAFXOversampler *pOS)
+{
+    float latency = 0.0f;
+
+    //each stage delays twice (up and down) by its group delay at its higher rate
+    for (int s = 0; s < pOS->n_stages; s++)
+    {
+        float delay;
+        if (pOS->filter == OS_FILTER_MINIMUM_PHASE)
+            delay = _IIRGroupDelay(&c_iir_halfbands[s]);
+        else
+            delay = (float)(c_fir_halfbands[s].n_taps - 1);
+        latency += delay / (float)(1 << s);
+    }
+    pOS->latency = latency;
+}
+
+//End of block: allpass states checked for subnormals (the FIR histories only hold input samples)
+static void _CheckStates(t_DAFXOversampler *pOS, int filter, int n_stages)
+{
+    DAFX_DenormalCountBlock(&pOS->denormal_stats);
+
+    if (filter != OS_FILTER_MINIMUM_PHASE)
+        return;
+
+    for (int s = 0; s < n_stages; s++) {
+        DAFX_DenormalCheckStates(&pOS->denormal_stats, pOS->stages[s].iir_up, OS_IIR_NUMOF_STATES);
+        DAFX_DenormalCheckStates(&pOS->denormal_stats, pOS->stages[s].iir_down, OS_IIR_NUMOF_STATES);
+    }
+}
+
+//all stages, whatever the factor and filter in use
+static void _ResetStates(t_DAFXOversampler *pOS)
+{
+    for (int s = 0; s < OS_MAX_NUMOF_STAGES; s++)
+    {
+        int n_lo = pOS->block_size << s;
+        t_os_stage *pStage = &pOS->stages[s];
+        memset(pStage->p_up_hist, 0, sizeof(float) * _UpHistLen(s, n_lo));
+        memset(pStage->p_down_even_hist, 0, sizeof(float) * _EvenHistLen(s, n_lo));
+        memset(pStage->p_down_odd_hist, 0, sizeof(float) * _OddHistLen(s, n_lo));
+        memset(pStage->iir_up, 0, sizeof(pStage->iir_up));
+        memset(pStage->iir_down, 0, sizeof(pStage->iir_down));
+    }
+}
+
+
+bool InitDAFXOversampler(t_DAFXOversampler *pOS)
+{
+    int block_size = pOS->block_size;
+
+    //every stage is sized for the largest block at its rates, whatever the factor in use
+    for (int s = 0; s < OS_MAX_NUMOF_STAGES; s++)
+    {
+        int n_lo = block_size << s;
+        t_os_stage *pStage = &pOS->stages[s];
+        pStage->p_up_hist = (float *) calloc(_UpHistLen(s, n_lo), sizeof(float));
+        pStage->p_down_even_hist = (float *) calloc(_EvenHistLen(s, n_lo), sizeof(float));
+        pStage->p_down_odd_hist = (float *) calloc(_OddHistLen(s, n_lo), sizeof(float));
+    }
+
+    pOS->p_buffer_a = (float *) DAFX_AlignedCalloc(OS_MAX_FACTOR * block_size, sizeof(float));
+    pOS->p_buffer_b = (float *) DAFX_AlignedCalloc(OS_MAX_FACTOR * block_size, sizeof(float));
+
+    pOS->factor = 0;
+    pOS->n_stages = 0;
+    pOS->filter = OS_INIT_DEFAULT_FILTER;
+    OS_SetFactor(pOS, OS_INIT_DEFAULT_FACTOR);
+
+    //no block runs yet: taken over right away
+    pOS->active_n_stages = pOS->n_stages;
+    pOS->active_filter = pOS->filter;
+    pOS->reset_pending = false;
+    _ResetStates(pOS);
+    DAFX_DenormalResetStats(&pOS->denormal_stats);
+
+    return true;
+}
+
+bool OS_Reset(t_DAFXOversampler *pOS)
+{
+    DAFX_ATOMIC_STORE(pOS->reset_pending, true);
+    return true;
+}
+
+bool OS_SetFactor(t_DAFXOversampler *pOS, int factor)
+{
+    int n_stages;
+
+    switch (factor) {
+        case 1:
+            n_stages = 0;
+            break;
+        case 2:
+            n_stages = 1;
+            break;
+        case 4:
+            n_stages = 2;
+            break;
+        case 8:
+            n_stages = 3;
+            break;
+        default:
+            return false;
+    }
+
+    if (factor == pOS->factor)
+        return true;
+
+    pOS->factor = factor;
+    DAFX_ATOMIC_STORE(pOS->n_stages, n_stages);
+    OS_Reset(pOS);
+    _UpdateLatency(pOS);
+    return true;
+}
+
+bool OS_SetFilter(t_DAFXOversampler *pOS, int filter)
+{
+    if (filter != OS_FILTER_LINEAR_PHASE && filter != OS_FILTER_MINIMUM_PHASE)
+        return false;
+
+    if (filter == pOS->filter)
+        return true;
+
+    DAFX_ATOMIC_STORE(pOS->filter, filter);
+    OS_Reset(pOS);
+    _UpdateLatency(pOS);
+    return true;
+}
+
+float OS_GetLatency(t_DAFXOversampler *pOS)
+{
+    return pOS->latency;
+}
+
+bool DAFXOversampler(t_DAFXOversampler *pOS, tf_os_process_function pf_process, void *p_process_state,
+                     float *p_in, float *p_out, int n)
+{
+    float *p_buffers[2] = {pOS->p_buffer_a, pOS->p_buffer_b};
+    int cur = 0;
+    int len = n;
+    bool status;
+    t_dafx_fp_state fp_state;
+
+    //a new factor or filter is taken together with the reset of the histories,
+    //so the whole block runs on one cascade with clean states
+    if (DAFX_ATOMIC_LOAD(pOS->reset_pending))
+    {
+        DAFX_ATOMIC_STORE(pOS->reset_pending, false);
+        pOS->active_n_stages = DAFX_ATOMIC_LOAD(pOS->n_stages);
+        pOS->active_filter = DAFX_ATOMIC_LOAD(pOS->filter);
+        _ResetStates(pOS);
+    }
+
+    int n_stages = pOS->active_n_stages;
+    int filter = pOS->active_filter;
+    int factor = 1 << n_stages;
+
+    if (n_stages == 0)
+        return pf_process(p_process_state, p_in, p_out, n);
+
+    DAFX_DenormalGuardBegin(&fp_state);
+
+    //up the cascade, ping-ponging between the two buffers
+    _Upsample(pOS, filter, 0, p_in, p_buffers[cur], len);
+    len *= 2;
+    for (int s = 1; s < n_stages; s++) {
+        _Upsample(pOS, filter, s, p_buffers[cur], p_buffers[cur ^ 1], len);
+        cur ^= 1;
+        len *= 2;
+    }
+
+    status = pf_process(p_process_state, p_buffers[cur], p_buffers[cur ^ 1], n * factor);
+    cur ^= 1;
+
+    //and back down, the last stage straight into the output
+    for (int s = n_stages - 1; s > 0; s--) {
+        len /= 2;
+        _Downsample(pOS, filter, s, p_buffers[cur], p_buffers[cur ^ 1], len);
+        cur ^= 1;
+    }
+    _Downsample(pOS, filter, 0, p_buffers[cur], p_out, len / 2);
+
+    _CheckStates(pOS, filter, n_stages);
+    DAFX_DenormalGuardEnd(&fp_state);
+
+    return status;
+}
+
+void DeallocDAFXOversampler(t_DAFXOversampler *pOS)
+{
+    for (int s = 0; s < OS_MAX_NUMOF_STAGES; s++) {
+        FREE(pOS->stages[s].p_up_hist);
+        FREE(pOS->stages[s].p_down_even_hist);
+        FREE(pOS->stages[s].p_down_odd_hist);
+    }
+    DAFX_AlignedFree(pOS->p_buffer_a);
+    DAFX_AlignedFree(pOS->p_buffer_b);
+}
@@ -0,0 +1,294 @@
+//
+//  DAFX_ParametricEQ.c
+//
+
+#include "DAFX_ParametricEQ.h"
+#include "DAFX_InitParametricEQ.h"
+#include "DAFX_SOSCascade.h"
+#include "DAFX_InitBiquadFilter.h"
+#include "DAFX_definitions.h"
+#include "DAFX_Denormal.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+#define COEFFS_PER_BAND     (BIQUAD_NUMERATOR_SIZE + BIQUAD_DENOMINATOR_SIZE)
+
+
+//RBJ audio EQ cookbook designs, computed in double (low frequency bands are sensitive to rounding)
+static void _DesignBand(t_peq_band *pBand, int fs, float *p_coeffs)
+{
+    double w0 = 2.0 * ONE_PI * (double)pBand->f0 / (double)fs;
+    double c = cos(w0);
+    double alpha = sin(w0) / (2.0 * (double)pBand->q);
+    double A = pow(10.0, (double)pBand->gain_db / 40.0);   //peaking and shelves
+    double G = A * A;                                       //output gain of the other types
+    double sa = 2.0 * sqrt(A) * alpha;
+    double b0, b1, b2, a0, a1, a2;
+    
+    if (!pBand->enabled)
+    {
+        p_coeffs[0] = 1.0; p_coeffs[1] = 0.0; p_coeffs[2] = 0.0;
+        p_coeffs[3] = 1.0; p_coeffs[4] = 0.0; p_coeffs[5] = 0.0;
+        return;
+    }
+    
+    switch (pBand->type) {
+        case PEQ_BAND_LOW_SHELF:
+            b0 =        A * ((A + 1.0) - (A - 1.0) * c + sa);
+            b1 =  2.0 * A * ((A - 1.0) - (A + 1.0) * c);
+            b2 =        A * ((A + 1.0) - (A - 1.0) * c - sa);
+            a0 =             (A + 1.0) + (A - 1.0) * c + sa;
+            a1 =     -2.0 * ((A - 1.0) + (A + 1.0) * c);
+            a2 =             (A + 1.0) + (A - 1.0) * c - sa;
+            break;
+        case PEQ_BAND_HIGH_SHELF:
+            b0 =        A * ((A + 1.0) + (A - 1.0) * c + sa);
+            b1 = -2.0 * A * ((A - 1.0) + (A + 1.0) * c);
+            b2 =        A * ((A + 1.0) + (A - 1.0) * c - sa);
+            a0 =             (A + 1.0) - (A - 1.0) * c + sa;
+            a1 =      2.0 * ((A - 1.0) - (A + 1.0) * c);
+            a2 =             (A + 1.0) - (A - 1.0) * c - sa;
+            break;
+        case PEQ_BAND_LOWPASS:
+            b0 = G * (1.0 - c) * 0.5;
+            b1 = G * (1.0 - c);
+            b2 = G * (1.0 - c) * 0.5;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * c;
+            a2 = 1.0 - alpha;
+            break;
+        case PEQ_BAND_HIGHPASS:
+            b0 = G * (1.0 + c) * 0.5;
+            b1 = -G * (1.0 + c);
+            b2 = G * (1.0 + c) * 0.5;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * c;
+            a2 = 1.0 - alpha;
+            break;
+        case PEQ_BAND_BANDPASS:
+            //constant 0 dB peak gain
+            b0 = G * alpha;
+            b1 = 0.0;
+            b2 = -G * alpha;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * c;
+            a2 = 1.0 - alpha;
+            break;
+        case PEQ_BAND_NOTCH:
+            b0 = G;
+            b1 = -2.0 * G * c;
+            b2 = G;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * c;
+            a2 = 1.0 - alpha;
+            break;
+        case PEQ_BAND_PEAKING:
+        default:
+            b0 = 1.0 + alpha * A;
+            b1 = -2.0 * c;
+            b2 = 1.0 - alpha * A;
+            a0 = 1.0 + alpha / A;
+            a1 = -2.0 * c;
+            a2 = 1.0 - alpha / A;
+            break;
+    }
+    
+    //normalized here already, in double
+    double ax = 1.0 / a0;
+    p_coeffs[0] = (float)(b0 * ax);
+    p_coeffs[1] = (float)(b1 * ax);
+    p_coeffs[2] = (float)(b2 * ax);
+    p_coeffs[3] = 1.0;
+    p_coeffs[4] = (float)(a1 * ax);
+    p_coeffs[5] = (float)(a2 * ax);
+}
+
+static inline t_peq_band *_GetBand(t_DAFXParametricEQ *pEQ, int band)
+{
+    return (band >= 0 && band < pEQ->num_bands) ? pEQ->p_bands + band : NULL;
+}
+
+//the band first: the audio thread clears any_dirty before it scans the bands
+static inline void _FlagBand(t_DAFXParametricEQ *pEQ, t_peq_band *pBand)
+{
+    DAFX_ATOMIC_STORE(pBand->dirty, true);
+    DAFX_ATOMIC_STORE(pEQ->any_dirty, true);
+}
+
+bool PEQ_SetBandType(t_DAFXParametricEQ *pEQ, int band, t_peq_band_type type)
+{
+    t_peq_band *pBand = _GetBand(pEQ, band);
+    if (pBand == NULL || (int)type < 0 || type >= ParametricEQ_N_BAND_TYPES)
+        return false;
+    
+    if (pBand->type != type) {
+        pBand->type = type;
+        _FlagBand(pEQ, pBand);
+    }
+    return true;
+}
+
+bool PEQ_SetBandFrequency(t_DAFXParametricEQ *pEQ, int band, float f0)
+{
+    t_peq_band *pBand = _GetBand(pEQ, band);
+    if (pBand == NULL)
+        return false;
+    
+    f0 = DAFX_MAX(DAFX_MIN(f0, PEQ_MAX_FREQ_RATIO * pEQ->fs), PEQ_MIN_FREQ_HZ);
+    if (pBand->f0 != f0) {
+        pBand->f0 = f0;
+        _FlagBand(pEQ, pBand);
+    }
+    return true;
+}
+
+bool PEQ_SetBandGain(t_DAFXParametricEQ *pEQ, int band, float gain_db)
+{
+    t_peq_band *pBand = _GetBand(pEQ, band);
+    if (pBand == NULL)
+        return false;
+    
+    gain_db = DAFX_MAX(DAFX_MIN(gain_db, PEQ_MAX_GAIN_DB), PEQ_MIN_GAIN_DB);
+    if (pBand->gain_db != gain_db) {
+        pBand->gain_db = gain_db;
+        _FlagBand(pEQ, pBand);
+    }
+    return true;
+}
+
+bool PEQ_SetBandQ(t_DAFXParametricEQ *pEQ, int band, float q)
+{
+    t_peq_band *pBand = _GetBand(pEQ, band);
+    if (pBand == NULL)
+        return false;
+    
+    q = DAFX_MAX(DAFX_MIN(q, PEQ_MAX_Q), PEQ_MIN_Q);
+    if (pBand->q != q) {
+        pBand->q = q;
+        _FlagBand(pEQ, pBand);
+    }
+    return true;
+}
+
+bool PEQ_SetBandEnabled(t_DAFXParametricEQ *pEQ, int band, bool enabled)
+{
+    t_peq_band *pBand = _GetBand(pEQ, band);
+    if (pBand == NULL)
+        return false;
+    
+    if (pBand->enabled != enabled) {
+        pBand->enabled = enabled;
+        _FlagBand(pEQ, pBand);
+    }
+    return true;
+}
+
+bool PEQ_SetBand(t_DAFXParametricEQ *pEQ, int band, t_peq_band_type type, float f0, float gain_db, float q)
+{
+    if (_GetBand(pEQ, band) == NULL)
+        return false;
+    
+    PEQ_SetBandType(pEQ, band, type);
+    PEQ_SetBandFrequency(pEQ, band, f0);
+    PEQ_SetBandGain(pEQ, band, gain_db);
+    PEQ_SetBandQ(pEQ, band, q);
+    
+    return true;
+}
+
+bool InitDAFXParametricEQ(t_DAFXParametricEQ *pEQ)
+{
+    int block_size = pEQ->block_size;
+    
+    if (pEQ->num_bands <= 0)
+        pEQ->num_bands = PEQ_INIT_NUMOF_BANDS;
+    pEQ->num_bands = DAFX_MIN(pEQ->num_bands, PEQ_MAX_NUMOF_BANDS);
+    
+    // memory allocation
+    pEQ->p_input_block = (float *) calloc(block_size, sizeof(float));
+    pEQ->p_output_block = (float *) calloc(block_size, sizeof(float));
+    pEQ->p_bands = (t_peq_band *) calloc(pEQ->num_bands, sizeof(t_peq_band));
+    pEQ->p_band_coeffs = (float *) calloc(pEQ->num_bands * COEFFS_PER_BAND, sizeof(float));
+    
+    //one stage per band
+    pEQ->p_cascade = (t_DAFX_SOSCascade *) calloc(1, sizeof(t_DAFX_SOSCascade));
+    if (pEQ->p_cascade == NULL)
+        return false;
+    pEQ->p_cascade->num_stages = pEQ->num_bands;
+    if (!InitSOSCascade(pEQ->p_cascade))
+        return false;
+    
+    //default bands: flat peaking filters, log-spaced
+    double ratio = (pEQ->num_bands > 1) ? pow(PEQ_INIT_F_HIGH_HZ / PEQ_INIT_F_LOW_HZ, 1.0 / (pEQ->num_bands - 1)) : 1.0;
+    for (int i = 0; i < pEQ->num_bands; i++)
+    {
+        t_peq_band *pBand = pEQ->p_bands + i;
+        pBand->type = PEQ_INIT_BAND_TYPE;
+        pBand->f0 = (float)(PEQ_INIT_F_LOW_HZ * pow(ratio, i));
+        pBand->gain_db = PEQ_INIT_GAIN_DB;
+        pBand->q = PEQ_INIT_Q;
+        pBand->enabled = true;
+        pBand->dirty = false;
+        
+        _DesignBand(pBand, pEQ->fs, pEQ->p_band_coeffs + i * COEFFS_PER_BAND);
+        SetSOSCascadeStageCoeffs(pEQ->p_cascade, i, pEQ->p_band_coeffs + i * COEFFS_PER_BAND);
+    }
+    pEQ->any_dirty = false;
+    
+    return true;
+}
+
+bool DAFXProcessParametricEQ(t_DAFXParametricEQ *pEQ)
+{
+    t_dafx_fp_state fp_state;
+    
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    if (!DAFX_ATOMIC_LOAD(pEQ->any_dirty))
+    {
+        ProcessBlockSOSCascade(pEQ->p_cascade, pEQ->p_input_block, pEQ->p_output_block, pEQ->block_size);
+        DAFX_DenormalGuardEnd(&fp_state);
+        return true;
+    }
+    
+    //redesign only the flagged bands, then glide to the new set over this block
+    //The flags are cleared before reading the parameters: a setter running meanwhile
+    //flags its band again, and it is redesigned in the next block
+    DAFX_ATOMIC_STORE(pEQ->any_dirty, false);
+    for (int i = 0; i < pEQ->num_bands; i++)
+    {
+        t_peq_band *pBand = pEQ->p_bands + i;
+        if (DAFX_ATOMIC_LOAD(pBand->dirty)) {
+            DAFX_ATOMIC_STORE(pBand->dirty, false);
+            _DesignBand(pBand, pEQ->fs, pEQ->p_band_coeffs + i * COEFFS_PER_BAND);
+        }
+    }
+    
+    ProcessBlockSOSCascadeRamp(pEQ->p_cascade, pEQ->p_band_coeffs, pEQ->p_input_block, pEQ->p_output_block, pEQ->block_size);
+    
+    DAFX_DenormalGuardEnd(&fp_state);
+    
+    return true;
+}
+
+bool DAFXBypassParametricEQ(t_DAFXParametricEQ *pEQ)
+{
+    memcpy(pEQ->p_output_block, pEQ->p_input_block, sizeof(float) * pEQ->block_size);
+    return true;
+}
+
+void DeallocDAFXParametricEQ(t_DAFXParametricEQ *pEQ)
+{
+    if(pEQ != NULL) {
+        FREE(pEQ->p_input_block);
+        FREE(pEQ->p_output_block);
+        FREE(pEQ->p_bands);
+        FREE(pEQ->p_band_coeffs);
+        DeallocSOSCascade(pEQ->p_cascade);
+        FREE(pEQ->p_cascade);
+    }
+}
@@ -0,0 +1,354 @@
+//
+//  DAFX_SOSCascade.c
+//
+
+#include "DAFX_SOSCascade.h"
+#include "DAFX_InitSOSCascade.h"
+#include "DAFX_InitBiquadFilter.h"
+
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+#define L   SOS_STAGES_PER_GROUP
+
+
+//One pipeline step with only a subset of the lanes active (pipeline fill and drain)
+//At step t, lane k works on sample t-k. Lanes are updated from the last to the first,
+//so lane k still sees the output lane k-1 produced in the previous step
+static void _SOSGroupPartialStep(float *g, float *p_in, float *p_out, int t, int n)
+{
+    float *y_prev = g + SOS_ROW_Y * L;
+    float *w1 = g + SOS_ROW_W1 * L;
+    float *w2 = g + SOS_ROW_W2 * L;
+    int k_first = DAFX_MAX(0, t - n + 1);
+    int k_last = DAFX_MIN(t, L - 1);
+
+    for (int k = k_last; k >= k_first; k--)
+    {
+        float x = (k == 0) ? p_in[t] : y_prev[k-1];
+        float y = g[SOS_ROW_B0 * L + k] * x + w1[k];
+        w1[k] = g[SOS_ROW_B1 * L + k] * x - g[SOS_ROW_A1 * L + k] * y + w2[k];
+        w2[k] = g[SOS_ROW_B2 * L + k] * x - g[SOS_ROW_A2 * L + k] * y;
+        y_prev[k] = y;
+    }
+
+    //the last lane produced a finished sample
+    if (k_last == L - 1)
+    {
+        p_out[t - (L - 1)] = y_prev[L - 1];
+    }
+}
+
+//Runs all the stages of one group over a block of samples
+static void _SOSGroupProcessBlock(float *g, float *p_in, float *p_out, int n)
+{
+    int t_end = n + L - 1; //number of pipeline steps
+    int t;
+
+    //fill the pipeline
+    for (t = 0; t < L - 1 && t < t_end; t++) {
+        _SOSGroupPartialStep(g, p_in, p_out, t, n);
+    }
+
+    //steady state: every lane busy, one vector operation updates all the stages
+    if (n > L - 1)
+    {
+        t_dafx_v4f b0 = dafx_v4f_load(g + SOS_ROW_B0 * L);
+        t_dafx_v4f b1 = dafx_v4f_load(g + SOS_ROW_B1 * L);
+        t_dafx_v4f b2 = dafx_v4f_load(g + SOS_ROW_B2 * L);
+        t_dafx_v4f a1 = dafx_v4f_load(g + SOS_ROW_A1 * L);
+        t_dafx_v4f a2 = dafx_v4f_load(g + SOS_ROW_A2 * L);
+        t_dafx_v4f w1 = dafx_v4f_load(g + SOS_ROW_W1 * L);
+        t_dafx_v4f w2 = dafx_v4f_load(g + SOS_ROW_W2 * L);
+        t_dafx_v4f y = dafx_v4f_load(g + SOS_ROW_Y * L);
+
+        for (t = L - 1; t < n; t++)
+        {
+            //lane 0 takes the new input sample, lane k the previous output of lane k-1
+            t_dafx_v4f x = dafx_v4f_shift_in(y, p_in[t]);
+
+            y = dafx_v4f_madd(b0, x, w1);
+            w1 = dafx_v4f_add(dafx_v4f_sub(dafx_v4f_mul(b1, x), dafx_v4f_mul(a1, y)), w2);
+            w2 = dafx_v4f_sub(dafx_v4f_mul(b2, x), dafx_v4f_mul(a2, y));
+
+            p_out[t - (L - 1)] = dafx_v4f_last(y);
+        }
+
+        dafx_v4f_store(g + SOS_ROW_W1 * L, w1);
+        dafx_v4f_store(g + SOS_ROW_W2 * L, w2);
+        dafx_v4f_store(g + SOS_ROW_Y * L, y);
+    }
+
+    //drain the pipeline
+    for (t = DAFX_MAX(L - 1, n); t < t_end; t++) {
+        _SOSGroupPartialStep(g, p_in, p_out, t, n);
+    }
+}
+
+//p_ramp[i] = c + (i0 + i + 1) * dc for i in [0, len), filled one vector at a time
+static void _FillCoeffRamp(float *p_ramp, float c, float dc, int i0, int len)
+{
+    float idx0[DAFX_SIMD_LANES];
+    for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+        idx0[k] = (float)(i0 + k + 1);
+    }
+
+    t_dafx_v4f idx = dafx_v4f_loadu(idx0);
+    t_dafx_v4f v_c = dafx_v4f_set1(c);
+    t_dafx_v4f v_dc = dafx_v4f_set1(dc);
+    t_dafx_v4f v_step = dafx_v4f_set1((float)DAFX_SIMD_LANES);
+
+    for (int i = 0; i < len; i += DAFX_SIMD_LANES)
+    {
+        dafx_v4f_storeu(p_ramp + i, dafx_v4f_madd(idx, v_dc, v_c));
+        idx = dafx_v4f_add(idx, v_step);
+    }
+}
+
+bool InitSOSCascade(t_DAFX_SOSCascade *pSOS)
+{
+    pSOS->num_stages = DAFX_MAX(pSOS->num_stages, 1);
+    pSOS->max_stages = pSOS->num_stages;
+    pSOS->num_groups = (pSOS->num_stages + L - 1) / L;
+
+    //one contiguous block for all coeffs and states
+    pSOS->p_memory = (float *) DAFX_AlignedCalloc(pSOS->num_groups * SOS_GROUP_SIZE, sizeof(float));
+    if (pSOS->p_memory == NULL)
+        return false;
+
+    //Initializing all stages (including the padding) to pass-through filters
+    for (int i = 0; i < pSOS->num_groups; i++) {
+        float *g = pSOS->p_memory + i * SOS_GROUP_SIZE;
+        for (int k = 0; k < L; k++) {
+            g[SOS_ROW_B0 * L + k] = 1.0;
+        }
+    }
+
+    DAFX_DenormalResetStats(&pSOS->denormal_stats);
+
+    return true;
+}
+
+bool SetSOSCascadeNumStages(t_DAFX_SOSCascade *pSOS, int num_stages)
+{
+    num_stages = DAFX_MAX(DAFX_MIN(num_stages, pSOS->max_stages), 1);
+
+    //dropped stages may end up padding the last group in use
+    for (int s = num_stages; s < pSOS->num_stages; s++)
+    {
+        float *g = pSOS->p_memory + (s / L) * SOS_GROUP_SIZE;
+        int k = s % L;
+
+        g[SOS_ROW_B0 * L + k] = 1.0;
+        g[SOS_ROW_B1 * L + k] = 0.0;
+        g[SOS_ROW_B2 * L + k] = 0.0;
+        g[SOS_ROW_A1 * L + k] = 0.0;
+        g[SOS_ROW_A2 * L + k] = 0.0;
+    }
+
+    pSOS->num_stages = num_stages;
+    pSOS->num_groups = (num_stages + L - 1) / L;
+
+    return true;
+}
+
+bool SetSOSCascadeStageCoeffs(t_DAFX_SOSCascade *pSOS, int stage, float *p_coeffs)
+{
+    if (stage < 0 || stage >= pSOS->num_stages)
+        return false;
+
+    float *g = pSOS->p_memory + (stage / L) * SOS_GROUP_SIZE;
+    int k = stage % L;
+
+    //expected coeff order: b0, b1, b2, a0, a1, a2
+    float ax = 1.0 / p_coeffs[3];
+
+    g[SOS_ROW_B0 * L + k] = p_coeffs[0] * ax;
+    g[SOS_ROW_B1 * L + k] = p_coeffs[1] * ax;
+    g[SOS_ROW_B2 * L + k] = p_coeffs[2] * ax;
+    g[SOS_ROW_A1 * L + k] = p_coeffs[4] * ax;
+    g[SOS_ROW_A2 * L + k] = p_coeffs[5] * ax;
+
+    return true;
+}
+
+bool SetSOSCascadeStageFeedbackCoeffs(t_DAFX_SOSCascade *pSOS, int stage, float a1, float a2)
+{
+    if (stage < 0 || stage >= pSOS->num_stages)
+        return false;
+
+    float *g = pSOS->p_memory + (stage / L) * SOS_GROUP_SIZE;
+    int k = stage % L;
+
+    g[SOS_ROW_A1 * L + k] = a1;
+    g[SOS_ROW_A2 * L + k] = a2;
+
+    return true;
+}
+
+bool GetSOSCascadeStageCoeffs(t_DAFX_SOSCascade *pSOS, int stage, float *p_coeffs)
+{
+    if (stage < 0 || stage >= pSOS->num_stages)
+        return false;
+
+    float *g = pSOS->p_memory + (stage / L) * SOS_GROUP_SIZE;
+    int k = stage % L;
+
+    p_coeffs[0] = g[SOS_ROW_B0 * L + k];
+    p_coeffs[1] = g[SOS_ROW_B1 * L + k];
+    p_coeffs[2] = g[SOS_ROW_B2 * L + k];
+    p_coeffs[3] = 1.0;
+    p_coeffs[4] = g[SOS_ROW_A1 * L + k];
+    p_coeffs[5] = g[SOS_ROW_A2 * L + k];
+
+    return true;
+}
+
+//End of block: states (w1, w2, y rows of every group) checked for subnormals
+static void _CheckStates(t_DAFX_SOSCascade *pSOS)
+{
+    DAFX_DenormalCountBlock(&pSOS->denormal_stats);
+    for (int i = 0; i < pSOS->num_groups; i++) {
+        float *g = pSOS->p_memory + i * SOS_GROUP_SIZE;
+        DAFX_DenormalCheckStates(&pSOS->denormal_stats, g + SOS_ROW_W1 * L, L * (SOS_NUMOF_ROWS - SOS_ROW_W1));
+    }
+}
+
+bool ProcessBlockSOSCascade(t_DAFX_SOSCascade *pSOS, float *p_in, float *p_out, int n)
+{
+    t_dafx_fp_state fp_state;
+
+    DAFX_DenormalGuardBegin(&fp_state);
+
+    if (pSOS->num_stages == 1)
+    {
+        //a single stage gains nothing from the pipeline - plain TDF-II loop
+        for (int i = 0; i < n; i++) {
+            p_out[i] = ProcessSingleSampleSOSCascade(pSOS, p_in[i]);
+        }
+    }
+    else
+    {
+        //first group reads the input, the following ones work in place on the output
+        float *p_src = p_in;
+        for (int i = 0; i < pSOS->num_groups; i++) {
+            _SOSGroupProcessBlock(pSOS->p_memory + i * SOS_GROUP_SIZE, p_src, p_out, n);
+            p_src = p_out;
+        }
+    }
+
+    _CheckStates(pSOS);
+    DAFX_DenormalGuardEnd(&fp_state);
+
+    return true;
+}
+
+float ProcessSingleSampleSOSCascade(t_DAFX_SOSCascade *pSOS, float x)
+{
+    for (int s = 0; s < pSOS->num_stages; s++)
+    {
+        float *g = pSOS->p_memory + (s / L) * SOS_GROUP_SIZE;
+        int k = s % L;
+        float *w = g + SOS_ROW_W1 * L + k;  //w[0]: w1, w[L]: w2
+
+        float y = g[SOS_ROW_B0 * L + k] * x + w[0];
+        w[0] = g[SOS_ROW_B1 * L + k] * x - g[SOS_ROW_A1 * L + k] * y + w[L];
+        w[L] = g[SOS_ROW_B2 * L + k] * x - g[SOS_ROW_A2 * L + k] * y;
+        g[SOS_ROW_Y * L + k] = y;
+
+        x = y;
+    }
+
+    return x;
+}
+
+bool ProcessBlockSOSCascadeRamp(t_DAFX_SOSCascade *pSOS, float *p_target_coeffs, float *p_in, float *p_out, int n)
+{
+    //per-sample coeffs of the current chunk: b0, b1, b2, a1, a2
+    float ramp[5][SOS_RAMP_CHUNK];
+    float *p_src = p_in;
+    t_dafx_fp_state fp_state;
+
+    if (n <= 0)
+        return true;
+
+    float inv_n = 1.0f / (float)n;
+
+    DAFX_DenormalGuardBegin(&fp_state);
+
+    for (int s = 0; s < pSOS->num_stages; s++)
+    {
+        float *g = pSOS->p_memory + (s / L) * SOS_GROUP_SIZE;
+        int k = s % L;
+        float *t = p_target_coeffs + s * (BIQUAD_NUMERATOR_SIZE + BIQUAD_DENOMINATOR_SIZE);
+        int rows[5] = {SOS_ROW_B0, SOS_ROW_B1, SOS_ROW_B2, SOS_ROW_A1, SOS_ROW_A2};
+
+        //normalized target: b0, b1, b2, a1, a2
+        float ax = 1.0 / t[3];
+        float target[5] = {t[0] * ax, t[1] * ax, t[2] * ax, t[4] * ax, t[5] * ax};
+        float start[5], delta[5];
+        for (int c = 0; c < 5; c++) {
+            start[c] = g[rows[c] * L + k];
+            delta[c] = (target[c] - start[c]) * inv_n;
+        }
+
+        float w1 = g[SOS_ROW_W1 * L + k];
+        float w2 = g[SOS_ROW_W2 * L + k];
+
+        for (int i0 = 0; i0 < n; i0 += SOS_RAMP_CHUNK)
+        {
+            int len = DAFX_MIN(SOS_RAMP_CHUNK, n - i0);
+
+            for (int c = 0; c < 5; c++) {
+                _FillCoeffRamp(ramp[c], start[c], delta[c], i0, len);
+            }
+
+            for (int i = 0; i < len; i++)
+            {
+                float x = p_src[i0 + i];
+                float y = ramp[0][i] * x + w1;
+                w1 = ramp[1][i] * x - ramp[3][i] * y + w2;
+                w2 = ramp[2][i] * x - ramp[4][i] * y;
+                p_out[i0 + i] = y;
+            }
+        }
+
+        g[SOS_ROW_W1 * L + k] = w1;
+        g[SOS_ROW_W2 * L + k] = w2;
+
+        //the target is the starting point of the next block
+        for (int c = 0; c < 5; c++) {
+            g[rows[c] * L + k] = target[c];
+        }
+
+        p_src = p_out;
+    }
+
+    _CheckStates(pSOS);
+    DAFX_DenormalGuardEnd(&fp_state);
+
+    return true;
+}
+
+bool ResetSOSCascade(t_DAFX_SOSCascade *pSOS)
+{
+    for (int i = 0; i < pSOS->num_groups; i++) {
+        float *g = pSOS->p_memory + i * SOS_GROUP_SIZE;
+        memset(g + SOS_ROW_W1 * L, 0, sizeof(float) * L * (SOS_NUMOF_ROWS - SOS_ROW_W1));
+    }
+    return true;
+}
+
+void DeallocSOSCascade(t_DAFX_SOSCascade *pSOS)
+{
+    if(pSOS != NULL) {
+        DAFX_AlignedFree(pSOS->p_memory);
+        pSOS->p_memory = NULL;
+    }
+}
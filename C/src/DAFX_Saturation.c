@@ -0,0 +1,776 @@
+//
+//  DAFX_Saturation.c
+//
+
+#include "DAFX_Saturation.h"
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+#define SAT_LOG2_E          1.442695040888963f
+
+//tanh(9) rounds to 1 in float
+#define SAT_EXP_CLAMP       9.0f
+
+//e^-17 is below float resolution next to 1
+#define SAT_EXP_CLIP_CLAMP  17.0f
+
+//where the Pade approximant is closest to the asymptote before overshooting it
+#define SAT_PADE_CLAMP      4.76f
+
+//stationary point of the polynomial: the curve flattens out there, so clamping keeps it smooth
+#define SAT_POLY_CLAMP      2.947198514f
+
+//(2^f - 1) / f on [-0.5, 0.5], minimax relative error 1.1e-8
+static const float c_exp2m1[6] = {0.69314718793f, 0.24022649795f, 0.05550357426f, 0.00961823749f, 0.00133907394f, 0.00015403519f};
+
+//sin(pi/2 x) ~ x * (c0 + c1 x^2 + ... + c5 x^10), Taylor series, error below 6e-8 on [-1, 1]
+static const float c_half_sine[6] = {1.5707963268f, -0.6459640975f, 0.0796926262f, -0.0046817541f, 0.0001604411f, -0.0000035988f};
+
+//tanh(x) ~ x * (1 + c1 x^2 + ... + c5 x^10), least maximum error on [0, SAT_POLY_CLAMP]
+static const float c_poly[6] = {1.0f, -0.30576033757f, 0.08172330567f, -0.01329011456f, 0.00112564104f, -0.00003780653512f};
+
+//cos(pi/2 x) ~ c0 + c1 x^2 + ... + c6 x^12, Taylor series, error below 7e-9 on [-1, 1]
+static const float c_half_cosine[7] = {1.0f, -1.2337005501f, 0.2536695079f, -0.0208634808f, 0.0009192603f, -0.0000252020f, 0.0000004711f};
+
+//log(1 + z) ~ z * (c0 + c1 z + ... + c7 z^7), least maximum error on [0, 1], 3.2e-8
+static const float c_log1p[8] = {0.99999642231f, -0.4998740162f, 0.33179801648f, -0.2407297947f, 0.16764574192f, -0.095319910838f, 0.036082876779f, -0.0064521872188f};
+
+//dilogarithm Li2(-z) ~ z * (c0 + c1 z + ... + c6 z^6), least maximum error on [0, 1], 3.6e-8
+static const float c_dilog[7] = {-0.99999684906f, 0.24991273279f, -0.1102812362f, 0.058642117359f, -0.029823244342f, 0.011144487477f, -0.0020650772611f};
+
+#define SAT_PI_SQUARED_24   0.4112335167f
+#define SAT_2_PI            0.6366197724f
+#define SAT_4_PI_SQUARED    0.4052847346f
+
+//steps (in shaper units) below which the difference quotients are dominated by rounding.
+//Expansions around the midpoint / centroid take over there
+#define SAT_ADAA_EPS        0.02f
+
+//segments shorter than this are averaged by quadrature rather than by the difference quotient of Q
+#define SAT_ADAA_GAUSS_SPAN 0.25f
+
+
+static inline t_dafx_v4f _Clamp(t_dafx_v4f x, float lim)
+{
+    return dafx_v4f_min(dafx_v4f_max(x, dafx_v4f_set1(-lim)), dafx_v4f_set1(lim));
+}
+
+//2^y - 1 for y in [-32, 32]: 2^y = 2^n * 2^f with n = round(y). For small y, n is 0 and
+//2^f - 1 is evaluated directly, so small signals do not suffer from cancellation
+static inline t_dafx_v4f _Exp2M1(t_dafx_v4f y)
+{
+    t_dafx_v4f n = dafx_v4f_sub(dafx_v4f_trunc(dafx_v4f_add(y, dafx_v4f_set1(32.5f))), dafx_v4f_set1(32.0f));
+    t_dafx_v4f f = dafx_v4f_sub(y, n);
+
+    t_dafx_v4f q = dafx_v4f_set1(c_exp2m1[5]);
+    for (int k = 4; k >= 0; k--) {
+        q = dafx_v4f_madd(q, f, dafx_v4f_set1(c_exp2m1[k]));
+    }
+    t_dafx_v4f s = dafx_v4f_pow2i(n);
+
+    return dafx_v4f_madd(s, dafx_v4f_mul(f, q), dafx_v4f_sub(s, dafx_v4f_set1(1.0f)));
+}
+
+static inline t_dafx_v4f _TanhExp(t_dafx_v4f x)
+{
+    //em1 = e^-2x - 1, tanh = -em1 / (2 + em1)
+    t_dafx_v4f em1 = _Exp2M1(dafx_v4f_mul(_Clamp(x, SAT_EXP_CLAMP), dafx_v4f_set1(-2.0f * SAT_LOG2_E)));
+
+    return dafx_v4f_div(dafx_v4f_sub(dafx_v4f_set1(0.0f), em1), dafx_v4f_add(dafx_v4f_set1(2.0f), em1));
+}
+
+static inline t_dafx_v4f _TanhPade(t_dafx_v4f x)
+{
+    x = _Clamp(x, SAT_PADE_CLAMP);
+    t_dafx_v4f x2 = dafx_v4f_mul(x, x);
+
+    //x (135135 + 17325 x^2 + 378 x^4 + x^6) / (135135 + 62370 x^2 + 3150 x^4 + 28 x^6)
+    t_dafx_v4f num = dafx_v4f_add(x2, dafx_v4f_set1(378.0f));
+    num = dafx_v4f_madd(num, x2, dafx_v4f_set1(17325.0f));
+    num = dafx_v4f_madd(num, x2, dafx_v4f_set1(135135.0f));
+    t_dafx_v4f den = dafx_v4f_madd(x2, dafx_v4f_set1(28.0f), dafx_v4f_set1(3150.0f));
+    den = dafx_v4f_madd(den, x2, dafx_v4f_set1(62370.0f));
+    den = dafx_v4f_madd(den, x2, dafx_v4f_set1(135135.0f));
+
+    return dafx_v4f_div(dafx_v4f_mul(x, num), den);
+}
+
+static inline t_dafx_v4f _TanhPoly(t_dafx_v4f x)
+{
+    x = _Clamp(x, SAT_POLY_CLAMP);
+    t_dafx_v4f x2 = dafx_v4f_mul(x, x);
+
+    t_dafx_v4f p = dafx_v4f_set1(c_poly[5]);
+    for (int k = 4; k >= 0; k--) {
+        p = dafx_v4f_madd(p, x2, dafx_v4f_set1(c_poly[k]));
+    }
+    return dafx_v4f_mul(x, p);
+}
+
+static inline t_dafx_v4f _TanhVector(t_sat_tanh_tier tier, t_dafx_v4f x)
+{
+    switch (tier) {
+        case SAT_TANH_PADE:
+            return _TanhPade(x);
+        case SAT_TANH_POLY:
+            return _TanhPoly(x);
+        default:
+            return _TanhExp(x);
+    }
+}
+
+//sin(pi/2 x), x clamped to [-1, 1]
+static inline t_dafx_v4f _SineClip(t_dafx_v4f x)
+{
+    x = _Clamp(x, 1.0f);
+    t_dafx_v4f x2 = dafx_v4f_mul(x, x);
+
+    t_dafx_v4f p = dafx_v4f_set1(c_half_sine[5]);
+    for (int k = 4; k >= 0; k--) {
+        p = dafx_v4f_madd(p, x2, dafx_v4f_set1(c_half_sine[k]));
+    }
+    return dafx_v4f_mul(x, p);
+}
+
+//sign(x) (1 - e^-|x|)
+static inline t_dafx_v4f _ExpClip(t_dafx_v4f x)
+{
+    t_dafx_v4f a = dafx_v4f_min(dafx_v4f_abs(x), dafx_v4f_set1(SAT_EXP_CLIP_CLAMP));
+    t_dafx_v4f em1 = _Exp2M1(dafx_v4f_mul(a, dafx_v4f_set1(-SAT_LOG2_E)));
+
+    return dafx_v4f_copysign(dafx_v4f_sub(dafx_v4f_set1(0.0f), em1), x);
+}
+
+static inline t_dafx_v4f _ShapeVector(t_sat_shape shape, t_sat_tanh_tier tier, t_dafx_v4f x)
+{
+    switch (shape) {
+        case SAT_SHAPE_SINE:
+            return _SineClip(x);
+        case SAT_SHAPE_EXP:
+            return _ExpClip(x);
+        default:
+            return _TanhVector(tier, x);
+    }
+}
+
+//shape and tier are the same for the whole block, the switches are hoisted out of the loop by the compiler
+static bool _ShapeBlock(t_sat_shape shape, t_sat_tanh_tier tier, float *p_in, float *p_out, int n, float pre_gain, float post_gain)
+{
+    int i = 0;
+    t_dafx_v4f g_in = dafx_v4f_set1(pre_gain);
+    t_dafx_v4f g_out = dafx_v4f_set1(post_gain);
+
+    for (; i + DAFX_SIMD_LANES <= n; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f x = dafx_v4f_mul(dafx_v4f_loadu(p_in + i), g_in);
+        dafx_v4f_storeu(p_out + i, dafx_v4f_mul(_ShapeVector(shape, tier, x), g_out));
+    }
+
+    //leftover samples through a zero-padded vector, so they see the same approximation
+    if (i < n)
+    {
+        float tail[DAFX_SIMD_LANES] = {0.0f};
+        memcpy(tail, p_in + i, sizeof(float) * (n - i));
+        t_dafx_v4f x = dafx_v4f_mul(dafx_v4f_loadu(tail), g_in);
+        dafx_v4f_storeu(tail, dafx_v4f_mul(_ShapeVector(shape, tier, x), g_out));
+        memcpy(p_out + i, tail, sizeof(float) * (n - i));
+    }
+
+    return true;
+}
+
+bool SAT_TanhBlock(t_sat_tanh_tier tier, float *p_in, float *p_out, int n, float pre_gain, float post_gain)
+{
+    if (tier == SAT_TANH_LIBM || tier >= Saturation_N_TANH_TIERS)
+    {
+        for (int i = 0; i < n; i++) {
+            p_out[i] = post_gain * tanhf(pre_gain * p_in[i]);
+        }
+        return true;
+    }
+
+    return _ShapeBlock(SAT_SHAPE_TANH, tier, p_in, p_out, n, pre_gain, post_gain);
+}
+
+bool SAT_SineClipBlock(float *p_in, float *p_out, int n, float pre_gain, float post_gain)
+{
+    return _ShapeBlock(SAT_SHAPE_SINE, SAT_TANH_EXP, p_in, p_out, n, pre_gain, post_gain);
+}
+
+bool SAT_ExpClipBlock(float *p_in, float *p_out, int n, float pre_gain, float post_gain)
+{
+    return _ShapeBlock(SAT_SHAPE_EXP, SAT_TANH_EXP, p_in, p_out, n, pre_gain, post_gain);
+}
+
+
+// ---- antiderivative anti-aliasing ---- //
+
+/*
+ * Each shaper f is odd and saturates at +-1, so its antiderivatives grow like |u| and u|u|/2.
+ * Taking divided differences of them directly would cancel away all float precision for
+ * large arguments, so they are split into that exact growth plus bounded terms:
+ *   F1(u) = |u| - k + R(u)           R = F1 - |u| + k  (even, 0 at infinity)
+ *   F2(u) = u|u| / 2 - k u + Q(u)    Q' = R            (odd, bounded)
+ * The growth parts are differenced in closed form below, only R and Q are evaluated.
+ *   tanh:       R = log(1 + e^-2|u|), Q = sign(u) (pi^2 / 24 + Li2(-e^-2|u|) / 2)
+ *   sine clip:  R = 1 - w - 2/pi cos(pi/2 w), Q = sign(u) (w - w^2 / 2 - 4/pi^2 sin(pi/2 w)), w = min(|u|, 1)
+ *   exp clip:   R = e^-|u|, Q = f(u)
+ */
+static inline void _ADAATerms(t_sat_shape shape, t_dafx_v4f u, t_dafx_v4f *p_r, t_dafx_v4f *p_q)
+{
+    t_dafx_v4f one = dafx_v4f_set1(1.0f);
+    t_dafx_v4f r, q;
+
+    switch (shape) {
+        case SAT_SHAPE_SINE:
+        {
+            t_dafx_v4f w = dafx_v4f_min(dafx_v4f_abs(u), one);
+            t_dafx_v4f w2 = dafx_v4f_mul(w, w);
+            t_dafx_v4f c = dafx_v4f_set1(c_half_cosine[6]);
+            for (int k = 5; k >= 0; k--) {
+                c = dafx_v4f_madd(c, w2, dafx_v4f_set1(c_half_cosine[k]));
+            }
+            r = dafx_v4f_sub(dafx_v4f_sub(one, w), dafx_v4f_mul(c, dafx_v4f_set1(SAT_2_PI)));
+            if (p_q != NULL) {
+                q = dafx_v4f_madd(w2, dafx_v4f_set1(-0.5f), w);
+                q = dafx_v4f_sub(q, dafx_v4f_mul(_SineClip(w), dafx_v4f_set1(SAT_4_PI_SQUARED)));
+                *p_q = dafx_v4f_copysign(q, u);
+            }
+            break;
+        }
+        case SAT_SHAPE_EXP:
+        {
+            t_dafx_v4f v = dafx_v4f_min(dafx_v4f_abs(u), dafx_v4f_set1(SAT_EXP_CLIP_CLAMP));
+            t_dafx_v4f em1 = _Exp2M1(dafx_v4f_mul(v, dafx_v4f_set1(-SAT_LOG2_E)));
+            r = dafx_v4f_add(one, em1);
+            if (p_q != NULL) {
+                *p_q = dafx_v4f_copysign(dafx_v4f_sub(dafx_v4f_set1(0.0f), em1), u);
+            }
+            break;
+        }
+        default:
+        {
+            //z = e^-2|u| in (0, 1]
+            t_dafx_v4f v = dafx_v4f_min(dafx_v4f_abs(u), dafx_v4f_set1(SAT_EXP_CLAMP));
+            t_dafx_v4f z = dafx_v4f_add(one, _Exp2M1(dafx_v4f_mul(v, dafx_v4f_set1(-2.0f * SAT_LOG2_E))));
+            t_dafx_v4f p = dafx_v4f_set1(c_log1p[7]);
+            for (int k = 6; k >= 0; k--) {
+                p = dafx_v4f_madd(p, z, dafx_v4f_set1(c_log1p[k]));
+            }
+            r = dafx_v4f_mul(z, p);
+            if (p_q != NULL) {
+                p = dafx_v4f_set1(c_dilog[6]);
+                for (int k = 5; k >= 0; k--) {
+                    p = dafx_v4f_madd(p, z, dafx_v4f_set1(c_dilog[k]));
+                }
+                q = dafx_v4f_madd(dafx_v4f_mul(z, p), dafx_v4f_set1(0.5f), dafx_v4f_set1(SAT_PI_SQUARED_24));
+                *p_q = dafx_v4f_copysign(q, u);
+            }
+            break;
+        }
+    }
+    *p_r = r;
+}
+
+
+//f(x) + d2 f''(x): the shaper with a curvature correction
+static inline t_dafx_v4f _ShapeCurved(t_sat_shape shape, t_dafx_v4f x, t_dafx_v4f d2)
+{
+    t_dafx_v4f one = dafx_v4f_set1(1.0f);
+    t_dafx_v4f f = _ShapeVector(shape, SAT_TANH_EXP, x);
+    t_dafx_v4f f2;
+
+    switch (shape) {
+        case SAT_SHAPE_SINE:
+            f2 = dafx_v4f_mul(f, dafx_v4f_set1(-2.4674011003f));     //-(pi/2)^2 f inside the knee, 0 beyond
+            f2 = dafx_v4f_select(dafx_v4f_cmplt(dafx_v4f_abs(x), one), f2, dafx_v4f_set1(0.0f));
+            break;
+        case SAT_SHAPE_EXP:
+            f2 = dafx_v4f_sub(f, dafx_v4f_copysign(one, x));           //-sign(x) e^-|x|
+            break;
+        default:
+            f2 = dafx_v4f_mul(dafx_v4f_mul(f, dafx_v4f_set1(-2.0f)), dafx_v4f_sub(one, dafx_v4f_mul(f, f)));
+            break;
+    }
+    return dafx_v4f_madd(f2, d2, f);
+}
+
+static inline t_dafx_v4u _Near(t_dafx_v4f d, float eps)
+{
+    return dafx_v4f_cmplt(dafx_v4f_abs(d), dafx_v4f_set1(eps));
+}
+
+//d, or 1 where d is 0 (0 / 0 guard for terms that vanish with d)
+static inline t_dafx_v4f _NonZero(t_dafx_v4f d)
+{
+    return dafx_v4f_select(_Near(d, 1e-30f), dafx_v4f_set1(1.0f), d);
+}
+
+//mean of R over [p, q]. Long segments take the difference quotient of Q, short ones a
+//3 point Gauss-Legendre rule on R - 2 min(s x, 0) (smooth, unlike R, with s the side of the
+//midpoint), less the exact mean of the added term
+static inline t_dafx_v4f _SegmentMean(t_sat_shape shape, t_dafx_v4f p, t_dafx_v4f q, t_dafx_v4f qp, t_dafx_v4f qq)
+{
+    t_dafx_v4f zero = dafx_v4f_set1(0.0f);
+    t_dafx_v4f d = dafx_v4f_sub(q, p);
+    t_dafx_v4f quotient = dafx_v4f_div(dafx_v4f_sub(qq, qp), _NonZero(d));
+    t_dafx_v4u short_segment = _Near(d, SAT_ADAA_GAUSS_SPAN);
+
+    if (!dafx_v4u_any(short_segment))
+        return quotient;
+
+    t_dafx_v4f mid = dafx_v4f_mul(dafx_v4f_add(p, q), dafx_v4f_set1(0.5f));
+    t_dafx_v4f s = dafx_v4f_copysign(dafx_v4f_set1(1.0f), mid);
+    t_dafx_v4f node = dafx_v4f_mul(d, dafx_v4f_set1(0.3872983346f));   //half width * sqrt(3/5)
+    t_dafx_v4f x0 = dafx_v4f_sub(mid, node);
+    t_dafx_v4f x2 = dafx_v4f_add(mid, node);
+    t_dafx_v4f r0, r1, r2;
+
+    _ADAATerms(shape, x0, &r0, NULL);
+    _ADAATerms(shape, mid, &r1, NULL);
+    _ADAATerms(shape, x2, &r2, NULL);
+    r0 = dafx_v4f_madd(dafx_v4f_min(dafx_v4f_mul(s, x0), zero), dafx_v4f_set1(-2.0f), r0);
+    r2 = dafx_v4f_madd(dafx_v4f_min(dafx_v4f_mul(s, x2), zero), dafx_v4f_set1(-2.0f), r2);
+    t_dafx_v4f gauss = dafx_v4f_madd(dafx_v4f_add(r0, r2), dafx_v4f_set1(5.0f / 18.0f), dafx_v4f_mul(r1, dafx_v4f_set1(8.0f / 18.0f)));
+
+    //the added term is nonzero only on the far side of 0, between 0 and the endpoint e there
+    t_dafx_v4f e = dafx_v4f_add(dafx_v4f_min(dafx_v4f_mul(s, p), zero), dafx_v4f_min(dafx_v4f_mul(s, q), zero));
+    gauss = dafx_v4f_sub(gauss, dafx_v4f_div(dafx_v4f_mul(e, e), _NonZero(dafx_v4f_abs(d))));
+
+    return dafx_v4f_select(short_segment, gauss, quotient);
+}
+
+//y[n] = (F1(u[n]) - F1(u[n-1])) / (u[n] - u[n-1]), the mean of f between the two points.
+//With sc = sign(u[n-1]) that is sc plus (-2 min(sc u[n], 0) + R(u[n]) - R(u[n-1])) / (u[n] - u[n-1])
+static inline t_dafx_v4f _ADAAFirst(t_sat_shape shape, t_DAFXSaturationADAA *pADAA, int i)
+{
+    t_dafx_v4f a = dafx_v4f_loadu(pADAA->p_u + i + 2);
+    t_dafx_v4f c = dafx_v4f_loadu(pADAA->p_u + i + 1);
+    t_dafx_v4f sc = dafx_v4f_copysign(dafx_v4f_set1(1.0f), c);
+    t_dafx_v4f da = dafx_v4f_sub(a, c);
+
+    t_dafx_v4f bend = dafx_v4f_mul(dafx_v4f_min(dafx_v4f_mul(sc, a), dafx_v4f_set1(0.0f)), dafx_v4f_set1(-2.0f));
+    bend = dafx_v4f_add(bend, dafx_v4f_sub(dafx_v4f_loadu(pADAA->p_r + i + 2), dafx_v4f_loadu(pADAA->p_r + i + 1)));
+    t_dafx_v4f y = dafx_v4f_add(sc, dafx_v4f_div(bend, _NonZero(da)));
+
+    //short steps: midpoint value, corrected by the curvature over the step
+    t_dafx_v4u near = _Near(da, SAT_ADAA_EPS);
+    if (dafx_v4u_any(near))
+    {
+        t_dafx_v4f mid = dafx_v4f_mul(dafx_v4f_add(a, c), dafx_v4f_set1(0.5f));
+        t_dafx_v4f ym = _ShapeCurved(shape, mid, dafx_v4f_mul(dafx_v4f_mul(da, da), dafx_v4f_set1(1.0f / 24.0f)));
+        y = dafx_v4f_select(near, ym, y);
+    }
+
+    return y;
+}
+
+//y[n] = 2 / (u[n] - u[n-2]) * (D(u[n], u[n-1]) - D(u[n-1], u[n-2])), D = difference quotient of F2,
+//the mean of f under the triangle spanned by the three points.
+//Both quotients are taken relative to the tangent of F1 at c = u[n-1], so only bounded terms are differenced
+static inline t_dafx_v4f _ADAASecond(t_sat_shape shape, t_DAFXSaturationADAA *pADAA, int i)
+{
+    t_dafx_v4f zero = dafx_v4f_set1(0.0f);
+    t_dafx_v4f two = dafx_v4f_set1(2.0f);
+    t_dafx_v4f a = dafx_v4f_loadu(pADAA->p_u + i + 2);
+    t_dafx_v4f c = dafx_v4f_loadu(pADAA->p_u + i + 1);
+    t_dafx_v4f b = dafx_v4f_loadu(pADAA->p_u + i);
+    t_dafx_v4f qc = dafx_v4f_loadu(pADAA->p_q + i + 1);
+    t_dafx_v4f sc = dafx_v4f_copysign(dafx_v4f_set1(1.0f), c);
+    t_dafx_v4f da = dafx_v4f_sub(a, c);
+    t_dafx_v4f db = dafx_v4f_sub(b, c);
+    t_dafx_v4f dab = dafx_v4f_sub(a, b);
+
+    //segment means of R, less the difference quotient of min(sc x, 0)^2 / (x - c), the part of the
+    //mean of |x| that comes from the far side of 0. When a and b are both there, that quotient
+    //is 1 - c^2 / ((a - c)(b - c)), taken directly to avoid cancelling two large terms
+    t_dafx_v4f ma = dafx_v4f_min(dafx_v4f_mul(sc, a), zero);
+    t_dafx_v4f mb = dafx_v4f_min(dafx_v4f_mul(sc, b), zero);
+    t_dafx_v4f ga = dafx_v4f_div(dafx_v4f_mul(ma, ma), _NonZero(da));
+    t_dafx_v4f gb = dafx_v4f_div(dafx_v4f_mul(mb, mb), _NonZero(db));
+    t_dafx_v4f far = dafx_v4f_div(dafx_v4f_sub(ga, gb), _NonZero(dab));
+    t_dafx_v4f both = dafx_v4f_sub(dafx_v4f_set1(1.0f), dafx_v4f_div(dafx_v4f_mul(c, c), _NonZero(dafx_v4f_mul(da, db))));
+    far = dafx_v4f_select(dafx_v4f_cmplt(zero, dafx_v4f_mul(ma, mb)), both, far);
+    t_dafx_v4f sab = dafx_v4f_sub(dafx_v4f_loadu(pADAA->p_s + i + 2), dafx_v4f_loadu(pADAA->p_s + i + 1));
+    t_dafx_v4f y = dafx_v4f_div(sab, _NonZero(dab));
+    y = dafx_v4f_madd(dafx_v4f_sub(y, dafx_v4f_mul(sc, far)), two, sc);
+
+    //u[n] ~ u[n-2]: both outer points collapse onto their mean xm, the triangle onto [c, xm]
+    t_dafx_v4u near = _Near(dab, SAT_ADAA_EPS);
+    if (dafx_v4u_any(near))
+    {
+        t_dafx_v4f xm = dafx_v4f_mul(dafx_v4f_add(a, b), dafx_v4f_set1(0.5f));
+        t_dafx_v4f dm = dafx_v4f_sub(xm, c);
+        t_dafx_v4f rm, qm;
+        _ADAATerms(shape, xm, &rm, &qm);
+        t_dafx_v4f mm = dafx_v4f_min(dafx_v4f_mul(sc, xm), zero);
+        t_dafx_v4f lm = dafx_v4f_div(dafx_v4f_mul(sc, dafx_v4f_mul(mm, mm)), _NonZero(dm));
+        lm = dafx_v4f_madd(mm, dafx_v4f_set1(-2.0f), lm);
+        lm = dafx_v4f_add(lm, dafx_v4f_sub(rm, _SegmentMean(shape, c, xm, qc, qm)));
+        t_dafx_v4f ym = dafx_v4f_add(sc, dafx_v4f_div(dafx_v4f_mul(lm, two), _NonZero(dm)));
+
+        //all three points close: f at the centroid, corrected by the curvature times half the variance
+        t_dafx_v4u close = _Near(dm, SAT_ADAA_EPS);
+        if (dafx_v4u_any(close))
+        {
+            t_dafx_v4f centroid = dafx_v4f_mul(dafx_v4f_add(dafx_v4f_add(a, b), c), dafx_v4f_set1(1.0f / 3.0f));
+            t_dafx_v4f var = dafx_v4f_madd(da, da, dafx_v4f_madd(db, db, dafx_v4f_mul(dab, dab)));
+            t_dafx_v4f yc = _ShapeCurved(shape, centroid, dafx_v4f_mul(var, dafx_v4f_set1(1.0f / 72.0f)));
+            ym = dafx_v4f_select(close, yc, ym);
+        }
+        y = dafx_v4f_select(near, ym, y);
+    }
+
+    return y;
+}
+
+bool InitDAFXSaturationADAA(t_DAFXSaturationADAA *pADAA)
+{
+    //2 samples of history in front, a vector of slack behind for the block tail
+    int len = pADAA->block_size + 2 + 2 * DAFX_SIMD_LANES;
+
+    pADAA->p_u = (float *) calloc(len, sizeof(float));
+    pADAA->p_r = (float *) calloc(len, sizeof(float));
+    pADAA->p_q = (float *) calloc(len, sizeof(float));
+    pADAA->p_s = (float *) calloc(len, sizeof(float));
+
+    return SAT_ResetADAA(pADAA);
+}
+
+bool SAT_ResetADAA(t_DAFXSaturationADAA *pADAA)
+{
+    pADAA->p_u[0] = 0.0f;
+    pADAA->p_u[1] = 0.0f;
+    return true;
+}
+
+bool SAT_ADAABlock(t_DAFXSaturationADAA *pADAA, t_sat_shape shape, t_sat_adaa_order order,
+                   float *p_in, float *p_out, int n, float pre_gain, float post_gain)
+{
+    float *p_u = pADAA->p_u;
+    t_dafx_v4f g_out = dafx_v4f_set1(post_gain);
+    int i;
+
+    if (order == SAT_ADAA_OFF || order >= Saturation_N_ADAA_ORDERS)
+        return _ShapeBlock(shape, SAT_TANH_EXP, p_in, p_out, n, pre_gain, post_gain);
+
+    n = DAFX_MIN(n, pADAA->block_size);
+
+    for (i = 0; i < n; i++) {
+        p_u[i + 2] = pre_gain * p_in[i];
+    }
+
+    //terms once per point and per segment, history included (the shape may have changed since).
+    //The last vectors run into the slack, whatever is there is finite and never read back
+    for (i = 0; i < n + 2; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f r, q;
+        t_dafx_v4f u = dafx_v4f_loadu(p_u + i);
+        if (order == SAT_ADAA_SECOND_ORDER) {
+            _ADAATerms(shape, u, &r, &q);
+            dafx_v4f_storeu(pADAA->p_q + i, q);
+        }
+        else {
+            _ADAATerms(shape, u, &r, NULL);
+        }
+        dafx_v4f_storeu(pADAA->p_r + i, r);
+    }
+    if (order == SAT_ADAA_SECOND_ORDER) {
+        for (i = 1; i < n + 2; i += DAFX_SIMD_LANES) {
+            t_dafx_v4f s = _SegmentMean(shape, dafx_v4f_loadu(p_u + i - 1), dafx_v4f_loadu(p_u + i),
+                                        dafx_v4f_loadu(pADAA->p_q + i - 1), dafx_v4f_loadu(pADAA->p_q + i));
+            dafx_v4f_storeu(pADAA->p_s + i, s);
+        }
+    }
+
+    for (i = 0; i < n; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f y = (order == SAT_ADAA_SECOND_ORDER) ? _ADAASecond(shape, pADAA, i) : _ADAAFirst(shape, pADAA, i);
+        y = dafx_v4f_mul(y, g_out);
+
+        if (i + DAFX_SIMD_LANES <= n) {
+            dafx_v4f_storeu(p_out + i, y);
+        }
+        else {
+            float tail[DAFX_SIMD_LANES];
+            dafx_v4f_storeu(tail, y);
+            memcpy(p_out + i, tail, sizeof(float) * (n - i));
+        }
+    }
+
+    //the last 2 points lead the next block
+    p_u[0] = p_u[n];
+    p_u[1] = p_u[n + 1];
+
+    return true;
+}
+
+void DeallocDAFXSaturationADAA(t_DAFXSaturationADAA *pADAA)
+{
+    FREE(pADAA->p_u);
+    FREE(pADAA->p_r);
+    FREE(pADAA->p_q);
+    FREE(pADAA->p_s);
+}
+
+
+// ---- transfer curve tables ---- //
+
+//longest line of a curve file
+#define SAT_TABLE_LINE_LEN  256
+
+bool InitDAFXSaturationTable(t_DAFXSaturationTable *pTable, float *p_y, int n_points, float x_min, float x_max)
+{
+    int n_seg = n_points - 1;
+
+    pTable->p_linear = NULL;
+    pTable->p_cubic = NULL;
+
+    if (n_points < SAT_TABLE_MIN_NUMOF_POINTS || n_points > SAT_TABLE_MAX_NUMOF_POINTS)
+        return false;
+    if (!isfinite(x_min) || !isfinite(x_max) || !(x_max > x_min))
+        return false;
+    for (int k = 0; k < n_points; k++) {
+        if (!isfinite(p_y[k]))
+            return false;
+    }
+
+    pTable->x_min = x_min;
+    pTable->x_max = x_max;
+    pTable->n_points = n_points;
+    pTable->scale = (float)((double)n_seg / ((double)x_max - (double)x_min));
+
+    pTable->p_linear = (float *) DAFX_AlignedCalloc(2 * n_seg, sizeof(float));
+    pTable->p_cubic = (float *) DAFX_AlignedCalloc(4 * n_seg, sizeof(float));
+
+    //coefficients in double, in segment units (t = 0 .. 1 across a segment)
+    for (int k = 0; k < n_seg; k++)
+    {
+        double y0 = p_y[k];
+        double y1 = p_y[k + 1];
+        double d = y1 - y0;
+        double m0 = d, m1 = d;
+
+        //Catmull-Rom tangents. Where the curve turns the tangent is 0, elsewhere it is
+        //at most 3 times the flatter neighbouring slope (Fritsch-Carlson), so the
+        //segments stay within their end points: flat tops stay flat
+        if (k > 0) {
+            double d_prev = y0 - p_y[k - 1];
+            m0 = (d_prev * d > 0.0) ? 0.5 * (d_prev + d) : 0.0;
+            if (fabs(m0) > 3.0 * DAFX_MIN(fabs(d_prev), fabs(d)))
+                m0 = copysign(3.0 * DAFX_MIN(fabs(d_prev), fabs(d)), m0);
+        }
+        if (k < n_seg - 1) {
+            double d_next = p_y[k + 2] - y1;
+            m1 = (d_next * d > 0.0) ? 0.5 * (d + d_next) : 0.0;
+            if (fabs(m1) > 3.0 * DAFX_MIN(fabs(d_next), fabs(d)))
+                m1 = copysign(3.0 * DAFX_MIN(fabs(d_next), fabs(d)), m1);
+        }
+
+        pTable->p_linear[2 * k] = (float)y0;
+        pTable->p_linear[2 * k + 1] = (float)d;
+
+        pTable->p_cubic[4 * k] = (float)y0;
+        pTable->p_cubic[4 * k + 1] = (float)m0;
+        pTable->p_cubic[4 * k + 2] = (float)(3.0 * d - 2.0 * m0 - m1);
+        pTable->p_cubic[4 * k + 3] = (float)(m0 + m1 - 2.0 * d);
+    }
+
+    return true;
+}
+
+//reads up to max_vals numbers off a line, stops at a comment. Returns how many there are
+//(max_vals + 1 if there are more), -1 if something else is in the way
+static int _ParseCurveLine(char *p_line, double *p_vals, int max_vals)
+{
+    int n_vals = 0;
+    char *p = p_line;
+
+    while (true)
+    {
+        char *p_end;
+        double v;
+
+        while (*p == ' ' || *p == '\t' || *p == ',' || *p == ';' || *p == '\r' || *p == '\n')
+            p++;
+        if (*p == '\0' || *p == '#')
+            return n_vals;
+
+        v = strtod(p, &p_end);
+        if (p_end == p)
+            return -1;
+        if (n_vals == max_vals)
+            return max_vals + 1;
+        p_vals[n_vals++] = v;
+        p = p_end;
+    }
+}
+
+bool InitDAFXSaturationTableFile(t_DAFXSaturationTable *pTable, const char *p_path)
+{
+    char line[SAT_TABLE_LINE_LEN];
+    int n_points = 0, n_cols = 0;
+    bool valid = true;
+    float *p_x, *p_y;
+    FILE *p_file;
+
+    pTable->p_linear = NULL;
+    pTable->p_cubic = NULL;
+
+    p_file = fopen(p_path, "r");
+    if (p_file == NULL)
+        return false;
+
+    p_x = (float *) calloc(SAT_TABLE_MAX_NUMOF_POINTS, sizeof(float));
+    p_y = (float *) calloc(SAT_TABLE_MAX_NUMOF_POINTS, sizeof(float));
+
+    while (valid && fgets(line, SAT_TABLE_LINE_LEN, p_file) != NULL)
+    {
+        double vals[2];
+        int n_vals = _ParseCurveLine(line, vals, 2);
+
+        //a line cut by the buffer would read as two
+        if (strchr(line, '\n') == NULL && !feof(p_file))
+            valid = false;
+        else if (n_vals == 0)
+            continue;
+        //every point has as many columns as the first one
+        else if (n_vals < 0 || n_vals > 2 || (n_cols != 0 && n_vals != n_cols) || n_points == SAT_TABLE_MAX_NUMOF_POINTS)
+            valid = false;
+        else
+        {
+            n_cols = n_vals;
+            p_x[n_points] = (float)vals[0];
+            p_y[n_points] = (float)vals[n_vals - 1];
+            n_points++;
+        }
+    }
+    fclose(p_file);
+
+    if (valid && n_cols == 1) {
+        valid = InitDAFXSaturationTable(pTable, p_y, n_points, -1.0f, 1.0f);
+    }
+    else if (valid && n_cols == 2 && n_points >= SAT_TABLE_MIN_NUMOF_POINTS)
+    {
+        float *p_even = (float *) calloc(n_points, sizeof(float));
+        double x_first = p_x[0];
+        double step = ((double)p_x[n_points - 1] - x_first) / (double)(n_points - 1);
+        int j = 0;
+
+        for (int k = 1; k < n_points; k++) {
+            if (!(p_x[k] > p_x[k - 1]))
+                valid = false;
+        }
+
+        //the pairs are joined by straight lines, which are sampled evenly
+        for (int k = 0; valid && k < n_points; k++)
+        {
+            double x = (k == n_points - 1) ? (double)p_x[n_points - 1] : x_first + (double)k * step;
+            while (j < n_points - 2 && p_x[j + 1] <= x)
+                j++;
+            double t = (x - p_x[j]) / ((double)p_x[j + 1] - p_x[j]);
+            p_even[k] = (float)(p_y[j] + t * ((double)p_y[j + 1] - p_y[j]));
+        }
+
+        if (valid)
+            valid = InitDAFXSaturationTable(pTable, p_even, n_points, p_x[0], p_x[n_points - 1]);
+        FREE(p_even);
+    }
+    else {
+        valid = false;
+    }
+
+    FREE(p_x);
+    FREE(p_y);
+
+    return valid;
+}
+
+//segment of each lane and the position within it. Out of range inputs (NaN included) land on the ends
+static inline t_dafx_v4f _TablePosition(const t_DAFXSaturationTable *pTable, t_dafx_v4f x, t_dafx_v4f g_pos, t_dafx_v4f offset, int *p_seg)
+{
+    float last = (float)(pTable->n_points - 2);
+    float f_seg[DAFX_SIMD_LANES];
+
+    t_dafx_v4f pos = dafx_v4f_madd(x, g_pos, offset);
+    pos = dafx_v4f_min(dafx_v4f_max(pos, dafx_v4f_set1(0.0f)), dafx_v4f_set1(last + 1.0f));
+    t_dafx_v4f seg = dafx_v4f_min(dafx_v4f_trunc(pos), dafx_v4f_set1(last));
+
+    dafx_v4f_storeu(f_seg, seg);
+    for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+        p_seg[k] = DAFX_MAX(DAFX_MIN((int)f_seg[k], (int)last), 0);
+    }
+
+    //t is 1 at the top end, which stays inside the last segment
+    return dafx_v4f_sub(pos, seg);
+}
+
+//no gather before AVX2: fetch each lane's segment, evaluate on vectors
+static inline t_dafx_v4f _TableVector(const t_DAFXSaturationTable *pTable, t_sat_table_interp interp, t_dafx_v4f x, t_dafx_v4f g_pos, t_dafx_v4f offset)
+{
+    int seg[DAFX_SIMD_LANES];
+    t_dafx_v4f t = _TablePosition(pTable, x, g_pos, offset, seg);
+
+    if (interp == SAT_TABLE_CUBIC)
+    {
+        //one row per lane, transposed to one coefficient per vector
+        t_dafx_v4f c[DAFX_SIMD_LANES];
+        for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+            c[k] = dafx_v4f_load(pTable->p_cubic + 4 * seg[k]);
+        }
+        dafx_v4f_transpose(c);
+        return dafx_v4f_madd(dafx_v4f_madd(dafx_v4f_madd(c[3], t, c[2]), t, c[1]), t, c[0]);
+    }
+    else
+    {
+        float y0[DAFX_SIMD_LANES], d[DAFX_SIMD_LANES];
+        for (int k = 0; k < DAFX_SIMD_LANES; k++) {
+            y0[k] = pTable->p_linear[2 * seg[k]];
+            d[k] = pTable->p_linear[2 * seg[k] + 1];
+        }
+        return dafx_v4f_madd(t, dafx_v4f_loadu(d), dafx_v4f_loadu(y0));
+    }
+}
+
+bool SAT_TableBlock(const t_DAFXSaturationTable *pTable, t_sat_table_interp interp,
+                    float *p_in, float *p_out, int n, float pre_gain, float post_gain)
+{
+    int i = 0;
+    //position in segments: (pre_gain * x - x_min) * scale
+    t_dafx_v4f g_pos = dafx_v4f_set1(pre_gain * pTable->scale);
+    t_dafx_v4f offset = dafx_v4f_set1(-pTable->x_min * pTable->scale);
+    t_dafx_v4f g_out = dafx_v4f_set1(post_gain);
+
+    if (interp >= Saturation_N_TABLE_INTERPS)
+        interp = SAT_TABLE_LINEAR;
+
+    for (; i + DAFX_SIMD_LANES <= n; i += DAFX_SIMD_LANES) {
+        t_dafx_v4f y = _TableVector(pTable, interp, dafx_v4f_loadu(p_in + i), g_pos, offset);
+        dafx_v4f_storeu(p_out + i, dafx_v4f_mul(y, g_out));
+    }
+
+    if (i < n)
+    {
+        float tail[DAFX_SIMD_LANES] = {0.0f};
+        memcpy(tail, p_in + i, sizeof(float) * (n - i));
+        t_dafx_v4f y = _TableVector(pTable, interp, dafx_v4f_loadu(tail), g_pos, offset);
+        dafx_v4f_storeu(tail, dafx_v4f_mul(y, g_out));
+        memcpy(p_out + i, tail, sizeof(float) * (n - i));
+    }
+
+    return true;
+}
+
+void DeallocDAFXSaturationTable(t_DAFXSaturationTable *pTable)
+{
+    if (pTable != NULL) {
+        DAFX_AlignedFree(pTable->p_linear);
+        DAFX_AlignedFree(pTable->p_cubic);
+        pTable->p_linear = NULL;
+        pTable->p_cubic = NULL;
+    }
+}
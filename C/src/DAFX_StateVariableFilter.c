@@ -0,0 +1,268 @@
+//
+//  DAFX_StateVariableFilter.c
+//
+
+#include "DAFX_StateVariableFilter.h"
+#include "DAFX_InitStateVariableFilter.h"
+
+#include "DAFX_definitions.h"
+#include "DAFX_SIMD.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+#include <math.h>
+#else
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+//tan(pi * r) for r = i / (2 * SVF_TAN_TABLE_SIZE), i.e. over 0 .. fs/2 for any sampling rate
+//Filled once and only read afterwards, so every instance shares it
+static float s_tan_table[SVF_TAN_TABLE_SIZE + 1];
+static bool s_tan_table_ready = false;
+
+static void _FillTanTable(void)
+{
+    if (s_tan_table_ready)
+        return;
+    
+    //the last point sits on the pole of tan - it is never reached due to SVF_MAX_CUTOFF_RATIO
+    for (int i = 0; i < SVF_TAN_TABLE_SIZE; i++) {
+        s_tan_table[i] = (float) tan(ONE_PI * 0.5 * (double)i / (double)SVF_TAN_TABLE_SIZE);
+    }
+    s_tan_table[SVF_TAN_TABLE_SIZE] = s_tan_table[SVF_TAN_TABLE_SIZE - 1];
+    
+    s_tan_table_ready = true;
+}
+
+//table position of a cutoff frequency, already bounded
+static inline float _TablePos(float fc, float inv_fs)
+{
+    float r = DAFX_MAX(DAFX_MIN(fc * inv_fs, SVF_MAX_CUTOFF_RATIO), 0.0f);
+    return r * (float)(2 * SVF_TAN_TABLE_SIZE);
+}
+
+static inline float _TableRead(float pos)
+{
+    int i = (int) pos;
+    float frac = pos - (float) i;
+    return s_tan_table[i] + frac * (s_tan_table[i + 1] - s_tan_table[i]);
+}
+
+static void _UpdateCoeffs(t_DAFXStateVariableFilter *pSVF)
+{
+    pSVF->k = 1.0f / pSVF->q;
+    pSVF->g = SVF_LookupG(pSVF->fc, pSVF->fs);
+}
+
+//Output blocks of one kernel call, kept in locals so the compiler does not reload them every sample
+typedef struct{
+    float *lp, *bp, *hp, *notch;
+}t_svf_outputs;
+
+//One TPT SVF step (Simper form): a1 = 1 / (1 + g * (g + k)), a2 = g * a1, a3 = g * a2
+//Written so that the integrator states only pass through a couple of operations per sample
+static inline void _SVFTick(t_svf_outputs *o, float x, float a1, float a2, float a3, float k, float *ic1, float *ic2, int i)
+{
+    float v3 = x - *ic2;
+    float v1 = a1 * *ic1 + a2 * v3;             //bandpass
+    float v2 = *ic2 + a2 * *ic1 + a3 * v3;      //lowpass
+    
+    *ic1 = 2.0f * v1 - *ic1;
+    *ic2 = 2.0f * v2 - *ic2;
+    
+    float hp = x - k * v1 - v2;
+    
+    o->lp[i] = v2;
+    o->bp[i] = v1;
+    o->hp[i] = hp;
+    o->notch[i] = hp + v2;
+}
+
+static inline t_svf_outputs _Outputs(t_DAFXStateVariableFilter *pSVF)
+{
+    t_svf_outputs o = {pSVF->p_lp_block, pSVF->p_bp_block, pSVF->p_hp_block, pSVF->p_notch_block};
+    return o;
+}
+
+float SVF_LookupG(float fc, int fs)
+{
+    _FillTanTable();
+    return _TableRead(_TablePos(fc, 1.0f / (float)fs));
+}
+
+bool InitDAFXStateVariableFilter(t_DAFXStateVariableFilter *pSVF)
+{
+    int block_size = pSVF->block_size;
+    
+    _FillTanTable();
+    
+    // memory allocation
+    pSVF->p_input_block = (float *) calloc(block_size, sizeof(float));
+    pSVF->p_lp_block = (float *) calloc(block_size, sizeof(float));
+    pSVF->p_bp_block = (float *) calloc(block_size, sizeof(float));
+    pSVF->p_hp_block = (float *) calloc(block_size, sizeof(float));
+    pSVF->p_notch_block = (float *) calloc(block_size, sizeof(float));
+    pSVF->p_cutoff_block = (float *) calloc(block_size, sizeof(float));
+    pSVF->p_a1_block = (float *) DAFX_AlignedCalloc(block_size + DAFX_SIMD_LANES, sizeof(float));
+    pSVF->p_a2_block = (float *) DAFX_AlignedCalloc(block_size + DAFX_SIMD_LANES, sizeof(float));
+    pSVF->p_a3_block = (float *) DAFX_AlignedCalloc(block_size + DAFX_SIMD_LANES, sizeof(float));
+    
+    //params
+    pSVF->fc = SVF_INIT_DEFAULT_CUTOFF_HZ;
+    pSVF->q = SVF_INIT_DEFAULT_Q;
+    _UpdateCoeffs(pSVF);
+    
+    for (int i = 0; i < block_size; i++) {
+        pSVF->p_cutoff_block[i] = pSVF->fc;
+    }
+    
+    SVF_Reset(pSVF);
+    DAFX_DenormalResetStats(&pSVF->denormal_stats);
+    
+    return true;
+}
+
+//End of block: integrator states checked for subnormals
+static void _CheckStates(t_DAFXStateVariableFilter *pSVF)
+{
+    DAFX_DenormalCountBlock(&pSVF->denormal_stats);
+    DAFX_DenormalCheckStates(&pSVF->denormal_stats, &pSVF->ic1eq, 1);
+    DAFX_DenormalCheckStates(&pSVF->denormal_stats, &pSVF->ic2eq, 1);
+}
+
+bool DAFXProcessStateVariableFilter(t_DAFXStateVariableFilter *pSVF)
+{
+    t_svf_outputs o = _Outputs(pSVF);
+    float *p_in = pSVF->p_input_block;
+    int n = pSVF->block_size;
+    float g = pSVF->g;
+    float k = pSVF->k;
+    float a1 = 1.0f / (1.0f + g * (g + k));
+    float a2 = g * a1;
+    float a3 = g * a2;
+    float ic1 = pSVF->ic1eq;
+    float ic2 = pSVF->ic2eq;
+    t_dafx_fp_state fp_state;
+    
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    for (int i = 0; i < n; i++) {
+        _SVFTick(&o, p_in[i], a1, a2, a3, k, &ic1, &ic2, i);
+    }
+    
+    pSVF->ic1eq = ic1;
+    pSVF->ic2eq = ic2;
+    
+    _CheckStates(pSVF);
+    DAFX_DenormalGuardEnd(&fp_state);
+    
+    return true;
+}
+
+bool DAFXProcessStateVariableFilterModulated(t_DAFXStateVariableFilter *pSVF)
+{
+    t_svf_outputs o = _Outputs(pSVF);
+    float *p_in = pSVF->p_input_block;
+    float *p_cutoff = pSVF->p_cutoff_block;
+    int n = pSVF->block_size;
+    float k = pSVF->k;
+    float *p_a1 = pSVF->p_a1_block;
+    float *p_a2 = pSVF->p_a2_block;
+    float *p_a3 = pSVF->p_a3_block;
+    float inv_fs = 1.0f / (float)pSVF->fs;
+    float ic1 = pSVF->ic1eq;
+    float ic2 = pSVF->ic2eq;
+    t_dafx_fp_state fp_state;
+    
+    if (n <= 0)
+        return true;
+    
+    DAFX_DenormalGuardBegin(&fp_state);
+    
+    //1st pass: per-sample g from the table (into p_a2 for now)
+    for (int i = 0; i < n; i++) {
+        p_a2[i] = _TableRead(_TablePos(p_cutoff[i], inv_fs));
+    }
+    
+    //2nd pass: per-sample coeffs a vector at a time, with the only division of the filter
+    //(blocks are padded to a multiple of the vector size)
+    t_dafx_v4f v_one = dafx_v4f_set1(1.0f);
+    t_dafx_v4f v_k = dafx_v4f_set1(k);
+    for (int i = 0; i < n; i += DAFX_SIMD_LANES)
+    {
+        t_dafx_v4f g = dafx_v4f_load(p_a2 + i);
+        t_dafx_v4f a1 = dafx_v4f_div(v_one, dafx_v4f_madd(g, dafx_v4f_add(g, v_k), v_one));
+        t_dafx_v4f a2 = dafx_v4f_mul(g, a1);
+        dafx_v4f_store(p_a1 + i, a1);
+        dafx_v4f_store(p_a2 + i, a2);
+        dafx_v4f_store(p_a3 + i, dafx_v4f_mul(g, a2));
+    }
+    
+    //3rd pass: the recursion itself
+    for (int i = 0; i < n; i++) {
+        _SVFTick(&o, p_in[i], p_a1[i], p_a2[i], p_a3[i], k, &ic1, &ic2, i);
+    }
+    
+    pSVF->ic1eq = ic1;
+    pSVF->ic2eq = ic2;
+    
+    //the filter keeps the last cutoff when going back to the fixed kernel
+    pSVF->fc = p_cutoff[n - 1];
+    pSVF->g = SVF_LookupG(pSVF->fc, pSVF->fs);
+    
+    _CheckStates(pSVF);
+    DAFX_DenormalGuardEnd(&fp_state);
+    
+    return true;
+}
+
+bool DAFXBypassStateVariableFilter(t_DAFXStateVariableFilter *pSVF)
+{
+    size_t bytes = sizeof(float) * pSVF->block_size;
+    
+    memcpy(pSVF->p_lp_block, pSVF->p_input_block, bytes);
+    memcpy(pSVF->p_bp_block, pSVF->p_input_block, bytes);
+    memcpy(pSVF->p_hp_block, pSVF->p_input_block, bytes);
+    memcpy(pSVF->p_notch_block, pSVF->p_input_block, bytes);
+    
+    return true;
+}
+
+void DeallocDAFXStateVariableFilter(t_DAFXStateVariableFilter *pSVF)
+{
+    if(pSVF != NULL) {
+        FREE(pSVF->p_input_block);
+        FREE(pSVF->p_lp_block);
+        FREE(pSVF->p_bp_block);
+        FREE(pSVF->p_hp_block);
+        FREE(pSVF->p_notch_block);
+        FREE(pSVF->p_cutoff_block);
+        DAFX_AlignedFree(pSVF->p_a1_block);
+        DAFX_AlignedFree(pSVF->p_a2_block);
+        DAFX_AlignedFree(pSVF->p_a3_block);
+        pSVF->p_a1_block = NULL;
+        pSVF->p_a2_block = NULL;
+        pSVF->p_a3_block = NULL;
+    }
+}
+
+bool SVF_SetCutoff(t_DAFXStateVariableFilter *pSVF, float fc)
+{
+    pSVF->fc = DAFX_MAX(fc, SVF_MIN_CUTOFF_HZ);
+    pSVF->g = SVF_LookupG(pSVF->fc, pSVF->fs);
+    return true;
+}
+
+bool SVF_SetQ(t_DAFXStateVariableFilter *pSVF, float q)
+{
+    pSVF->q = DAFX_MAX(DAFX_MIN(q, SVF_MAX_Q), SVF_MIN_Q);
+    pSVF->k = 1.0f / pSVF->q;
+    return true;
+}
+
+bool SVF_Reset(t_DAFXStateVariableFilter *pSVF)
+{
+    pSVF->ic1eq = 0.0f;
+    pSVF->ic2eq = 0.0f;
+    return true;
+}
@@ -7,6 +7,7 @@
 #include "DAFX_LowFrequencyOscillator.h"
 #include "DAFX_InitTremolo.h"
 #include "DAFX_definitions.h"
+#include "DAFX_Denormal.h"
 
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
@@ -64,6 +65,53 @@ bool SetPostGain(t_DAFXTremolo *pTREM, float gain)
     return true;
 }
 
+//any LFO shape, the tables are shared with every other instance
+bool SetShape(t_DAFXTremolo *pTREM, t_lfo_algo_select shape)
+{
+    t_lfo_algo_select prev_shape = pTREM->p_LFO->algo;
+    
+    LFO_SetMode(pTREM->p_LFO, shape);
+    
+    //the bus slot carries the shape: move to the one of the new shape (kept as it was if the bus is full)
+    if (pTREM->p_mod_bus != NULL && pTREM->p_LFO->algo != prev_shape &&
+        !SetModulationBus(pTREM, pTREM->p_mod_bus, pTREM->mod_division, pTREM->mod_phase_offset))
+    {
+        LFO_SetMode(pTREM->p_LFO, prev_shape);
+        return false;
+    }
+    return true;
+}
+
+bool SetModulationBus(t_DAFXTremolo *pTREM, t_DAFX_ModulationBus *pBUS, float division, float phase_offset)
+{
+    int slot = -1;
+    
+    if (pBUS != NULL)
+    {
+        if (pBUS->block_size != pTREM->block_size)
+            return false;
+        
+        slot = MODBUS_Subscribe(pBUS, pTREM->p_LFO->algo, division, phase_offset);
+        if (slot < 0)
+            return false;
+    }
+    
+    t_DAFX_ModulationBus *pOldBUS = pTREM->p_mod_bus;
+    int old_slot = pTREM->mod_slot;
+    
+    //the slot first, the bus published last: a block that sees the new bus sees its slot too
+    DAFX_ATOMIC_STORE(pTREM->mod_slot, slot);
+    DAFX_ATOMIC_STORE(pTREM->p_mod_bus, pBUS);
+    pTREM->mod_division = division;
+    pTREM->mod_phase_offset = phase_offset;
+    
+    //the old slot may be handed out again from here on
+    if (pOldBUS != NULL)
+        MODBUS_Unsubscribe(pOldBUS, old_slot);
+    
+    return true;
+}
+
 bool InitDAFXTremolo(t_DAFXTremolo *pTREM)
 {
     // ---- general, wrapper ---- //
@@ -77,6 +125,10 @@ bool InitDAFXTremolo(t_DAFXTremolo *pTREM)
     pTREM->p_LFO->block_size = block_size;
     InitDAFXLowFrequencyOscillator(pTREM->p_LFO);
     LFO_SetMode(pTREM->p_LFO, LFO_ALGO_SELECT_SIN);
+    pTREM->p_mod_bus = NULL;
+    pTREM->mod_slot = -1;
+    pTREM->mod_division = 1.0;
+    pTREM->mod_phase_offset = 0.0;
     
     // -- Tremolo params -- //
     SetRate(pTREM, TREM_INIT_DEFAULT_RATE_BMP);
@@ -94,14 +146,27 @@ bool DAFXTremolo(t_DAFXTremolo *pTREM)
     float *pOutput = pTREM->p_output_block;
     float *p_lfo_buff = pTREM->p_LFO->p_output_block;
     float gain = pTREM->post_gain;
+    //read once: the bus may be switched by the message thread (see SetModulationBus)
+    t_DAFX_ModulationBus *pBUS = DAFX_ATOMIC_LOAD(pTREM->p_mod_bus);
+    int slot = DAFX_ATOMIC_LOAD(pTREM->mod_slot);
+    t_dafx_fp_state fp_state;
+
+    DAFX_DenormalGuardBegin(&fp_state);
 
     //First, generate the LFO signal with a single call to its sample generator function
-    DAFXLowFrequencyOscillator(pTREM->p_LFO);
+    //(or map the shared modulator through the LFO's depth settings)
+    if (pBUS != NULL && slot >= 0) {
+        MODBUS_Render(pBUS, slot, pTREM->p_LFO);
+    } else {
+        DAFXLowFrequencyOscillator(pTREM->p_LFO);
+    }
     
     for (int i = 0; i < block_size; i++) {
         pOutput[i] = pInput[i] * p_lfo_buff[i] * gain;
     }
     
+    DAFX_DenormalGuardEnd(&fp_state);
+    
     return true;
 }
 
@@ -113,6 +178,8 @@ bool DAFXBypassTremolo(t_DAFXTremolo *pTREM)
 
 void DeallocDAFXTremolo(t_DAFXTremolo *pTREM)
 {
+    if (pTREM->p_mod_bus != NULL)
+        MODBUS_Unsubscribe(pTREM->p_mod_bus, pTREM->mod_slot);
     FREE(pTREM->p_input_block);
     FREE(pTREM->p_output_block);
 }
@@ -6,7 +6,9 @@
 #include "DAFX_Vibrato.h"
 #include "DAFX_LowFrequencyOscillator.h"
 #include "DAFX_InitVibrato.h"
+#include "DAFX_ControlRate.h"
 #include "DAFX_definitions.h"
+#include "DAFX_Denormal.h"
 
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
@@ -18,14 +20,18 @@
 
 bool VIB_SetRate(t_DAFXVibrato *pVIB, int rate_bpm)
 {
+    pVIB->rate_bpm = rate_bpm;
+    
+    //the rate of a bus modulator comes from the tempo, this one applies when leaving the bus
+    if (pVIB->p_mod_bus != NULL)
+        return true;
+    
     float f = DAFX_MAX((float)rate_bpm, 0.0) * 0.01666667; // *(1/60)
     LFO_SetFrequency(pVIB->pLFO, f);
     
     //Need to reset the depth accordingly, because d(sin(Ax))/dx == A * cos(Ax)
     VIB_SetDepth(pVIB, pVIB->depth);
     
-    pVIB->rate_bpm = rate_bpm;
-    
     return true;
 }
 
@@ -43,6 +49,79 @@ bool VIB_SetDepth(t_DAFXVibrato *pVIB, float depth)
     return true;
 }
 
+//the depth scaling above assumes a sine: shapes with steps (square, sample-and-hold)
+//make the delay jump, which is heard as clicks rather than pitch modulation
+bool VIB_SetShape(t_DAFXVibrato *pVIB, t_lfo_algo_select shape)
+{
+    t_lfo_algo_select prev_shape = pVIB->pLFO->algo;
+    
+    LFO_SetMode(pVIB->pLFO, shape);
+    
+    //the bus slot carries the shape: move to the one of the new shape (kept as it was if the bus is full)
+    if (pVIB->p_mod_bus != NULL && pVIB->pLFO->algo != prev_shape &&
+        !VIB_SetModulationBus(pVIB, pVIB->p_mod_bus, pVIB->mod_division, pVIB->mod_phase_offset))
+    {
+        LFO_SetMode(pVIB->pLFO, prev_shape);
+        return false;
+    }
+    return true;
+}
+
+bool VIB_SetControlRate(t_DAFXVibrato *pVIB, int period, t_ctrl_interp_mode interp)
+{
+    CTRL_SetPeriod(pVIB->p_ctrl, period);
+    CTRL_SetInterpolation(pVIB->p_ctrl, interp);
+    return true;
+}
+
+//the depth compensation uses the rate of the bus modulator, which changes with the tempo
+static void _FollowSlotRate(t_DAFXVibrato *pVIB, t_DAFX_ModulationBus *pBUS, int slot)
+{
+    float f = MODBUS_GetSlotFrequency(pBUS, slot);
+    
+    if (f != pVIB->pLFO->f) {
+        LFO_SetFrequency(pVIB->pLFO, f);
+        VIB_SetDepth(pVIB, pVIB->depth);
+    }
+}
+
+bool VIB_SetModulationBus(t_DAFXVibrato *pVIB, t_DAFX_ModulationBus *pBUS, float division, float phase_offset)
+{
+    int slot = -1;
+    
+    if (pBUS != NULL)
+    {
+        if (pBUS->block_size != pVIB->block_size)
+            return false;
+        
+        slot = MODBUS_Subscribe(pBUS, pVIB->pLFO->algo, division, phase_offset);
+        if (slot < 0)
+            return false;
+    }
+    
+    t_DAFX_ModulationBus *pOldBUS = pVIB->p_mod_bus;
+    int old_slot = pVIB->mod_slot;
+    
+    //the slot first, the bus published last: a block that sees the new bus sees its slot too
+    DAFX_ATOMIC_STORE(pVIB->mod_slot, slot);
+    DAFX_ATOMIC_STORE(pVIB->p_mod_bus, pBUS);
+    pVIB->mod_division = division;
+    pVIB->mod_phase_offset = phase_offset;
+    
+    //the old slot may be handed out again from here on
+    if (pOldBUS != NULL)
+        MODBUS_Unsubscribe(pOldBUS, old_slot);
+    
+    //the depth compensation follows the rate of the modulator (at the current tempo)
+    if (pBUS != NULL) {
+        _FollowSlotRate(pVIB, pBUS, slot);
+    } else {
+        VIB_SetRate(pVIB, pVIB->rate_bpm);
+    }
+    
+    return true;
+}
+
 bool InitDAFXVibrato(t_DAFXVibrato *pVIB)
 {
     // ---- general, wrapper ---- //
@@ -60,6 +139,17 @@ bool InitDAFXVibrato(t_DAFXVibrato *pVIB)
     pVIB->pLFO->block_size = block_size;
     InitDAFXLowFrequencyOscillator(pVIB->pLFO);
     LFO_SetMode(pVIB->pLFO, LFO_ALGO_SELECT_SIN);
+    pVIB->p_mod_bus = NULL;
+    pVIB->mod_slot = -1;
+    pVIB->mod_division = 1.0;
+    pVIB->mod_phase_offset = 0.0;
+    
+    //allocate and init control-rate track
+    pVIB->p_ctrl = (t_DAFX_ControlRate *) calloc(1, sizeof(t_DAFX_ControlRate));
+    pVIB->p_ctrl->block_size = block_size;
+    pVIB->p_ctrl->max_period = VIB_CTRL_MAX_PERIOD;
+    InitControlRate(pVIB->p_ctrl);
+    VIB_SetControlRate(pVIB, VIB_INIT_CTRL_PERIOD, VIB_INIT_CTRL_INTERP);
     
     // -- Vibrato params -- //
     VIB_SetRate(pVIB, VIB_INIT_DEFAULT_RATE_BPM);
@@ -77,16 +167,36 @@ bool DAFXVibrato(t_DAFXVibrato *pVIB)
     int block_size = pVIB->block_size;
     float *pInput = pVIB->p_input_buffer;
     float *pOutput = pVIB->p_output_buffer;
-    float *p_lfo_buff = pVIB->pLFO->p_output_block;
     t_DAFXIntegerSampleDelayLine *pDEL = pVIB->pDEL;
+    t_DAFX_ControlRate *pCTRL = pVIB->p_ctrl;
+    float *p_points = CTRL_GetPoints(pCTRL);
+    float max_delay_ms = pDEL->max_delay_ms;
+    double ms_to_samples = 0.001 * pDEL->fs;
+    //read once: the bus may be switched by the message thread (see VIB_SetModulationBus)
+    t_DAFX_ModulationBus *pBUS = DAFX_ATOMIC_LOAD(pVIB->p_mod_bus);
+    int slot = DAFX_ATOMIC_LOAD(pVIB->mod_slot);
+    t_dafx_fp_state fp_state;
 
-    //First, generate the LFO signal with a single call to its sample generator function
-    DAFXLowFrequencyOscillator(pVIB->pLFO);
+    DAFX_DenormalGuardBegin(&fp_state);
+
+    //First, generate the LFO signal (delay in ms) at control rate
+    //(or map the shared modulator through the LFO's depth settings)
+    if (pBUS != NULL && slot >= 0) {
+        _FollowSlotRate(pVIB, pBUS, slot);
+        MODBUS_RenderControlRate(pBUS, slot, pVIB->pLFO, pCTRL->period, p_points);
+    } else {
+        DAFXLowFrequencyOscillatorControlRate(pVIB->pLFO, pCTRL->period, p_points);
+    }
     
-    for (int i = 0; i < block_size; i++) {
-        DEL_SetDelayMs(pDEL, p_lfo_buff[i]);
-        pOutput[i] = DAFXProcessDelaySingleSample(pDEL, pInput[i]);
+    //delay in samples at the control points, interpolated for every sample
+    for (int k = 0; k < pCTRL->num_points; k++) {
+        p_points[k] = (float)(DAFX_MIN(DAFX_MAX(p_points[k], 0.0), max_delay_ms) * ms_to_samples);
     }
+    CTRL_Interpolate(pCTRL);
+    
+    DAFXProcessDelayBlockModulated(pDEL, pCTRL->p_output_block, pInput, pOutput, block_size);
+    
+    DAFX_DenormalGuardEnd(&fp_state);
     
     return true;
 }
@@ -99,6 +209,10 @@ bool DAFXBypassVibrato(t_DAFXVibrato *pVIB)
 
 void DeallocDAFXVibrato(t_DAFXVibrato *pVIB)
 {
+    if (pVIB->p_mod_bus != NULL)
+        MODBUS_Unsubscribe(pVIB->p_mod_bus, pVIB->mod_slot);
+    DeallocControlRate(pVIB->p_ctrl);
+    FREE(pVIB->p_ctrl);
     FREE(pVIB->p_input_buffer);
     FREE(pVIB->p_output_buffer);
 }
@@ -0,0 +1,37 @@
+//
+//  DAFX_Test.h
+//
+//  Checks shared by the test executables: every check prints what was measured,
+//  and main returns the number of failed ones
+//
+
+#ifndef DAFX_Test_h
+#define DAFX_Test_h
+
+#include <stdio.h>
+#include <math.h>
+
+static int dafx_test_failures = 0;
+
+#define DAFX_CHECK(cond, ...) do {                      \
+        printf("%s ", (cond) ? "ok  " : "FAIL");        \
+        printf(__VA_ARGS__);                            \
+        printf("\n");                                   \
+        if (!(cond)) dafx_test_failures++;              \
+    } while (0)
+
+#define DAFX_TEST_RESULT() (dafx_test_failures > 0 ? 1 : 0)
+
+//largest absolute difference between two blocks
+static double DAFX_TestMaxDiff(const float *p_a, const float *p_b, int n)
+{
+    double max_diff = 0.0;
+    for (int i = 0; i < n; i++) {
+        double diff = fabs((double)p_a[i] - (double)p_b[i]);
+        if (diff > max_diff)
+            max_diff = diff;
+    }
+    return max_diff;
+}
+
+#endif /* DAFX_Test_h */
@@ -0,0 +1,150 @@
+//
+//  test_BiquadFilter.c
+//
+//  The state-space block mode against the TDF-II recursion it replaces: both
+//  are measured against the same recursion in double precision, over designs
+//  from 20 Hz to 20 kHz and a block length that leaves a tail after the steps.
+//  Above LOW_F0 the state-space error has to stay within a few times the
+//  TDF-II one, below it (poles close to z = 1, see SetBiquadProcessMode) it
+//  is only bounded
+//
+
+#include "DAFX_Test.h"
+#include "DAFX_BiquadFilter.h"
+
+#define BLOCK_LEN   37
+#define NUM_BLOCKS  2000
+#define FS          48000.0
+
+#define LOW_F0              1000.0
+#define MAX_ERR_RATIO       4.0     //state-space / TDF-II error, above LOW_F0
+#define MAX_ERR_FLOOR       1e-6
+#define MAX_ERR_LOW_F0      1e-2    //full scale input
+
+typedef enum
+{
+    DESIGN_LOWPASS = 0,
+    DESIGN_BANDPASS,
+}t_design;
+
+//RBJ cookbook low and band pass
+static void _Design(float *p_coeffs, double f0, double q, t_design design)
+{
+    double w = 2.0 * M_PI * f0 / FS;
+    double cs = cos(w);
+    double alpha = sin(w) / (2.0 * q);
+
+    if (design == DESIGN_LOWPASS) {
+        p_coeffs[0] = (float)((1.0 - cs) / 2.0);
+        p_coeffs[1] = (float)(1.0 - cs);
+        p_coeffs[2] = (float)((1.0 - cs) / 2.0);
+    } else {
+        p_coeffs[0] = (float)alpha;
+        p_coeffs[1] = 0.0f;
+        p_coeffs[2] = (float)-alpha;
+    }
+    p_coeffs[3] = (float)(1.0 + alpha);
+    p_coeffs[4] = (float)(-2.0 * cs);
+    p_coeffs[5] = (float)(1.0 - alpha);
+}
+
+//TDF-II in double, on the float coefficients the filters were given (normalized the same way)
+static double _ReferenceSample(const float *b, const float *a, double *w, double x)
+{
+    double y = b[0] * x + w[0];
+    w[0] = b[1] * x - a[1] * y + w[1];
+    w[1] = b[2] * x - a[2] * y;
+    return y;
+}
+
+int main(void)
+{
+    const double f0s[] = {20.0, 100.0, 2000.0, 10000.0, 20000.0};
+    const double qs[] = {0.707, 2.75, 10.0};
+
+    for (int d = DESIGN_LOWPASS; d <= DESIGN_BANDPASS; d++) {
+        for (int f = 0; f < 5; f++) {
+            for (int q = 0; q < 3; q++)
+            {
+                t_DAFX_BiquadFilter bq_sample, bq_ss;
+                float coeffs[6];
+                double w_ref[2] = {0.0, 0.0};
+                double err_sample = 0.0, err_ss = 0.0, peak = 0.0;
+                unsigned int seed = 1;
+
+                _Design(coeffs, f0s[f], qs[q], (t_design)d);
+                bq_sample.buffer_len = bq_ss.buffer_len = BLOCK_LEN;
+                InitBiquadFilter(&bq_sample);
+                InitBiquadFilter(&bq_ss);
+                SetBiquadFilterCoeffs(&bq_sample, coeffs);
+                SetBiquadProcessMode(&bq_ss, BIQUAD_MODE_STATE_SPACE);
+                SetBiquadFilterCoeffs(&bq_ss, coeffs);
+
+                for (int blk = 0; blk < NUM_BLOCKS; blk++)
+                {
+                    for (int i = 0; i < BLOCK_LEN; i++) {
+                        seed = seed * 1103515245u + 12345u;
+                        bq_sample.pInBuff[i] = bq_ss.pInBuff[i] = (float)((seed >> 16) & 0x7fff) / 16384.0f - 1.0f;
+                    }
+                    ProcessBlockBiquad(&bq_sample);
+                    ProcessBlockBiquad(&bq_ss);
+
+                    for (int i = 0; i < BLOCK_LEN; i++) {
+                        double ref = _ReferenceSample(bq_sample.b, bq_sample.a, w_ref, bq_sample.pInBuff[i]);
+                        err_sample = fmax(err_sample, fabs(bq_sample.pOutBuff[i] - ref));
+                        err_ss = fmax(err_ss, fabs(bq_ss.pOutBuff[i] - ref));
+                        peak = fmax(peak, fabs(ref));
+                    }
+                }
+                if (f0s[f] >= LOW_F0) {
+                    DAFX_CHECK(err_ss <= MAX_ERR_RATIO * err_sample + MAX_ERR_FLOOR,
+                               "%s %5.0f Hz Q %5.2f: max error TDF-II %.2e, state-space %.2e (peak %.2f)",
+                               d ? "band pass" : "low pass ", f0s[f], qs[q], err_sample, err_ss, peak);
+                } else {
+                    DAFX_CHECK(err_ss <= MAX_ERR_LOW_F0,
+                               "%s %5.0f Hz Q %5.2f: max error TDF-II %.2e, state-space %.2e (peak %.2f, low f0)",
+                               d ? "band pass" : "low pass ", f0s[f], qs[q], err_sample, err_ss, peak);
+                }
+
+                DeallocBiquadFilter(&bq_sample);
+                DeallocBiquadFilter(&bq_ss);
+            }
+        }
+    }
+
+    //switching modes between blocks keeps the state: same output as staying in sample mode
+    {
+        t_DAFX_BiquadFilter bq_sample, bq_switch;
+        float coeffs[6];
+        double max_diff = 0.0;
+
+        _Design(coeffs, 5000.0, 0.707, DESIGN_LOWPASS);
+        bq_sample.buffer_len = bq_switch.buffer_len = BLOCK_LEN;
+        InitBiquadFilter(&bq_sample);
+        InitBiquadFilter(&bq_switch);
+        SetBiquadFilterCoeffs(&bq_sample, coeffs);
+        SetBiquadFilterCoeffs(&bq_switch, coeffs);
+
+        for (int blk = 0; blk < 100; blk++)
+        {
+            SetBiquadProcessMode(&bq_switch, (blk % 3 == 0) ? BIQUAD_MODE_SAMPLE : BIQUAD_MODE_STATE_SPACE);
+            for (int i = 0; i < BLOCK_LEN; i++)
+                bq_sample.pInBuff[i] = bq_switch.pInBuff[i] = sinf(0.05f * (float)(blk * BLOCK_LEN + i));
+            ProcessBlockBiquad(&bq_sample);
+            ProcessBlockBiquad(&bq_switch);
+            max_diff = fmax(max_diff, DAFX_TestMaxDiff(bq_sample.pOutBuff, bq_switch.pOutBuff, BLOCK_LEN));
+        }
+        DAFX_CHECK(max_diff < 1e-5, "mode switched every block: max difference to sample mode %.2e", max_diff);
+
+        SetBiquadProcessMode(&bq_switch, BIQUAD_MODE_STATE_SPACE);
+        DAFX_CHECK(!SetBiquadProcessMode(&bq_switch, BiquadFilter_N_MODES) &&
+                   !SetBiquadProcessMode(&bq_switch, (t_biquad_process_mode)-1) &&
+                   bq_switch.mode == BIQUAD_MODE_STATE_SPACE,
+                   "unknown process modes are rejected");
+
+        DeallocBiquadFilter(&bq_sample);
+        DeallocBiquadFilter(&bq_switch);
+    }
+
+    return DAFX_TEST_RESULT();
+}
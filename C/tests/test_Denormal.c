@@ -0,0 +1,167 @@
+//
+//  test_Denormal.c
+//
+//  Recursive modules fed a loud burst and then silence: their states must decay
+//  away without ever holding a subnormal, and the guard must give the caller
+//  its FPU mode back
+//
+
+#include "DAFX_Test.h"
+#include "DAFX_Denormal.h"
+#include "DAFX_BiquadFilter.h"
+#include "DAFX_SOSCascade.h"
+#include "DAFX_StateVariableFilter.h"
+
+#define FS              48000
+#define BLOCK_LEN       64
+#define BURST_BLOCKS    (FS / BLOCK_LEN)            //1 s of noise
+#define SILENT_BLOCKS   (10 * FS / BLOCK_LEN)       //then 10 s of silence
+#define NUM_STAGES      4
+
+static unsigned int noise_seed = 1;
+
+static float _Input(int blk)
+{
+    if (blk >= BURST_BLOCKS)
+        return 0.0f;
+    noise_seed = noise_seed * 1664525u + 1013904223u;
+    return (float)(noise_seed >> 9) * (1.0f / 8388608.0f) - 1.0f;
+}
+
+//narrow low pass near DC: the slowest decay there is
+static void _LowPassCoeffs(double f0, double q, float *p_coeffs)
+{
+    double w0 = 2.0 * M_PI * f0 / FS;
+    double alpha = sin(w0) / (2.0 * q);
+
+    p_coeffs[0] = (float)((1.0 - cos(w0)) * 0.5);
+    p_coeffs[1] = (float)(1.0 - cos(w0));
+    p_coeffs[2] = (float)((1.0 - cos(w0)) * 0.5);
+    p_coeffs[3] = (float)(1.0 + alpha);
+    p_coeffs[4] = (float)(-2.0 * cos(w0));
+    p_coeffs[5] = (float)(1.0 - alpha);
+}
+
+static int _CountSubnormals(const float *p_x, int n)
+{
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        if (DAFX_IsSubnormal(p_x[i]))
+            count++;
+    }
+    return count;
+}
+
+static void _TestStateCheck(void)
+{
+    t_dafx_denormal_stats stats;
+    float states[5] = {0.0f, 1e-40f, 1.0f, -1e-39f, 1e-20f};
+
+    DAFX_DenormalResetStats(&stats);
+    DAFX_DenormalCheckStates(&stats, states, 5);
+
+    DAFX_CHECK(stats.num_subnormals == 2, "state check: %u subnormals counted in 5 states (2 expected)",
+               stats.num_subnormals);
+#if defined(DAFX_DENORMAL_INJECT)
+    DAFX_CHECK(stats.num_flushes == 3 && states[1] == 0.0f && states[3] == 0.0f && states[4] == 0.0f && states[2] == 1.0f,
+               "software flush: %u states below the threshold set to zero", stats.num_flushes);
+#endif
+}
+
+static void _TestGuardRestoresMode(void)
+{
+#if defined(DAFX_DENORMAL_FTZ_SSE)
+    t_DAFX_BiquadFilter bq;
+    float coeffs[6];
+
+    bq.buffer_len = BLOCK_LEN;
+    InitBiquadFilter(&bq);
+    _LowPassCoeffs(1000.0, 0.707, coeffs);
+    SetBiquadFilterCoeffs(&bq, coeffs);
+
+    unsigned int csr_before = _mm_getcsr();
+    ProcessBlockBiquad(&bq);
+    unsigned int csr_after = _mm_getcsr();
+
+    DAFX_CHECK(csr_before == csr_after, "MXCSR of the caller restored after a block (0x%04x / 0x%04x)",
+               csr_before, csr_after);
+    DeallocBiquadFilter(&bq);
+#endif
+}
+
+static void _TestSilenceAfterBurst(void)
+{
+    t_DAFX_BiquadFilter bq;
+    t_DAFX_SOSCascade sos;
+    t_DAFXStateVariableFilter svf;
+    float coeffs[6];
+    float in[BLOCK_LEN], sos_out[BLOCK_LEN];
+    int out_subnormals[3] = {0, 0, 0};
+
+    bq.buffer_len = BLOCK_LEN;
+    InitBiquadFilter(&bq);
+    _LowPassCoeffs(40.0, 10.0, coeffs);
+    SetBiquadFilterCoeffs(&bq, coeffs);
+
+    sos.num_stages = NUM_STAGES;
+    InitSOSCascade(&sos);
+    for (int s = 0; s < NUM_STAGES; s++) {
+        _LowPassCoeffs(30.0 + 20.0 * s, 4.0, coeffs);
+        SetSOSCascadeStageCoeffs(&sos, s, coeffs);
+    }
+
+    svf.block_size = BLOCK_LEN;
+    svf.fs = FS;
+    InitDAFXStateVariableFilter(&svf);
+    SVF_SetCutoff(&svf, 60.0f);
+    SVF_SetQ(&svf, 8.0f);
+
+    noise_seed = 1;
+    for (int blk = 0; blk < BURST_BLOCKS + SILENT_BLOCKS; blk++)
+    {
+        for (int i = 0; i < BLOCK_LEN; i++)
+            in[i] = _Input(blk);
+
+        memcpy(bq.pInBuff, in, sizeof(in));
+        ProcessBlockBiquad(&bq);
+        ProcessBlockSOSCascade(&sos, in, sos_out, BLOCK_LEN);
+        memcpy(svf.p_input_block, in, sizeof(in));
+        DAFXProcessStateVariableFilter(&svf);
+
+        out_subnormals[0] += _CountSubnormals(bq.pOutBuff, BLOCK_LEN);
+        out_subnormals[1] += _CountSubnormals(sos_out, BLOCK_LEN);
+        out_subnormals[2] += _CountSubnormals(svf.p_lp_block, BLOCK_LEN);
+    }
+
+    DAFX_CHECK(bq.denormal_stats.num_blocks == BURST_BLOCKS + SILENT_BLOCKS && bq.denormal_stats.num_subnormals == 0
+               && out_subnormals[0] == 0,
+               "biquad: %u blocks checked, %u subnormal states, %d subnormal outputs",
+               bq.denormal_stats.num_blocks, bq.denormal_stats.num_subnormals, out_subnormals[0]);
+    DAFX_CHECK(sos.denormal_stats.num_blocks == BURST_BLOCKS + SILENT_BLOCKS && sos.denormal_stats.num_subnormals == 0
+               && out_subnormals[1] == 0,
+               "SOS cascade: %u blocks checked, %u subnormal states, %d subnormal outputs",
+               sos.denormal_stats.num_blocks, sos.denormal_stats.num_subnormals, out_subnormals[1]);
+    DAFX_CHECK(svf.denormal_stats.num_blocks == BURST_BLOCKS + SILENT_BLOCKS && svf.denormal_stats.num_subnormals == 0
+               && out_subnormals[2] == 0,
+               "SVF: %u blocks checked, %u subnormal states, %d subnormal outputs",
+               svf.denormal_stats.num_blocks, svf.denormal_stats.num_subnormals, out_subnormals[2]);
+
+    //10 s are far beyond the decay of all of them (rounding may keep them from reaching exactly zero)
+    DAFX_CHECK(fabsf(bq.pOutBuff[BLOCK_LEN - 1]) < 1e-30f && fabsf(sos_out[BLOCK_LEN - 1]) < 1e-30f
+               && fabsf(svf.p_lp_block[BLOCK_LEN - 1]) < 1e-30f,
+               "outputs after 10 s of silence below -600 dB: %g %g %g", bq.pOutBuff[BLOCK_LEN - 1], sos_out[BLOCK_LEN - 1],
+               svf.p_lp_block[BLOCK_LEN - 1]);
+
+    DeallocBiquadFilter(&bq);
+    DeallocSOSCascade(&sos);
+    DeallocDAFXStateVariableFilter(&svf);
+}
+
+int main(void)
+{
+    _TestStateCheck();
+    _TestGuardRestoresMode();
+    _TestSilenceAfterBurst();
+
+    return DAFX_TEST_RESULT();
+}
@@ -0,0 +1,166 @@
+//
+//  test_LowFrequencyOscillator.c
+//
+//  Block generators of the LFO against the waveforms computed in double from
+//  the sample position, and against the recursive path they replaced. The
+//  recursive path itself over a long run, where it used to drift (the full
+//  10^9 sample soak is bench_LowFrequencyOscillatorSoak)
+//
+
+#include "DAFX_Test.h"
+#include "DAFX_LowFrequencyOscillator.h"
+
+#define FS          48000
+#define SECONDS     60
+#define FREQ        3.7f
+#define AMP         0.8f
+#define OFFSET      0.1f
+#define CLIP_H      0.85f
+#define BALANCE     0.3f
+
+//about 3.5 minutes at 48 kHz, at a tempo synced rate (97 bpm) that is no whole number of samples
+#define SOAK_SAMPLES    10000000L
+#define SOAK_FREQ       (97.0f / 60.0f)
+
+static void _Setup(t_DAFXLowFrequencyOscillator *pLFO, int len)
+{
+    pLFO->block_size = len;
+    pLFO->fs = FS;
+    InitDAFXLowFrequencyOscillator(pLFO);
+    LFO_SetFrequency(pLFO, FREQ);
+    LFO_SetAmplitude(pLFO, AMP);
+    LFO_SetOffset(pLFO, OFFSET);
+    LFO_SetClipHigh(pLFO, CLIP_H);
+}
+
+static double _Clip(double y)
+{
+    return fmin(fmax(y, -1.0), (double)CLIP_H);
+}
+
+//sine: amp * sin(2 pi f n / fs) + offset
+static double _SineRef(long n)
+{
+    return _Clip(AMP * sin(2.0 * M_PI * (double)FREQ * (double)n / FS) + OFFSET);
+}
+
+//sawtooth rising over [0, balance) of the phase shifted by balance / 2, falling over the rest
+static double _SawRef(long n)
+{
+    double q = fmod((double)n * (double)FREQ / FS + 0.5 * BALANCE, 1.0);
+    double y = fmin(-AMP + 2.0 * AMP * q / BALANCE, AMP - 2.0 * AMP * (q - BALANCE) / (1.0 - BALANCE));
+    return _Clip(y + OFFSET);
+}
+
+static double _MaxErrorAgainstRef(int len, t_lfo_algo_select algo, double (*pf_ref)(long))
+{
+    t_DAFXLowFrequencyOscillator lfo = {0};
+    int num_blocks = SECONDS * FS / len;
+    double max_err = 0.0;
+    long n = 0;
+
+    _Setup(&lfo, len);
+    LFO_SetMode(&lfo, algo);
+    LFO_SetBalance(&lfo, BALANCE);
+    LFO_ReinitPhase(&lfo);
+
+    for (int blk = 0; blk < num_blocks; blk++)
+    {
+        DAFXLowFrequencyOscillator(&lfo);
+        for (int i = 0; i < len; i++, n++) {
+            double err = fabs(pf_ref(n) - (double)lfo.p_output_block[i]);
+            if (err > max_err)
+                max_err = err;
+        }
+    }
+
+    DeallocDAFXLowFrequencyOscillator(&lfo);
+
+    return max_err;
+}
+
+//first block of the sine, block generator against the recursion
+static double _BlockAgainstRecursive(int len)
+{
+    t_DAFXLowFrequencyOscillator blk = {0};
+    t_DAFXLowFrequencyOscillator rec = {0};
+
+    _Setup(&blk, len);
+    _Setup(&rec, len);
+    LFO_SetProcessMode(&rec, LFO_PROCESS_RECURSIVE);
+
+    DAFXLowFrequencyOscillator(&blk);
+    DAFXLowFrequencyOscillator(&rec);
+    double err = DAFX_TestMaxDiff(blk.p_output_block, rec.p_output_block, len);
+
+    DeallocDAFXLowFrequencyOscillator(&blk);
+    DeallocDAFXLowFrequencyOscillator(&rec);
+
+    return err;
+}
+
+//recursive sine (renormalized) and sawtooth (fractional phase) over SOAK_SAMPLES samples,
+//largest error in the last second against the waveform at the exact phase
+static double _RecursiveSoakError(t_lfo_algo_select algo)
+{
+    t_DAFXLowFrequencyOscillator lfo = {0};
+    int len = 64;
+    long num_blocks = SOAK_SAMPLES / len;
+    double inc = (double)SOAK_FREQ / FS;
+    double max_err = 0.0;
+    long n = 0;
+
+    lfo.block_size = len;
+    lfo.fs = FS;
+    InitDAFXLowFrequencyOscillator(&lfo);
+    LFO_SetProcessMode(&lfo, LFO_PROCESS_RECURSIVE);
+    LFO_SetMode(&lfo, algo);
+    LFO_SetFrequency(&lfo, SOAK_FREQ);
+    LFO_SetBalance(&lfo, 0.5f);
+    LFO_ReinitPhase(&lfo);
+
+    for (long blk = 0; blk < num_blocks; blk++)
+    {
+        DAFXLowFrequencyOscillator(&lfo);
+        if (blk < num_blocks - FS / len) {
+            n += len;
+            continue;
+        }
+        //sample n is at phase n f / fs, as in block mode
+        for (int i = 0; i < len; i++, n++) {
+            double p = fmod((double)n * inc, 1.0);
+            double q = fmod(p + 0.25, 1.0);
+            double ref = (algo == LFO_ALGO_SELECT_SIN) ? sin(2.0 * M_PI * p) : (q < 0.5 ? 4.0 * q - 1.0 : 3.0 - 4.0 * q);
+            double err = fabs(ref - (double)lfo.p_output_block[i]);
+            if (err > max_err)
+                max_err = err;
+        }
+    }
+
+    DeallocDAFXLowFrequencyOscillator(&lfo);
+
+    return max_err;
+}
+
+int main(void)
+{
+    int lens[3] = {64, 256, 1023};
+
+    for (int k = 0; k < 3; k++)
+    {
+        double err_sin = _MaxErrorAgainstRef(lens[k], LFO_ALGO_SELECT_SIN, _SineRef);
+        double err_saw = _MaxErrorAgainstRef(lens[k], LFO_ALGO_SELECT_SAW, _SawRef);
+        double err_rec = _BlockAgainstRecursive(lens[k]);
+
+        DAFX_CHECK(err_sin < 1e-5, "block %d, %d s of sine: max error %.3g", lens[k], SECONDS, err_sin);
+        DAFX_CHECK(err_saw < 1e-5, "block %d, %d s of sawtooth: max error %.3g", lens[k], SECONDS, err_saw);
+        DAFX_CHECK(err_rec < 1e-5, "block %d: block sine against the recursive one %.3g", lens[k], err_rec);
+    }
+
+    double err_sin = _RecursiveSoakError(LFO_ALGO_SELECT_SIN);
+    double err_saw = _RecursiveSoakError(LFO_ALGO_SELECT_SAW);
+    DAFX_CHECK(err_sin < 1e-5, "recursive sine after %ld samples: max error %.3g", SOAK_SAMPLES, err_sin);
+    DAFX_CHECK(err_saw < 1e-4, "recursive sawtooth after %ld samples: max error %.3g", SOAK_SAMPLES, err_saw);
+
+    return DAFX_TEST_RESULT();
+}
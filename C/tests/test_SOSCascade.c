@@ -0,0 +1,143 @@
+//
+//  test_SOSCascade.c
+//
+//  The pipelined SOS cascade against the same stages run one after the other
+//  through the sample based biquad, block and sample processing alike
+//
+
+#include "DAFX_Test.h"
+#include "DAFX_BiquadFilter.h"
+#include "DAFX_SOSCascade.h"
+
+#define MAX_STAGES  9
+#define MAX_LEN     40
+#define NUM_BLOCKS  50
+
+static void _StageCoeffs(int stage, float *p_coeffs)
+{
+    p_coeffs[0] = 0.1f + 0.01f * (float)stage;
+    p_coeffs[1] = 0.2f;
+    p_coeffs[2] = 0.1f;
+    p_coeffs[3] = 1.0f;
+    p_coeffs[4] = -1.2f + 0.05f * (float)stage;
+    p_coeffs[5] = 0.5f;
+}
+
+//a sine with a click every 7 samples
+static float _Input(int i)
+{
+    return sinf(0.3f * (float)i) + ((i % 7 == 0) ? 1.0f : 0.0f);
+}
+
+static double _MaxErrorAgainstChain(int num_stages, int len)
+{
+    t_DAFX_BiquadFilter chain[MAX_STAGES];
+    t_DAFX_SOSCascade sos;
+    float coeffs[6];
+    float in[MAX_LEN], out[MAX_LEN], ref[MAX_LEN];
+    double max_err = 0.0;
+
+    sos.num_stages = num_stages;
+    InitSOSCascade(&sos);
+    for (int s = 0; s < num_stages; s++) {
+        _StageCoeffs(s, coeffs);
+        chain[s].buffer_len = len;
+        InitBiquadFilter(&chain[s]);
+        SetBiquadFilterCoeffs(&chain[s], coeffs);
+        SetSOSCascadeStageCoeffs(&sos, s, coeffs);
+    }
+
+    for (int blk = 0; blk < NUM_BLOCKS; blk++)
+    {
+        for (int i = 0; i < len; i++)
+            in[i] = _Input(blk * len + i);
+
+        for (int i = 0; i < len; i++) {
+            float x = in[i];
+            for (int s = 0; s < num_stages; s++)
+                x = ProcessSingleSampleBiquad(&chain[s], x);
+            ref[i] = x;
+        }
+
+        //every 5th block sample by sample, the others in place
+        if (blk % 5 == 4) {
+            for (int i = 0; i < len; i++)
+                out[i] = ProcessSingleSampleSOSCascade(&sos, in[i]);
+        } else {
+            memcpy(out, in, sizeof(float) * len);
+            ProcessBlockSOSCascade(&sos, out, out, len);
+        }
+
+        double err = DAFX_TestMaxDiff(out, ref, len);
+        if (err > max_err)
+            max_err = err;
+    }
+
+    for (int s = 0; s < num_stages; s++)
+        DeallocBiquadFilter(&chain[s]);
+    DeallocSOSCascade(&sos);
+
+    return max_err;
+}
+
+//dropping stages within the allocation has to give the same filter as a cascade built that short
+static double _MaxErrorAfterShrink(int max_stages, int num_stages)
+{
+    t_DAFX_SOSCascade sos_big, sos_ref;
+    float coeffs[6];
+    float out_big[MAX_LEN], out_ref[MAX_LEN];
+    double max_err = 0.0;
+
+    sos_big.num_stages = max_stages;
+    sos_ref.num_stages = num_stages;
+    InitSOSCascade(&sos_big);
+    InitSOSCascade(&sos_ref);
+    for (int s = 0; s < max_stages; s++) {
+        _StageCoeffs(s, coeffs);
+        SetSOSCascadeStageCoeffs(&sos_big, s, coeffs);
+        if (s < num_stages)
+            SetSOSCascadeStageCoeffs(&sos_ref, s, coeffs);
+    }
+    SetSOSCascadeNumStages(&sos_big, num_stages);
+
+    for (int blk = 0; blk < NUM_BLOCKS; blk++)
+    {
+        for (int i = 0; i < MAX_LEN; i++)
+            out_big[i] = out_ref[i] = _Input(blk * MAX_LEN + i);
+        ProcessBlockSOSCascade(&sos_big, out_big, out_big, MAX_LEN);
+        ProcessBlockSOSCascade(&sos_ref, out_ref, out_ref, MAX_LEN);
+
+        double err = DAFX_TestMaxDiff(out_big, out_ref, MAX_LEN);
+        if (err > max_err)
+            max_err = err;
+    }
+
+    DeallocSOSCascade(&sos_big);
+    DeallocSOSCascade(&sos_ref);
+
+    return max_err;
+}
+
+int main(void)
+{
+    for (int num_stages = 1; num_stages <= MAX_STAGES; num_stages++)
+    {
+        double max_err = 0.0;
+        for (int len = 1; len <= MAX_LEN; len += 3) {
+            double err = _MaxErrorAgainstChain(num_stages, len);
+            if (err > max_err)
+                max_err = err;
+        }
+        DAFX_CHECK(max_err < 1e-5, "%d stages, blocks of 1..%d: max error against the biquad chain %.3g",
+                   num_stages, MAX_LEN, max_err);
+    }
+
+    for (int num_stages = 1; num_stages < MAX_STAGES; num_stages++)
+    {
+        double err = _MaxErrorAfterShrink(MAX_STAGES, num_stages);
+        DAFX_CHECK(err == 0.0, "%d of %d stages in use: max difference to a %d stage cascade %.3g",
+                   num_stages, MAX_STAGES, num_stages, err);
+    }
+
+    return DAFX_TEST_RESULT();
+}
@@ -0,0 +1,279 @@
+//
+//  test_Saturation.c
+//
+//  tanh approximation tiers against double precision tanh: the max errors
+//  documented in DAFX_Saturation.h, the output range, monotonicity and the gains.
+//  ADAA shapers against the mean of the shaper over the last inputs, computed by
+//  quadrature in double, and the aliasing they remove from a driven tone
+//
+
+#include "DAFX_Test.h"
+#include "DAFX_Saturation.h"
+#include "DAFX_FFT.h"
+#include "DAFX_Denormal.h"
+
+#define NUM_POINTS  (1 << 20)
+#define X_MAX       20.0f
+
+static float in[NUM_POINTS];
+static float out[NUM_POINTS];
+
+static const char *c_tier_name[Saturation_N_TANH_TIERS] = {"libm", "exp", "pade", "poly"};
+
+//documented max errors, with room for the rounding of other compilers
+static const double c_max_error[Saturation_N_TANH_TIERS] = {2e-7, 2e-7, 1e-4, 4e-3};
+
+static void _TestTier(t_sat_tanh_tier tier)
+{
+    double max_err = 0.0, max_step_back = 0.0;
+    bool in_range = true;
+
+    for (int i = 0; i < NUM_POINTS; i++)
+        in[i] = -X_MAX + 2.0f * X_MAX * (float)i / (float)(NUM_POINTS - 1);
+    SAT_TanhBlock(tier, in, out, NUM_POINTS, 1.0f, 1.0f);
+
+    for (int i = 0; i < NUM_POINTS; i++)
+    {
+        double err = fabs((double)out[i] - tanh((double)in[i]));
+        if (err > max_err)
+            max_err = err;
+        if (out[i] > 1.0f || out[i] < -1.0f)
+            in_range = false;
+        if (i > 0 && out[i - 1] - out[i] > max_step_back)
+            max_step_back = out[i - 1] - out[i];
+    }
+
+    DAFX_CHECK(max_err <= c_max_error[tier], "%-4s: max error over [-%g, %g] %.3g", c_tier_name[tier], X_MAX, X_MAX, max_err);
+    DAFX_CHECK(in_range, "%-4s: output within [-1, 1]", c_tier_name[tier]);
+    DAFX_CHECK(max_step_back < 4e-6, "%-4s: monotonic up to float rounding (largest step back %.2g)", c_tier_name[tier], max_step_back);
+
+    //in place, with both gains
+    for (int i = 0; i < 64; i++)
+        in[i] = 0.9f * sinf(0.1f * (float)i);
+    memcpy(out, in, 64 * sizeof(float));
+    SAT_TanhBlock(tier, out, out, 64, 5.0f, 0.75f);
+    double max_gain_err = 0.0;
+    for (int i = 0; i < 64; i++) {
+        double err = fabs((double)out[i] - 0.75 * tanh(5.0 * (double)in[i]));
+        if (err > max_gain_err)
+            max_gain_err = err;
+    }
+    DAFX_CHECK(max_gain_err <= 0.75 * c_max_error[tier] + 1e-7, "%-4s: 0.75 tanh(5 x) in place, max error %.3g",
+               c_tier_name[tier], max_gain_err);
+}
+
+// ---- ADAA ---- //
+
+#define ADAA_BLOCK_LEN      64
+#define ADAA_NUM_BLOCKS     60
+#define QUAD_STEPS          400         //Simpson, even
+#define FFT_SIZE            16384
+#define TONE_BIN            849         //odd: no alias lands on a harmonic
+
+static const char *c_shape_name[Saturation_N_SHAPES] = {"tanh", "sine", "exp"};
+
+static double _Shaper(t_sat_shape shape, double u)
+{
+    switch (shape) {
+        case SAT_SHAPE_SINE:
+            return sin(0.5 * M_PI * fmax(-1.0, fmin(1.0, u)));
+        case SAT_SHAPE_EXP:
+            return copysign(1.0 - exp(-fabs(u)), u);
+        default:
+            return tanh(u);
+    }
+}
+
+static double _Simpson(t_sat_shape shape, double lo, double hi, double w0, double w1)
+{
+    double h = (hi - lo) / QUAD_STEPS;
+    double sum = 0.0;
+
+    for (int i = 0; i <= QUAD_STEPS; i++) {
+        double x = lo + i * h;
+        double c = (i == 0 || i == QUAD_STEPS) ? 1.0 : ((i % 2) ? 4.0 : 2.0);
+        sum += c * _Shaper(shape, x) * (w0 + w1 * x);
+    }
+    return sum * h / 3.0;
+}
+
+//integral over [lo, hi] of the shaper times the weight w0 + w1 x, split where
+//the sine and exp shapers are not smooth (-1, 0, 1) so Simpson keeps its accuracy
+static double _Integral(t_sat_shape shape, double lo, double hi, double w0, double w1)
+{
+    static const double c_kinks[3] = {-1.0, 0.0, 1.0};
+    double sum = 0.0;
+
+    for (int k = 0; k < 3; k++) {
+        if (c_kinks[k] > lo && c_kinks[k] < hi) {
+            sum += _Simpson(shape, lo, c_kinks[k], w0, w1);
+            lo = c_kinks[k];
+        }
+    }
+    return sum + _Simpson(shape, lo, hi, w0, w1);
+}
+
+//1st order: mean of the shaper between the last 2 inputs
+static double _ADAA1Ref(t_sat_shape shape, double x0, double x1)
+{
+    if (fabs(x0 - x1) < 1e-9)
+        return _Shaper(shape, x0);
+    return _Integral(shape, fmin(x0, x1), fmax(x0, x1), 1.0, 0.0) / fabs(x0 - x1);
+}
+
+//2nd order: mean of the shaper weighted by the linear B-spline on the last 3 inputs
+static double _ADAA2Ref(t_sat_shape shape, double x0, double x1, double x2)
+{
+    double k[3] = {x0, x1, x2};
+    for (int i = 0; i < 3; i++) {
+        for (int j = i + 1; j < 3; j++) {
+            if (k[j] < k[i]) {
+                double t = k[i];
+                k[i] = k[j];
+                k[j] = t;
+            }
+        }
+    }
+    double p = k[0], q = k[1], r = k[2];
+    if (r - p < 1e-9)
+        return _Shaper(shape, q);
+
+    double sum = 0.0;
+    if (q > p)
+        sum += _Integral(shape, p, q, -p / (q - p), 1.0 / (q - p));
+    if (r > q)
+        sum += _Integral(shape, q, r, r / (r - q), -1.0 / (r - q));
+    return 2.0 * sum / (r - p);
+}
+
+static unsigned int adaa_seed = 1;
+
+static double _Random(void)
+{
+    adaa_seed = adaa_seed * 1664525u + 1013904223u;
+    return (double)(adaa_seed >> 8) * (2.0 / 16777216.0) - 1.0;
+}
+
+//random walks and sines from 0.3 to 200 in shaper units, blocks of varying length
+static double _ADAAMaxError(t_DAFXSaturationADAA *pADAA, t_sat_shape shape, t_sat_adaa_order order)
+{
+    static const double c_amp[5] = {0.3, 1.0, 3.0, 20.0, 200.0};
+    static const double c_step[5] = {0.001, 0.01, 0.05, 0.3, 3.0};
+    float x[ADAA_BLOCK_LEN], y[ADAA_BLOCK_LEN];
+    double max_err = 0.0;
+
+    adaa_seed = 1;
+    for (int sc = 0; sc < 5; sc++)
+    {
+        double hist[3] = {0.0, 0.0, 0.0};
+        double u = 0.0, phase = 0.0;
+
+        SAT_ResetADAA(pADAA);
+        for (int blk = 0; blk < ADAA_NUM_BLOCKS; blk++)
+        {
+            int n = 1 + (blk * 37) % ADAA_BLOCK_LEN;
+            for (int i = 0; i < n; i++) {
+                if (blk % 2) {
+                    phase += 0.013 * (1 + sc);
+                    u = c_amp[sc] * sin(phase);
+                } else {
+                    u += _Random() * c_step[sc] * c_amp[sc];
+                    if (fabs(u) > c_amp[sc])
+                        u = copysign(c_amp[sc], u);
+                }
+                x[i] = (float)u;
+            }
+            SAT_ADAABlock(pADAA, shape, order, x, y, n, 1.0f, 1.0f);
+
+            for (int i = 0; i < n; i++)
+            {
+                hist[0] = hist[1];
+                hist[1] = hist[2];
+                hist[2] = x[i];
+                double ref = (order == SAT_ADAA_FIRST_ORDER) ? _ADAA1Ref(shape, hist[2], hist[1])
+                                                             : _ADAA2Ref(shape, hist[2], hist[1], hist[0]);
+                double err = fabs(ref - (double)y[i]);
+                if (err > max_err)
+                    max_err = err;
+            }
+        }
+    }
+    return max_err;
+}
+
+//alias power below 20 kHz against the power of the harmonics, in dB, for a tone at 2.5 kHz / 48 kHz
+static double _AliasPower(t_DAFXSaturationADAA *pADAA, t_DAFX_FFT *pFFT, t_sat_shape shape, t_sat_adaa_order order, float drive)
+{
+    static float in[2 * FFT_SIZE], out[2 * FFT_SIZE];
+    float *p_re = (float *) DAFX_AlignedCalloc(FFT_SIZE / 2, sizeof(float));
+    float *p_im = (float *) DAFX_AlignedCalloc(FFT_SIZE / 2, sizeof(float));
+    double harm = 0.0, alias = 0.0;
+
+    for (int i = 0; i < 2 * FFT_SIZE; i++)
+        in[i] = (float)(0.9 * sin(2.0 * M_PI * TONE_BIN * (double)i / FFT_SIZE));
+
+    //the first half lets the history settle
+    SAT_ResetADAA(pADAA);
+    for (int i = 0; i < 2 * FFT_SIZE; i += ADAA_BLOCK_LEN)
+        SAT_ADAABlock(pADAA, shape, order, in + i, out + i, ADAA_BLOCK_LEN, drive, 1.0f);
+    FFTForwardReal(pFFT, out + FFT_SIZE, p_re, p_im);
+
+    for (int k = 1; k < FFT_SIZE / 2; k++) {
+        double p = (double)p_re[k] * p_re[k] + (double)p_im[k] * p_im[k];
+        if (k % TONE_BIN == 0)
+            harm += p;
+        else if (k * 48000.0 / FFT_SIZE < 20000.0)
+            alias += p;
+    }
+
+    DAFX_AlignedFree(p_re);
+    DAFX_AlignedFree(p_im);
+
+    return 10.0 * log10(alias / harm);
+}
+
+static void _TestADAA(void)
+{
+    static const float c_drive[Saturation_N_SHAPES] = {20.0f, 8.0f, 20.0f};
+    t_DAFXSaturationADAA adaa = {0};
+    t_DAFX_FFT fft = {0};
+    t_dafx_fp_state fp_state;
+
+    adaa.block_size = ADAA_BLOCK_LEN;
+    InitDAFXSaturationADAA(&adaa);
+    fft.size = FFT_SIZE;
+    InitFFT(&fft);
+
+    //as in a host callback: the shapers do not guard against subnormals themselves
+    DAFX_DenormalGuardBegin(&fp_state);
+
+    for (int s = 0; s < Saturation_N_SHAPES; s++)
+    {
+        t_sat_shape shape = (t_sat_shape)s;
+        double err1 = _ADAAMaxError(&adaa, shape, SAT_ADAA_FIRST_ORDER);
+        double err2 = _ADAAMaxError(&adaa, shape, SAT_ADAA_SECOND_ORDER);
+        DAFX_CHECK(err1 < 1e-4, "%-4s ADAA1: max error against the mean of the shaper %.3g", c_shape_name[s], err1);
+        DAFX_CHECK(err2 < 1e-4, "%-4s ADAA2: max error against the mean of the shaper %.3g", c_shape_name[s], err2);
+
+        double alias0 = _AliasPower(&adaa, &fft, shape, SAT_ADAA_OFF, c_drive[s]);
+        double alias1 = _AliasPower(&adaa, &fft, shape, SAT_ADAA_FIRST_ORDER, c_drive[s]);
+        double alias2 = _AliasPower(&adaa, &fft, shape, SAT_ADAA_SECOND_ORDER, c_drive[s]);
+        DAFX_CHECK(alias1 < alias0 - 6.0 && alias2 < alias1 - 6.0,
+                   "%-4s drive %g: aliases below 20 kHz %.1f dB plain, %.1f dB ADAA1, %.1f dB ADAA2",
+                   c_shape_name[s], c_drive[s], alias0, alias1, alias2);
+    }
+
+    DAFX_DenormalGuardEnd(&fp_state);
+
+    DeallocDAFXSaturationADAA(&adaa);
+    DeallocFFT(&fft);
+}
+
+int main(void)
+{
+    for (int t = 0; t < Saturation_N_TANH_TIERS; t++)
+        _TestTier((t_sat_tanh_tier)t);
+    _TestADAA();
+
+    return DAFX_TEST_RESULT();
+}
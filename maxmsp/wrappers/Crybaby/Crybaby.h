@@ -18,6 +18,7 @@
 #endif
 
 #include "DAFX_Crybaby.h"
+#include "DAFX_FrequencyResponse.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +38,11 @@ enum
     CB_INLET_LFO_CLIP_L,
     CB_INLET_REINIT_LFO_PHASE,
     CB_INLET_BYPASS_CB,
+    CB_INLET_COEFF_UPDATE_MODE,
+    CB_INLET_MOD_SOURCE,
+    CB_INLET_ENV_SENSITIVITY,
+    CB_INLET_ENV_ATTACK,
+    CB_INLET_ENV_RELEASE,
     Crybaby_N_INLETS,
 };
 
@@ -47,6 +53,12 @@ enum
     CB_OUTLET_LFO_SIGNAL,
     Crybaby_N_OUTLETS,
 };
+
+//rightmost outlet (not a signal): magnitude response in dB as a list, on a log-spaced
+//grid of CB_CURVE_NUM_POINTS points from 20 Hz to 20 kHz, at most every CB_CURVE_PERIOD_MS
+#define CB_OUTLET_RESPONSE_CURVE    Crybaby_N_OUTLETS
+#define CB_CURVE_NUM_POINTS         512
+#define CB_CURVE_PERIOD_MS          50
     
     
     
@@ -56,6 +68,15 @@ enum
         
         t_DAFXCrybaby * pCB;
         void * pf_CB_perform;        
+        
+        //response curve publishing: evaluated and sent from the scheduler, triggered from perform
+        t_DAFX_FrequencyResponse * pFR;
+        void * p_curve_outlet;
+        void * p_curve_clock;
+        t_atom * p_curve_atoms;
+        long curve_period_samples;
+        long curve_countdown;
+        int curve_version_sent;
        
     } t_Crybaby;
     
@@ -81,6 +102,9 @@ enum
     //runs if input is a bang
     void Crybaby_bang(t_Crybaby *x);
     
+    //evaluates the current filter response and sends it if it changed (scheduler thread)
+    void Crybaby_curve_tick(t_Crybaby *x);
+    
     // Runs if mouse is hovered over an in/outlet
     void Crybaby_assist(t_Crybaby *x, void *b, long m, long a, char *s);    
     
@@ -60,6 +60,9 @@ void *Crybaby_new(t_symbol *s, long argc, t_atom *argv)
         // dsp_setup sets up these inlets as proxies!
         dsp_setup((t_pxobject *)x, Crybaby_N_INLETS);	// MSP inlets: arg is # of inlets and is REQUIRED! use 0 if you don't need inlets
         
+        //Response curve outlet - created first so that it ends up rightmost
+        x->p_curve_outlet = listout(x);
+        
         //Creating outlets - note: no need to store pointers to them in the struct, as in Max object       
         for (int i = 0; i < Crybaby_N_OUTLETS; i++) {
             outlet_new(x, "signal"); 		// signal outlet (note "signal" rather than NULL)
@@ -77,6 +80,17 @@ void *Crybaby_new(t_symbol *s, long argc, t_atom *argv)
         x->pCB->block_size = DAFX_BLOCK_SIZE;        
         
         InitDAFXCrybaby(x->pCB);          
+        
+        //Response curve of the wah filter
+        x->pFR = (t_DAFX_FrequencyResponse *) calloc(1, sizeof(t_DAFX_FrequencyResponse));
+        x->pFR->fs = x->pCB->fs;
+        x->pFR->num_points = CB_CURVE_NUM_POINTS;
+        InitFrequencyResponse(x->pFR);
+        x->p_curve_atoms = (t_atom *) calloc(CB_CURVE_NUM_POINTS, sizeof(t_atom));
+        x->p_curve_clock = clock_new(x, (method)Crybaby_curve_tick);
+        x->curve_period_samples = (long)CB_CURVE_PERIOD_MS * x->pCB->fs / 1000;
+        x->curve_countdown = 0;
+        x->curve_version_sent = 0;
     }
     return (x);
 }
@@ -86,7 +100,15 @@ void *Crybaby_new(t_symbol *s, long argc, t_atom *argv)
 void Crybaby_free(t_Crybaby *x)
 {
     dsp_free((t_pxobject *)x);
+    
+    //no curve tick may run past this point, it reads the filter coeffs and the response buffers
+    clock_unset(x->p_curve_clock);
+    object_free(x->p_curve_clock);
+    
     DeallocDAFXCrybaby(x->pCB);
+    DeallocFrequencyResponse(x->pFR);
+    FREE(x->pFR);
+    FREE(x->p_curve_atoms);
 }
 
 //Action if mouse is hovered over the in/outlets
@@ -131,6 +153,21 @@ void Crybaby_assist(t_Crybaby *x, void *b, long m, long a, char *s)
             case CB_INLET_BYPASS_CB:
                 sprintf(s, "(int) Bypass / Manual / Auto");
                 break;
+            case CB_INLET_COEFF_UPDATE_MODE:
+                sprintf(s, "(int) Auto-wah filter update (0: every sample, 1: per-block ramp, 2: control rate)");
+                break;
+            case CB_INLET_MOD_SOURCE:
+                sprintf(s, "(int) Auto-wah source (0: LFO, 1: input envelope)");
+                break;
+            case CB_INLET_ENV_SENSITIVITY:
+                sprintf(s, "(float) Envelope sensitivity (dB)");
+                break;
+            case CB_INLET_ENV_ATTACK:
+                sprintf(s, "(float) Envelope attack (ms)");
+                break;
+            case CB_INLET_ENV_RELEASE:
+                sprintf(s, "(float) Envelope release (ms)");
+                break;
             
             default:
                 sprintf(s, "Invalid inlet!");
@@ -149,7 +186,10 @@ void Crybaby_assist(t_Crybaby *x, void *b, long m, long a, char *s)
                 sprintf(s, "(signal) biquad filter coefficients");
                 break;
             case CB_OUTLET_LFO_SIGNAL:
-                sprintf(s, "(signal) Auto-wah control signal (LFO)");
+                sprintf(s, "(signal) Auto-wah control signal (pedal position)");
+                break;
+            case CB_OUTLET_RESPONSE_CURVE:
+                sprintf(s, "(list) Filter magnitude response (dB), log-spaced 20 Hz - 20 kHz");
                 break;
             default:
                 sprintf(s, "Invalid outlet!");
@@ -232,6 +272,28 @@ void Crybaby_float(t_Crybaby *x, double f)
             }            
             break;
             
+        //Auto-wah coefficient update: table lookup per sample or ramped per block
+        case CB_INLET_COEFF_UPDATE_MODE:
+            Crybaby_SetCoeffUpdateMode(x->pCB, (t_cb_coeff_update_mode) f);
+            break;
+            
+        //Auto-wah driven by the LFO or by the envelope of the input
+        case CB_INLET_MOD_SOURCE:
+            Crybaby_SetModSource(x->pCB, (t_cb_mod_source) f);
+            break;
+            
+        case CB_INLET_ENV_SENSITIVITY:
+            Crybaby_SetEnvSensitivity(x->pCB, f);
+            break;
+            
+        case CB_INLET_ENV_ATTACK:
+            Crybaby_SetEnvAttack(x->pCB, f);
+            break;
+            
+        case CB_INLET_ENV_RELEASE:
+            Crybaby_SetEnvRelease(x->pCB, f);
+            break;
+            
         default:
             break;
     }
@@ -257,11 +319,41 @@ void Crybaby_bang(t_Crybaby *x)
 }
 
 
+//Sends the magnitude response of the current filter, unless it has not changed since the last time
+void Crybaby_curve_tick(t_Crybaby *x)
+{
+    //cached by coefficient hash - a still pedal costs nothing here
+    FR_EvaluateBiquad(x->pFR, x->pCB->p_biquad_coeffs);
+    
+    if (x->pFR->version == x->curve_version_sent)
+        return;
+    x->curve_version_sent = x->pFR->version;
+    
+    for (int i = 0; i < CB_CURVE_NUM_POINTS; i++) {
+        atom_setfloat(x->p_curve_atoms + i, x->pFR->p_magnitude_db[i]);
+    }
+    outlet_list(x->p_curve_outlet, NULL, CB_CURVE_NUM_POINTS, x->p_curve_atoms);
+}
+
+
 // registers a function for the signal chain in Max
 // This function is called if the input is a signal.
 // It is possible to assign a different perform function with object_method() based on some condition
 void Crybaby_dsp64(t_Crybaby *x, t_object *dsp64, short *count, double samplerate, long maxvectorsize, long flags)
 {
+    //the filter tables are only rebuilt if the sample rate has changed
+    if ((int)samplerate != x->pCB->fs)
+    {
+        //a pending curve tick would be computed half on the old grid
+        clock_unset(x->p_curve_clock);
+        
+        Crybaby_SetSampleRate(x->pCB, (int)samplerate);
+        
+        //same buffers, the grid is recomputed in place (back to the default range, clipped to the new Nyquist)
+        FR_SetGrid(x->pFR, x->pCB->fs, 0.0, 0.0);
+        x->curve_period_samples = (long)CB_CURVE_PERIOD_MS * x->pCB->fs / 1000;
+        x->curve_version_sent = 0;
+    }
     
     //This call adds the DSP operation of this MSP object to the signal chain
     //It is also possible to implement several perform functions, and assigning a different one to the DSP chain
@@ -299,6 +391,9 @@ void Crybaby_perform64(t_Crybaby *x,
     performFunction CB_perform = (performFunction) x->pf_CB_perform;
     CB_perform(pCB);  
     
+    //pedal positions driven by the LFO or the envelope, at control rate (reuses the output block of the LFO)
+    Crybaby_GetPedalTrack(pCB, pCB->pLFO->p_output_block);
+    
     for(int i = 0; i < sampleframes; i++){
         //Converting results from float back to double, which Max expects
         OutSignal[i] = (double) pCB->p_output_block[i];
@@ -309,4 +404,11 @@ void Crybaby_perform64(t_Crybaby *x,
         OutFilterCoeffs[i] = (double) pCB->p_biquad_coeffs[i];
     }
     
+    //throttled response curve: the evaluation runs in the scheduler, not in the audio thread
+    x->curve_countdown -= sampleframes;
+    if (x->curve_countdown <= 0) {
+        x->curve_countdown = x->curve_period_samples;
+        clock_delay(x->p_curve_clock, 0);
+    }
+    
 }
\ No newline at end of file
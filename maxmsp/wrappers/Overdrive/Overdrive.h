@@ -32,6 +32,11 @@ enum
     OD_INLET_PARAM,
     OD_INLET_THRESH,
     OD_INLET_BYPASS_OD,
+    OD_INLET_TANH_TIER,
+    OD_INLET_ADAA,
+    OD_INLET_OVERSAMPLING,
+    OD_INLET_OS_FILTER,
+    OD_INLET_TABLE_INTERP,
     Overdrive_N_INLETS,
 };
 
@@ -72,6 +77,12 @@ enum
     //runs if input is an int
     void Overdrive_int(t_Overdrive *x, long n);
     
+    //"read <file>": loads a transfer curve for the table algo (no file name opens a dialog)
+    void Overdrive_read(t_Overdrive *x, t_symbol *s);
+    
+    //the file is read on the main thread
+    void Overdrive_doread(t_Overdrive *x, t_symbol *s, long argc, t_atom *argv);
+    
     // Runs if mouse is hovered over an in/outlet
     void Overdrive_assist(t_Overdrive *x, void *b, long m, long a, char *s);    
     
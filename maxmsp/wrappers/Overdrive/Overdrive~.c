@@ -36,6 +36,7 @@ void ext_main(void *r)
     class_addmethod(c, (method)Overdrive_assist,	"assist",	A_CANT, 0); //action if mouse is hovered over an in/outlet
     class_addmethod(c, (method)Overdrive_int,	"int",      A_LONG, 0); //action if input is an int
     class_addmethod(c, (method)Overdrive_float,	"float",	A_FLOAT,0); //action if input is a float
+    class_addmethod(c, (method)Overdrive_read,	"read",     A_DEFSYM,0); //loads a transfer curve file
     
     class_dspinit(c); //this is always needed for MSP objects
     class_register(CLASS_BOX, c);
@@ -83,7 +84,7 @@ void *Overdrive_new(t_symbol *s, long argc, t_atom *argv)
 void Overdrive_free(t_Overdrive *x)
 {
     dsp_free((t_pxobject *)x);
-    DeallocDAFXOverdrive(x->pOD);
+    DeallocDAFXOverdrive(x->pOD); //also frees a table retired by a read
 }
 
 //Action if mouse is hovered over the in/outlets
@@ -96,7 +97,7 @@ void Overdrive_assist(t_Overdrive *x, void *b, long m, long a, char *s)
                 sprintf(s, "(signal) Input signal");
                 break;
             case OD_INLET_ALGO_SELECT:
-                sprintf(s, "(int) algo selector. 0 - tanh, 1 - sin, 2 - exp");
+                sprintf(s, "(int) algo selector. 0 - tanh, 1 - sin, 2 - exp, 3 - table (after read)");
                 break;
             case OD_INLET_IN_GAIN:
                 sprintf(s, "(float) input gain (linear)");
@@ -113,6 +114,21 @@ void Overdrive_assist(t_Overdrive *x, void *b, long m, long a, char *s)
             case OD_INLET_BYPASS_OD:
                 sprintf(s, "(int) Bypass / Enable OD (lookup) / Enable OD (formula) ");
                 break;
+            case OD_INLET_TANH_TIER:
+                sprintf(s, "(int) tanh accuracy. 0 - libm, 1 - exp, 2 - pade, 3 - polynomial");
+                break;
+            case OD_INLET_ADAA:
+                sprintf(s, "(int) antialiasing. 0 - off, 1 - 1st order ADAA, 2 - 2nd order ADAA");
+                break;
+            case OD_INLET_OVERSAMPLING:
+                sprintf(s, "(int) oversampling factor. 1, 2, 4 or 8");
+                break;
+            case OD_INLET_OS_FILTER:
+                sprintf(s, "(int) oversampling filters. 0 - linear phase, 1 - minimum phase");
+                break;
+            case OD_INLET_TABLE_INTERP:
+                sprintf(s, "(int) table interpolation. 0 - linear, 1 - cubic");
+                break;
             
             default:
                 sprintf(s, "Invalid inlet!");
@@ -150,33 +166,17 @@ void Overdrive_float(t_Overdrive *x, double f)
     {
         //Overdrive algo selector
         case OD_INLET_ALGO_SELECT:
-            {
-                switch((int)f) {
-                    case OD_ALGO_SELECT_TANH:
-                        x->pOD->algo = OD_ALGO_SELECT_TANH;
-                        break;
-                    case OD_ALGO_SELECT_SIN:
-                        x->pOD->algo = OD_ALGO_SELECT_SIN;
-                        break;
-                    case OD_ALGO_SELECT_EXP:
-                        x->pOD->algo = OD_ALGO_SELECT_EXP;
-                        break;
-                    default:
-                        break;
-                }
-            }
+            OD_SetAlgo(x->pOD, (t_od_algo_select)DAFX_MAX((int)f, 0));
             break;
             
         //Input gain
         case OD_INLET_IN_GAIN:
-            x->pOD->in_gain = DAFX_MAX(DAFX_MIN(f, OD_INIT_IN_GAIN_MAX), OD_INIT_IN_GAIN_MIN);
-            ReDrawGainCurve(x->pOD);
+            OD_SetInGain(x->pOD, f);
             break;
         
         //Output gain
         case OD_INLET_OUT_GAIN:
-            x->pOD->out_gain = DAFX_MAX(DAFX_MIN(f, OD_INIT_OUT_GAIN_MAX), OD_INIT_OUT_GAIN_MIN);
-            ReDrawGainCurve(x->pOD);
+            OD_SetOutGain(x->pOD, f);
             break;
             
         //Overdrive parameter
@@ -184,18 +184,17 @@ void Overdrive_float(t_Overdrive *x, double f)
             {
                 switch(x->pOD->algo) {
                     case OD_ALGO_SELECT_TANH:
-                        x->pOD->tan_param = DAFX_MAX(DAFX_MIN(f, OD_INIT_TAN_MAX), OD_INIT_TAN_MIN);
+                        OD_SetTanParam(x->pOD, f);
                         break;
                     case OD_ALGO_SELECT_SIN:
                         break;
                     case OD_ALGO_SELECT_EXP:
-                        x->pOD->exp_param = DAFX_MAX(DAFX_MIN(f, OD_INIT_EXP_MAX), OD_INIT_EXP_MIN);
+                        OD_SetExpParam(x->pOD, f);
                         break;
                     default:
                         break;
                 }
             }
-            ReDrawGainCurve(x->pOD);
             break;
             
             
@@ -207,14 +206,12 @@ void Overdrive_float(t_Overdrive *x, double f)
                         break;
                     case OD_ALGO_SELECT_SIN:
                     case OD_ALGO_SELECT_EXP:
-                        x->pOD->thresh = DAFX_MAX(DAFX_MIN(f, OD_INIT_THRESH_MAX), OD_INIT_THRESH_MIN);
-                        x->pOD->inv_thresh = 1.0f / x->pOD->thresh;
+                        OD_SetThreshold(x->pOD, f);
                         break;
                     default:
                         break;
                 }
             }
-            ReDrawGainCurve(x->pOD);
             break;
             
         //Set the OD_perform to Bypass / process
@@ -231,9 +228,36 @@ void Overdrive_float(t_Overdrive *x, double f)
             }
             break;
             
+        //tanh approximation
+        case OD_INLET_TANH_TIER:
+            OD_SetTanhTier(x->pOD, (t_sat_tanh_tier)DAFX_MAX((int)f, 0));
+            break;
+            
+        //antiderivative anti-aliasing
+        case OD_INLET_ADAA:
+            OD_SetADAAOrder(x->pOD, (t_sat_adaa_order)DAFX_MAX((int)f, 0));
+            break;
+            
+        //oversampling of the shaper
+        case OD_INLET_OVERSAMPLING:
+            OD_SetOversampling(x->pOD, (int)f);
+            break;
+            
+        case OD_INLET_OS_FILTER:
+            OD_SetOversamplingFilter(x->pOD, (int)f);
+            break;
+            
+        //interpolation of the table algo
+        case OD_INLET_TABLE_INTERP:
+            OD_SetTableInterp(x->pOD, (t_sat_table_interp)DAFX_MAX((int)f, 0));
+            break;
+            
         default:
             break;
     }
+    
+    //only redrawn if the shape has actually changed, here rather than in the perform routine
+    ReDrawGainCurve(x->pOD);
 }
 
 //Action if input was an int
@@ -242,12 +266,57 @@ void Overdrive_int(t_Overdrive *x, long n)
     Overdrive_float(x, (double)n);
 }
 
+//Action if a "read" message was received
+void Overdrive_read(t_Overdrive *x, t_symbol *s)
+{
+    defer(x, (method)Overdrive_doread, s, 0, NULL);
+}
+
+//Looks the file up in the Max search path and loads it. The table algo is then picked with the algo inlet
+void Overdrive_doread(t_Overdrive *x, t_symbol *s, long argc, t_atom *argv)
+{
+    char filename[MAX_PATH_CHARS];
+    char fullpath[MAX_PATH_CHARS];
+    short path;
+    t_fourcc type;
+    
+    if (s == gensym("")) {
+        filename[0] = 0;
+        if (open_dialog(filename, &path, &type, NULL, 0))
+            return;
+    }
+    else {
+        strncpy_zero(filename, s->s_name, MAX_PATH_CHARS);
+        if (locatefile_extended(filename, &path, &type, NULL, 0)) {
+            object_error((t_object *)x, "%s: can't find file", s->s_name);
+            return;
+        }
+    }
+    
+    //the table swapped out by the previous read, the perform routine may only be done with it once a vector has passed
+    if (!OD_ReleaseRetiredTable(x->pOD, !sys_getdspobjdspstate((t_object *)x))) {
+        object_error((t_object *)x, "%s: previous transfer curve still in use, try again", filename);
+        return;
+    }
+    
+    if (path_toabsolutesystempath(path, filename, fullpath) ||
+        !OD_LoadTableFile(x->pOD, fullpath)) {
+        object_error((t_object *)x, "%s: not a transfer curve (1 or 2 numbers per line, at most %d points)",
+                     filename, SAT_TABLE_MAX_NUMOF_POINTS);
+        return;
+    }
+    
+    ReDrawGainCurve(x->pOD);
+}
+
 
 // registers a function for the signal chain in Max
 // This function is called if the input is a signal.
 // It is possible to assign a different perform function with object_method() based on some condition
 void Overdrive_dsp64(t_Overdrive *x, t_object *dsp64, short *count, double samplerate, long maxvectorsize, long flags)
 {
+    //the chain is stopped while it is rebuilt, no perform call can hold a table retired by a read
+    OD_ReleaseRetiredTable(x->pOD, true);
     
     //This call adds the DSP operation of this MSP object to the signal chain
     //It is also possible to implement several perform functions, and assigning a different one to the DSP chain